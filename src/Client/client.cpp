@@ -1,11 +1,14 @@
 // STL
 #include <cassert>
+#include <iostream>
+#include <sstream>
 #include <string.h>
 #include <vector>
 
 // Boost
 #include <boost/array.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/chrono.hpp>
 
 // Project
 #include "client.h"
@@ -18,39 +21,40 @@
 //------------------------------------------------------------------------------
 client::client(
 	const std::string& inUsername,
-	const uint16_t& inServerPort,
-	const int8_t& inServerIndex,
+	const serverTopology& inTopology,
+	const int16_t& inServerIndex,
 	boost::asio::io_service& ioService) :
-	m_resolver(ioService),
 	m_UDPsocket(ioService),
-	m_serverPort(inServerPort),
+	m_serverEndPoint(inTopology.viewServerEndpoint(inServerIndex)),
+	m_deliveryBuffer(inTopology.viewReorderHoldMilliseconds()),
 	m_terminate(false),
-	m_sequenceNumber(0)
+	m_serverName(inTopology.viewServerName(inServerIndex))
 {
 	this->m_username = inUsername;
-	this->m_serverIndex = inServerIndex;
+
+	// numbered from the time the client started, so the clients it sends
+	// to do not take its messages for duplicates of ones sent before a
+	// restart
+	this->m_sequenceNumber =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count() * 1000;
 
 	this->m_activeProtocol =
 		client::Protocol::p_UDP;
 
-	const std::string serverAddress = 
-		constants::serverHostName(this->m_serverIndex);
-
-	const std::string serverPort =
-		std::to_string(inServerPort);
-
-	boost::asio::ip::udp::resolver::query serverQuery(
-		boost::asio::ip::udp::v4(),
-		serverAddress,
-		serverPort);
-
-	this->m_serverEndPoint =
-		*this->m_resolver.resolve(serverQuery);
-
 	this->m_UDPsocket.open(
 		boost::asio::ip::udp::v4());
 
-	std::string destination = constants::serverIndexToServerName(this->m_serverIndex);
+	this->connect();
+};
+
+//---------------------------------------------------------------------- connect
+// Implementation notes:
+//  Also used when the server no longer knows the client's session
+//------------------------------------------------------------------------------
+void client::connect()
+{
+	std::string destination = this->m_serverName;
 	std::string initiateMessage = this->m_username + " has connected.";
 
 	dataMessage connectionMessage(
@@ -83,6 +87,10 @@ void client::run()
 	this->m_threads.create_thread(
 		boost::bind(&client::receiveLoop, this));
 
+	// thread for retransmitting messages the server did not ACK
+	this->m_threads.create_thread(
+		boost::bind(&client::retransmitLoop, this));
+
 	this->m_threads.join_all();
 }
 
@@ -97,11 +105,15 @@ void client::getLoop()
 	{
 		try
 		{
+			// anything ACKed after the get would be sent again
+			this->sendAcknowledgements(
+				true);
+
 			dataMessage connectionMessage(
 				this->sequenceNumber(),
 				constants::mt_CLIENT_GET,
 				this->m_username,
-				constants::serverIndexToServerName(this->m_serverIndex),
+				this->m_serverName,
 				"blank");
 
 			this->sendOverUDP(
@@ -122,7 +134,9 @@ void client::getLoop()
 //-------------------------------------------------------------------- inputLoop
 // Implementation notes:
 //  Parses the user input from the command line, branches to different areas
-//  based on the parsed /command, if no /command found, broadcast the message
+//  based on the parsed /command, if no /command found, broadcast the message.
+//  On exit, the messages still in the outbox are given a moment to be ACKed
+//  before disconnecting.
 //------------------------------------------------------------------------------
 void client::inputLoop()
 {
@@ -136,7 +150,7 @@ void client::inputLoop()
 
 		// By default, destination and message type are "broadcast"
 		// and "chat", respectively
-		std::string destination = "broadcast";
+		std::string destination = constants::broadcastIdentifier();
 		constants::MessageType messageType = constants::MessageType::mt_UNDEFINED;
 
 		std::stringstream ss;
@@ -147,15 +161,60 @@ void client::inputLoop()
 
 		if((temp == "/message") || (temp == "/m"))
 		{
+			// several targets separated by the multicast delimiter
+			// are sent one message, a target starting with the channel
+			// prefix reaches everyone who joined that channel
 			std::string actualMessage("");
 			ss >> destination;
 			
 			std::getline(ss, chatInput);
 			messageType = constants::MessageType::mt_CLIENT_SEND;
 		}
+		else if(!temp.empty() && temp[0] != '/')
+		{
+			// no /command, the whole line goes to everyone
+			messageType = constants::MessageType::mt_CLIENT_SEND;
+		}
+		else if((temp == "/join") || (temp == "/leave"))
+		{
+			std::string channel("");
+			ss >> channel;
+
+			if(channel.size() < 2 || channel[0] != constants::channelPrefix())
+			{
+				std::cout << "Channel names start with '" << constants::channelPrefix()
+					<< "'. (Use '" << temp << "' " << constants::channelPrefix() << "<channel>)" << std::endl;
+				continue;
+			}
+
+			dataMessage subscriptionMessage(
+				this->sequenceNumber(),
+				(temp == "/join")
+					? constants::MessageType::mt_CLIENT_JOIN
+					: constants::MessageType::mt_CLIENT_LEAVE,
+				this->m_username,
+				this->m_serverName,
+				channel);
+
+			this->sendReliably(subscriptionMessage);
+			continue;
+		}
+		else if(temp == "/stats")
+		{
+			{
+				boost::lock_guard<boost::mutex> lock(this->m_outboxMutex);
+
+				std::cout << this->m_outbox.statisticsAsString() << std::endl;
+			}
+
+			boost::lock_guard<boost::mutex> lock(this->m_deliveryMutex);
+
+			std::cout << this->m_deliveryBuffer.statisticsAsString() << std::endl;
+			continue;
+		}
 		else
 		{
-			std::cout << "Invalid command. (Use '/m' || '/message' <target> <message>" << std::endl;
+			std::cout << "Invalid command. (Use '/m' || '/message' <target>[,<target>...] <message>, or no command to broadcast)" << std::endl;
 			continue;
 		}
 
@@ -168,6 +227,29 @@ void client::inputLoop()
 
 		if(currentMessage.viewPayload() == "/exit")
 		{
+			const clientOutbox::outboxClock::time_point exitTime =
+				clientOutbox::outboxClock::now();
+
+			while(clientOutbox::outboxClock::now() - exitTime
+				< boost::chrono::milliseconds(constants::clientDrainTimeoutMilliseconds))
+			{
+				{
+					boost::lock_guard<boost::mutex> lock(this->m_outboxMutex);
+
+					if(this->m_outbox.isEmpty())
+					{
+						break;
+					}
+				}
+
+				boost::this_thread::sleep(
+					boost::posix_time::millisec(
+					constants::forwardIntervalMilliseconds));
+			}
+
+			this->sendAcknowledgements(
+				true);
+
 			this->m_terminate = true;
 
 			std::string disconnectMessage =
@@ -189,7 +271,13 @@ void client::inputLoop()
 			{
 				case client::Protocol::p_UDP:
 				{
-					this->sendOverUDP(currentMessage);
+					currentMessage.setPreviousSequenceNumber(
+						this->m_lastSequenceNumberByDestination[destination]);
+
+					this->m_lastSequenceNumberByDestination[destination] =
+						currentMessage.viewSequenceNumber();
+
+					this->sendReliably(currentMessage);
 					break;
 				}
 				case client::Protocol::p_BLUETOOTH:
@@ -208,15 +296,181 @@ void client::inputLoop()
 	}
 };
 
+//--------------------------------------------------------------- retransmitLoop
+// Implementation notes:
+//  Checks the retransmit timers as often as the server checks its relays,
+//  and the hold timers of messages received out of order
+//------------------------------------------------------------------------------
+void client::retransmitLoop()
+{
+	while(!this->m_terminate)
+	{
+		this->flushOutbox();
+
+		this->sendAcknowledgements(
+			false);
+
+		std::vector<dataMessage> expired;
+
+		{
+			boost::lock_guard<boost::mutex> lock(this->m_deliveryMutex);
+
+			expired = this->m_deliveryBuffer.takeExpired(
+				deliveryBuffer::deliveryClock::now());
+		}
+
+		this->showMessages(
+			expired);
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::forwardIntervalMilliseconds));
+	}
+};
+
+//----------------------------------------------------------------- sendReliably
+// Implementation notes:
+//  Queues the message then sends it right away if the window has room
+//------------------------------------------------------------------------------
+void client::sendReliably(
+	const dataMessage& message)
+{
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_outboxMutex);
+
+		this->m_outbox.enqueue(
+			message);
+	}
+
+	this->flushOutbox();
+};
+
+//------------------------------------------------------------------ flushOutbox
+// Implementation notes:
+//  The messages are sent without holding the lock. Messages given up on are
+//  reported, the user can send them again.
+//------------------------------------------------------------------------------
+void client::flushOutbox()
+{
+	std::vector<dataMessage> sendable;
+	std::vector<dataMessage> failed;
+
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_outboxMutex);
+
+		sendable = this->m_outbox.takeSendable(
+			clientOutbox::outboxClock::now());
+
+		failed = this->m_outbox.takeFailed();
+	}
+
+	for(const dataMessage& message : failed)
+	{
+		std::cout << "Could not send \"" << message.viewPayload() << "\" to "
+			<< message.viewDestinationIdentifier() << ", " << this->m_serverName
+			<< " did not acknowledge it after " << constants::clientMaximumTransmissions
+			<< " attempts" << std::endl;
+	}
+
+	for(const dataMessage& message : sendable)
+	{
+		try
+		{
+			this->sendOverUDP(
+				message);
+		}
+		catch(std::exception& exception)
+		{
+			std::cout << exception.what() << std::endl;
+		}
+	}
+};
+
+//--------------------------------------------------------- sendAcknowledgements
+// Implementation notes:
+//  The pending ACKs share the delivery lock, they are added as messages are
+//  received
+//------------------------------------------------------------------------------
+void client::sendAcknowledgements(
+	const bool& inForce)
+{
+	std::vector<dataMessage> frames;
+
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_deliveryMutex);
+
+		if(this->m_pendingAcknowledgements.isEmpty())
+		{
+			return;
+		}
+
+		if(!inForce
+			&& deliveryBuffer::deliveryClock::now() - this->m_timeOfOldestPendingAcknowledgement
+				< boost::chrono::milliseconds(constants::acknowledgementDelayMilliseconds))
+		{
+			return;
+		}
+
+		frames = this->m_pendingAcknowledgements.asMessages(
+			this->m_username,
+			this->m_serverName);
+
+		this->m_pendingAcknowledgements.clear();
+	}
+
+	for(const dataMessage& frame : frames)
+	{
+		try
+		{
+			this->sendOverUDP(
+				frame);
+		}
+		catch(std::exception& exception)
+		{
+			std::cout << exception.what() << std::endl;
+		}
+	}
+};
+
+//----------------------------------------------------------------- showMessages
+// Implementation notes:
+//  Same format as before the delivery buffer
+//------------------------------------------------------------------------------
+void client::showMessages(
+	const std::vector<dataMessage>& messages)
+{
+	for(const dataMessage& message : messages)
+	{
+		std::cout << message.viewSourceIdentifier()
+			<< " says: " << message.viewPayload() << std::endl;
+	}
+};
+
 //------------------------------------------------------------------ sendOverUDP
 // Implementation notes:
-//  Sends a message to the sever over UDP
+//  Sends a message to the sever over UDP. The session is put in as the
+//  message is sent, so messages queued in the outbox before the client had
+//  one, or before it connected again, go out from the current one.
 //------------------------------------------------------------------------------
 void client::sendOverUDP(
 	const dataMessage& message)
 {
+	dataMessage messageToSend(message);
+
+	if(message.viewMessageType() != constants::MessageType::mt_CLIENT_CONNECT)
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_sessionMutex);
+
+		if(!this->m_sessionIdentifier.empty())
+		{
+			messageToSend.setSourceIdentifier(
+				this->m_sessionIdentifier);
+		}
+	}
+
 	this->m_UDPsocket.send_to(
-		boost::asio::buffer(message.asCharVector()),
+		boost::asio::buffer(messageToSend.asCharVector()),
 		this->m_serverEndPoint);
 };
 
@@ -232,7 +486,8 @@ void client::sendOverBluetooth(
 
 //------------------------------------------------------------------ receiveLoop
 // Implementation notes:
-//  Listen for messages from the server
+//  Listen for messages from the server. The receive blocks, so there is no
+//  sleep between messages and ACKs are handled as they arrive.
 //------------------------------------------------------------------------------
 void client::receiveLoop()
 {
@@ -251,14 +506,18 @@ void client::receiveOverUDP()
 {
 	try
 	{
-		const uint16_t arbitraryLength = 256;
+		std::vector<char> receivedMessage(constants::receiveBufferLength);
 
-		std::vector<char> receivedMessage(arbitraryLength);
+		// the other threads send to the server endpoint meanwhile, so the
+		// sender is not written into it
+		boost::asio::ip::udp::endpoint senderEndPoint;
 
 		size_t incomingMessageLength =
 			this->m_UDPsocket.receive_from(
 				boost::asio::buffer(receivedMessage),
-				this->m_serverEndPoint);
+				senderEndPoint);
+
+		receivedMessage.resize(incomingMessageLength);
 
 		dataMessage message(
 			receivedMessage);
@@ -302,22 +561,52 @@ void client::receiveOverUDP()
 				}
 				case constants::MessageType::mt_SERVER_SEND:
 				{
-					std::cout << message.viewSourceIdentifier()
-						<< " says: " << message.viewPayload() << std::endl;
+					std::vector<dataMessage> deliverable;
+
+					{
+						boost::lock_guard<boost::mutex> lock(this->m_deliveryMutex);
+
+						const deliveryBuffer::deliveryClock::time_point now =
+							deliveryBuffer::deliveryClock::now();
+
+						deliverable = this->m_deliveryBuffer.receive(
+							message,
+							now);
+
+						// duplicates are ACKed too, the ACK for the first
+						// copy may have been lost. The retransmit loop sends
+						// the ACKs together once the first has waited a bit.
+						if(this->m_pendingAcknowledgements.isEmpty())
+						{
+							this->m_timeOfOldestPendingAcknowledgement = now;
+						}
 
-					dataMessage ackMessage(
-						message.viewSequenceNumber(),
-						constants::mt_CLIENT_ACK,
-						this->m_username,
-						constants::serverIndexToServerName(this->m_serverIndex),
-						"blank");
+						this->m_pendingAcknowledgements.add(
+							message.viewSourceIdentifier(),
+							message.viewSequenceNumber());
+					}
 
-					this->sendOverUDP(ackMessage);
+					this->showMessages(
+						deliverable);
 					break;
 				}
 				case constants::MessageType::mt_SERVER_ACK:
 				{
-					assert(false);
+					bool acknowledged = false;
+
+					{
+						boost::lock_guard<boost::mutex> lock(this->m_outboxMutex);
+
+						acknowledged = this->m_outbox.receiveAcknowledgement(
+							message.viewSequenceNumber(),
+							clientOutbox::outboxClock::now());
+					}
+
+					// the window may have room for more
+					if(acknowledged)
+					{
+						this->flushOutbox();
+					}
 					break;
 				}
 				case constants::MessageType::mt_SERVER_SYNC:
@@ -326,6 +615,25 @@ void client::receiveOverUDP()
 					assert(false);
 					break;
 				}
+				case constants::MessageType::mt_SERVER_SESSION:
+				{
+					const bool refused = message.viewPayload() == "0";
+
+					{
+						boost::lock_guard<boost::mutex> lock(this->m_sessionMutex);
+
+						this->m_sessionIdentifier = refused
+							? ""
+							: constants::sessionPrefix() + message.viewPayload();
+					}
+
+					// the server restarted, or timed the client out
+					if(refused)
+					{
+						this->connect();
+					}
+					break;
+				}
 				case constants::MessageType::mt_PING:
 				{
 					// #TODO necessary?
@@ -338,11 +646,6 @@ void client::receiveOverUDP()
 				}
 			}
 		}
-
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::updateIntervalMilliseconds));
 	}
 	catch(std::exception& exception)
 	{
@@ -363,7 +666,7 @@ void client::receiveOverBluetooth()
 // Implementation notes:
 //  Increments the sequence number every time it is used, self explanatory.
 //------------------------------------------------------------------------------
-const int64_t& client::sequenceNumber()
+int64_t client::sequenceNumber()
 {
 	return ++this->m_sequenceNumber;
 };
\ No newline at end of file
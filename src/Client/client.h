@@ -1,6 +1,9 @@
 #pragma once
 
 // STL
+#include <atomic>
+#include <map>
+#include <string>
 #include <vector>
 #include <cstdint>
 
@@ -9,7 +12,11 @@
 #include <boost/thread.hpp>
 
 // Project
+#include "../Common/acknowledgementFrame.h"
 #include "../Common/dataMessage.h"
+#include "../Common/serverTopology.h"
+#include "clientOutbox.h"
+#include "deliveryBuffer.h"
 
 class client
 {
@@ -31,14 +38,14 @@ public:
 	// Access:    public 
 	// Returns:   
 	// Parameter: const std::string& username
-	// Parameter: const uint16_t& inServerPort
-	// Parameter: const int8_t& inServerIndex
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const int16_t& inServerIndex
 	// Parameter: boost::asio::io_service& ioService
 	//--------------------------------------------------------------------------
 	client(
 		const std::string& username,
-		const uint16_t& inServerPort,
-		const int8_t& inServerIndex,
+		const serverTopology& inTopology,
+		const int16_t& inServerIndex,
 		boost::asio::io_service &ioService);
 
 	//---------------------------------------------------------------------- run
@@ -54,6 +61,18 @@ public:
 	void run();
 
 private:
+
+	//------------------------------------------------------------------ connect
+	// Brief Description
+	//  Sends the connection message, which always names the client. The
+	//  server replies with the session to send from then on.
+	//
+	// Method:    connect
+	// FullName:  client::connect
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void connect();
 	
 	//------------------------------------------------------------------ getLoop
 	// Brief Description
@@ -81,9 +100,74 @@ private:
 	//--------------------------------------------------------------------------
 	void inputLoop();
 
+	//----------------------------------------------------------- retransmitLoop
+	// Brief Description
+	//  The client loop that periodically sends again the messages the server
+	//  has not ACKed in time.
+	//
+	// Method:    retransmitLoop
+	// FullName:  client::retransmitLoop
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void retransmitLoop();
+
+	//------------------------------------------------------------- sendReliably
+	// Brief Description
+	//  Queues a message in the outbox, it is sent as soon as the congestion
+	//  window allows and retransmitted until the server ACKs it.
+	//
+	// Method:    sendReliably
+	// FullName:  client::sendReliably
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& message
+	//--------------------------------------------------------------------------
+	void sendReliably(
+		const dataMessage& message);
+
+	//-------------------------------------------------------------- flushOutbox
+	// Brief Description
+	//  Sends whatever the outbox has ready to send.
+	//
+	// Method:    flushOutbox
+	// FullName:  client::flushOutbox
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushOutbox();
+
+	//----------------------------------------------------- sendAcknowledgements
+	// Brief Description
+	//  Sends the pending ACKs as frames once the oldest has waited the
+	//  coalescing delay, or straight away if forced, as before a get.
+	//
+	// Method:    sendAcknowledgements
+	// FullName:  client::sendAcknowledgements
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const bool& inForce
+	//--------------------------------------------------------------------------
+	void sendAcknowledgements(
+		const bool& inForce);
+
+	//------------------------------------------------------------- showMessages
+	// Brief Description
+	//  Prints messages released by the delivery buffer.
+	//
+	// Method:    showMessages
+	// FullName:  client::showMessages
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::vector<dataMessage>& messages
+	//--------------------------------------------------------------------------
+	void showMessages(
+		const std::vector<dataMessage>& messages);
+
 	//-------------------------------------------------------------- sendOverUDP
 	// Brief Description
-	//  Sends messages to the server over UDP.
+	//  Sends messages to the server over UDP, from the client's session if
+	//  the server gave it one.
 	//
 	// Method:    sendOverUDP
 	// FullName:  client::sendOverUDP
@@ -145,24 +229,34 @@ private:
 	// Brief Description
 	//  The sequence number for the client. This increments every time it is
 	//  called and can be used to verify which messages were received by
-	//  the server.
+	//  the server. Safe to call from any of the client's threads.
 	//
 	// Method:    sequenceNumber
 	// FullName:  client::sequenceNumber
 	// Access:    private 
-	// Returns:   const int64_t&
+	// Returns:   int64_t
 	//--------------------------------------------------------------------------
-	const int64_t& sequenceNumber();
+	int64_t sequenceNumber();
 
 	// Member Variables
 	boost::asio::ip::udp::socket m_UDPsocket;
-	boost::asio::ip::udp::resolver m_resolver;
 	boost::asio::ip::udp::endpoint m_serverEndPoint;
 	boost::thread_group m_threads;
+	boost::mutex m_outboxMutex;
+	clientOutbox m_outbox;
+	boost::mutex m_deliveryMutex;
+	deliveryBuffer m_deliveryBuffer;
+	std::map<std::string, int64_t> m_lastSequenceNumberByDestination;
+	acknowledgementFrame m_pendingAcknowledgements;
+	deliveryBuffer::deliveryClock::time_point m_timeOfOldestPendingAcknowledgement;
 	client::Protocol m_activeProtocol;
 	bool m_terminate;
-	int64_t m_sequenceNumber;
+	std::atomic<int64_t> m_sequenceNumber;
 	std::string m_username;
-	uint16_t m_serverPort;
-	int8_t m_serverIndex;
+	std::string m_serverName;
+
+	// empty until the server gives the client a session, set by the receive
+	// loop and read by every thread that sends
+	boost::mutex m_sessionMutex;
+	std::string m_sessionIdentifier;
 };
\ No newline at end of file
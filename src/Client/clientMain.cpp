@@ -1,52 +1,84 @@
 // STL
 #include <iostream>
+#include <fstream>
 #include <string.h>
+#include <stdexcept>
 // Boost
 #include <boost/asio.hpp>
 
 // Project
 #include "client.h"
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+#include "../Common/serverTopology.h"
 
-int main()
+int main(int argc, char* argv[])
 {
 	try
 	{
-		char identifier;
-		bool identifierIsValid;
+		// the configuration file can be given as the first argument,
+		// otherwise servers.cfg is used if present
+		const std::string configurationFilePath(
+			(argc > 1) ? argv[1] : "servers.cfg");
+
+		const serverTopology topology(
+			(argc > 1 || std::ifstream(configurationFilePath).good())
+			? serverTopology(configurationFilePath)
+			: serverTopology());
+
+		std::string identifier("");
+		int16_t serverIndex = -1;
 
 		do
 		{
-			std::cout << "Which server to connect to? ('A' - 'E')" << std::endl;
+			std::cout << "Which server to connect to? ("
+				<< topology.serverNamesAsString() << ")" << std::endl;
 			std::cin >> identifier;
 
-			identifierIsValid =
-				constants::identifierIsValid(identifier);
+			serverIndex =
+				topology.serverIndexFromIdentifier(identifier);
 
-			if(!identifierIsValid)
+			if(serverIndex == -1)
 			{
 				std::cout << identifier << " is invalid. Please try again." << std::endl;
 			}
-		} while(!identifierIsValid);
+		} while(serverIndex == -1);
 
 		std::string ignore("");
-		
+
 		// necessary since last was cin next is getline
 		std::getline(std::cin, ignore);
 
-		const uint8_t serverIndex(
-			constants::charToServerIndex(identifier));
+		std::string username("");
+
+		// the server refuses a username it could take for a session, a
+		// channel or a list of clients
+		do
+		{
+			std::cout << "Enter your username: " << std::endl;
+			std::getline(std::cin, username);
+
+			if(!dataMessage::isValidUsername(username))
+			{
+				std::cout << username << " is invalid. Usernames cannot be empty, be "
+					<< constants::broadcastIdentifier() << ", start with "
+					<< constants::sessionPrefix() << " or " << constants::channelPrefix()
+					<< ", or contain " << constants::messageDelimiter()[0] << ", "
+					<< constants::messageDelimiter()[1] << " or "
+					<< constants::syncIdentifierDelimiter() << ". Please try again." << std::endl;
+			}
+		} while(!dataMessage::isValidUsername(username) && std::cin.good());
 
-		const uint16_t listeningPort(
-			constants::serverIndexToListeningPort(serverIndex));
+		if(!dataMessage::isValidUsername(username))
+		{
+			throw std::runtime_error("No valid username was entered");
+		}
 
-		std::string username("");
-		std::cout << "Enter your username: " << std::endl;
-		std::getline(std::cin, username);
 		boost::asio::io_service ioService;
 
 		client clientInstance(
-			username, 
-			listeningPort,
+			username,
+			topology,
 			serverIndex,
 			ioService);
 
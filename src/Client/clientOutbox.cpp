@@ -0,0 +1,308 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// Project
+#include "clientOutbox.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Starts in slow start, with no threshold below the maximum window
+//------------------------------------------------------------------------------
+clientOutbox::clientOutbox() :
+	m_retransmitTimer(
+		constants::clientInitialRetransmitMilliseconds,
+		constants::clientMinimumRetransmitMilliseconds,
+		constants::clientMaximumRetransmitMilliseconds),
+	m_congestionWindow(constants::clientInitialCongestionWindow),
+	m_slowStartThreshold(constants::clientMaximumCongestionWindow),
+	m_messagesSent(0),
+	m_retransmissions(0),
+	m_windowDecreases(0),
+	m_messagesFailed(0)
+{
+};
+
+//---------------------------------------------------------------------- enqueue
+// Implementation notes:
+//  Messages keep the sequence number the client gave them, the server ACKs
+//  that number
+//------------------------------------------------------------------------------
+void clientOutbox::enqueue(
+	const dataMessage& inMessage)
+{
+	this->m_queued.push_back(
+		inMessage);
+};
+
+//----------------------------------------------------------------- takeSendable
+// Implementation notes:
+//  The window is only halved for a timeout of a message sent after the last
+//  decrease, so one burst of losses halves it once rather than once per
+//  message lost. A message that timed out on its last transmission is
+//  moved to the failed messages instead of being sent again.
+//------------------------------------------------------------------------------
+std::vector<dataMessage> clientOutbox::takeSendable(
+	const outboxClock::time_point& inNow)
+{
+	std::vector<dataMessage> outMessages;
+
+	const size_t windowSize = std::max(
+		static_cast<size_t>(1),
+		static_cast<size_t>(std::floor(this->m_congestionWindow)));
+
+	bool timedOut = false;
+	bool decrease = false;
+
+	std::map<int64_t, inFlightMessage>::iterator it = this->m_inFlight.begin();
+
+	while(it != this->m_inFlight.end() && outMessages.size() < windowSize)
+	{
+		const double waitedMilliseconds =
+			boost::chrono::duration<double, boost::milli>(
+				inNow - it->second.m_timeSent).count();
+
+		if(waitedMilliseconds < this->m_retransmitTimer.viewTimeoutMilliseconds())
+		{
+			it++;
+			continue;
+		}
+
+		timedOut = true;
+		decrease = decrease || it->second.m_timeSent > this->m_timeOfLastDecrease;
+
+		if(it->second.m_transmissions >= constants::clientMaximumTransmissions)
+		{
+			this->m_failed.push_back(
+				it->second.m_message);
+
+			this->m_messagesFailed++;
+
+			it = this->m_inFlight.erase(it);
+			continue;
+		}
+
+		it->second.m_timeSent = inNow;
+		it->second.m_transmissions++;
+
+		outMessages.push_back(
+			it->second.m_message);
+
+		it++;
+	}
+
+	this->m_retransmissions += outMessages.size();
+
+	if(timedOut)
+	{
+		this->m_retransmitTimer.backOff();
+	}
+
+	if(decrease)
+	{
+		this->m_slowStartThreshold = std::max(
+			this->m_congestionWindow / 2,
+			1.0);
+
+		this->m_congestionWindow = this->m_slowStartThreshold;
+		this->m_timeOfLastDecrease = inNow;
+		this->m_windowDecreases++;
+	}
+
+	// the span from the oldest message waiting on an ACK is bounded too, the
+	// server only remembers that many sequence numbers to spot duplicates
+	while(!this->m_queued.empty()
+		&& this->m_inFlight.size() < std::floor(this->m_congestionWindow)
+		&& (this->m_inFlight.empty()
+			|| this->m_queued.front().viewSequenceNumber() - this->m_inFlight.begin()->first
+				< constants::clientSequenceSpan))
+	{
+		const dataMessage& message = this->m_queued.front();
+
+		this->m_inFlight.insert(std::make_pair(
+			message.viewSequenceNumber(),
+			inFlightMessage(message, inNow)));
+
+		outMessages.push_back(
+			message);
+
+		this->m_queued.pop_front();
+		this->m_messagesSent++;
+	}
+
+	return outMessages;
+};
+
+//------------------------------------------------------- receiveAcknowledgement
+// Implementation notes:
+//  Only messages sent once are sampled, a retransmitted message's ACK could
+//  be for either transmission (Karn's algorithm)
+//------------------------------------------------------------------------------
+bool clientOutbox::receiveAcknowledgement(
+	const int64_t& inSequenceNumber,
+	const outboxClock::time_point& inNow)
+{
+	std::map<int64_t, inFlightMessage>::iterator it =
+		this->m_inFlight.find(inSequenceNumber);
+
+	if(it == this->m_inFlight.end())
+	{
+		return false;
+	}
+
+	if(it->second.m_transmissions == 1)
+	{
+		this->m_retransmitTimer.addSample(
+			boost::chrono::duration<double, boost::milli>(
+				inNow - it->second.m_timeSent).count());
+	}
+
+	this->m_inFlight.erase(it);
+
+	this->m_retransmitTimer.reset();
+
+	if(this->m_congestionWindow < this->m_slowStartThreshold)
+	{
+		this->m_congestionWindow += 1;
+	}
+	else
+	{
+		this->m_congestionWindow += 1 / this->m_congestionWindow;
+	}
+
+	this->m_congestionWindow = std::min(
+		this->m_congestionWindow,
+		static_cast<double>(constants::clientMaximumCongestionWindow));
+
+	return true;
+};
+
+//------------------------------------------------------------------- takeFailed
+// Implementation notes:
+//  Swapped out, so each failed message is returned once
+//------------------------------------------------------------------------------
+std::vector<dataMessage> clientOutbox::takeFailed()
+{
+	std::vector<dataMessage> outMessages;
+
+	outMessages.swap(
+		this->m_failed);
+
+	return outMessages;
+};
+
+//---------------------------------------------------------------------- isEmpty
+// Implementation notes:
+//  Nothing queued and nothing waiting on an ACK
+//------------------------------------------------------------------------------
+bool clientOutbox::isEmpty() const
+{
+	return this->m_queued.empty() && this->m_inFlight.empty();
+};
+
+//----------------------------------------------------------------- viewInFlight
+// Implementation notes:
+//  Returns the number of messages waiting on an ACK
+//------------------------------------------------------------------------------
+size_t clientOutbox::viewInFlight() const
+{
+	return this->m_inFlight.size();
+};
+
+//------------------------------------------------------------------- viewQueued
+// Implementation notes:
+//  Returns the number of messages not yet sent
+//------------------------------------------------------------------------------
+size_t clientOutbox::viewQueued() const
+{
+	return this->m_queued.size();
+};
+
+//------------------------------------------------------------- viewMessagesSent
+// Implementation notes:
+//  Returns a const reference to the number of messages sent
+//------------------------------------------------------------------------------
+const uint64_t& clientOutbox::viewMessagesSent() const
+{
+	return this->m_messagesSent;
+};
+
+//---------------------------------------------------------- viewRetransmissions
+// Implementation notes:
+//  Returns a const reference to the number of retransmissions
+//------------------------------------------------------------------------------
+const uint64_t& clientOutbox::viewRetransmissions() const
+{
+	return this->m_retransmissions;
+};
+
+//---------------------------------------------------------- viewWindowDecreases
+// Implementation notes:
+//  Returns a const reference to the number of window decreases
+//------------------------------------------------------------------------------
+const uint64_t& clientOutbox::viewWindowDecreases() const
+{
+	return this->m_windowDecreases;
+};
+
+//----------------------------------------------------------- viewMessagesFailed
+// Implementation notes:
+//  Returns a const reference to the number of messages given up on
+//------------------------------------------------------------------------------
+const uint64_t& clientOutbox::viewMessagesFailed() const
+{
+	return this->m_messagesFailed;
+};
+
+//--------------------------------------------------------- viewCongestionWindow
+// Implementation notes:
+//  Returns a const reference to the congestion window
+//------------------------------------------------------------------------------
+const double& clientOutbox::viewCongestionWindow() const
+{
+	return this->m_congestionWindow;
+};
+
+//---------------------------------------------------- viewRoundTripMilliseconds
+// Implementation notes:
+//  Returns a const reference to the smoothed round trip time
+//------------------------------------------------------------------------------
+const double& clientOutbox::viewRoundTripMilliseconds() const
+{
+	return this->m_retransmitTimer.viewRoundTripMilliseconds();
+};
+
+//-------------------------------------------- viewRetransmitTimeoutMilliseconds
+// Implementation notes:
+//  Returns a const reference to the retransmit timer
+//------------------------------------------------------------------------------
+const double& clientOutbox::viewRetransmitTimeoutMilliseconds() const
+{
+	return this->m_retransmitTimer.viewTimeoutMilliseconds();
+};
+
+//----------------------------------------------------------- statisticsAsString
+// Implementation notes:
+//  Times are rounded to a tenth of a millisecond
+//------------------------------------------------------------------------------
+std::string clientOutbox::statisticsAsString() const
+{
+	std::stringstream ss;
+
+	ss << std::fixed << std::setprecision(1)
+		<< "sent " << this->m_messagesSent
+		<< ", retransmitted " << this->m_retransmissions
+		<< ", window decreases " << this->m_windowDecreases
+		<< ", failed " << this->m_messagesFailed
+		<< ", window " << this->m_congestionWindow
+		<< ", in flight " << this->m_inFlight.size()
+		<< ", queued " << this->m_queued.size()
+		<< ", rtt " << this->viewRoundTripMilliseconds() << " ms"
+		<< ", rto " << this->viewRetransmitTimeoutMilliseconds() << " ms";
+
+	return ss.str();
+};
\ No newline at end of file
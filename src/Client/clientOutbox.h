@@ -0,0 +1,252 @@
+#pragma once
+
+// STL
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+#include "../Common/retransmitTimer.h"
+
+class clientOutbox
+{
+public:
+
+	typedef boost::chrono::steady_clock outboxClock;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the outbox of a client. Messages sent to the server
+	//  stay in the outbox until the server ACKs them, and are sent again if
+	//  the ACK does not arrive in time.
+	//
+	// Method:    clientOutbox
+	// FullName:  clientOutbox::clientOutbox
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	clientOutbox();
+
+	//------------------------------------------------------------------ enqueue
+	// Brief Description
+	//  Queues a message to be sent once the congestion window allows.
+	//
+	// Method:    enqueue
+	// FullName:  clientOutbox::enqueue
+	// Access:    public
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void enqueue(
+		const dataMessage& inMessage);
+
+	//------------------------------------------------------------- takeSendable
+	// Brief Description
+	//  Returns the messages that should be put on the wire now: messages
+	//  whose retransmit timer expired, then queued messages while fewer than
+	//  the congestion window are waiting on an ACK and they are numbered
+	//  close enough to the oldest one. A timeout halves the congestion
+	//  window and doubles the retransmit timer. A message that times out
+	//  after its last allowed transmission is given up on, see takeFailed.
+	//
+	// Method:    takeSendable
+	// FullName:  clientOutbox::takeSendable
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const outboxClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> takeSendable(
+		const outboxClock::time_point& inNow);
+
+	//--------------------------------------------------- receiveAcknowledgement
+	// Brief Description
+	//  Processes an ACK from the server for the message with the given
+	//  sequence number. Each new ACK grows the congestion window, by one
+	//  message per ACK in slow start and by one message per window after.
+	//  Returns false if the message was not waiting on an ACK.
+	//
+	// Method:    receiveAcknowledgement
+	// FullName:  clientOutbox::receiveAcknowledgement
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const int64_t& inSequenceNumber
+	// Parameter: const outboxClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	bool receiveAcknowledgement(
+		const int64_t& inSequenceNumber,
+		const outboxClock::time_point& inNow);
+
+	//--------------------------------------------------------------- takeFailed
+	// Brief Description
+	//  Returns the messages the server did not ACK after the most
+	//  transmissions allowed, which are no longer sent, so the user can be
+	//  told. Each is returned once.
+	//
+	// Method:    takeFailed
+	// FullName:  clientOutbox::takeFailed
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> takeFailed();
+
+	//------------------------------------------------------------------ isEmpty
+	// Brief Description
+	//  Used to determine if every message was ACKed by the server.
+	//
+	// Method:    isEmpty
+	// FullName:  clientOutbox::isEmpty
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isEmpty() const;
+
+	//------------------------------------------------------------- viewInFlight
+	// Brief Description
+	//  Returns the number of messages sent and waiting on an ACK.
+	//
+	// Method:    viewInFlight
+	// FullName:  clientOutbox::viewInFlight
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewInFlight() const;
+
+	//--------------------------------------------------------------- viewQueued
+	// Brief Description
+	//  Returns the number of messages waiting for room in the window.
+	//
+	// Method:    viewQueued
+	// FullName:  clientOutbox::viewQueued
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewQueued() const;
+
+	//--------------------------------------------------------- viewMessagesSent
+	// Brief Description
+	//  Returns the number of messages sent for the first time.
+	//
+	// Method:    viewMessagesSent
+	// FullName:  clientOutbox::viewMessagesSent
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewMessagesSent() const;
+
+	//------------------------------------------------------ viewRetransmissions
+	// Brief Description
+	//  Returns the number of messages sent again after their timer expired.
+	//
+	// Method:    viewRetransmissions
+	// FullName:  clientOutbox::viewRetransmissions
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewRetransmissions() const;
+
+	//------------------------------------------------------ viewWindowDecreases
+	// Brief Description
+	//  Returns the number of times a timeout halved the congestion window.
+	//
+	// Method:    viewWindowDecreases
+	// FullName:  clientOutbox::viewWindowDecreases
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewWindowDecreases() const;
+
+	//------------------------------------------------------- viewMessagesFailed
+	// Brief Description
+	//  Returns the number of messages given up on.
+	//
+	// Method:    viewMessagesFailed
+	// FullName:  clientOutbox::viewMessagesFailed
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewMessagesFailed() const;
+
+	//----------------------------------------------------- viewCongestionWindow
+	// Brief Description
+	//  Returns the number of messages that may wait on an ACK at once.
+	//
+	// Method:    viewCongestionWindow
+	// FullName:  clientOutbox::viewCongestionWindow
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewCongestionWindow() const;
+
+	//------------------------------------------------ viewRoundTripMilliseconds
+	// Brief Description
+	//  Returns the smoothed round trip time to the server, 0 before the
+	//  first sample.
+	//
+	// Method:    viewRoundTripMilliseconds
+	// FullName:  clientOutbox::viewRoundTripMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewRoundTripMilliseconds() const;
+
+	//---------------------------------------- viewRetransmitTimeoutMilliseconds
+	// Brief Description
+	//  Returns the current retransmit timer.
+	//
+	// Method:    viewRetransmitTimeoutMilliseconds
+	// FullName:  clientOutbox::viewRetransmitTimeoutMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewRetransmitTimeoutMilliseconds() const;
+
+	//------------------------------------------------------- statisticsAsString
+	// Brief Description
+	//  Returns the counters and the window on one line, for tuning.
+	//
+	// Method:    statisticsAsString
+	// FullName:  clientOutbox::statisticsAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string statisticsAsString() const;
+
+private:
+
+	class inFlightMessage
+	{
+	public:
+		inFlightMessage(
+			const dataMessage& inMessage,
+			const outboxClock::time_point& inTimeSent) :
+			m_message(inMessage),
+			m_timeSent(inTimeSent),
+			m_transmissions(1)
+		{
+		};
+
+		dataMessage m_message;
+		outboxClock::time_point m_timeSent;
+		uint16_t m_transmissions;
+	};
+
+	// Member Variables
+	std::deque<dataMessage> m_queued;
+	std::map<int64_t, inFlightMessage> m_inFlight;
+	std::vector<dataMessage> m_failed;
+	retransmitTimer m_retransmitTimer;
+	double m_congestionWindow;
+	double m_slowStartThreshold;
+	outboxClock::time_point m_timeOfLastDecrease;
+
+	uint64_t m_messagesSent;
+	uint64_t m_retransmissions;
+	uint64_t m_windowDecreases;
+	uint64_t m_messagesFailed;
+};
\ No newline at end of file
@@ -0,0 +1,310 @@
+// STL
+#include <sstream>
+#include <string>
+
+// Project
+#include "deliveryBuffer.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Senders are added as their first message arrives
+//------------------------------------------------------------------------------
+deliveryBuffer::deliveryBuffer(
+	const uint16_t& inHoldMilliseconds) :
+	m_holdTime(inHoldMilliseconds),
+	m_duplicatesSuppressed(0),
+	m_messagesHeld(0),
+	m_gapsSkipped(0),
+	m_deliveredLate(0),
+	m_deliveredTooOld(0)
+{
+};
+
+//---------------------------------------------------------------------- receive
+// Implementation notes:
+//  A message the hold time gave up on is shown as soon as it arrives.
+//  Showing it out of order beats not showing it at all. The same goes for
+//  a message below the window, which backoff or a failover delayed, and
+//  which cannot be told apart from one already shown.
+//------------------------------------------------------------------------------
+std::vector<dataMessage> deliveryBuffer::receive(
+	const dataMessage& inMessage,
+	const deliveryClock::time_point& inNow)
+{
+	std::vector<dataMessage> outMessages;
+
+	senderState& sender =
+		this->m_senders[inMessage.viewSourceIdentifier()];
+
+	const int64_t& sequenceNumber = inMessage.viewSequenceNumber();
+
+	if(sender.m_highestSequenceNumber - sequenceNumber
+		>= constants::deliveredWindowSize)
+	{
+		this->m_deliveredTooOld++;
+
+		outMessages.push_back(
+			inMessage);
+
+		return outMessages;
+	}
+
+	if(this->wasReceived(sender, sequenceNumber))
+	{
+		this->m_duplicatesSuppressed++;
+		return outMessages;
+	}
+
+	this->markReceived(
+		sender,
+		sequenceNumber);
+
+	if(sender.m_givenUp.erase(sequenceNumber) > 0)
+	{
+		this->m_deliveredLate++;
+
+		outMessages.push_back(
+			inMessage);
+
+		return outMessages;
+	}
+
+	sender.m_held.insert(std::make_pair(
+		sequenceNumber,
+		std::make_pair(inMessage, inNow)));
+
+	this->release(
+		sender,
+		inNow,
+		outMessages);
+
+	if(sender.m_held.count(sequenceNumber) > 0)
+	{
+		this->m_messagesHeld++;
+	}
+
+	return outMessages;
+};
+
+//------------------------------------------------------------------ takeExpired
+// Implementation notes:
+//  Every sender with something held is checked
+//------------------------------------------------------------------------------
+std::vector<dataMessage> deliveryBuffer::takeExpired(
+	const deliveryClock::time_point& inNow)
+{
+	std::vector<dataMessage> outMessages;
+
+	for(std::pair<const std::string, senderState>& entry : this->m_senders)
+	{
+		if(!entry.second.m_held.empty())
+		{
+			this->release(
+				entry.second,
+				inNow,
+				outMessages);
+		}
+	}
+
+	return outMessages;
+};
+
+//--------------------------------------------------------------------- viewHeld
+// Implementation notes:
+//  Sums the held messages of every sender
+//------------------------------------------------------------------------------
+size_t deliveryBuffer::viewHeld() const
+{
+	size_t held = 0;
+
+	for(const std::pair<const std::string, senderState>& entry : this->m_senders)
+	{
+		held += entry.second.m_held.size();
+	}
+
+	return held;
+};
+
+//----------------------------------------------------- viewDuplicatesSuppressed
+// Implementation notes:
+//  Returns a const reference to the number of duplicates suppressed
+//------------------------------------------------------------------------------
+const uint64_t& deliveryBuffer::viewDuplicatesSuppressed() const
+{
+	return this->m_duplicatesSuppressed;
+};
+
+//------------------------------------------------------------- viewMessagesHeld
+// Implementation notes:
+//  Returns a const reference to the number of messages held
+//------------------------------------------------------------------------------
+const uint64_t& deliveryBuffer::viewMessagesHeld() const
+{
+	return this->m_messagesHeld;
+};
+
+//-------------------------------------------------------------- viewGapsSkipped
+// Implementation notes:
+//  Returns a const reference to the number of gaps skipped
+//------------------------------------------------------------------------------
+const uint64_t& deliveryBuffer::viewGapsSkipped() const
+{
+	return this->m_gapsSkipped;
+};
+
+//------------------------------------------------------------ viewDeliveredLate
+// Implementation notes:
+//  Returns a const reference to the number of messages delivered late
+//------------------------------------------------------------------------------
+const uint64_t& deliveryBuffer::viewDeliveredLate() const
+{
+	return this->m_deliveredLate;
+};
+
+//---------------------------------------------------------- viewDeliveredTooOld
+// Implementation notes:
+//  Returns a const reference to the number of messages delivered too old
+//------------------------------------------------------------------------------
+const uint64_t& deliveryBuffer::viewDeliveredTooOld() const
+{
+	return this->m_deliveredTooOld;
+};
+
+//----------------------------------------------------------- statisticsAsString
+// Implementation notes:
+//  Same layout as the outbox statistics
+//------------------------------------------------------------------------------
+std::string deliveryBuffer::statisticsAsString() const
+{
+	std::stringstream ss;
+
+	ss << "duplicates suppressed " << this->m_duplicatesSuppressed
+		<< ", held for order " << this->m_messagesHeld
+		<< ", gaps skipped " << this->m_gapsSkipped
+		<< ", delivered late " << this->m_deliveredLate
+		<< ", too old " << this->m_deliveredTooOld
+		<< ", held now " << this->viewHeld();
+
+	return ss.str();
+};
+
+//------------------------------------------------------------------ wasReceived
+// Implementation notes:
+//  A sender with no highest sequence number has not been heard from
+//------------------------------------------------------------------------------
+bool deliveryBuffer::wasReceived(
+	const senderState& inSender,
+	const int64_t& inSequenceNumber) const
+{
+	if(inSender.m_highestSequenceNumber == 0
+		|| inSequenceNumber > inSender.m_highestSequenceNumber)
+	{
+		return false;
+	}
+
+	if(inSender.m_highestSequenceNumber - inSequenceNumber
+		>= constants::deliveredWindowSize)
+	{
+		return true;
+	}
+
+	return inSender.m_received.test(
+		inSequenceNumber % constants::deliveredWindowSize);
+};
+
+//----------------------------------------------------------------- markReceived
+// Implementation notes:
+//  Sliding forward clears the bits of the sequence numbers skipped over,
+//  they now stand for numbers one window higher
+//------------------------------------------------------------------------------
+void deliveryBuffer::markReceived(
+	senderState& inSender,
+	const int64_t& inSequenceNumber)
+{
+	if(inSender.m_highestSequenceNumber == 0
+		|| inSequenceNumber - inSender.m_highestSequenceNumber
+			>= constants::deliveredWindowSize)
+	{
+		inSender.m_received.reset();
+		inSender.m_highestSequenceNumber = inSequenceNumber;
+	}
+
+	while(inSender.m_highestSequenceNumber < inSequenceNumber)
+	{
+		inSender.m_highestSequenceNumber++;
+
+		inSender.m_received.reset(
+			inSender.m_highestSequenceNumber % constants::deliveredWindowSize);
+	}
+
+	inSender.m_received.set(
+		inSequenceNumber % constants::deliveredWindowSize);
+};
+
+//--------------------------------------------------------------------- wasShown
+// Implementation notes:
+//  0 is the previous message of the first one in a chain. A message given
+//  up on does not hold up the rest of its chain again. Anything older than
+//  the window counts as received, and so as shown.
+//------------------------------------------------------------------------------
+bool deliveryBuffer::wasShown(
+	const senderState& inSender,
+	const int64_t& inSequenceNumber) const
+{
+	return inSequenceNumber == 0
+		|| inSender.m_givenUp.count(inSequenceNumber) > 0
+		|| (this->wasReceived(inSender, inSequenceNumber)
+			&& inSender.m_held.count(inSequenceNumber) == 0);
+};
+
+//---------------------------------------------------------------------- release
+// Implementation notes:
+//  A message's previous one always has a lower sequence number, so one pass
+//  in order shows every chain as far as it can go. A message waits for a
+//  held previous one however long it has been held itself, the previous
+//  one is shown after its own hold time at the latest.
+//------------------------------------------------------------------------------
+void deliveryBuffer::release(
+	senderState& inSender,
+	const deliveryClock::time_point& inNow,
+	std::vector<dataMessage>& outMessages)
+{
+	std::map<int64_t, std::pair<dataMessage, deliveryClock::time_point>>::iterator next =
+		inSender.m_held.begin();
+
+	while(next != inSender.m_held.end())
+	{
+		const int64_t previousSequenceNumber =
+			next->second.first.viewPreviousSequenceNumber();
+
+		if(!this->wasShown(inSender, previousSequenceNumber))
+		{
+			if(inSender.m_held.count(previousSequenceNumber) > 0
+				|| inNow - next->second.second < this->m_holdTime)
+			{
+				next++;
+				continue;
+			}
+
+			this->m_gapsSkipped++;
+
+			inSender.m_givenUp.insert(
+				previousSequenceNumber);
+		}
+
+		outMessages.push_back(
+			next->second.first);
+
+		next = inSender.m_held.erase(
+			next);
+	}
+
+	// older ones are shown as too old if they arrive now
+	while(!inSender.m_givenUp.empty()
+		&& inSender.m_highestSequenceNumber - *inSender.m_givenUp.begin()
+			>= constants::deliveredWindowSize)
+	{
+		inSender.m_givenUp.erase(
+			inSender.m_givenUp.begin());
+	}
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+#pragma once
+
+// STL
+#include <bitset>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "../Common/constants.h"
+#include "../Common/dataMessage.h"
+
+class deliveryBuffer
+{
+public:
+
+	typedef boost::chrono::steady_clock deliveryClock;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the buffer between the messages a client receives and
+	//  the ones it shows. Each message is shown once, and in the order its
+	//  sender sent it, waiting at most the hold time for a missing earlier
+	//  message.
+	//
+	// Method:    deliveryBuffer
+	// FullName:  deliveryBuffer::deliveryBuffer
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inHoldMilliseconds
+	//--------------------------------------------------------------------------
+	deliveryBuffer(
+		const uint16_t& inHoldMilliseconds);
+
+	//------------------------------------------------------------------ receive
+	// Brief Description
+	//  Records a message received from the server and returns the messages
+	//  that can now be shown, in order. A duplicate returns nothing. A
+	//  message that overtook an earlier one is held until the earlier one
+	//  arrives or the hold time passes. A message older than the window is
+	//  returned straight away, since it cannot be told from a duplicate.
+	//
+	// Method:    receive
+	// FullName:  deliveryBuffer::receive
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const deliveryClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> receive(
+		const dataMessage& inMessage,
+		const deliveryClock::time_point& inNow);
+
+	//-------------------------------------------------------------- takeExpired
+	// Brief Description
+	//  Returns the held messages that waited the hold time for an earlier
+	//  message, along with any held behind them. The earlier message is
+	//  given up on.
+	//
+	// Method:    takeExpired
+	// FullName:  deliveryBuffer::takeExpired
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const deliveryClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> takeExpired(
+		const deliveryClock::time_point& inNow);
+
+	//----------------------------------------------------------------- viewHeld
+	// Brief Description
+	//  Returns the number of messages currently held.
+	//
+	// Method:    viewHeld
+	// FullName:  deliveryBuffer::viewHeld
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewHeld() const;
+
+	//------------------------------------------------- viewDuplicatesSuppressed
+	// Brief Description
+	//  Returns the number of messages received again and not shown.
+	//
+	// Method:    viewDuplicatesSuppressed
+	// FullName:  deliveryBuffer::viewDuplicatesSuppressed
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewDuplicatesSuppressed() const;
+
+	//--------------------------------------------------------- viewMessagesHeld
+	// Brief Description
+	//  Returns the number of messages that arrived out of order and were
+	//  held for an earlier one.
+	//
+	// Method:    viewMessagesHeld
+	// FullName:  deliveryBuffer::viewMessagesHeld
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewMessagesHeld() const;
+
+	//---------------------------------------------------------- viewGapsSkipped
+	// Brief Description
+	//  Returns the number of times the hold time passed and a missing
+	//  message was given up on.
+	//
+	// Method:    viewGapsSkipped
+	// FullName:  deliveryBuffer::viewGapsSkipped
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewGapsSkipped() const;
+
+	//-------------------------------------------------------- viewDeliveredLate
+	// Brief Description
+	//  Returns the number of messages that arrived after they were given up
+	//  on. They are shown as they arrive, out of order.
+	//
+	// Method:    viewDeliveredLate
+	// FullName:  deliveryBuffer::viewDeliveredLate
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewDeliveredLate() const;
+
+	//------------------------------------------------------ viewDeliveredTooOld
+	// Brief Description
+	//  Returns the number of messages that arrived more than the window
+	//  below the highest sequence number of their sender. They are shown as
+	//  they arrive, even if they were shown before.
+	//
+	// Method:    viewDeliveredTooOld
+	// FullName:  deliveryBuffer::viewDeliveredTooOld
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewDeliveredTooOld() const;
+
+	//------------------------------------------------------- statisticsAsString
+	// Brief Description
+	//  Returns the counters on one line, for tuning.
+	//
+	// Method:    statisticsAsString
+	// FullName:  deliveryBuffer::statisticsAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string statisticsAsString() const;
+
+private:
+
+	class senderState
+	{
+	public:
+		senderState() :
+			m_highestSequenceNumber(0)
+		{
+		};
+
+		// bit (sequence number % window size) is set for each sequence
+		// number received in the window below the highest
+		int64_t m_highestSequenceNumber;
+		std::bitset<constants::deliveredWindowSize> m_received;
+
+		// a sender's messages to each destination form a chain of their
+		// own, and a client gets several of them from one sender when it
+		// is sent to directly, by broadcast, multicast and channel. A
+		// message is shown once the one before it in its chain was.
+		std::map<int64_t, std::pair<dataMessage, deliveryClock::time_point>> m_held;
+
+		// the sequence numbers the hold time gave up on, within the window
+		std::set<int64_t> m_givenUp;
+	};
+
+	//-------------------------------------------------------------- wasReceived
+	// Brief Description
+	//  Used to determine if a sequence number was already received from the
+	//  sender. Anything older than the window is taken to have been, so that
+	//  it does not hold up the messages after it.
+	//
+	// Method:    wasReceived
+	// FullName:  deliveryBuffer::wasReceived
+	// Access:    private
+	// Returns:   bool
+	// Parameter: const senderState& inSender
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	bool wasReceived(
+		const senderState& inSender,
+		const int64_t& inSequenceNumber) const;
+
+	//------------------------------------------------------------- markReceived
+	// Brief Description
+	//  Records a sequence number as received, sliding the window forward if
+	//  it is the highest yet.
+	//
+	// Method:    markReceived
+	// FullName:  deliveryBuffer::markReceived
+	// Access:    private
+	// Returns:   void
+	// Parameter: senderState& inSender
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	void markReceived(
+		senderState& inSender,
+		const int64_t& inSequenceNumber);
+
+	//------------------------------------------------------------------ wasShown
+	// Brief Description
+	//  Used to determine if the message with the sequence number was shown,
+	//  which it was if it was received and is not held, or given up on.
+	//
+	// Method:    wasShown
+	// FullName:  deliveryBuffer::wasShown
+	// Access:    private
+	// Returns:   bool
+	// Parameter: const senderState& inSender
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	bool wasShown(
+		const senderState& inSender,
+		const int64_t& inSequenceNumber) const;
+
+	//------------------------------------------------------------------ release
+	// Brief Description
+	//  Moves the held messages of a sender that can be shown to outMessages:
+	//  those whose previous message was shown, and those that waited the
+	//  hold time for a previous message that never arrived.
+	//
+	// Method:    release
+	// FullName:  deliveryBuffer::release
+	// Access:    private
+	// Returns:   void
+	// Parameter: senderState& inSender
+	// Parameter: const deliveryClock::time_point& inNow
+	// Parameter: std::vector<dataMessage>& outMessages
+	//--------------------------------------------------------------------------
+	void release(
+		senderState& inSender,
+		const deliveryClock::time_point& inNow,
+		std::vector<dataMessage>& outMessages);
+
+	// Member Variables
+	boost::chrono::milliseconds m_holdTime;
+	std::map<std::string, senderState> m_senders;
+
+	uint64_t m_duplicatesSuppressed;
+	uint64_t m_messagesHeld;
+	uint64_t m_gapsSkipped;
+	uint64_t m_deliveredLate;
+	uint64_t m_deliveredTooOld;
+};
\ No newline at end of file
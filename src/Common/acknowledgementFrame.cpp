@@ -0,0 +1,191 @@
+// STL
+#include <iterator>
+#include <string>
+
+// Project
+#include "acknowledgementFrame.h"
+#include "constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Nothing acknowledged
+//------------------------------------------------------------------------------
+acknowledgementFrame::acknowledgementFrame()
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Each entry is "<source>:<first>-<last>". The source is split off at the
+//  last ':' so it may contain one itself.
+//------------------------------------------------------------------------------
+acknowledgementFrame::acknowledgementFrame(
+	const dataMessage& inAcknowledgement)
+{
+	for(const std::string& entry : inAcknowledgement.viewServerSyncPayload())
+	{
+		try
+		{
+			const size_t sourceEnd = entry.rfind(':');
+			const size_t separator = entry.find('-', sourceEnd + 2);
+
+			if(sourceEnd == std::string::npos || separator == std::string::npos)
+			{
+				continue;
+			}
+
+			const int64_t first = std::stoll(
+				entry.substr(sourceEnd + 1, separator - sourceEnd - 1));
+
+			const int64_t last = std::stoll(
+				entry.substr(separator + 1));
+
+			if(first <= last)
+			{
+				this->m_rangesBySource[entry.substr(0, sourceEnd)][first] = last;
+			}
+		}
+		catch(std::exception& exception)
+		{
+			// malformed, ignore it
+		}
+	}
+};
+
+//-------------------------------------------------------------------------- add
+// Implementation notes:
+//  Extends the range ending just below or starting just above the sequence
+//  number, joining the two if it fills the gap between them
+//------------------------------------------------------------------------------
+void acknowledgementFrame::add(
+	const std::string& inSourceIdentifier,
+	const int64_t& inSequenceNumber)
+{
+	if(this->contains(inSourceIdentifier, inSequenceNumber))
+	{
+		return;
+	}
+
+	std::map<int64_t, int64_t>& ranges =
+		this->m_rangesBySource[inSourceIdentifier];
+
+	std::map<int64_t, int64_t>::iterator next =
+		ranges.upper_bound(inSequenceNumber);
+
+	int64_t first = inSequenceNumber;
+	int64_t last = inSequenceNumber;
+
+	if(next != ranges.end() && next->first == inSequenceNumber + 1)
+	{
+		last = next->second;
+		next = ranges.erase(next);
+	}
+
+	if(next != ranges.begin())
+	{
+		std::map<int64_t, int64_t>::iterator previous = std::prev(next);
+
+		if(previous->second == inSequenceNumber - 1)
+		{
+			previous->second = last;
+			return;
+		}
+	}
+
+	ranges[first] = last;
+};
+
+//--------------------------------------------------------------------- contains
+// Implementation notes:
+//  The range starting at or below the sequence number is the only one that
+//  can hold it
+//------------------------------------------------------------------------------
+bool acknowledgementFrame::contains(
+	const std::string& inSourceIdentifier,
+	const int64_t& inSequenceNumber) const
+{
+	std::map<std::string, std::map<int64_t, int64_t>>::const_iterator source =
+		this->m_rangesBySource.find(inSourceIdentifier);
+
+	if(source == this->m_rangesBySource.end())
+	{
+		return false;
+	}
+
+	std::map<int64_t, int64_t>::const_iterator range =
+		source->second.upper_bound(inSequenceNumber);
+
+	if(range == source->second.begin())
+	{
+		return false;
+	}
+
+	return inSequenceNumber <= std::prev(range)->second;
+};
+
+//---------------------------------------------------------------------- isEmpty
+// Implementation notes:
+//  Senders are only added along with a range
+//------------------------------------------------------------------------------
+bool acknowledgementFrame::isEmpty() const
+{
+	return this->m_rangesBySource.empty();
+};
+
+//------------------------------------------------------------------------ clear
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+void acknowledgementFrame::clear()
+{
+	this->m_rangesBySource.clear();
+};
+
+//------------------------------------------------------------------- asMessages
+// Implementation notes:
+//  Entries are written in the same format as a sync payload
+//------------------------------------------------------------------------------
+std::vector<dataMessage> acknowledgementFrame::asMessages(
+	const std::string& inSourceID,
+	const std::string& inDestinationID) const
+{
+	std::vector<dataMessage> outMessages;
+	std::vector<std::string> entries;
+
+	for(const std::pair<const std::string, std::map<int64_t, int64_t>>& source :
+		this->m_rangesBySource)
+	{
+		for(const std::pair<const int64_t, int64_t>& range : source.second)
+		{
+			entries.push_back(
+				source.first + ":" + std::to_string(range.first)
+				+ "-" + std::to_string(range.second));
+
+			if(entries.size() == constants::acknowledgementFrameLimit)
+			{
+				outMessages.push_back(dataMessage(
+					0,
+					constants::MessageType::mt_CLIENT_ACK,
+					inSourceID,
+					inDestinationID,
+					entries,
+					-1));
+
+				entries.clear();
+			}
+		}
+	}
+
+	if(!entries.empty())
+	{
+		outMessages.push_back(dataMessage(
+			0,
+			constants::MessageType::mt_CLIENT_ACK,
+			inSourceID,
+			inDestinationID,
+			entries,
+			-1));
+	}
+
+	return outMessages;
+};
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Project
+#include "dataMessage.h"
+
+class acknowledgementFrame
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty frame. A frame acknowledges any number of
+	//  messages, each identified by the client that sent it and its sequence
+	//  number, so a client can ACK everything it received at once.
+	//
+	// Method:    acknowledgementFrame
+	// FullName:  acknowledgementFrame::acknowledgementFrame
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	acknowledgementFrame();
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the frame carried by a received client ACK. Malformed
+	//  entries are ignored.
+	//
+	// Method:    acknowledgementFrame
+	// FullName:  acknowledgementFrame::acknowledgementFrame
+	// Access:    public
+	// Returns:
+	// Parameter: const dataMessage& inAcknowledgement
+	//--------------------------------------------------------------------------
+	acknowledgementFrame(
+		const dataMessage& inAcknowledgement);
+
+	//---------------------------------------------------------------------- add
+	// Brief Description
+	//  Adds a message to the frame. Consecutive sequence numbers from the
+	//  same sender are merged into one range.
+	//
+	// Method:    add
+	// FullName:  acknowledgementFrame::add
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inSourceIdentifier
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	void add(
+		const std::string& inSourceIdentifier,
+		const int64_t& inSequenceNumber);
+
+	//----------------------------------------------------------------- contains
+	// Brief Description
+	//  Used to determine if the frame acknowledges the given message.
+	//
+	// Method:    contains
+	// FullName:  acknowledgementFrame::contains
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::string& inSourceIdentifier
+	// Parameter: const int64_t& inSequenceNumber
+	//--------------------------------------------------------------------------
+	bool contains(
+		const std::string& inSourceIdentifier,
+		const int64_t& inSequenceNumber) const;
+
+	//------------------------------------------------------------------ isEmpty
+	// Brief Description
+	//  Used to determine if the frame acknowledges anything.
+	//
+	// Method:    isEmpty
+	// FullName:  acknowledgementFrame::isEmpty
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isEmpty() const;
+
+	//-------------------------------------------------------------------- clear
+	// Brief Description
+	//  Removes everything from the frame.
+	//
+	// Method:    clear
+	// FullName:  acknowledgementFrame::clear
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void clear();
+
+	//--------------------------------------------------------------- asMessages
+	// Brief Description
+	//  Returns the frame as client ACK messages, split so each fits in a
+	//  datagram. The payload lists one range per entry, the sequence number
+	//  of the messages themselves is unused.
+	//
+	// Method:    asMessages
+	// FullName:  acknowledgementFrame::asMessages
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	// Parameter: const std::string& inSourceID
+	// Parameter: const std::string& inDestinationID
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> asMessages(
+		const std::string& inSourceID,
+		const std::string& inDestinationID) const;
+
+private:
+	// Member Variables
+
+	// first sequence number to last, per sender
+	std::map<std::string, std::map<int64_t, int64_t>> m_rangesBySource;
+};
\ No newline at end of file
@@ -0,0 +1,386 @@
+// STL
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "asyncLog.h"
+#include "constants.h"
+
+// lines above the level are skipped by write() without touching the state
+std::atomic<int> asyncLog::s_level(asyncLog::ll_TRACE);
+
+//---------------------------------------------------------------------- logRing
+// Implementation notes:
+//  One producer, the thread that owns it, and one consumer, the writer
+//  thread. The indices only ever grow, so head - tail is the number of
+//  records waiting and neither side needs a lock.
+//------------------------------------------------------------------------------
+class asyncLog::logRing
+{
+public:
+	logRing() :
+		m_records(constants::logRingRecords),
+		m_head(0),
+		m_tail(0),
+		m_abandoned(false),
+		m_dropped(0),
+		m_traceCount(0)
+	{
+	};
+
+	std::vector<logRecord> m_records;
+
+	// next record written by the owner, next record read by the writer
+	std::atomic<uint64_t> m_head;
+	std::atomic<uint64_t> m_tail;
+
+	// set when the owner exits, the writer forgets the ring once it is empty
+	std::atomic<bool> m_abandoned;
+	std::atomic<uint64_t> m_dropped;
+
+	// only touched by the owner
+	uint64_t m_traceCount;
+};
+
+//--------------------------------------------------------------------- logState
+// Implementation notes:
+//  The writer thread is started with the state and stopped when it is
+//  destroyed at exit, after writing whatever is left in the rings.
+//------------------------------------------------------------------------------
+class asyncLog::logState
+{
+public:
+	logState() :
+		m_traceSampling(1),
+		m_stopping(false),
+		m_passes(0)
+	{
+		this->m_writer = boost::thread(&asyncLog::writerLoop);
+	};
+
+	~logState()
+	{
+		this->m_stopping = true;
+		this->m_writer.join();
+	};
+
+	boost::mutex m_ringsMutex;
+	std::vector<boost::shared_ptr<logRing> > m_rings;
+	std::atomic<uint32_t> m_traceSampling;
+	std::atomic<bool> m_stopping;
+
+	// counted after each pass of the writer is flushed to std::cout
+	std::atomic<uint64_t> m_passes;
+	boost::thread m_writer;
+};
+
+//------------------------------------------------------------------------ state
+// Implementation notes:
+//  The writer thread waits in here until the constructor returns
+//------------------------------------------------------------------------------
+asyncLog::logState& asyncLog::state()
+{
+	static logState state;
+
+	return state;
+};
+
+//--------------------------------------------------------------------- setLevel
+// Implementation notes:
+//  A sampling of 0 is taken as 1, every trace line is kept
+//------------------------------------------------------------------------------
+void asyncLog::setLevel(
+	const LogLevel& inLevel,
+	const uint32_t& inTraceSampling)
+{
+	asyncLog::state().m_traceSampling = std::max<uint32_t>(inTraceSampling, 1);
+
+	s_level.store(
+		static_cast<int>(inLevel),
+		std::memory_order_relaxed);
+};
+
+//------------------------------------------------------------------------ flush
+// Implementation notes:
+//  Once every ring is empty, the pass of the writer that emptied them may
+//  still be writing, so wait for the next pass to be counted as well
+//------------------------------------------------------------------------------
+void asyncLog::flush()
+{
+	logState& state = asyncLog::state();
+
+	const boost::posix_time::ptime giveUp =
+		boost::posix_time::microsec_clock::universal_time()
+		+ boost::posix_time::seconds(1);
+
+	bool drained = false;
+	uint64_t passes = 0;
+
+	while(boost::posix_time::microsec_clock::universal_time() < giveUp)
+	{
+		if(drained)
+		{
+			if(state.m_passes.load() != passes)
+			{
+				return;
+			}
+		}
+		else
+		{
+			passes = state.m_passes.load();
+			drained = true;
+
+			boost::lock_guard<boost::mutex> lock(state.m_ringsMutex);
+
+			for(const boost::shared_ptr<logRing>& ring : state.m_rings)
+			{
+				if(ring->m_tail.load() != ring->m_head.load())
+				{
+					drained = false;
+					break;
+				}
+			}
+		}
+
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::logWriterIdleMilliseconds));
+	}
+};
+
+//-------------------------------------------------------------- levelFromString
+// Implementation notes:
+//  The names are the ones servers.cfg uses
+//------------------------------------------------------------------------------
+bool asyncLog::levelFromString(
+	const std::string& inName,
+	LogLevel& outLevel)
+{
+	static const char* names[] = {"error", "warning", "info", "trace"};
+
+	for(int level = ll_ERROR; level <= ll_TRACE; level++)
+	{
+		if(inName == names[level])
+		{
+			outLevel = static_cast<LogLevel>(level);
+			return true;
+		}
+	}
+
+	return false;
+};
+
+//---------------------------------------------------------------------- enqueue
+// Implementation notes:
+//  The ring of a thread is created the first time it logs. The handle
+//  kept per thread marks the ring abandoned when the thread exits, rather
+//  than freeing it under the writer.
+//------------------------------------------------------------------------------
+void asyncLog::enqueue(
+	const logRecord& inRecord)
+{
+	class ringHandle
+	{
+	public:
+		~ringHandle()
+		{
+			if(this->m_ring)
+			{
+				this->m_ring->m_abandoned = true;
+			}
+		};
+
+		boost::shared_ptr<logRing> m_ring;
+	};
+
+	thread_local ringHandle handle;
+
+	if(!handle.m_ring)
+	{
+		logState& state = asyncLog::state();
+
+		handle.m_ring.reset(new logRing());
+
+		boost::lock_guard<boost::mutex> lock(state.m_ringsMutex);
+		state.m_rings.push_back(handle.m_ring);
+	}
+
+	logRing& ring = *handle.m_ring;
+
+	if(inRecord.m_level == ll_TRACE)
+	{
+		const uint32_t sampling = asyncLog::state().m_traceSampling.load(
+			std::memory_order_relaxed);
+
+		if(ring.m_traceCount++ % sampling != 0)
+		{
+			return;
+		}
+	}
+
+	const uint64_t head = ring.m_head.load(std::memory_order_relaxed);
+
+	if(head - ring.m_tail.load(std::memory_order_acquire) >= ring.m_records.size())
+	{
+		// the writer is behind, losing a line beats blocking a server thread
+		ring.m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ring.m_records[head % ring.m_records.size()] = inRecord;
+	ring.m_head.store(head + 1, std::memory_order_release);
+};
+
+//----------------------------------------------------------------------- format
+// Implementation notes:
+//  A "{}" past the last argument is left as is. A text argument stores
+//  where it ends in the record's text, it starts where the one before it
+//  ended.
+//------------------------------------------------------------------------------
+std::string asyncLog::format(
+	const logRecord& inRecord)
+{
+	std::ostringstream line;
+	uint8_t argument = 0;
+	uint16_t textStart = 0;
+
+	for(const char* character = inRecord.m_format; *character != '\0'; character++)
+	{
+		if(character[0] != '{'
+			|| character[1] != '}'
+			|| argument >= inRecord.m_argumentCount)
+		{
+			line << *character;
+			continue;
+		}
+
+		const int64_t value = inRecord.m_arguments[argument];
+
+		switch(inRecord.m_argumentTypes[argument])
+		{
+			case la_INTEGER:
+			{
+				line << value;
+				break;
+			}
+			case la_REAL:
+			{
+				double real;
+				std::memcpy(&real, &value, sizeof(real));
+				line << real;
+				break;
+			}
+			case la_TEXT:
+			{
+				const uint16_t textEnd = static_cast<uint16_t>(value);
+				line.write(inRecord.m_text + textStart, textEnd - textStart);
+				textStart = textEnd;
+				break;
+			}
+		}
+
+		argument++;
+		character++;
+	}
+
+	return line.str();
+};
+
+//------------------------------------------------------------------- writerLoop
+// Implementation notes:
+//  The rings are copied out under the lock, so threads starting to log do
+//  not wait on the formatting. A ring's records are only released once
+//  they were written, which is what flush() waits for.
+//------------------------------------------------------------------------------
+void asyncLog::writerLoop()
+{
+	logState& state = asyncLog::state();
+
+	std::vector<boost::shared_ptr<logRing> > rings;
+
+	while(true)
+	{
+		const bool stopping = state.m_stopping;
+
+		{
+			boost::lock_guard<boost::mutex> lock(state.m_ringsMutex);
+
+			rings.clear();
+
+			// forget the rings of threads that exited once they are empty
+			for(const boost::shared_ptr<logRing>& ring : state.m_rings)
+			{
+				if(!ring->m_abandoned
+					|| ring->m_tail.load() != ring->m_head.load())
+				{
+					rings.push_back(ring);
+				}
+			}
+
+			state.m_rings = rings;
+		}
+
+		std::string lines;
+
+		for(const boost::shared_ptr<logRing>& ring : rings)
+		{
+			const uint64_t head = ring->m_head.load(std::memory_order_acquire);
+			uint64_t tail = ring->m_tail.load(std::memory_order_relaxed);
+
+			for(; tail != head; tail++)
+			{
+				lines += asyncLog::format(
+					ring->m_records[tail % ring->m_records.size()]);
+				lines += '\n';
+			}
+
+			const uint64_t dropped = ring->m_dropped.exchange(0);
+
+			if(dropped > 0)
+			{
+				lines += "Log fell behind, " + std::to_string(dropped) + " lines dropped\n";
+			}
+
+			if(!lines.empty())
+			{
+				std::cout << lines;
+				lines.clear();
+			}
+
+			ring->m_tail.store(tail, std::memory_order_release);
+		}
+
+		std::cout << std::flush;
+		state.m_passes++;
+
+		if(stopping)
+		{
+			// this pass started after the last line was logged
+			return;
+		}
+
+		bool idle = true;
+
+		for(const boost::shared_ptr<logRing>& ring : rings)
+		{
+			if(ring->m_tail.load() != ring->m_head.load())
+			{
+				idle = false;
+				break;
+			}
+		}
+
+		if(idle)
+		{
+			boost::this_thread::sleep(
+				boost::posix_time::millisec(
+				constants::logWriterIdleMilliseconds));
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+class asyncLog
+{
+public:
+
+	enum LogLevel
+	{
+		ll_ERROR,
+		ll_WARNING,
+		ll_INFO,
+		ll_TRACE
+	};
+
+	//-------------------------------------------------------------------- write
+	// Brief Description
+	//  Logs a line at the given level. Each "{}" in the format is replaced
+	//  by the next argument, which may be an integer, a floating point
+	//  number or a string. The arguments are copied to a ring buffer of the
+	//  calling thread and formatted by the writer thread later, so the
+	//  format must be a string literal. Lines below the level set are
+	//  skipped before anything is copied.
+	//
+	// Method:    write
+	// FullName:  asyncLog::write
+	// Access:    public
+	// Returns:   void
+	// Parameter: const LogLevel& inLevel
+	// Parameter: const char* inFormat
+	// Parameter: const Arguments&... inArguments
+	//--------------------------------------------------------------------------
+	template<typename... Arguments>
+	static void write(
+		const LogLevel& inLevel,
+		const char* inFormat,
+		const Arguments&... inArguments)
+	{
+		if(!asyncLog::enabled(inLevel))
+		{
+			return;
+		}
+
+		logRecord record;
+
+		record.m_format = inFormat;
+		record.m_level = static_cast<uint8_t>(inLevel);
+		record.m_argumentCount = 0;
+		record.m_textBytes = 0;
+
+		asyncLog::encode(
+			record,
+			inArguments...);
+
+		asyncLog::enqueue(
+			record);
+	};
+
+	//------------------------------------------------------------------ enabled
+	// Brief Description
+	//  Returns true if lines at the given level are logged, one relaxed
+	//  load. Callers only need it to skip work done to build arguments.
+	//
+	// Method:    enabled
+	// FullName:  asyncLog::enabled
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const LogLevel& inLevel
+	//--------------------------------------------------------------------------
+	static bool enabled(
+		const LogLevel& inLevel)
+	{
+		return static_cast<int>(inLevel)
+			<= s_level.load(std::memory_order_relaxed);
+	};
+
+	//----------------------------------------------------------------- setLevel
+	// Brief Description
+	//  Sets the most verbose level logged. Trace lines are then only kept
+	//  one in the given number, per thread.
+	//
+	// Method:    setLevel
+	// FullName:  asyncLog::setLevel
+	// Access:    public
+	// Returns:   void
+	// Parameter: const LogLevel& inLevel
+	// Parameter: const uint32_t& inTraceSampling
+	//--------------------------------------------------------------------------
+	static void setLevel(
+		const LogLevel& inLevel,
+		const uint32_t& inTraceSampling);
+
+	//-------------------------------------------------------------------- flush
+	// Brief Description
+	//  Waits until the writer thread has written every line logged so far,
+	//  for at most a second.
+	//
+	// Method:    flush
+	// FullName:  asyncLog::flush
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	static void flush();
+
+	//---------------------------------------------------------- levelFromString
+	// Brief Description
+	//  Returns the level with the given name, and false if there is none.
+	//
+	// Method:    levelFromString
+	// FullName:  asyncLog::levelFromString
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::string& inName
+	// Parameter: LogLevel& outLevel
+	//--------------------------------------------------------------------------
+	static bool levelFromString(
+		const std::string& inName,
+		LogLevel& outLevel);
+
+private:
+
+	static const uint8_t maximumArguments = 6;
+	static const uint16_t maximumTextBytes = 160;
+
+	enum ArgumentType
+	{
+		la_INTEGER,
+		la_REAL,
+		la_TEXT
+	};
+
+	class logRecord
+	{
+	public:
+		const char* m_format;
+		uint8_t m_level;
+		uint8_t m_argumentCount;
+		uint8_t m_argumentTypes[maximumArguments];
+		uint16_t m_textBytes;
+
+		// integers, reals by their bits, or the end of a text in m_text
+		int64_t m_arguments[maximumArguments];
+		char m_text[maximumTextBytes];
+	};
+
+	// defined in the .cpp, the rings are only touched through enqueue
+	class logRing;
+	class logState;
+
+	//-------------------------------------------------------------------- state
+	// Brief Description
+	//  Returns the rings of every thread that logged and the writer thread,
+	//  created on first use.
+	//
+	// Method:    state
+	// FullName:  asyncLog::state
+	// Access:    private
+	// Returns:   logState&
+	//--------------------------------------------------------------------------
+	static logState& state();
+
+	//------------------------------------------------------------------ enqueue
+	// Brief Description
+	//  Copies the record to the calling thread's ring buffer, or drops it
+	//  if the buffer is full or the record is sampled out.
+	//
+	// Method:    enqueue
+	// FullName:  asyncLog::enqueue
+	// Access:    private
+	// Returns:   void
+	// Parameter: const logRecord& inRecord
+	//--------------------------------------------------------------------------
+	static void enqueue(
+		const logRecord& inRecord);
+
+	//------------------------------------------------------------------- encode
+	// Brief Description
+	//  Copies the arguments into the record, one overload per kind of
+	//  argument. Arguments past the maximum are left out.
+	//
+	// Method:    encode
+	// FullName:  asyncLog::encode
+	// Access:    private
+	// Returns:   void
+	// Parameter: logRecord& record
+	//--------------------------------------------------------------------------
+	static void encode(
+		logRecord&)
+	{
+	};
+
+	template<typename Integer, typename... Arguments>
+	static typename std::enable_if<std::is_integral<Integer>::value>::type encode(
+		logRecord& record,
+		const Integer& inInteger,
+		const Arguments&... inArguments)
+	{
+		if(record.m_argumentCount < maximumArguments)
+		{
+			record.m_argumentTypes[record.m_argumentCount] = la_INTEGER;
+			record.m_arguments[record.m_argumentCount++] = static_cast<int64_t>(inInteger);
+		}
+
+		asyncLog::encode(
+			record,
+			inArguments...);
+	};
+
+	template<typename... Arguments>
+	static void encode(
+		logRecord& record,
+		const double& inReal,
+		const Arguments&... inArguments)
+	{
+		if(record.m_argumentCount < maximumArguments)
+		{
+			record.m_argumentTypes[record.m_argumentCount] = la_REAL;
+			std::memcpy(&record.m_arguments[record.m_argumentCount++], &inReal, sizeof(inReal));
+		}
+
+		asyncLog::encode(
+			record,
+			inArguments...);
+	};
+
+	template<typename... Arguments>
+	static void encode(
+		logRecord& record,
+		const std::string& inText,
+		const Arguments&... inArguments)
+	{
+		asyncLog::encodeText(
+			record,
+			inText.data(),
+			inText.size());
+
+		asyncLog::encode(
+			record,
+			inArguments...);
+	};
+
+	template<typename... Arguments>
+	static void encode(
+		logRecord& record,
+		const char* inText,
+		const Arguments&... inArguments)
+	{
+		asyncLog::encodeText(
+			record,
+			inText,
+			std::strlen(inText));
+
+		asyncLog::encode(
+			record,
+			inArguments...);
+	};
+
+	//--------------------------------------------------------------- encodeText
+	// Brief Description
+	//  Appends a text argument to the record's text, cut short if the text
+	//  is full.
+	//
+	// Method:    encodeText
+	// FullName:  asyncLog::encodeText
+	// Access:    private
+	// Returns:   void
+	// Parameter: logRecord& record
+	// Parameter: const char* inText
+	// Parameter: const size_t& inLength
+	//--------------------------------------------------------------------------
+	static void encodeText(
+		logRecord& record,
+		const char* inText,
+		const size_t& inLength)
+	{
+		if(record.m_argumentCount >= maximumArguments)
+		{
+			return;
+		}
+
+		const size_t length = std::min<size_t>(
+			inLength,
+			maximumTextBytes - record.m_textBytes);
+
+		std::memcpy(record.m_text + record.m_textBytes, inText, length);
+
+		record.m_textBytes = static_cast<uint16_t>(record.m_textBytes + length);
+
+		record.m_argumentTypes[record.m_argumentCount] = la_TEXT;
+		record.m_arguments[record.m_argumentCount++] = record.m_textBytes;
+	};
+
+	//------------------------------------------------------------------- format
+	// Brief Description
+	//  Returns the line a record stands for. Only called by the writer
+	//  thread.
+	//
+	// Method:    format
+	// FullName:  asyncLog::format
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: const logRecord& inRecord
+	//--------------------------------------------------------------------------
+	static std::string format(
+		const logRecord& inRecord);
+
+	//--------------------------------------------------------------- writerLoop
+	// Brief Description
+	//  Drains every thread's ring buffer in turn and writes the lines to
+	//  std::cout, flushing once per pass rather than once per line.
+	//
+	// Method:    writerLoop
+	// FullName:  asyncLog::writerLoop
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	static void writerLoop();
+
+	// the level is read on every call, everything else is in the state
+	static std::atomic<int> s_level;
+};
\ No newline at end of file
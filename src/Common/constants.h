@@ -3,149 +3,208 @@
 // STL
 #include <string>
 #include <cstdint>
-#include <cctype>
-#include <string>
-#include <vector>
 
 namespace constants
 {
 	const uint16_t updateIntervalMilliseconds = 1000;
 	const uint16_t syncIntervalMilliseconds = 1500;
 	const uint16_t forwardIntervalMilliseconds = 5;
+	const uint16_t heartbeatIntervalMilliseconds = 250;
+	const uint16_t suspicionTimeoutMilliseconds = 1000;
+
+	// the largest payload a UDP datagram can carry, so nothing the protocol
+	// sends is cut short. Synced lists are split into parts far below it.
+	const uint16_t receiveBufferLength = 65507;
+
+	// client and channel lists are synced in parts of at most this many
+	// bytes of names, each in a datagram of its own, so that a list of any
+	// length arrives whole. An incomplete list is not applied.
+	const uint16_t syncListPartLength = 1200;
+	const uint16_t syncListMaximumParts = 1024;
+
+	// membership updates name the version of the list they follow. One that
+	// follows a version less than this far ahead of the list's is held
+	// until the updates in between are retransmitted; a larger gap is a
+	// server that restarted, and its update is applied at once.
+	const uint16_t membershipUpdateHoldVersions = 64;
+
+	// reliable relays between servers. The retransmit timeout does not go
+	// below a server's worst case handling delay under a fan-out, or ACKs
+	// that are merely late get their relays sent again.
+	const uint16_t relayWindowSize = 64;
+	const uint16_t relayRetransmitBurst = 8;
+	const uint16_t relayFastRetransmitThreshold = 3;
+	const uint16_t relaySelectiveAcknowledgementLimit = 16;
+	const uint16_t relayInitialRetransmitMilliseconds = 200;
+	const uint16_t relayMinimumRetransmitMilliseconds = 200;
+	const uint16_t relayMaximumRetransmitMilliseconds = 2000;
+
+	// reliable sends from clients to their server
+	const uint16_t clientInitialCongestionWindow = 4;
+	const uint16_t clientMaximumCongestionWindow = 64;
+	const uint16_t clientSequenceSpan = 128;
+	const uint16_t clientInitialRetransmitMilliseconds = 300;
+	const uint16_t clientMinimumRetransmitMilliseconds = 20;
+	const uint16_t clientMaximumRetransmitMilliseconds = 4000;
+	const uint16_t clientDrainTimeoutMilliseconds = 3000;
+
+	// a message the server has not ACKed after this many transmissions,
+	// about half a minute with the backoff, is given up on and reported
+	const uint16_t clientMaximumTransmissions = 10;
+
+	// duplicate suppression and ordering of messages shown by a client
+	const uint16_t deliveredWindowSize = 1024;
+	const uint16_t reorderHoldMilliseconds = 500;
+
+	// client ACKs are batched into frames, sent once the oldest has waited
+	// the delay
+	const uint16_t acknowledgementDelayMilliseconds = 10;
+	const uint16_t acknowledgementFrameLimit = 32;
+
+	// a server disconnects a client it has not heard from for the timeout,
+	// the deadlines are kept on a timer wheel of slots one tick long
+	const uint16_t sessionTimeoutMilliseconds = 30000;
+	const uint16_t sessionWheelSlotCount = 512;
+	const uint16_t sessionWheelTickMilliseconds = 100;
+
+	// a session holds the index of the server that issued it in its top
+	// byte, so a topology has at most this many servers
+	const uint16_t maximumServers = 256;
+
+	// a server gives up on a message it could not deliver in time, or that
+	// would take a recipient or the server over its quota
+	const uint32_t messageTimeToLiveMilliseconds = 300000;
+	const uint32_t recipientMessageQuota = 4096;
+	const uint32_t recipientByteQuota = 4194304;
+	const uint32_t serverMessageQuota = 262144;
+	const uint32_t serverByteQuota = 67108864;
+	const uint16_t backlogSweepIntervalMilliseconds = 1000;
+
+	// held messages are retried with a backoff between these
+	const uint16_t heldRetryMinimumMilliseconds = 5;
+	const uint16_t heldRetryMaximumMilliseconds = 2000;
+
+	// undelivered messages are appended to memory mapped segments, written
+	// to disk together every interval. A segment less than the percentage
+	// live is compacted into the newest one.
+	const uint32_t spoolSegmentBytes = 8388608;
+	const uint16_t spoolSynchronizeIntervalMilliseconds = 20;
+	const uint16_t spoolCompactionPercent = 25;
+	const uint32_t spoolRemovedIndexSlots = 4096;
+
+	// captured datagrams are buffered and appended to the file this often
+	const uint16_t captureFlushIntervalMilliseconds = 20;
+
+	// each thread logs to a ring of this many lines, the writer thread
+	// sleeps the interval when every ring is empty
+	const uint16_t logRingRecords = 1024;
+	const uint16_t logWriterIdleMilliseconds = 2;
+
+	// servers write their metrics to a file this often, when asked to
+	const uint16_t metricsExportIntervalMilliseconds = 1000;
+
+	// in profiling builds, each thread keeps this many of its most recent
+	// stages for the Chrome trace
+	const uint32_t profileStagesPerThread = 16384;
+
+	// servers can sync their client lists as Bloom filters of this many
+	// bits instead, which fit a datagram once encoded
+	const uint16_t membershipFilterBits = 8192;
+	const uint16_t membershipFilterMinimumBits = 64;
+	const uint16_t membershipFilterMaximumBits = 16384;
+
+	// the protocol simulator keeps running this long after the last message
+	// is sent, so messages sent near the end can still be delivered
+	const uint32_t simulationDrainMilliseconds = 30000;
 
-	const std::vector<uint16_t> serverListeningPorts(
-	{8080, 8081, 8082, 8083, 8084});
-
-	const int8_t highestServerIndex = 
-		(static_cast<int8_t>(constants::serverListeningPorts.size()) - 1);
-
-	const int8_t numberOfServers = 5;
-
-	const std::vector<std::string> serverNames(
-	{"Alpha", "Bravo", "Charlie", "Delta", "Echo"});
-
-	static std::string serverHostName(
-		const uint8_t& inServerIndex)
-	{
-		return constants::serverNames[inServerIndex]
-			+ "ServerCPSC3780";
-	}
-
-	//-------------------------------------------------------- charToServerIndex
+	//--------------------------------------------------------- messageDelimiter
 	// Brief Description
-	//  Converts the input char to the server index. The server index can later
-	//  be used to determine the associated port via indexing at
-	//  serverListeningPorts[index]
+	//  The character sequence used to delimit messages sent both ways between
+	//  server and client.
 	//
-	// Method:    charToServerIndex
-	// FullName:  constants::charToServerIndex
+	// Method:    messageDelimiter
+	// FullName:  constants::messageDelimiter
 	// Access:    public static 
-	// Returns:   uint8_t
-	// Parameter: const char& inChar
+	// Returns:   std::string
 	//--------------------------------------------------------------------------
-	static uint8_t charToServerIndex(
-		const char& inChar)
-	{
-		const char inCharAsLower(
-			std::tolower(inChar));
-
-		return static_cast<uint8_t>(inCharAsLower - 'a');
-	};
-
-
-	static bool leftAdjacentServerIndexIsValid(
-		const int8_t& inLeftAdjacentServerIndex)
-	{
-		return inLeftAdjacentServerIndex >= 0;
-	};
-
-	static bool rightAdjacentServerIndexIsValid(
-		const int8_t& inRightAdjacentServerIndex)
+	static inline std::string messageDelimiter()
 	{
-		return inRightAdjacentServerIndex <= constants::highestServerIndex;
+		return "/?";
 	};
 
-	//----------------------------------------------- serverIndexToListeningPort
+	//-------------------------------------------------- syncIdentifierDelimiter
 	// Brief Description
-	//  Returns the listening port associated with a server index.
+	//  The character used to delimit identifiers in sync messages
+	//  sent between servers.
 	//
-	// Method:    serverIndexToListeningPort
-	// FullName:  constants::serverIndexToListeningPort
+	// Method:    syncIdentifierDelimiter
+	// FullName:  constants::syncIdentifierDelimiter
 	// Access:    public static 
-	// Returns:   uint16_t
-	// Parameter: const uint8_t& inServerIndex
+	// Returns:   char
 	//--------------------------------------------------------------------------
-	static uint16_t serverIndexToListeningPort(
-		const uint8_t& inServerIndex)
+	static inline char syncIdentifierDelimiter()
 	{
-		return constants::serverListeningPorts[inServerIndex];
+		return ',';
 	};
 
-	//-------------------------------------------------- serverIndexToServerName
+	//------------------------------------------------------ broadcastIdentifier
 	// Brief Description
-	//  Returns the name of the server associated with the given server index.
+	//  The destination identifier of a message sent to every client.
 	//
-	// Method:    portNumberToServerName
-	// FullName:  constants::portNumberToServerName
+	// Method:    broadcastIdentifier
+	// FullName:  constants::broadcastIdentifier
 	// Access:    public static 
 	// Returns:   std::string
-	// Parameter: const uint8_t& inServerIndex
 	//--------------------------------------------------------------------------
-	static std::string serverIndexToServerName(
-		const uint8_t& inServerIndex)
+	static inline std::string broadcastIdentifier()
 	{
-		return constants::serverNames[inServerIndex];;
+		return "broadcast";
 	};
 
-	//-------------------------------------------------------- identifierIsValid
+	//------------------------------------------------------- multicastDelimiter
 	// Brief Description
-	//  Used to determine if the user specified server identifier is valid.
-	//  (As per the specification, only a-e are supported. Input can be
-	//  uppercase, as char is converted to lowercase before comparison is done.
+	//  The character used to delimit the clients in the destination
+	//  identifier of a message sent to several of them.
 	//
-	// Method:    identifierIsValid
-	// FullName:  constants::identifierIsValid
+	// Method:    multicastDelimiter
+	// FullName:  constants::multicastDelimiter
 	// Access:    public static 
-	// Returns:   bool
-	// Parameter: const char & inChar
+	// Returns:   char
 	//--------------------------------------------------------------------------
-	static bool identifierIsValid(
-		const char& inChar)
+	static inline char multicastDelimiter()
 	{
-		const char inCharAsLower(
-			std::tolower(inChar));
-
-		return (inCharAsLower >= 'a') && (inCharAsLower <= 'e');
+		return ',';
 	};
 
-	//--------------------------------------------------------- messageDelimiter
+	//------------------------------------------------------------ channelPrefix
 	// Brief Description
-	//  The character sequence used to delimit messages sent both ways between
-	//  server and client.
+	//  The character every channel name starts with, which tells a message
+	//  to a channel apart from a message to a client.
 	//
-	// Method:    messageDelimiter
-	// FullName:  constants::messageDelimiter
+	// Method:    channelPrefix
+	// FullName:  constants::channelPrefix
 	// Access:    public static 
-	// Returns:   std::string
+	// Returns:   char
 	//--------------------------------------------------------------------------
-	static inline std::string messageDelimiter()
+	static inline char channelPrefix()
 	{
-		return "/?";
+		return '#';
 	};
 
-	//-------------------------------------------------- syncIdentifierDelimiter
+	//------------------------------------------------------------ sessionPrefix
 	// Brief Description
-	//  The character used to delimit identifiers in sync messages
-	//  sent between servers.
+	//  The character a session identifier starts with, which a client
+	//  sends as its source instead of its username once its server has
+	//  given it a session.
 	//
-	// Method:    syncIdentifierDelimiter
-	// FullName:  constants::syncIdentifierDelimiter
+	// Method:    sessionPrefix
+	// FullName:  constants::sessionPrefix
 	// Access:    public static 
 	// Returns:   char
 	//--------------------------------------------------------------------------
-	static inline char syncIdentifierDelimiter()
+	static inline char sessionPrefix()
 	{
-		return ',';
+		return '@';
 	};
 
 	enum MessageType
@@ -160,5 +219,15 @@ namespace constants
 		mt_SERVER_ACK = 7,
 		mt_SERVER_SYNC = 8,
 		mt_PING = 9,
+		mt_SERVER_CLIENT_JOINED = 10,
+		mt_SERVER_CLIENT_LEFT = 11,
+		mt_CLIENT_JOIN = 12,
+		mt_CLIENT_LEAVE = 13,
+		mt_SERVER_CHANNEL_SYNC = 14,
+		mt_SERVER_CHANNEL_ADDED = 15,
+		mt_SERVER_CHANNEL_REMOVED = 16,
+		mt_SERVER_SESSION = 17,
+		mt_SERVER_SUMMARY = 18,
+		mt_SERVER_SYNC_REQUEST = 19,
 	};
 }
\ No newline at end of file
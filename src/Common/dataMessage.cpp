@@ -1,10 +1,13 @@
 // STL
 #include <string>
+#include <sstream>
 #include <iostream>
+#include <limits>
 
 // Project
 #include "dataMessage.h"
 #include "constants.h"
+#include "stageProfiler.h"
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
@@ -23,6 +26,11 @@ dataMessage::dataMessage(
 	this->m_destinationIdentifier = inDestinationID;
 	this->m_payload = inPayload;
 	this->m_serverSyncPayloadOriginIndex = -1;
+	this->m_hopCount = 0;
+	this->m_linkSequenceNumber = 0;
+	this->m_linkWindowBase = 0;
+	this->m_previousSequenceNumber = 0;
+	this->m_timeToLiveMilliseconds = 0;
 };
 
 //------------------------------------------------------------------ constructor
@@ -35,7 +43,7 @@ dataMessage::dataMessage(
 	const std::string& inSourceID,
 	const std::string& inDestinationID,
 	const std::vector<std::string>& inServerSyncPayload,
-	const int8_t& inServerSyncPayloadOriginIndex)
+	const int16_t& inServerSyncPayloadOriginIndex)
 {
 	this->m_sequenceNumber = inSequenceNumber;
 	this->m_messageType = inMessageType;
@@ -43,6 +51,11 @@ dataMessage::dataMessage(
 	this->m_destinationIdentifier = inDestinationID;
 	this->m_payload = dataMessage::createServerSyncPayload(inServerSyncPayload);
 	this->m_serverSyncPayloadOriginIndex = inServerSyncPayloadOriginIndex;
+	this->m_hopCount = 0;
+	this->m_linkSequenceNumber = 0;
+	this->m_linkWindowBase = 0;
+	this->m_previousSequenceNumber = 0;
+	this->m_timeToLiveMilliseconds = 0;
 };
 
 //------------------------------------------------------------------ constructor
@@ -52,12 +65,14 @@ dataMessage::dataMessage(
 dataMessage::dataMessage(
 	const std::vector<char>& inCharVector)
 {
+	stageProfiler::scopedStage stage("decode");
+
 	std::string asString(
 		inCharVector.begin(),
 		inCharVector.end());
 
 	std::string sequenceNumberAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
-	this->m_sequenceNumber = std::stoi(sequenceNumberAsString);
+	this->m_sequenceNumber = std::stoll(sequenceNumberAsString);
 	asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
 
 	std::string messageType = asString.substr(0, asString.find(constants::messageDelimiter()));
@@ -76,6 +91,79 @@ dataMessage::dataMessage(
 	std::string serverSyncPayloadOriginIndexAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
 	this->m_serverSyncPayloadOriginIndex = std::stoi(serverSyncPayloadOriginIndexAsString);
 	asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+
+	// the hop count is absent from messages sent by older builds
+	this->m_hopCount = 0;
+
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::string hopCountAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
+		this->m_hopCount = static_cast<uint16_t>(std::stoi(hopCountAsString));
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	// as are the link sequence numbers, which only relays between servers use
+	this->m_linkSequenceNumber = 0;
+	this->m_linkWindowBase = 0;
+
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::string linkSequenceNumberAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
+		this->m_linkSequenceNumber = std::stoll(linkSequenceNumberAsString);
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::string linkWindowBaseAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
+		this->m_linkWindowBase = std::stoll(linkWindowBaseAsString);
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	// only chat messages from clients carry the previous sequence number
+	this->m_previousSequenceNumber = 0;
+
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::string previousSequenceNumberAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
+		this->m_previousSequenceNumber = std::stoll(previousSequenceNumberAsString);
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	// and only relayed broadcasts and channel messages carry target servers
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::stringstream targetServerIndices(
+			asString.substr(0, asString.find(constants::messageDelimiter())));
+
+		std::string targetServerIndex("");
+
+		while(std::getline(targetServerIndices, targetServerIndex, constants::syncIdentifierDelimiter()))
+		{
+			this->m_targetServerIndices.push_back(
+				static_cast<int16_t>(std::stoi(targetServerIndex)));
+		}
+
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	// the time to live is absent from messages sent by older builds too
+	this->m_timeToLiveMilliseconds = 0;
+
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		std::string timeToLiveAsString = asString.substr(0, asString.find(constants::messageDelimiter()));
+		this->m_timeToLiveMilliseconds = std::stoll(timeToLiveAsString);
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
+
+	// only the few messages sampled for tracing carry a trace
+	if(asString.find(constants::messageDelimiter()) != std::string::npos)
+	{
+		this->m_trace = messageTrace(
+			asString.substr(0, asString.find(constants::messageDelimiter())));
+		asString.erase(0, asString.find(constants::messageDelimiter()) + constants::messageDelimiter().length());
+	}
 };
 
 //----------------------------------------------------------- viewSequenceNumber
@@ -115,6 +203,75 @@ const std::string& dataMessage::viewSourceIdentifier() const
 	return this->m_sourceIdentifier;
 };
 
+//---------------------------------------------------------- setSourceIdentifier
+// Implementation notes:
+//  Sets the source identifier to inSourceID
+//------------------------------------------------------------------------------
+void dataMessage::setSourceIdentifier(
+	const std::string& inSourceID)
+{
+	this->m_sourceIdentifier = inSourceID;
+};
+
+//---------------------------------------------------------------- isFromSession
+// Implementation notes:
+//  Usernames never start with the session prefix
+//------------------------------------------------------------------------------
+bool dataMessage::isFromSession() const
+{
+	return !this->m_sourceIdentifier.empty()
+		&& this->m_sourceIdentifier[0] == constants::sessionPrefix();
+};
+
+//------------------------------------------------------- parseSessionIdentifier
+// Implementation notes:
+//  Digits only and at most ten of them, checked against the largest 32-bit
+//  number before narrowing, so a larger number is not taken for the session
+//  it wraps around to
+//------------------------------------------------------------------------------
+bool dataMessage::parseSessionIdentifier(
+	uint32_t& outSessionIdentifier) const
+{
+	if(!this->isFromSession()
+		|| this->m_sourceIdentifier.size() < 2
+		|| this->m_sourceIdentifier.size() > 11
+		|| this->m_sourceIdentifier.find_first_not_of("0123456789", 1) != std::string::npos)
+	{
+		return false;
+	}
+
+	const uint64_t sessionIdentifier =
+		std::stoull(this->m_sourceIdentifier.substr(1));
+
+	if(sessionIdentifier == 0
+		|| sessionIdentifier > std::numeric_limits<uint32_t>::max())
+	{
+		return false;
+	}
+
+	outSessionIdentifier = static_cast<uint32_t>(sessionIdentifier);
+
+	return true;
+};
+
+//-------------------------------------------------------------- isValidUsername
+// Implementation notes:
+//  isFromSession, isChannel and isMulticast tell names apart by these
+//  characters, and sync payloads are split on the list delimiter. A client
+//  named as the broadcast destination could never be sent to directly.
+//------------------------------------------------------------------------------
+bool dataMessage::isValidUsername(
+	const std::string& inUsername)
+{
+	return !inUsername.empty()
+		&& inUsername != constants::broadcastIdentifier()
+		&& inUsername[0] != constants::sessionPrefix()
+		&& inUsername[0] != constants::channelPrefix()
+		&& inUsername.find_first_of(constants::messageDelimiter()) == std::string::npos
+		&& inUsername.find(constants::syncIdentifierDelimiter()) == std::string::npos
+		&& inUsername.find(constants::multicastDelimiter()) == std::string::npos;
+};
+
 //---------------------------------------------------- viewDestinationIdentifier
 // Implementation notes:
 //  Returns a const reference to the destinationIdentifier string
@@ -124,6 +281,75 @@ const std::string& dataMessage::viewDestinationIdentifier() const
 	return this->m_destinationIdentifier;
 };
 
+//----------------------------------------------------- setDestinationIdentifier
+// Implementation notes:
+//  Sets the destination identifier to inDestinationID
+//------------------------------------------------------------------------------
+void dataMessage::setDestinationIdentifier(
+	const std::string& inDestinationID)
+{
+	this->m_destinationIdentifier = inDestinationID;
+};
+
+//------------------------------------------------------------------ isBroadcast
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+bool dataMessage::isBroadcast() const
+{
+	return this->m_destinationIdentifier == constants::broadcastIdentifier();
+};
+
+//-------------------------------------------------------------------- isChannel
+// Implementation notes:
+//  Client names never start with the channel prefix
+//------------------------------------------------------------------------------
+bool dataMessage::isChannel() const
+{
+	return !this->m_destinationIdentifier.empty()
+		&& this->m_destinationIdentifier[0] == constants::channelPrefix();
+};
+
+//------------------------------------------------------------------ isMulticast
+// Implementation notes:
+//  A single client never contains the delimiter
+//------------------------------------------------------------------------------
+bool dataMessage::isMulticast() const
+{
+	return this->m_destinationIdentifier.find(constants::multicastDelimiter())
+		!= std::string::npos;
+};
+
+//--------------------------------------------------------------- viewRecipients
+// Implementation notes:
+//  Empty names, from doubled or trailing delimiters, are skipped
+//------------------------------------------------------------------------------
+std::vector<std::string> dataMessage::viewRecipients() const
+{
+	std::vector<std::string> outRecipients;
+	std::string recipient("");
+
+	for(const char& character : this->m_destinationIdentifier)
+	{
+		if(character != constants::multicastDelimiter())
+		{
+			recipient += character;
+		}
+		else if(!recipient.empty())
+		{
+			outRecipients.push_back(recipient);
+			recipient = "";
+		}
+	}
+
+	if(!recipient.empty())
+	{
+		outRecipients.push_back(recipient);
+	}
+
+	return outRecipients;
+};
+
 //------------------------------------------------------------------ viewPayload
 // Implementation notes:
 //  Returns a const reference to the payload string
@@ -137,11 +363,161 @@ const std::string& dataMessage::viewPayload() const
 // Implementation notes:
 //  Returns a const reference to the server sync payload origin index integer
 //------------------------------------------------------------------------------
-const int8_t& dataMessage::viewServerSyncPayloadOriginIndex() const
+const int16_t& dataMessage::viewServerSyncPayloadOriginIndex() const
 {
 	return this->m_serverSyncPayloadOriginIndex;
 };
 
+//---------------------------------------------- setServerSyncPayloadOriginIndex
+// Implementation notes:
+//  Sets the server sync payload origin index to inServerSyncPayloadOriginIndex
+//------------------------------------------------------------------------------
+void dataMessage::setServerSyncPayloadOriginIndex(
+	const int16_t& inServerSyncPayloadOriginIndex)
+{
+	this->m_serverSyncPayloadOriginIndex = inServerSyncPayloadOriginIndex;
+};
+
+//----------------------------------------------------------------- viewHopCount
+// Implementation notes:
+//  Returns a const reference to the hop count
+//------------------------------------------------------------------------------
+const uint16_t& dataMessage::viewHopCount() const
+{
+	return this->m_hopCount;
+};
+
+//------------------------------------------------------------ incrementHopCount
+// Implementation notes:
+//  Adds one to the hop count
+//------------------------------------------------------------------------------
+void dataMessage::incrementHopCount()
+{
+	this->m_hopCount++;
+};
+
+//------------------------------------------------------- viewLinkSequenceNumber
+// Implementation notes:
+//  Returns a const reference to the link sequence number
+//------------------------------------------------------------------------------
+const int64_t& dataMessage::viewLinkSequenceNumber() const
+{
+	return this->m_linkSequenceNumber;
+};
+
+//----------------------------------------------------------- viewLinkWindowBase
+// Implementation notes:
+//  Returns a const reference to the link window base
+//------------------------------------------------------------------------------
+const int64_t& dataMessage::viewLinkWindowBase() const
+{
+	return this->m_linkWindowBase;
+};
+
+//------------------------------------------------------- setLinkSequenceNumbers
+// Implementation notes:
+//  Sets both link sequence numbers
+//------------------------------------------------------------------------------
+void dataMessage::setLinkSequenceNumbers(
+	const int64_t& inLinkSequenceNumber,
+	const int64_t& inLinkWindowBase)
+{
+	this->m_linkSequenceNumber = inLinkSequenceNumber;
+	this->m_linkWindowBase = inLinkWindowBase;
+};
+
+//--------------------------------------------------- viewPreviousSequenceNumber
+// Implementation notes:
+//  Returns a const reference to the previous sequence number
+//------------------------------------------------------------------------------
+const int64_t& dataMessage::viewPreviousSequenceNumber() const
+{
+	return this->m_previousSequenceNumber;
+};
+
+//---------------------------------------------------- setPreviousSequenceNumber
+// Implementation notes:
+//  Sets the previous sequence number to inPreviousSequenceNumber
+//------------------------------------------------------------------------------
+void dataMessage::setPreviousSequenceNumber(
+	const int64_t& inPreviousSequenceNumber)
+{
+	this->m_previousSequenceNumber = inPreviousSequenceNumber;
+};
+
+//------------------------------------------------------ viewTargetServerIndices
+// Implementation notes:
+//  Returns a const reference to the target server indices
+//------------------------------------------------------------------------------
+const std::vector<int16_t>& dataMessage::viewTargetServerIndices() const
+{
+	return this->m_targetServerIndices;
+};
+
+//------------------------------------------------------- setTargetServerIndices
+// Implementation notes:
+//  Sets the target server indices to inTargetServerIndices
+//------------------------------------------------------------------------------
+void dataMessage::setTargetServerIndices(
+	const std::vector<int16_t>& inTargetServerIndices)
+{
+	this->m_targetServerIndices = inTargetServerIndices;
+};
+
+//--------------------------------------------------- viewTimeToLiveMilliseconds
+// Implementation notes:
+//  Returns a const reference to the time to live
+//------------------------------------------------------------------------------
+const int64_t& dataMessage::viewTimeToLiveMilliseconds() const
+{
+	return this->m_timeToLiveMilliseconds;
+};
+
+//---------------------------------------------------------------- setTimeToLive
+// Implementation notes:
+//  Sets the time to live to inTimeToLiveMilliseconds
+//------------------------------------------------------------------------------
+void dataMessage::setTimeToLive(
+	const int64_t& inTimeToLiveMilliseconds)
+{
+	this->m_timeToLiveMilliseconds = inTimeToLiveMilliseconds;
+};
+
+//-------------------------------------------------------------------- viewTrace
+// Implementation notes:
+//  Returns a const reference to the trace
+//------------------------------------------------------------------------------
+const messageTrace& dataMessage::viewTrace() const
+{
+	return this->m_trace;
+};
+
+//--------------------------------------------------------------------- setTrace
+// Implementation notes:
+//  Sets the trace to inTrace
+//------------------------------------------------------------------------------
+void dataMessage::setTrace(
+	const messageTrace& inTrace)
+{
+	this->m_trace = inTrace;
+};
+
+//------------------------------------------------------------------- stampTrace
+// Implementation notes:
+//  The clock is only read for traced messages
+//------------------------------------------------------------------------------
+void dataMessage::stampTrace(
+	const int16_t& inServerIndex,
+	const messageTrace::TraceStage& inStage)
+{
+	if(this->m_trace.isTraced())
+	{
+		this->m_trace.stamp(
+			inServerIndex,
+			inStage);
+	}
+};
+
 //------------------------------------------------------ viewMessageTypeAsString
 // Implementation notes:
 //  Returns a const string reference to the message type
@@ -197,6 +573,56 @@ const std::string dataMessage::viewMessageTypeAsString() const
 			messageTypeAsString = "ping";
 			break;
 		}
+		case constants::MessageType::mt_SERVER_CLIENT_JOINED:
+		{
+			messageTypeAsString = "server client joined";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_CLIENT_LEFT:
+		{
+			messageTypeAsString = "server client left";
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_JOIN:
+		{
+			messageTypeAsString = "client join";
+			break;
+		}
+		case constants::MessageType::mt_CLIENT_LEAVE:
+		{
+			messageTypeAsString = "client leave";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_CHANNEL_SYNC:
+		{
+			messageTypeAsString = "server channel sync";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_CHANNEL_ADDED:
+		{
+			messageTypeAsString = "server channel added";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_CHANNEL_REMOVED:
+		{
+			messageTypeAsString = "server channel removed";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SESSION:
+		{
+			messageTypeAsString = "server session";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SUMMARY:
+		{
+			messageTypeAsString = "server summary";
+			break;
+		}
+		case constants::MessageType::mt_SERVER_SYNC_REQUEST:
+		{
+			messageTypeAsString = "server sync request";
+			break;
+		}
 		default:
 		{
 			assert(false);
@@ -258,6 +684,56 @@ const constants::MessageType dataMessage::stringToMessageType(
 		return constants::mt_PING;
 	}
 
+	if(inMessageTypeAsString == "server client joined")
+	{
+		return constants::mt_SERVER_CLIENT_JOINED;
+	}
+
+	if(inMessageTypeAsString == "server client left")
+	{
+		return constants::mt_SERVER_CLIENT_LEFT;
+	}
+
+	if(inMessageTypeAsString == "client join")
+	{
+		return constants::mt_CLIENT_JOIN;
+	}
+
+	if(inMessageTypeAsString == "client leave")
+	{
+		return constants::mt_CLIENT_LEAVE;
+	}
+
+	if(inMessageTypeAsString == "server channel sync")
+	{
+		return constants::mt_SERVER_CHANNEL_SYNC;
+	}
+
+	if(inMessageTypeAsString == "server channel added")
+	{
+		return constants::mt_SERVER_CHANNEL_ADDED;
+	}
+
+	if(inMessageTypeAsString == "server channel removed")
+	{
+		return constants::mt_SERVER_CHANNEL_REMOVED;
+	}
+
+	if(inMessageTypeAsString == "server session")
+	{
+		return constants::mt_SERVER_SESSION;
+	}
+
+	if(inMessageTypeAsString == "server summary")
+	{
+		return constants::mt_SERVER_SUMMARY;
+	}
+
+	if(inMessageTypeAsString == "server sync request")
+	{
+		return constants::mt_SERVER_SYNC_REQUEST;
+	}
+
 	assert(false);
 
 	return constants::MessageType::mt_UNDEFINED;
@@ -313,14 +789,81 @@ std::vector<std::string> dataMessage::viewServerSyncPayload() const
 std::vector<char> dataMessage::asCharVector() const
 {
 	const std::string messageAsString(
-		std::to_string(this->m_sequenceNumber) + constants::messageDelimiter()
+		this->fieldsBeforeLinkAsString()
+		+ dataMessage::linkSequenceNumbersAsString(
+			this->m_linkSequenceNumber,
+			this->m_linkWindowBase)
+		+ this->fieldsAfterLinkAsString());
+
+	return std::vector<char>(
+		messageAsString.begin(),
+		messageAsString.end());
+};
+
+//----------------------------------------------------- fieldsBeforeLinkAsString
+// Implementation notes:
+//  Sequence number through hop count
+//------------------------------------------------------------------------------
+std::string dataMessage::fieldsBeforeLinkAsString() const
+{
+	return std::to_string(this->m_sequenceNumber) + constants::messageDelimiter()
 		+ this->viewMessageTypeAsString() + constants::messageDelimiter()
 		+ this->m_sourceIdentifier + constants::messageDelimiter()
 		+ this->m_destinationIdentifier + constants::messageDelimiter()
 		+ this->m_payload + constants::messageDelimiter()
-		+ std::to_string(this->m_serverSyncPayloadOriginIndex) + constants::messageDelimiter());
+		+ std::to_string(this->m_serverSyncPayloadOriginIndex) + constants::messageDelimiter()
+		+ std::to_string(this->m_hopCount) + constants::messageDelimiter();
+};
 
-	return std::vector<char>(
-		messageAsString.begin(),
-		messageAsString.end());
+//-------------------------------------------------- linkSequenceNumbersAsString
+// Implementation notes:
+//  Static, a relay is stamped with new ones on every transmission
+//------------------------------------------------------------------------------
+std::string dataMessage::linkSequenceNumbersAsString(
+	const int64_t& inLinkSequenceNumber,
+	const int64_t& inLinkWindowBase)
+{
+	return std::to_string(inLinkSequenceNumber) + constants::messageDelimiter()
+		+ std::to_string(inLinkWindowBase) + constants::messageDelimiter();
+};
+
+//------------------------------------------------------ fieldsAfterLinkAsString
+// Implementation notes:
+//  Previous sequence number, target servers, time to live and, only if the
+//  message is traced, its trace
+//------------------------------------------------------------------------------
+std::string dataMessage::fieldsAfterLinkAsString() const
+{
+	std::string outFields(
+		std::to_string(this->m_previousSequenceNumber) + constants::messageDelimiter()
+		+ this->targetServerIndicesAsString() + constants::messageDelimiter()
+		+ std::to_string(this->m_timeToLiveMilliseconds) + constants::messageDelimiter());
+
+	if(this->m_trace.isTraced())
+	{
+		outFields += this->m_trace.asString() + constants::messageDelimiter();
+	}
+
+	return outFields;
+};
+
+//-------------------------------------------------- targetServerIndicesAsString
+// Implementation notes:
+//  Same delimiter as the sync payload
+//------------------------------------------------------------------------------
+std::string dataMessage::targetServerIndicesAsString() const
+{
+	std::string outIndices("");
+
+	for(const int16_t& targetServerIndex : this->m_targetServerIndices)
+	{
+		if(!outIndices.empty())
+		{
+			outIndices += constants::syncIdentifierDelimiter();
+		}
+
+		outIndices += std::to_string(targetServerIndex);
+	}
+
+	return outIndices;
 };
\ No newline at end of file
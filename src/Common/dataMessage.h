@@ -10,6 +10,7 @@
 
 // Project
 #include "../Common/constants.h"
+#include "../Common/messageTrace.h"
 #include "../Common/remoteConnection.h"
 
 class dataMessage
@@ -55,7 +56,7 @@ public:
 	// Parameter: const std::string& inSourceID
 	// Parameter: const std::string& inDestinationID
 	// Parameter: const std::vector<std::string>& inServerSyncPayload
-	// Parameter: const int8_t& inServerSyncPayloadOriginIndex
+	// Parameter: const int16_t& inServerSyncPayloadOriginIndex
 	//--------------------------------------------------------------------------
 	dataMessage(
 		const int64_t& inSequenceNumber,
@@ -63,7 +64,7 @@ public:
 		const std::string& inSourceID,
 		const std::string& inDestinationID,
 		const std::vector<std::string>& inServerSyncPayload,
-		const int8_t& inServerSyncPayloadOriginIndex);
+		const int16_t& inServerSyncPayloadOriginIndex);
 
 	//-------------------------------------------------------------- constructor
 	// Brief Description
@@ -133,12 +134,71 @@ public:
 	//--------------------------------------------------------------------------
 	const std::string& viewSourceIdentifier() const;
 
+	//------------------------------------------------------ setSourceIdentifier
+	// Brief Description
+	//  Sets the source identifier, used by a server to put back the username
+	//  of a client that sent its session identifier instead, and by a client
+	//  to send its session identifier.
+	//
+	// Method:    setSourceIdentifier
+	// FullName:  dataMessage::setSourceIdentifier
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inSourceID
+	//--------------------------------------------------------------------------
+	void setSourceIdentifier(
+		const std::string& inSourceID);
+
+	//------------------------------------------------------------ isFromSession
+	// Brief Description
+	//  Returns whether the source identifier is a session identifier rather
+	//  than a username.
+	//
+	// Method:    isFromSession
+	// FullName:  dataMessage::isFromSession
+	// Access:    public 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isFromSession() const;
+
+	//--------------------------------------------------- parseSessionIdentifier
+	// Brief Description
+	//  Reads the session identifier the source identifier holds. Returns
+	//  false if it is not a session identifier, or not a number from 1 to
+	//  the largest 32-bit one.
+	//
+	// Method:    parseSessionIdentifier
+	// FullName:  dataMessage::parseSessionIdentifier
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: uint32_t& outSessionIdentifier
+	//--------------------------------------------------------------------------
+	bool parseSessionIdentifier(
+		uint32_t& outSessionIdentifier) const;
+
+	//---------------------------------------------------------- isValidUsername
+	// Brief Description
+	//  Returns whether a client can connect with the username. It cannot be
+	//  empty, be the broadcast identifier, start with the session or channel
+	//  prefix, or contain the characters of the message delimiter or the
+	//  list delimiters.
+	//
+	// Method:    isValidUsername
+	// FullName:  dataMessage::isValidUsername
+	// Access:    public static 
+	// Returns:   bool
+	// Parameter: const std::string& inUsername
+	//--------------------------------------------------------------------------
+	static bool isValidUsername(
+		const std::string& inUsername);
+
 	//------------------------------------------------ viewDestinationIdentifier
 	// Brief Description
 	//  Returns a const reference to the destination identifier string. This
-	//  should always represent a specific client that a private message
-	//  is intended for. It is used by the server to determine which connected
-	//  client to relay the private message to.
+	//  represents either a specific client that a private message is
+	//  intended for, several clients separated by the multicast delimiter,
+	//  or every client, as the broadcast identifier. It is used by the server
+	//  to determine which connected clients to relay the message to.
 	//
 	// Method:    viewDestinationIdentifier
 	// FullName:  dataMessage::viewDestinationIdentifier
@@ -147,6 +207,66 @@ public:
 	//--------------------------------------------------------------------------
 	const std::string& viewDestinationIdentifier() const;
 
+	//------------------------------------------------- setDestinationIdentifier
+	// Brief Description
+	//  Sets the destination identifier, used by a server to narrow a
+	//  multicast down to the clients reached through one neighbour.
+	//
+	// Method:    setDestinationIdentifier
+	// FullName:  dataMessage::setDestinationIdentifier
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::string& inDestinationID
+	//--------------------------------------------------------------------------
+	void setDestinationIdentifier(
+		const std::string& inDestinationID);
+
+	//-------------------------------------------------------------- isBroadcast
+	// Brief Description
+	//  Returns true if the message is destined for every client.
+	//
+	// Method:    isBroadcast
+	// FullName:  dataMessage::isBroadcast
+	// Access:    public 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isBroadcast() const;
+
+	//---------------------------------------------------------------- isChannel
+	// Brief Description
+	//  Returns true if the message is destined for the subscribers of a
+	//  channel.
+	//
+	// Method:    isChannel
+	// FullName:  dataMessage::isChannel
+	// Access:    public 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isChannel() const;
+
+	//-------------------------------------------------------------- isMulticast
+	// Brief Description
+	//  Returns true if the destination lists more than one client.
+	//
+	// Method:    isMulticast
+	// FullName:  dataMessage::isMulticast
+	// Access:    public 
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isMulticast() const;
+
+	//----------------------------------------------------------- viewRecipients
+	// Brief Description
+	//  Returns the clients listed in the destination, one for a private
+	//  message.
+	//
+	// Method:    viewRecipients
+	// FullName:  dataMessage::viewRecipients
+	// Access:    public 
+	// Returns:   std::vector<std::string>
+	//--------------------------------------------------------------------------
+	std::vector<std::string> viewRecipients() const;
+
 	//-------------------------------------------------------------- viewPayload
 	// Brief Description
 	//  Returns a const reference to the payload string. This should always
@@ -169,9 +289,209 @@ public:
 	// Method:    viewServerSyncPayloadOriginIndex
 	// FullName:  dataMessage::viewServerSyncPayloadOriginIndex
 	// Access:    public 
-	// Returns:   const int8_t&
+	// Returns:   const int16_t&
+	//--------------------------------------------------------------------------
+	const int16_t& viewServerSyncPayloadOriginIndex() const;
+
+	//------------------------------------------ setServerSyncPayloadOriginIndex
+	// Brief Description
+	//  Sets the origin index. For messages relayed between servers, this is
+	//  the index of the server the sending client is connected to.
+	//
+	// Method:    setServerSyncPayloadOriginIndex
+	// FullName:  dataMessage::setServerSyncPayloadOriginIndex
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int16_t& inServerSyncPayloadOriginIndex
+	//--------------------------------------------------------------------------
+	void setServerSyncPayloadOriginIndex(
+		const int16_t& inServerSyncPayloadOriginIndex);
+
+	//------------------------------------------------------------- viewHopCount
+	// Brief Description
+	//  Returns the number of times this message has been relayed from one
+	//  server to another.
+	//
+	// Method:    viewHopCount
+	// FullName:  dataMessage::viewHopCount
+	// Access:    public 
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewHopCount() const;
+
+	//-------------------------------------------------------- incrementHopCount
+	// Brief Description
+	//  Called by a server each time it relays this message to another server.
+	//
+	// Method:    incrementHopCount
+	// FullName:  dataMessage::incrementHopCount
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void incrementHopCount();
+
+	//--------------------------------------------------- viewLinkSequenceNumber
+	// Brief Description
+	//  Returns the sequence number of this message on the link between two
+	//  servers it is being relayed over, or 0 if it is not a relay.
+	//
+	// Method:    viewLinkSequenceNumber
+	// FullName:  dataMessage::viewLinkSequenceNumber
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewLinkSequenceNumber() const;
+
+	//------------------------------------------------------- viewLinkWindowBase
+	// Brief Description
+	//  Returns the lowest link sequence number the relaying server was still
+	//  waiting on an ACK for when it sent this message. Everything below it
+	//  has been acknowledged.
+	//
+	// Method:    viewLinkWindowBase
+	// FullName:  dataMessage::viewLinkWindowBase
+	// Access:    public 
+	// Returns:   const int64_t&
 	//--------------------------------------------------------------------------
-	const int8_t& viewServerSyncPayloadOriginIndex() const;
+	const int64_t& viewLinkWindowBase() const;
+
+	//--------------------------------------------------- setLinkSequenceNumbers
+	// Brief Description
+	//  Called by a server each time it sends this message over a link.
+	//
+	// Method:    setLinkSequenceNumbers
+	// FullName:  dataMessage::setLinkSequenceNumbers
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inLinkSequenceNumber
+	// Parameter: const int64_t& inLinkWindowBase
+	//--------------------------------------------------------------------------
+	void setLinkSequenceNumbers(
+		const int64_t& inLinkSequenceNumber,
+		const int64_t& inLinkWindowBase);
+
+	//----------------------------------------------- viewPreviousSequenceNumber
+	// Brief Description
+	//  Returns the sequence number of the message the sending client sent to
+	//  the same destination before this one, or 0 if there was none. The
+	//  receiving client uses it to show messages in the order they were
+	//  sent.
+	//
+	// Method:    viewPreviousSequenceNumber
+	// FullName:  dataMessage::viewPreviousSequenceNumber
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewPreviousSequenceNumber() const;
+
+	//------------------------------------------------ setPreviousSequenceNumber
+	// Brief Description
+	//  Sets the sequence number of the message sent to the same destination
+	//  before this one.
+	//
+	// Method:    setPreviousSequenceNumber
+	// FullName:  dataMessage::setPreviousSequenceNumber
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inPreviousSequenceNumber
+	//--------------------------------------------------------------------------
+	void setPreviousSequenceNumber(
+		const int64_t& inPreviousSequenceNumber);
+
+	//-------------------------------------------------- viewTargetServerIndices
+	// Brief Description
+	//  Returns the servers a relayed broadcast or channel message still has
+	//  to reach through the server receiving it. Empty for one that has not
+	//  been relayed yet, and for every other message.
+	//
+	// Method:    viewTargetServerIndices
+	// FullName:  dataMessage::viewTargetServerIndices
+	// Access:    public 
+	// Returns:   const std::vector<int16_t>&
+	//--------------------------------------------------------------------------
+	const std::vector<int16_t>& viewTargetServerIndices() const;
+
+	//--------------------------------------------------- setTargetServerIndices
+	// Brief Description
+	//  Sets the servers a relayed broadcast or channel message still has to
+	//  reach.
+	//
+	// Method:    setTargetServerIndices
+	// FullName:  dataMessage::setTargetServerIndices
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const std::vector<int16_t>& inTargetServerIndices
+	//--------------------------------------------------------------------------
+	void setTargetServerIndices(
+		const std::vector<int16_t>& inTargetServerIndices);
+
+	//----------------------------------------------- viewTimeToLiveMilliseconds
+	// Brief Description
+	//  Returns how much longer servers should keep the message before giving
+	//  up on delivering it, as of when it was sent. 0 if it was not set, in
+	//  which case the server's default applies.
+	//
+	// Method:    viewTimeToLiveMilliseconds
+	// FullName:  dataMessage::viewTimeToLiveMilliseconds
+	// Access:    public 
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& viewTimeToLiveMilliseconds() const;
+
+	//------------------------------------------------------------ setTimeToLive
+	// Brief Description
+	//  Sets how much longer servers should keep the message. A server
+	//  relaying it sets what is left of it.
+	//
+	// Method:    setTimeToLive
+	// FullName:  dataMessage::setTimeToLive
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int64_t& inTimeToLiveMilliseconds
+	//--------------------------------------------------------------------------
+	void setTimeToLive(
+		const int64_t& inTimeToLiveMilliseconds);
+
+	//---------------------------------------------------------------- viewTrace
+	// Brief Description
+	//  Returns the trace of the message, with a stamp for each stage it
+	//  went through on each server. Most messages are not traced.
+	//
+	// Method:    viewTrace
+	// FullName:  dataMessage::viewTrace
+	// Access:    public 
+	// Returns:   const messageTrace&
+	//--------------------------------------------------------------------------
+	const messageTrace& viewTrace() const;
+
+	//----------------------------------------------------------------- setTrace
+	// Brief Description
+	//  Sets the trace of the message, which starts tracing it.
+	//
+	// Method:    setTrace
+	// FullName:  dataMessage::setTrace
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const messageTrace& inTrace
+	//--------------------------------------------------------------------------
+	void setTrace(
+		const messageTrace& inTrace);
+
+	//--------------------------------------------------------------- stampTrace
+	// Brief Description
+	//  Records that the message reached a stage on the given server now, if
+	//  it is traced.
+	//
+	// Method:    stampTrace
+	// FullName:  dataMessage::stampTrace
+	// Access:    public 
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	// Parameter: const messageTrace::TraceStage& inStage
+	//--------------------------------------------------------------------------
+	void stampTrace(
+		const int16_t& inServerIndex,
+		const messageTrace::TraceStage& inStage);
 	
 	//------------------------------------------------------ stringToMessageType
 	// Brief Description
@@ -237,12 +557,72 @@ public:
 	//--------------------------------------------------------------------------
 	std::vector<char> asCharVector() const;
 
+	//------------------------------------------------- fieldsBeforeLinkAsString
+	// Brief Description
+	//  Returns the part of the encoding before the link sequence numbers,
+	//  ending with a delimiter. Together with linkSequenceNumbersAsString
+	//  and fieldsAfterLinkAsString it makes up asCharVector.
+	//
+	// Method:    fieldsBeforeLinkAsString
+	// FullName:  dataMessage::fieldsBeforeLinkAsString
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string fieldsBeforeLinkAsString() const;
+
+	//---------------------------------------------- linkSequenceNumbersAsString
+	// Brief Description
+	//  Returns the link sequence number and window base as encoded, each
+	//  followed by a delimiter.
+	//
+	// Method:    linkSequenceNumbersAsString
+	// FullName:  dataMessage::linkSequenceNumbersAsString
+	// Access:    public static 
+	// Returns:   std::string
+	// Parameter: const int64_t& inLinkSequenceNumber
+	// Parameter: const int64_t& inLinkWindowBase
+	//--------------------------------------------------------------------------
+	static std::string linkSequenceNumbersAsString(
+		const int64_t& inLinkSequenceNumber,
+		const int64_t& inLinkWindowBase);
+
+	//-------------------------------------------------- fieldsAfterLinkAsString
+	// Brief Description
+	//  Returns the part of the encoding after the link sequence numbers.
+	//
+	// Method:    fieldsAfterLinkAsString
+	// FullName:  dataMessage::fieldsAfterLinkAsString
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string fieldsAfterLinkAsString() const;
+
 private:	
+
+	//---------------------------------------------- targetServerIndicesAsString
+	// Brief Description
+	//  Returns the target server indices separated by the sync identifier
+	//  delimiter, empty if there are none.
+	//
+	// Method:    targetServerIndicesAsString
+	// FullName:  dataMessage::targetServerIndicesAsString
+	// Access:    private 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string targetServerIndicesAsString() const;
+
 	// Member Variables
 	int64_t m_sequenceNumber;
 	constants::MessageType m_messageType;
 	std::string m_sourceIdentifier;
 	std::string m_destinationIdentifier;
 	std::string m_payload;
-	int8_t m_serverSyncPayloadOriginIndex;
+	int16_t m_serverSyncPayloadOriginIndex;
+	uint16_t m_hopCount;
+	int64_t m_linkSequenceNumber;
+	int64_t m_linkWindowBase;
+	int64_t m_previousSequenceNumber;
+	std::vector<int16_t> m_targetServerIndices;
+	int64_t m_timeToLiveMilliseconds;
+	messageTrace m_trace;
 };
\ No newline at end of file
@@ -0,0 +1,287 @@
+// STL
+#include <algorithm>
+#include <stdexcept>
+
+// Project
+#include "datagramCapture.h"
+
+namespace
+{
+	// identifies capture files, and the version of their format
+	const std::string captureTag("CPSC3780 capture 1\n");
+
+	//--------------------------------------------------------------- readNumber
+	// Implementation notes:
+	//  The inverse of datagramCapture::writeNumber. False at the end of the
+	//  file, or if it ends within the number.
+	//--------------------------------------------------------------------------
+	bool readNumber(
+		std::istream& inFile,
+		uint64_t& outNumber)
+	{
+		outNumber = 0;
+
+		for(uint16_t shift = 0; shift < 64; shift += 7)
+		{
+			const int byte = inFile.get();
+
+			if(byte == std::char_traits<char>::eof())
+			{
+				return false;
+			}
+
+			outNumber |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+			if((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	//---------------------------------------------------------------- readBytes
+	// Implementation notes:
+	//  A length is read first, so a corrupt one is checked against what is
+	//  left rather than allocated
+	//--------------------------------------------------------------------------
+	bool readBytes(
+		std::istream& inFile,
+		const uint64_t& inBytesLeft,
+		std::vector<char>& outBytes)
+	{
+		uint64_t length = 0;
+
+		if(!readNumber(inFile, length) || length > inBytesLeft)
+		{
+			return false;
+		}
+
+		outBytes.resize(static_cast<size_t>(length));
+
+		return length == 0 || inFile.read(outBytes.data(), outBytes.size()).good();
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The tag and name are written straight away, so an empty capture is
+//  still a valid file
+//------------------------------------------------------------------------------
+datagramCapture::datagramCapture(
+	const std::string& inPath,
+	const std::string& inServerName) :
+	m_file(inPath.c_str(), std::ios::binary | std::ios::trunc),
+	m_microsecondsOfLastDatagram(0),
+	m_hasDatagrams(false)
+{
+	if(!this->m_file.is_open())
+	{
+		throw std::runtime_error(
+			"unable to create capture file " + inPath);
+	}
+
+	this->m_buffer.insert(
+		this->m_buffer.end(),
+		captureTag.begin(),
+		captureTag.end());
+
+	this->writeNumber(
+		inServerName.size());
+
+	this->m_buffer.insert(
+		this->m_buffer.end(),
+		inServerName.begin(),
+		inServerName.end());
+
+	this->flush();
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The file is closed by its own destructor
+//------------------------------------------------------------------------------
+datagramCapture::~datagramCapture()
+{
+	this->flush();
+};
+
+//----------------------------------------------------------------------- record
+// Implementation notes:
+//  Times are stored as the difference from the previous datagram, mostly
+//  one or two bytes under load
+//------------------------------------------------------------------------------
+void datagramCapture::record(
+	const captureClock::time_point& inReceivedAt,
+	const boost::asio::ip::udp::endpoint& inSource,
+	const std::vector<char>& inPayload)
+{
+	if(!this->m_hasDatagrams)
+	{
+		this->m_timeOfFirstDatagram = inReceivedAt;
+		this->m_hasDatagrams = true;
+	}
+
+	const int64_t microseconds = std::max<int64_t>(
+		boost::chrono::duration_cast<boost::chrono::microseconds>(
+			inReceivedAt - this->m_timeOfFirstDatagram).count(),
+		this->m_microsecondsOfLastDatagram);
+
+	this->writeNumber(
+		microseconds - this->m_microsecondsOfLastDatagram);
+
+	this->m_microsecondsOfLastDatagram = microseconds;
+
+	if(inSource.address().is_v4())
+	{
+		const boost::asio::ip::address_v4::bytes_type address =
+			inSource.address().to_v4().to_bytes();
+
+		this->writeNumber(address.size());
+		this->m_buffer.insert(this->m_buffer.end(), address.begin(), address.end());
+	}
+	else
+	{
+		const boost::asio::ip::address_v6::bytes_type address =
+			inSource.address().to_v6().to_bytes();
+
+		this->writeNumber(address.size());
+		this->m_buffer.insert(this->m_buffer.end(), address.begin(), address.end());
+	}
+
+	this->writeNumber(
+		inSource.port());
+
+	this->writeNumber(
+		inPayload.size());
+
+	this->m_buffer.insert(
+		this->m_buffer.end(),
+		inPayload.begin(),
+		inPayload.end());
+};
+
+//------------------------------------------------------------------------ flush
+// Implementation notes:
+//  The file is flushed too, so a capture can be copied while it is taken
+//------------------------------------------------------------------------------
+void datagramCapture::flush()
+{
+	if(this->m_buffer.empty())
+	{
+		return;
+	}
+
+	this->m_file.write(
+		this->m_buffer.data(),
+		this->m_buffer.size());
+
+	this->m_file.flush();
+
+	this->m_buffer.clear();
+};
+
+//------------------------------------------------------------------------- read
+// Implementation notes:
+//  The whole capture is read up front, so replaying it does not wait on
+//  the disk
+//------------------------------------------------------------------------------
+datagramCapture::recording datagramCapture::read(
+	const std::string& inPath)
+{
+	std::ifstream file(
+		inPath.c_str(),
+		std::ios::binary);
+
+	std::string tag(captureTag.size(), '\0');
+
+	if(!file.read(&tag[0], tag.size()) || tag != captureTag)
+	{
+		throw std::runtime_error(
+			inPath + " is not a capture file");
+	}
+
+	file.seekg(0, std::ios::end);
+	const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(captureTag.size(), std::ios::beg);
+
+	recording outRecording;
+	std::vector<char> bytes;
+
+	if(!readBytes(file, fileSize, bytes))
+	{
+		throw std::runtime_error(
+			inPath + " has no server name");
+	}
+
+	outRecording.m_serverName.assign(
+		bytes.begin(),
+		bytes.end());
+
+	int64_t microseconds = 0;
+	uint64_t number = 0;
+
+	while(readNumber(file, number))
+	{
+		microseconds += static_cast<int64_t>(number);
+
+		boost::asio::ip::address address;
+
+		if(!readBytes(file, fileSize, bytes))
+		{
+			break;
+		}
+
+		if(bytes.size() == sizeof(boost::asio::ip::address_v4::bytes_type))
+		{
+			boost::asio::ip::address_v4::bytes_type addressBytes;
+			std::copy(bytes.begin(), bytes.end(), addressBytes.begin());
+			address = boost::asio::ip::address_v4(addressBytes);
+		}
+		else if(bytes.size() == sizeof(boost::asio::ip::address_v6::bytes_type))
+		{
+			boost::asio::ip::address_v6::bytes_type addressBytes;
+			std::copy(bytes.begin(), bytes.end(), addressBytes.begin());
+			address = boost::asio::ip::address_v6(addressBytes);
+		}
+		else
+		{
+			break;
+		}
+
+		uint64_t port = 0;
+
+		if(!readNumber(file, port)
+			|| !readBytes(file, fileSize, bytes))
+		{
+			break;
+		}
+
+		outRecording.m_datagrams.push_back(capturedDatagram(
+			microseconds,
+			boost::asio::ip::udp::endpoint(address, static_cast<uint16_t>(port)),
+			bytes));
+	}
+
+	return outRecording;
+};
+
+//------------------------------------------------------------------ writeNumber
+// Implementation notes:
+//  Little endian groups of 7 bits
+//------------------------------------------------------------------------------
+void datagramCapture::writeNumber(
+	uint64_t inNumber)
+{
+	while(inNumber >= 0x80)
+	{
+		this->m_buffer.push_back(
+			static_cast<char>((inNumber & 0x7f) | 0x80));
+
+		inNumber >>= 7;
+	}
+
+	this->m_buffer.push_back(
+		static_cast<char>(inNumber));
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+// STL
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+
+// Records the datagrams a server receives to a capture file, and reads them
+// back for replay. The file starts with a tag and the name of the server,
+// then has one record per datagram: the microseconds since the previous
+// one, the source address and port, and the datagram, with every number
+// written as a variable length integer.
+class datagramCapture
+{
+public:
+
+	typedef boost::chrono::steady_clock captureClock;
+
+	class capturedDatagram
+	{
+	public:
+		capturedDatagram(
+			const int64_t& inMicroseconds,
+			const boost::asio::ip::udp::endpoint& inSource,
+			const std::vector<char>& inPayload) :
+			m_microseconds(inMicroseconds),
+			m_source(inSource),
+			m_payload(inPayload)
+		{
+		};
+
+		// since the first datagram of the capture
+		int64_t m_microseconds;
+		boost::asio::ip::udp::endpoint m_source;
+		std::vector<char> m_payload;
+	};
+
+	class recording
+	{
+	public:
+		std::string m_serverName;
+		std::vector<capturedDatagram> m_datagrams;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that starts a new capture file for the named server,
+	//  replacing any file at the path. Throws a std::runtime_error if the
+	//  file cannot be created.
+	//
+	// Method:    datagramCapture
+	// FullName:  datagramCapture::datagramCapture
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inPath
+	// Parameter: const std::string& inServerName
+	//--------------------------------------------------------------------------
+	datagramCapture(
+		const std::string& inPath,
+		const std::string& inServerName);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Writes the records still buffered.
+	//
+	// Method:    ~datagramCapture
+	// FullName:  datagramCapture::~datagramCapture
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~datagramCapture();
+
+	//------------------------------------------------------------------- record
+	// Brief Description
+	//  Appends a datagram received at the given time from the source. The
+	//  record is buffered until the next flush().
+	//
+	// Method:    record
+	// FullName:  datagramCapture::record
+	// Access:    public
+	// Returns:   void
+	// Parameter: const captureClock::time_point& inReceivedAt
+	// Parameter: const boost::asio::ip::udp::endpoint& inSource
+	// Parameter: const std::vector<char>& inPayload
+	//--------------------------------------------------------------------------
+	void record(
+		const captureClock::time_point& inReceivedAt,
+		const boost::asio::ip::udp::endpoint& inSource,
+		const std::vector<char>& inPayload);
+
+	//-------------------------------------------------------------------- flush
+	// Brief Description
+	//  Writes the buffered records to the file.
+	//
+	// Method:    flush
+	// FullName:  datagramCapture::flush
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flush();
+
+	//--------------------------------------------------------------------- read
+	// Brief Description
+	//  Returns the server name and every datagram of a capture file. A
+	//  record cut short, as by a server that was killed, ends the capture.
+	//  Throws a std::runtime_error if the file is not a capture.
+	//
+	// Method:    read
+	// FullName:  datagramCapture::read
+	// Access:    public
+	// Returns:   datagramCapture::recording
+	// Parameter: const std::string& inPath
+	//--------------------------------------------------------------------------
+	static recording read(
+		const std::string& inPath);
+
+private:
+
+	//-------------------------------------------------------------- writeNumber
+	// Brief Description
+	//  Appends a number to the buffer, 7 bits per byte with the high bit set
+	//  on every byte but the last.
+	//
+	// Method:    writeNumber
+	// FullName:  datagramCapture::writeNumber
+	// Access:    private
+	// Returns:   void
+	// Parameter: uint64_t inNumber
+	//--------------------------------------------------------------------------
+	void writeNumber(
+		uint64_t inNumber);
+
+	// Member Variables
+	std::ofstream m_file;
+	std::vector<char> m_buffer;
+	captureClock::time_point m_timeOfFirstDatagram;
+	int64_t m_microsecondsOfLastDatagram;
+	bool m_hasDatagrams;
+};
\ No newline at end of file
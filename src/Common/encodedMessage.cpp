@@ -0,0 +1,54 @@
+// Project
+#include "encodedMessage.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The encoding is kept in three parts around the link sequence numbers,
+//  which a relay needs stamped anew on each transmission
+//------------------------------------------------------------------------------
+encodedMessage::encodedMessage(
+	const dataMessage& inMessage) :
+	m_message(inMessage),
+	m_fieldsBeforeLink(inMessage.fieldsBeforeLinkAsString()),
+	m_linkSequenceNumbers(dataMessage::linkSequenceNumbersAsString(
+		inMessage.viewLinkSequenceNumber(),
+		inMessage.viewLinkWindowBase())),
+	m_fieldsAfterLink(inMessage.fieldsAfterLinkAsString())
+{
+};
+
+//------------------------------------------------------------------ viewMessage
+// Implementation notes:
+//  Returns a const reference to the message
+//------------------------------------------------------------------------------
+const dataMessage& encodedMessage::viewMessage() const
+{
+	return this->m_message;
+};
+
+//------------------------------------------------------------------ viewBuffers
+// Implementation notes:
+//  The same bytes as asCharVector, without copying them into one vector
+//------------------------------------------------------------------------------
+boost::array<boost::asio::const_buffer, 3> encodedMessage::viewBuffers() const
+{
+	return this->viewBuffersForRelay(
+		this->m_linkSequenceNumbers);
+};
+
+//---------------------------------------------------------- viewBuffersForRelay
+// Implementation notes:
+//  send_to() gathers the buffers into a single datagram
+//------------------------------------------------------------------------------
+boost::array<boost::asio::const_buffer, 3> encodedMessage::viewBuffersForRelay(
+	const std::string& inLinkSequenceNumbers) const
+{
+	boost::array<boost::asio::const_buffer, 3> outBuffers =
+	{{
+		boost::asio::buffer(this->m_fieldsBeforeLink),
+		boost::asio::buffer(inLinkSequenceNumbers),
+		boost::asio::buffer(this->m_fieldsAfterLink)
+	}};
+
+	return outBuffers;
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+// STL
+#include <string>
+
+// Boost
+#include <boost/array.hpp>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Project
+#include "dataMessage.h"
+
+class encodedMessage
+{
+public:
+
+	typedef boost::shared_ptr<const encodedMessage> pointer;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an immutable message and its encoding, made once so
+	//  that the message lists, the links between servers and every recipient
+	//  of a fan-out can share one copy through a pointer, and send it again
+	//  without encoding it again.
+	//
+	// Method:    encodedMessage
+	// FullName:  encodedMessage::encodedMessage
+	// Access:    public
+	// Returns:
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	encodedMessage(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- viewMessage
+	// Brief Description
+	//  Returns a const reference to the message.
+	//
+	// Method:    viewMessage
+	// FullName:  encodedMessage::viewMessage
+	// Access:    public
+	// Returns:   const dataMessage&
+	//--------------------------------------------------------------------------
+	const dataMessage& viewMessage() const;
+
+	//-------------------------------------------------------------- viewBuffers
+	// Brief Description
+	//  Returns buffers over the encoding, to be sent as one datagram.
+	//
+	// Method:    viewBuffers
+	// FullName:  encodedMessage::viewBuffers
+	// Access:    public
+	// Returns:   boost::array<boost::asio::const_buffer, 3>
+	//--------------------------------------------------------------------------
+	boost::array<boost::asio::const_buffer, 3> viewBuffers() const;
+
+	//------------------------------------------------------ viewBuffersForRelay
+	// Brief Description
+	//  Returns buffers over the encoding with the link sequence numbers
+	//  replaced by the ones given, encoded by linkSequenceNumbersAsString.
+	//  The string must outlive the send.
+	//
+	// Method:    viewBuffersForRelay
+	// FullName:  encodedMessage::viewBuffersForRelay
+	// Access:    public
+	// Returns:   boost::array<boost::asio::const_buffer, 3>
+	// Parameter: const std::string& inLinkSequenceNumbers
+	//--------------------------------------------------------------------------
+	boost::array<boost::asio::const_buffer, 3> viewBuffersForRelay(
+		const std::string& inLinkSequenceNumbers) const;
+
+private:
+
+	// Member Variables
+	dataMessage m_message;
+	std::string m_fieldsBeforeLink;
+	std::string m_linkSequenceNumbers;
+	std::string m_fieldsAfterLink;
+};
\ No newline at end of file
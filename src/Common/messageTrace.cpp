@@ -0,0 +1,198 @@
+// STL
+#include <sstream>
+#include <stdexcept>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "messageTrace.h"
+
+namespace
+{
+	// the stamps are separated from the identifier and each other by the
+	// first, and their fields by the second. Neither occurs in the message
+	// delimiter or the sync payload delimiters.
+	const char stampDelimiter = ';';
+	const char fieldDelimiter = '.';
+
+	// one letter per stage on the wire, in the order of the enum
+	const std::string stageLetters("rhqfda");
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  An identifier of 0 means the message is not traced
+//------------------------------------------------------------------------------
+messageTrace::messageTrace() :
+	m_identifier(0)
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Nothing else to set
+//------------------------------------------------------------------------------
+messageTrace::messageTrace(
+	const uint64_t& inIdentifier) :
+	m_identifier(inIdentifier)
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  std::stoll and std::stoull throw on fields that are not numbers
+//------------------------------------------------------------------------------
+messageTrace::messageTrace(
+	const std::string& inTraceAsString) :
+	m_identifier(0)
+{
+	std::stringstream ss(inTraceAsString);
+	std::string field("");
+
+	if(!std::getline(ss, field, stampDelimiter))
+	{
+		throw std::runtime_error("empty trace");
+	}
+
+	this->m_identifier = std::stoull(field);
+
+	while(std::getline(ss, field, stampDelimiter))
+	{
+		const size_t firstDelimiter = field.find(fieldDelimiter);
+		const size_t secondDelimiter = field.find(fieldDelimiter, firstDelimiter + 1);
+
+		if(firstDelimiter == std::string::npos
+			|| secondDelimiter != firstDelimiter + 2
+			|| stageLetters.find(field[firstDelimiter + 1]) == std::string::npos)
+		{
+			throw std::runtime_error("malformed trace stamp '" + field + "'");
+		}
+
+		this->m_stamps.push_back(traceStamp(
+			static_cast<int16_t>(std::stoi(field.substr(0, firstDelimiter))),
+			static_cast<TraceStage>(stageLetters.find(field[firstDelimiter + 1])),
+			std::stoll(field.substr(secondDelimiter + 1))));
+	}
+};
+
+//--------------------------------------------------------------------- isTraced
+// Implementation notes:
+//  Traced messages always have an identifier
+//------------------------------------------------------------------------------
+bool messageTrace::isTraced() const
+{
+	return this->m_identifier != 0;
+};
+
+//--------------------------------------------------------------- viewIdentifier
+// Implementation notes:
+//  Returns a const reference to the identifier
+//------------------------------------------------------------------------------
+const uint64_t& messageTrace::viewIdentifier() const
+{
+	return this->m_identifier;
+};
+
+//------------------------------------------------------------------- viewStamps
+// Implementation notes:
+//  Returns a const reference to the stamps
+//------------------------------------------------------------------------------
+const std::vector<messageTrace::traceStamp>& messageTrace::viewStamps() const
+{
+	return this->m_stamps;
+};
+
+//------------------------------------------------------------------------ stamp
+// Implementation notes:
+//  Untraced messages are the common case, they cost one comparison
+//------------------------------------------------------------------------------
+void messageTrace::stamp(
+	const int16_t& inServerIndex,
+	const TraceStage& inStage,
+	const int64_t& inMicroseconds)
+{
+	if(!this->isTraced())
+	{
+		return;
+	}
+
+	this->m_stamps.push_back(traceStamp(
+		inServerIndex,
+		inStage,
+		inMicroseconds));
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  e.g. "42;0.r.1700000000000000;0.f.1700000000000050"
+//------------------------------------------------------------------------------
+std::string messageTrace::asString() const
+{
+	if(!this->isTraced())
+	{
+		return "";
+	}
+
+	std::string outTrace(std::to_string(this->m_identifier));
+
+	for(const traceStamp& stamp : this->m_stamps)
+	{
+		outTrace += stampDelimiter;
+		outTrace += std::to_string(stamp.m_serverIndex);
+		outTrace += fieldDelimiter;
+		outTrace += stageLetters[stamp.m_stage];
+		outTrace += fieldDelimiter;
+		outTrace += std::to_string(stamp.m_microseconds);
+	}
+
+	return outTrace;
+};
+
+//-------------------------------------------------------------- nowMicroseconds
+// Implementation notes:
+//  The system clock, unlike the steady clock, is comparable across processes
+//------------------------------------------------------------------------------
+int64_t messageTrace::nowMicroseconds()
+{
+	return boost::chrono::duration_cast<boost::chrono::microseconds>(
+		boost::chrono::system_clock::now().time_since_epoch()).count();
+};
+
+//---------------------------------------------------------------- stageAsString
+// Implementation notes:
+//  Past tense, a stamp is when the stage was reached
+//------------------------------------------------------------------------------
+std::string messageTrace::stageAsString(
+	const TraceStage& inStage)
+{
+	switch(inStage)
+	{
+		case ts_RECEIVE:
+		{
+			return "received";
+		}
+		case ts_HELD:
+		{
+			return "held";
+		}
+		case ts_QUEUE:
+		{
+			return "queued";
+		}
+		case ts_FORWARD:
+		{
+			return "forwarded";
+		}
+		case ts_DELIVER:
+		{
+			return "delivered";
+		}
+		case ts_ACKNOWLEDGE:
+		{
+			return "acknowledged";
+		}
+	}
+
+	return "";
+};
\ No newline at end of file
@@ -0,0 +1,173 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class messageTrace
+{
+public:
+
+	enum TraceStage
+	{
+		ts_RECEIVE,
+		ts_HELD,
+		ts_QUEUE,
+		ts_FORWARD,
+		ts_DELIVER,
+		ts_ACKNOWLEDGE
+	};
+
+	class traceStamp
+	{
+	public:
+		traceStamp(
+			const int16_t& inServerIndex,
+			const TraceStage& inStage,
+			const int64_t& inMicroseconds) :
+			m_serverIndex(inServerIndex),
+			m_stage(inStage),
+			m_microseconds(inMicroseconds)
+		{
+		};
+
+		int16_t m_serverIndex;
+		TraceStage m_stage;
+		int64_t m_microseconds;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a message that is not traced.
+	//
+	// Method:    messageTrace
+	// FullName:  messageTrace::messageTrace
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	messageTrace();
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a trace with the given identifier and no stamps yet.
+	//
+	// Method:    messageTrace
+	// FullName:  messageTrace::messageTrace
+	// Access:    public
+	// Returns:
+	// Parameter: const uint64_t& inIdentifier
+	//--------------------------------------------------------------------------
+	explicit messageTrace(
+		const uint64_t& inIdentifier);
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that reads a trace back from asString(). Throws a
+	//  std::exception if it is malformed.
+	//
+	// Method:    messageTrace
+	// FullName:  messageTrace::messageTrace
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inTraceAsString
+	//--------------------------------------------------------------------------
+	explicit messageTrace(
+		const std::string& inTraceAsString);
+
+	//----------------------------------------------------------------- isTraced
+	// Brief Description
+	//  Returns true if the message is traced, that is has an identifier.
+	//
+	// Method:    isTraced
+	// FullName:  messageTrace::isTraced
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool isTraced() const;
+
+	//----------------------------------------------------------- viewIdentifier
+	// Brief Description
+	//  Returns the identifier given by the server that started the trace, 0
+	//  if the message is not traced.
+	//
+	// Method:    viewIdentifier
+	// FullName:  messageTrace::viewIdentifier
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewIdentifier() const;
+
+	//--------------------------------------------------------------- viewStamps
+	// Brief Description
+	//  Returns the stamps in the order they were added.
+	//
+	// Method:    viewStamps
+	// FullName:  messageTrace::viewStamps
+	// Access:    public
+	// Returns:   const std::vector<messageTrace::traceStamp>&
+	//--------------------------------------------------------------------------
+	const std::vector<traceStamp>& viewStamps() const;
+
+	//-------------------------------------------------------------------- stamp
+	// Brief Description
+	//  Records that the message reached a stage on the given server at the
+	//  given time, by default now. Does nothing if it is not traced.
+	//
+	// Method:    stamp
+	// FullName:  messageTrace::stamp
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	// Parameter: const TraceStage& inStage
+	// Parameter: const int64_t& inMicroseconds
+	//--------------------------------------------------------------------------
+	void stamp(
+		const int16_t& inServerIndex,
+		const TraceStage& inStage,
+		const int64_t& inMicroseconds = messageTrace::nowMicroseconds());
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns the identifier then each stamp as server index, stage letter
+	//  and time, separated by the trace delimiters. Empty if the message is
+	//  not traced.
+	//
+	// Method:    asString
+	// FullName:  messageTrace::asString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asString() const;
+
+	//---------------------------------------------------------- nowMicroseconds
+	// Brief Description
+	//  Returns the wall clock in microseconds since the epoch. Stamps from
+	//  different computers are only comparable as far as their clocks agree.
+	//
+	// Method:    nowMicroseconds
+	// FullName:  messageTrace::nowMicroseconds
+	// Access:    public
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	static int64_t nowMicroseconds();
+
+	//------------------------------------------------------------ stageAsString
+	// Brief Description
+	//  Returns the name of a stage, as reports print it.
+	//
+	// Method:    stageAsString
+	// FullName:  messageTrace::stageAsString
+	// Access:    public
+	// Returns:   std::string
+	// Parameter: const TraceStage& inStage
+	//--------------------------------------------------------------------------
+	static std::string stageAsString(
+		const TraceStage& inStage);
+
+private:
+
+	// Member Variables
+	uint64_t m_identifier;
+	std::vector<traceStamp> m_stamps;
+};
\ No newline at end of file
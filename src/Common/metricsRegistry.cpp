@@ -0,0 +1,340 @@
+// STL
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// Project
+#include "metricsRegistry.h"
+
+namespace
+{
+	// values below this many are counted exactly, above it each power of
+	// two is split in half this many buckets
+	const uint64_t exactValues = 64;
+	const uint64_t subBucketsPerPowerOfTwo = 32;
+	const uint16_t exactBits = 6;
+
+	// large enough for a day in microseconds
+	const uint16_t highestPowerOfTwo = 47;
+
+	const size_t bucketCount =
+		exactValues + (highestPowerOfTwo - exactBits + 1) * subBucketsPerPowerOfTwo;
+
+	//------------------------------------------------------------- highestBitOf
+	// Implementation notes:
+	//  Binary search, the value is not 0
+	//--------------------------------------------------------------------------
+	uint16_t highestBitOf(
+		uint64_t inValue)
+	{
+		uint16_t bit = 0;
+
+		for(uint16_t shift = 32; shift > 0; shift /= 2)
+		{
+			if(inValue >> shift)
+			{
+				inValue >>= shift;
+				bit += shift;
+			}
+		}
+
+		return bit;
+	};
+
+	//------------------------------------------------------------ bucketOfValue
+	// Implementation notes:
+	//  Above the exact values, a value's highest bit picks its power of two
+	//  and the next five bits its bucket within it
+	//--------------------------------------------------------------------------
+	size_t bucketOfValue(
+		const uint64_t& inValue)
+	{
+		if(inValue < exactValues)
+		{
+			return static_cast<size_t>(inValue);
+		}
+
+		const uint16_t highestBit = std::min(
+			highestBitOf(inValue),
+			highestPowerOfTwo);
+
+		const uint16_t shift = highestBit - (exactBits - 1);
+
+		const uint64_t subBucket = std::min(
+			(inValue >> shift) - subBucketsPerPowerOfTwo,
+			subBucketsPerPowerOfTwo - 1);
+
+		return static_cast<size_t>(
+			exactValues
+			+ (highestBit - exactBits) * subBucketsPerPowerOfTwo
+			+ subBucket);
+	};
+
+	//----------------------------------------------------- highestValueOfBucket
+	// Implementation notes:
+	//  The inverse of bucketOfValue
+	//--------------------------------------------------------------------------
+	uint64_t highestValueOfBucket(
+		const size_t& inBucket)
+	{
+		if(inBucket < exactValues)
+		{
+			return inBucket;
+		}
+
+		const uint16_t highestBit = static_cast<uint16_t>(
+			exactBits + (inBucket - exactValues) / subBucketsPerPowerOfTwo);
+
+		const uint16_t shift = highestBit - (exactBits - 1);
+
+		const uint64_t subBucket =
+			(inBucket - exactValues) % subBucketsPerPowerOfTwo;
+
+		return ((subBucketsPerPowerOfTwo + subBucket + 1) << shift) - 1;
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Every bucket is allocated up front, recording never allocates
+//------------------------------------------------------------------------------
+metricsRegistry::latencyHistogram::latencyHistogram() :
+	m_buckets(bucketCount),
+	m_count(0),
+	m_sum(0),
+	m_maximum(0)
+{
+	for(std::atomic<uint64_t>& bucket : this->m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+};
+
+//----------------------------------------------------------------------- record
+// Implementation notes:
+//  The maximum is raised with a compare and swap, which only loops while
+//  another thread raises it at the same time
+//------------------------------------------------------------------------------
+void metricsRegistry::latencyHistogram::record(
+	const uint64_t& inValue)
+{
+	this->m_buckets[bucketOfValue(inValue)].fetch_add(1, std::memory_order_relaxed);
+	this->m_count.fetch_add(1, std::memory_order_relaxed);
+	this->m_sum.fetch_add(inValue, std::memory_order_relaxed);
+
+	uint64_t maximum = this->m_maximum.load(std::memory_order_relaxed);
+
+	while(inValue > maximum
+		&& !this->m_maximum.compare_exchange_weak(maximum, inValue, std::memory_order_relaxed))
+	{
+	}
+};
+
+//-------------------------------------------------------------------- viewCount
+// Implementation notes:
+//  Returns the number of values recorded
+//------------------------------------------------------------------------------
+uint64_t metricsRegistry::latencyHistogram::viewCount() const
+{
+	return this->m_count.load(std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------------- viewPercentile
+// Implementation notes:
+//  Counts taken while other threads record may be off by the values
+//  recorded meanwhile, which does not matter for monitoring. The bucket
+//  bound is capped at the maximum, so the 100th percentile is exact.
+//------------------------------------------------------------------------------
+uint64_t metricsRegistry::latencyHistogram::viewPercentile(
+	const double& inPercentile) const
+{
+	const uint64_t count = this->viewCount();
+
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	uint64_t rank = static_cast<uint64_t>(inPercentile / 100.0 * count + 0.5);
+
+	rank = std::max<uint64_t>(rank, 1);
+
+	uint64_t seen = 0;
+
+	for(size_t bucket = 0; bucket < this->m_buckets.size(); bucket++)
+	{
+		seen += this->m_buckets[bucket].load(std::memory_order_relaxed);
+
+		if(seen >= rank)
+		{
+			return std::min(
+				highestValueOfBucket(bucket),
+				this->viewMaximum());
+		}
+	}
+
+	return this->viewMaximum();
+};
+
+//------------------------------------------------------------------ viewMaximum
+// Implementation notes:
+//  Returns the largest value recorded
+//------------------------------------------------------------------------------
+uint64_t metricsRegistry::latencyHistogram::viewMaximum() const
+{
+	return this->m_maximum.load(std::memory_order_relaxed);
+};
+
+//--------------------------------------------------------------------- viewMean
+// Implementation notes:
+//  0 when nothing was recorded
+//------------------------------------------------------------------------------
+double metricsRegistry::latencyHistogram::viewMean() const
+{
+	const uint64_t count = this->viewCount();
+
+	if(count == 0)
+	{
+		return 0.0;
+	}
+
+	return static_cast<double>(this->m_sum.load(std::memory_order_relaxed)) / count;
+};
+
+//------------------------------------------------------------------- addCounter
+// Implementation notes:
+//  The metric is allocated on its own, so growing the map never moves it
+//------------------------------------------------------------------------------
+metricsRegistry::counter& metricsRegistry::addCounter(
+	const std::string& inName)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	boost::shared_ptr<counter>& metric = this->m_counters[inName];
+
+	if(!metric)
+	{
+		metric.reset(new counter());
+	}
+
+	return *metric;
+};
+
+//--------------------------------------------------------------------- addGauge
+// Implementation notes:
+//  Same as addCounter
+//------------------------------------------------------------------------------
+metricsRegistry::gauge& metricsRegistry::addGauge(
+	const std::string& inName)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	boost::shared_ptr<gauge>& metric = this->m_gauges[inName];
+
+	if(!metric)
+	{
+		metric.reset(new gauge());
+	}
+
+	return *metric;
+};
+
+//----------------------------------------------------------------- addHistogram
+// Implementation notes:
+//  Same as addCounter
+//------------------------------------------------------------------------------
+metricsRegistry::latencyHistogram& metricsRegistry::addHistogram(
+	const std::string& inName)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	boost::shared_ptr<latencyHistogram>& metric = this->m_histograms[inName];
+
+	if(!metric)
+	{
+		metric.reset(new latencyHistogram());
+	}
+
+	return *metric;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  Counters, gauges and histograms are listed in turn, each sorted by name
+//------------------------------------------------------------------------------
+std::string metricsRegistry::asString(
+	const std::string& inPrefix) const
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	std::stringstream ss;
+
+	for(const auto& metric : this->m_counters)
+	{
+		if(metric.first.compare(0, inPrefix.size(), inPrefix) == 0)
+		{
+			ss << metric.first << " " << metric.second->view() << "\n";
+		}
+	}
+
+	for(const auto& metric : this->m_gauges)
+	{
+		if(metric.first.compare(0, inPrefix.size(), inPrefix) == 0)
+		{
+			ss << metric.first << " " << metric.second->view() << "\n";
+		}
+	}
+
+	for(const auto& metric : this->m_histograms)
+	{
+		if(metric.first.compare(0, inPrefix.size(), inPrefix) == 0)
+		{
+			const latencyHistogram& histogram = *metric.second;
+
+			ss << metric.first
+				<< " count " << histogram.viewCount()
+				<< ", mean " << static_cast<uint64_t>(histogram.viewMean())
+				<< ", p50 " << histogram.viewPercentile(50.0)
+				<< ", p99 " << histogram.viewPercentile(99.0)
+				<< ", p99.9 " << histogram.viewPercentile(99.9)
+				<< ", max " << histogram.viewMaximum() << "\n";
+		}
+	}
+
+	return ss.str();
+};
+
+//------------------------------------------------------------------ writeToFile
+// Implementation notes:
+//  Written next to the file and renamed over it, a rename replaces the
+//  file in one step. Where rename does not replace files, the old file is
+//  removed first.
+//------------------------------------------------------------------------------
+bool metricsRegistry::writeToFile(
+	const std::string& inPath) const
+{
+	const std::string temporaryPath(inPath + ".tmp");
+
+	{
+		std::ofstream file(
+			temporaryPath.c_str(),
+			std::ios::trunc);
+
+		file << this->asString();
+
+		if(!file.good())
+		{
+			return false;
+		}
+	}
+
+	if(std::rename(temporaryPath.c_str(), inPath.c_str()) == 0)
+	{
+		return true;
+	}
+
+	std::remove(inPath.c_str());
+
+	return std::rename(temporaryPath.c_str(), inPath.c_str()) == 0;
+};
\ No newline at end of file
@@ -0,0 +1,172 @@
+#pragma once
+
+// STL
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+class metricsRegistry
+{
+public:
+
+	class counter
+	{
+	public:
+		counter() :
+			m_value(0)
+		{
+		};
+
+		void add(
+			const uint64_t& inAmount = 1)
+		{
+			this->m_value.fetch_add(inAmount, std::memory_order_relaxed);
+		};
+
+		uint64_t view() const
+		{
+			return this->m_value.load(std::memory_order_relaxed);
+		};
+
+		std::atomic<uint64_t> m_value;
+	};
+
+	class gauge
+	{
+	public:
+		gauge() :
+			m_value(0)
+		{
+		};
+
+		void set(
+			const int64_t& inValue)
+		{
+			this->m_value.store(inValue, std::memory_order_relaxed);
+		};
+
+		int64_t view() const
+		{
+			return this->m_value.load(std::memory_order_relaxed);
+		};
+
+		std::atomic<int64_t> m_value;
+	};
+
+	// Values are counted in buckets that are exact below 64 and at most 1/32
+	// of their value wide above, like an HDR histogram, so percentiles are
+	// within about 3% at any magnitude. Any number of threads may record.
+	class latencyHistogram
+	{
+	public:
+		latencyHistogram();
+
+		void record(
+			const uint64_t& inValue);
+
+		uint64_t viewCount() const;
+
+		// the highest value counted in the bucket the percentile falls in
+		uint64_t viewPercentile(
+			const double& inPercentile) const;
+
+		uint64_t viewMaximum() const;
+
+		double viewMean() const;
+
+		std::vector<std::atomic<uint64_t>> m_buckets;
+		std::atomic<uint64_t> m_count;
+		std::atomic<uint64_t> m_sum;
+		std::atomic<uint64_t> m_maximum;
+	};
+
+	//--------------------------------------------------------------- addCounter
+	// Brief Description
+	//  Returns the counter with the given name, registering it at 0 the
+	//  first time. The reference stays valid as long as the registry, so
+	//  hot paths look their metrics up once and keep them.
+	//
+	// Method:    addCounter
+	// FullName:  metricsRegistry::addCounter
+	// Access:    public
+	// Returns:   metricsRegistry::counter&
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	counter& addCounter(
+		const std::string& inName);
+
+	//----------------------------------------------------------------- addGauge
+	// Brief Description
+	//  Returns the gauge with the given name, registering it at 0 the first
+	//  time.
+	//
+	// Method:    addGauge
+	// FullName:  metricsRegistry::addGauge
+	// Access:    public
+	// Returns:   metricsRegistry::gauge&
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	gauge& addGauge(
+		const std::string& inName);
+
+	//------------------------------------------------------------- addHistogram
+	// Brief Description
+	//  Returns the histogram with the given name, registering an empty one
+	//  the first time.
+	//
+	// Method:    addHistogram
+	// FullName:  metricsRegistry::addHistogram
+	// Access:    public
+	// Returns:   metricsRegistry::latencyHistogram&
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	latencyHistogram& addHistogram(
+		const std::string& inName);
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns one line per metric whose name starts with the prefix, sorted
+	//  by name. Histograms are summarized by their count, mean, 50th, 99th
+	//  and 99.9th percentiles and maximum.
+	//
+	// Method:    asString
+	// FullName:  metricsRegistry::asString
+	// Access:    public
+	// Returns:   std::string
+	// Parameter: const std::string& inPrefix
+	//--------------------------------------------------------------------------
+	std::string asString(
+		const std::string& inPrefix = "") const;
+
+	//-------------------------------------------------------------- writeToFile
+	// Brief Description
+	//  Replaces the file with every metric, as asString() lists them.
+	//  Readers never see a file that is half written. Returns false if the
+	//  file could not be written.
+	//
+	// Method:    writeToFile
+	// FullName:  metricsRegistry::writeToFile
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::string& inPath
+	//--------------------------------------------------------------------------
+	bool writeToFile(
+		const std::string& inPath) const;
+
+private:
+
+	// Member Variables
+
+	// only registering and listing lock, metrics are updated without it
+	mutable boost::mutex m_mutex;
+	std::map<std::string, boost::shared_ptr<counter>> m_counters;
+	std::map<std::string, boost::shared_ptr<gauge>> m_gauges;
+	std::map<std::string, boost::shared_ptr<latencyHistogram>> m_histograms;
+};
\ No newline at end of file
@@ -6,15 +6,18 @@
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
-//  Sets all relevant member variables
+//  Sets all relevant member variables. The activity clock is monotonic, so
+//  timeouts are not thrown off by the system time being changed.
 //------------------------------------------------------------------------------
 remoteConnection::remoteConnection(
 	const std::string& inIdentifier,
-	const boost::asio::ip::udp::endpoint& inEndpoint)
+	const boost::asio::ip::udp::endpoint& inEndpoint,
+	const uint32_t& inSessionIdentifier)
 {
 	this->m_identifier = inIdentifier;
 	this->m_endpoint = inEndpoint;
-	this->m_timeOfLastActivity = boost::chrono::system_clock::now();
+	this->m_sessionIdentifier = inSessionIdentifier;
+	this->m_timeOfLastActivity = activityClock::now();
 };
 
 //--------------------------------------------------------------- viewIdentifier
@@ -35,20 +38,30 @@ const boost::asio::ip::udp::endpoint& remoteConnection::viewEndpoint() const
 	return this->m_endpoint;
 };
 
+//-------------------------------------------------------- viewSessionIdentifier
+// Implementation notes:
+//  Returns a const reference to the session identifier
+//------------------------------------------------------------------------------
+const uint32_t& remoteConnection::viewSessionIdentifier() const
+{
+	return this->m_sessionIdentifier;
+};
+
 //------------------------------------------------------- viewTimeOfLastActivity
 // Implementation notes:
 //  Returns a const reference to the timeOfLastActivity
 //------------------------------------------------------------------------------
-const boost::chrono::system_clock::time_point& remoteConnection::viewTimeOfLastActivity() const
+const remoteConnection::activityClock::time_point& remoteConnection::viewTimeOfLastActivity() const
 {
 	return this->m_timeOfLastActivity;
 };
 
 //---------------------------------------------------- refreshTimeOfLastActivity
 // Implementation notes:
-//  Sets the timeOfLastActivity to now
+//  Sets the timeOfLastActivity to the given time
 //------------------------------------------------------------------------------
-void remoteConnection::refreshTimeOfLastActivity()
+void remoteConnection::refreshTimeOfLastActivity(
+	const activityClock::time_point& inNow)
 {
-	this->m_timeOfLastActivity = boost::chrono::system_clock::now();
+	this->m_timeOfLastActivity = inNow;
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ class remoteConnection
 {
 public:
 
+	typedef boost::chrono::steady_clock activityClock;
+
 	//-------------------------------------------------------------- constructor
 	// Brief Description
 	//  Constructor for the remote connection
@@ -22,10 +24,12 @@ public:
 	// Returns:   
 	// Parameter: const std::string& inIdentifier
 	// Parameter: const boost::asio::ip::udp::endpoint& inEndpoint
+	// Parameter: const uint32_t& inSessionIdentifier
 	//--------------------------------------------------------------------------
 	remoteConnection(
 		const std::string& inIdentifier,
-		const boost::asio::ip::udp::endpoint& inEndpoint);
+		const boost::asio::ip::udp::endpoint& inEndpoint,
+		const uint32_t& inSessionIdentifier = 0);
 
 	//----------------------------------------------------------- viewIdentifier
 	// Brief Description
@@ -51,6 +55,18 @@ public:
 	//--------------------------------------------------------------------------
 	const boost::asio::ip::udp::endpoint& viewEndpoint() const;
 
+	//---------------------------------------------------- viewSessionIdentifier
+	// Brief Description
+	//  Returns a const reference to the session identifier the server gave
+	//  a client when it connected, 0 for the connections to servers.
+	//
+	// Method:    viewSessionIdentifier
+	// FullName:  remoteConnection::viewSessionIdentifier
+	// Access:    public 
+	// Returns:   const uint32_t&
+	//--------------------------------------------------------------------------
+	const uint32_t& viewSessionIdentifier() const;
+
 	//--------------------------------------------------- viewTimeOfLastActivity
 	// Brief Description
 	//  Returns a const reference to the time of the last activity that this
@@ -59,24 +75,28 @@ public:
 	// Method:    viewTimeOfLastActivity
 	// FullName:  remoteConnection::viewTimeOfLastActivity
 	// Access:    public 
-	// Returns:   const boost::chrono::system_clock::time_point&
+	// Returns:   const activityClock::time_point&
 	//--------------------------------------------------------------------------
-	const boost::chrono::system_clock::time_point& viewTimeOfLastActivity() const;
+	const activityClock::time_point& viewTimeOfLastActivity() const;
 
 	//------------------------------------------------ refreshTimeOfLastActivity
 	// Brief Description
-	//  Refreshes the time of the last activity to the current time. This is
-	//  done periodically to prevent timeouts.
+	//  Refreshes the time of the last activity to the given time, which the
+	//  caller reads once for many connections rather than once per message.
+	//  This is done on every message to prevent timeouts.
 	//
 	// Method:    refreshTimeOfLastActivity
 	// FullName:  remoteConnection::refreshTimeOfLastActivity
 	// Access:    public 
 	// Returns:   void
+	// Parameter: const activityClock::time_point& inNow
 	//--------------------------------------------------------------------------
-	void refreshTimeOfLastActivity();
+	void refreshTimeOfLastActivity(
+		const activityClock::time_point& inNow);
 
 private:
 	std::string m_identifier;
 	boost::asio::ip::udp::endpoint m_endpoint;
-	boost::chrono::system_clock::time_point m_timeOfLastActivity;	
+	uint32_t m_sessionIdentifier;
+	activityClock::time_point m_timeOfLastActivity;	
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Project
+#include "retransmitTimer.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  No round trip sample yet
+//------------------------------------------------------------------------------
+retransmitTimer::retransmitTimer(
+	const uint16_t& inInitialMilliseconds,
+	const uint16_t& inMinimumMilliseconds,
+	const uint16_t& inMaximumMilliseconds) :
+	m_initialMilliseconds(inInitialMilliseconds),
+	m_minimumMilliseconds(inMinimumMilliseconds),
+	m_maximumMilliseconds(inMaximumMilliseconds),
+	m_roundTripMilliseconds(0),
+	m_roundTripVariationMilliseconds(0),
+	m_timeoutMilliseconds(inInitialMilliseconds)
+{
+};
+
+//-------------------------------------------------------------------- addSample
+// Implementation notes:
+//  RFC 6298 constants
+//------------------------------------------------------------------------------
+void retransmitTimer::addSample(
+	const double& inRoundTripMilliseconds)
+{
+	if(this->m_roundTripMilliseconds == 0)
+	{
+		this->m_roundTripMilliseconds = inRoundTripMilliseconds;
+		this->m_roundTripVariationMilliseconds = inRoundTripMilliseconds / 2;
+	}
+	else
+	{
+		this->m_roundTripVariationMilliseconds =
+			0.75 * this->m_roundTripVariationMilliseconds
+			+ 0.25 * std::fabs(this->m_roundTripMilliseconds - inRoundTripMilliseconds);
+
+		this->m_roundTripMilliseconds =
+			0.875 * this->m_roundTripMilliseconds
+			+ 0.125 * inRoundTripMilliseconds;
+	}
+};
+
+//---------------------------------------------------------------------- backOff
+// Implementation notes:
+//  Exponential backoff
+//------------------------------------------------------------------------------
+void retransmitTimer::backOff()
+{
+	this->m_timeoutMilliseconds = std::min(
+		this->m_timeoutMilliseconds * 2,
+		this->m_maximumMilliseconds);
+};
+
+//------------------------------------------------------------------------ reset
+// Implementation notes:
+//  The initial timeout is kept until there is a round trip sample
+//------------------------------------------------------------------------------
+void retransmitTimer::reset()
+{
+	if(this->m_roundTripMilliseconds == 0)
+	{
+		this->m_timeoutMilliseconds = this->m_initialMilliseconds;
+		return;
+	}
+
+	this->m_timeoutMilliseconds = std::max(
+		this->m_minimumMilliseconds,
+		std::min(
+			this->m_roundTripMilliseconds + 4 * this->m_roundTripVariationMilliseconds,
+			this->m_maximumMilliseconds));
+};
+
+//---------------------------------------------------- viewRoundTripMilliseconds
+// Implementation notes:
+//  Returns a const reference to the smoothed round trip time
+//------------------------------------------------------------------------------
+const double& retransmitTimer::viewRoundTripMilliseconds() const
+{
+	return this->m_roundTripMilliseconds;
+};
+
+//------------------------------------------------------ viewTimeoutMilliseconds
+// Implementation notes:
+//  Returns a const reference to the timeout
+//------------------------------------------------------------------------------
+const double& retransmitTimer::viewTimeoutMilliseconds() const
+{
+	return this->m_timeoutMilliseconds;
+};
\ No newline at end of file
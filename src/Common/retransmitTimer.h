@@ -0,0 +1,97 @@
+#pragma once
+
+// STL
+#include <cstdint>
+
+class retransmitTimer
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the retransmit timer of one sender. The timeout starts
+	//  at the initial value and, once round trip samples arrive, is kept
+	//  between the minimum and maximum.
+	//
+	// Method:    retransmitTimer
+	// FullName:  retransmitTimer::retransmitTimer
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inInitialMilliseconds
+	// Parameter: const uint16_t& inMinimumMilliseconds
+	// Parameter: const uint16_t& inMaximumMilliseconds
+	//--------------------------------------------------------------------------
+	retransmitTimer(
+		const uint16_t& inInitialMilliseconds,
+		const uint16_t& inMinimumMilliseconds,
+		const uint16_t& inMaximumMilliseconds);
+
+	//---------------------------------------------------------------- addSample
+	// Brief Description
+	//  Updates the smoothed round trip time and its variation with a new
+	//  sample, as TCP does. Only messages sent once should be sampled, the
+	//  ACK of a retransmitted message could be for either transmission.
+	//
+	// Method:    addSample
+	// FullName:  retransmitTimer::addSample
+	// Access:    public
+	// Returns:   void
+	// Parameter: const double& inRoundTripMilliseconds
+	//--------------------------------------------------------------------------
+	void addSample(
+		const double& inRoundTripMilliseconds);
+
+	//------------------------------------------------------------------ backOff
+	// Brief Description
+	//  Doubles the timeout, up to the maximum, after a message timed out.
+	//
+	// Method:    backOff
+	// FullName:  retransmitTimer::backOff
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void backOff();
+
+	//-------------------------------------------------------------------- reset
+	// Brief Description
+	//  Sets the timeout from the smoothed round trip time and its variation,
+	//  undoing any backoff. Called when an ACK shows the peer is reachable.
+	//
+	// Method:    reset
+	// FullName:  retransmitTimer::reset
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void reset();
+
+	//------------------------------------------------ viewRoundTripMilliseconds
+	// Brief Description
+	//  Returns the smoothed round trip time, 0 before the first sample.
+	//
+	// Method:    viewRoundTripMilliseconds
+	// FullName:  retransmitTimer::viewRoundTripMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewRoundTripMilliseconds() const;
+
+	//-------------------------------------------------- viewTimeoutMilliseconds
+	// Brief Description
+	//  Returns how long to wait for an ACK before sending a message again.
+	//
+	// Method:    viewTimeoutMilliseconds
+	// FullName:  retransmitTimer::viewTimeoutMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewTimeoutMilliseconds() const;
+
+private:
+	// Member Variables
+	double m_initialMilliseconds;
+	double m_minimumMilliseconds;
+	double m_maximumMilliseconds;
+	double m_roundTripMilliseconds;
+	double m_roundTripVariationMilliseconds;
+	double m_timeoutMilliseconds;
+};
\ No newline at end of file
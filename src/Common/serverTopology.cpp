@@ -0,0 +1,1010 @@
+// STL
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+// Project
+#include "serverTopology.h"
+#include "constants.h"
+
+namespace
+{
+	//---------------------------------------------------------------- lowercase
+	// Implementation notes:
+	//  Server names are compared case insensitively
+	//--------------------------------------------------------------------------
+	std::string lowercase(
+		std::string inString)
+	{
+		std::transform(
+			inString.begin(),
+			inString.end(),
+			inString.begin(),
+			::tolower);
+
+		return inString;
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Same names and ports as the original compiled in federation
+//------------------------------------------------------------------------------
+serverTopology::serverTopology() :
+	m_routingMode(serverTopology::RoutingMode::rm_CHAIN),
+	m_heartbeatIntervalMilliseconds(constants::heartbeatIntervalMilliseconds),
+	m_suspicionTimeoutMilliseconds(constants::suspicionTimeoutMilliseconds),
+	m_reorderHoldMilliseconds(constants::reorderHoldMilliseconds),
+	m_sessionTimeoutMilliseconds(constants::sessionTimeoutMilliseconds),
+	m_messageTimeToLiveMilliseconds(constants::messageTimeToLiveMilliseconds),
+	m_spoolDirectory(""),
+	m_logLevel(asyncLog::ll_TRACE),
+	m_traceSampling(1),
+	m_metricsDirectory(""),
+	m_metricsIntervalMilliseconds(constants::metricsExportIntervalMilliseconds),
+	m_messageTraceDirectory(""),
+	m_messageTraceSampling(0),
+	m_captureDirectory(""),
+	m_membershipFilterBits(0)
+{
+	const std::vector<std::string> defaultServerNames(
+	{"Alpha", "Bravo", "Charlie", "Delta", "Echo"});
+
+	const uint16_t firstListeningPort = 8080;
+
+	for(size_t i = 0; i < defaultServerNames.size(); i++)
+	{
+		this->addServer(
+			defaultServerNames[i],
+			boost::asio::ip::udp::endpoint(
+				boost::asio::ip::address_v4::loopback(),
+				static_cast<uint16_t>(firstListeningPort + i)));
+	}
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Addresses must be numeric, host names are rejected rather than resolved.
+//  Links may name servers listed further down, so they are added last.
+//------------------------------------------------------------------------------
+serverTopology::serverTopology(
+	const std::string& inConfigurationFilePath) :
+	m_routingMode(serverTopology::RoutingMode::rm_CHAIN),
+	m_heartbeatIntervalMilliseconds(constants::heartbeatIntervalMilliseconds),
+	m_suspicionTimeoutMilliseconds(constants::suspicionTimeoutMilliseconds),
+	m_reorderHoldMilliseconds(constants::reorderHoldMilliseconds),
+	m_sessionTimeoutMilliseconds(constants::sessionTimeoutMilliseconds),
+	m_messageTimeToLiveMilliseconds(constants::messageTimeToLiveMilliseconds),
+	m_spoolDirectory(""),
+	m_logLevel(asyncLog::ll_TRACE),
+	m_traceSampling(1),
+	m_metricsDirectory(""),
+	m_metricsIntervalMilliseconds(constants::metricsExportIntervalMilliseconds),
+	m_messageTraceDirectory(""),
+	m_messageTraceSampling(0),
+	m_captureDirectory(""),
+	m_membershipFilterBits(0)
+{
+	// location, first server name, second server name
+	std::vector<std::pair<std::string, std::pair<std::string, std::string>>> links;
+
+	std::ifstream configurationFile(inConfigurationFilePath);
+
+	if(!configurationFile)
+	{
+		throw std::runtime_error(
+			"Unable to open " + inConfigurationFilePath);
+	}
+
+	std::string line("");
+	size_t lineNumber = 0;
+
+	while(std::getline(configurationFile, line))
+	{
+		lineNumber++;
+
+		const std::string location(
+			inConfigurationFilePath + ":" + std::to_string(lineNumber) + ": ");
+
+		std::stringstream ss(
+			line.substr(0, line.find('#')));
+
+		std::string keyword("");
+
+		if(!(ss >> keyword))
+		{
+			// blank line or comment
+			continue;
+		}
+
+		if(keyword == "server")
+		{
+			std::string name("");
+			std::string address("");
+			uint32_t port = 0;
+
+			if(!(ss >> name >> address >> port) || port == 0 || port > 65535)
+			{
+				throw std::runtime_error(
+					location + "expected 'server <name> <address> <port>'");
+			}
+
+			boost::system::error_code error;
+
+			const boost::asio::ip::address serverAddress(
+				boost::asio::ip::address::from_string(address, error));
+
+			if(error || !serverAddress.is_v4())
+			{
+				throw std::runtime_error(
+					location + address + " is not an IPv4 address");
+			}
+
+			try
+			{
+				this->addServer(
+					name,
+					boost::asio::ip::udp::endpoint(
+						serverAddress,
+						static_cast<uint16_t>(port)));
+			}
+			catch(std::runtime_error& exception)
+			{
+				throw std::runtime_error(
+					location + exception.what());
+			}
+		}
+		else if(keyword == "routing")
+		{
+			std::string routingMode("");
+			ss >> routingMode;
+
+			if(routingMode == "chain")
+			{
+				this->m_routingMode = serverTopology::RoutingMode::rm_CHAIN;
+			}
+			else if(routingMode == "mesh")
+			{
+				this->m_routingMode = serverTopology::RoutingMode::rm_MESH;
+			}
+			else if(routingMode == "overlay")
+			{
+				this->m_routingMode = serverTopology::RoutingMode::rm_OVERLAY;
+			}
+			else
+			{
+				throw std::runtime_error(
+					location + "expected 'routing <chain|mesh|overlay>'");
+			}
+		}
+		else if(keyword == "heartbeat")
+		{
+			uint32_t heartbeatInterval = 0;
+			uint32_t suspicionTimeout = 0;
+
+			if(!(ss >> heartbeatInterval >> suspicionTimeout)
+				|| heartbeatInterval == 0
+				|| suspicionTimeout <= heartbeatInterval
+				|| suspicionTimeout > 65535)
+			{
+				throw std::runtime_error(
+					location + "expected 'heartbeat <interval ms> <timeout ms>'"
+					" with the timeout longer than the interval");
+			}
+
+			this->setHeartbeat(
+				static_cast<uint16_t>(heartbeatInterval),
+				static_cast<uint16_t>(suspicionTimeout));
+		}
+		else if(keyword == "reorder")
+		{
+			uint32_t holdTime = 0;
+
+			if(!(ss >> holdTime) || holdTime > 65535)
+			{
+				throw std::runtime_error(
+					location + "expected 'reorder <hold ms>'");
+			}
+
+			this->setReorderHold(
+				static_cast<uint16_t>(holdTime));
+		}
+		else if(keyword == "session")
+		{
+			uint32_t sessionTimeout = 0;
+
+			if(!(ss >> sessionTimeout) || sessionTimeout == 0 || sessionTimeout > 65535)
+			{
+				throw std::runtime_error(
+					location + "expected 'session <idle timeout ms>'");
+			}
+
+			this->setSessionTimeout(
+				static_cast<uint16_t>(sessionTimeout));
+		}
+		else if(keyword == "ttl")
+		{
+			uint32_t timeToLive = 0;
+
+			if(!(ss >> timeToLive) || timeToLive == 0)
+			{
+				throw std::runtime_error(
+					location + "expected 'ttl <message time to live ms>'");
+			}
+
+			this->setMessageTimeToLive(
+				timeToLive);
+		}
+		else if(keyword == "spool")
+		{
+			std::string spoolDirectory("");
+
+			if(!(ss >> spoolDirectory))
+			{
+				throw std::runtime_error(
+					location + "expected 'spool <directory>'");
+			}
+
+			this->setSpoolDirectory(
+				spoolDirectory);
+		}
+		else if(keyword == "log")
+		{
+			std::string levelName("");
+			asyncLog::LogLevel logLevel = asyncLog::ll_TRACE;
+			uint32_t traceSampling = 1;
+
+			// the sampling is optional, every trace line is kept without it
+			std::string traceSamplingText("");
+			ss >> levelName >> traceSamplingText;
+
+			if(!traceSamplingText.empty())
+			{
+				std::stringstream samplingStream(traceSamplingText);
+				samplingStream >> traceSampling;
+
+				if(samplingStream.fail() || !samplingStream.eof())
+				{
+					traceSampling = 0;
+				}
+			}
+
+			if(!asyncLog::levelFromString(levelName, logLevel)
+				|| traceSampling == 0)
+			{
+				throw std::runtime_error(
+					location + "expected 'log <error|warning|info|trace> [<keep 1 in N trace lines>]'");
+			}
+
+			this->setLogLevel(
+				logLevel,
+				traceSampling);
+		}
+		else if(keyword == "metrics")
+		{
+			std::string metricsDirectory("");
+			uint32_t exportInterval = constants::metricsExportIntervalMilliseconds;
+
+			if(!(ss >> metricsDirectory)
+				|| (!(ss >> exportInterval) && !ss.eof())
+				|| exportInterval == 0
+				|| exportInterval > 65535)
+			{
+				throw std::runtime_error(
+					location + "expected 'metrics <directory> [<export interval ms>]'");
+			}
+
+			this->setMetricsExport(
+				metricsDirectory,
+				static_cast<uint16_t>(exportInterval));
+		}
+		else if(keyword == "trace")
+		{
+			uint32_t traceSampling = 0;
+			std::string traceDirectory("");
+
+			if(!(ss >> traceSampling >> traceDirectory) || traceSampling == 0)
+			{
+				throw std::runtime_error(
+					location + "expected 'trace <trace 1 in N messages> <directory>'");
+			}
+
+			this->setMessageTracing(
+				traceDirectory,
+				traceSampling);
+		}
+		else if(keyword == "capture")
+		{
+			std::string captureDirectory("");
+
+			if(!(ss >> captureDirectory))
+			{
+				throw std::runtime_error(
+					location + "expected 'capture <directory>'");
+			}
+
+			this->setCaptureDirectory(
+				captureDirectory);
+		}
+		else if(keyword == "membership")
+		{
+			std::string membershipMode("");
+			uint32_t filterBits = constants::membershipFilterBits;
+
+			// the size is optional for filters
+			if(!(ss >> membershipMode)
+				|| (!(ss >> filterBits) && !ss.eof()))
+			{
+				membershipMode = "";
+			}
+
+			if(membershipMode == "full")
+			{
+				filterBits = 0;
+			}
+			else if(membershipMode != "bloom"
+				|| filterBits < constants::membershipFilterMinimumBits
+				|| filterBits > constants::membershipFilterMaximumBits)
+			{
+				throw std::runtime_error(
+					location + "expected 'membership <full|bloom> [<filter bits>]'"
+					" with " + std::to_string(constants::membershipFilterMinimumBits)
+					+ " to " + std::to_string(constants::membershipFilterMaximumBits) + " bits");
+			}
+
+			this->setMembershipFilterBits(
+				static_cast<uint16_t>(filterBits));
+		}
+		else if(keyword == "link")
+		{
+			std::string firstServerName("");
+			std::string secondServerName("");
+
+			if(!(ss >> firstServerName >> secondServerName))
+			{
+				throw std::runtime_error(
+					location + "expected 'link <name> <name>'");
+			}
+
+			links.push_back(std::make_pair(
+				location,
+				std::make_pair(firstServerName, secondServerName)));
+		}
+		else
+		{
+			throw std::runtime_error(
+				location + "unknown keyword '" + keyword + "'");
+		}
+	}
+
+	if(this->m_serverNames.empty())
+	{
+		throw std::runtime_error(
+			inConfigurationFilePath + ": no servers defined");
+	}
+
+	for(const auto& link : links)
+	{
+		const int16_t firstServerIndex =
+			this->serverIndexFromIdentifier(link.second.first);
+
+		const int16_t secondServerIndex =
+			this->serverIndexFromIdentifier(link.second.second);
+
+		if(firstServerIndex == -1 || secondServerIndex == -1)
+		{
+			throw std::runtime_error(
+				link.first + "link to an unknown server");
+		}
+
+		this->addLink(
+			firstServerIndex,
+			secondServerIndex);
+	}
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Both vectors are expected to be the same length
+//------------------------------------------------------------------------------
+serverTopology::serverTopology(
+	const std::vector<std::string>& inServerNames,
+	const std::vector<boost::asio::ip::udp::endpoint>& inServerEndpoints) :
+	m_routingMode(serverTopology::RoutingMode::rm_CHAIN),
+	m_heartbeatIntervalMilliseconds(constants::heartbeatIntervalMilliseconds),
+	m_suspicionTimeoutMilliseconds(constants::suspicionTimeoutMilliseconds),
+	m_reorderHoldMilliseconds(constants::reorderHoldMilliseconds),
+	m_sessionTimeoutMilliseconds(constants::sessionTimeoutMilliseconds),
+	m_messageTimeToLiveMilliseconds(constants::messageTimeToLiveMilliseconds),
+	m_spoolDirectory(""),
+	m_logLevel(asyncLog::ll_TRACE),
+	m_traceSampling(1),
+	m_metricsDirectory(""),
+	m_metricsIntervalMilliseconds(constants::metricsExportIntervalMilliseconds),
+	m_messageTraceDirectory(""),
+	m_messageTraceSampling(0),
+	m_captureDirectory(""),
+	m_membershipFilterBits(0)
+{
+	for(size_t i = 0; i < inServerNames.size(); i++)
+	{
+		this->addServer(
+			inServerNames[i],
+			inServerEndpoints[i]);
+	}
+};
+
+//-------------------------------------------------------------------- addServer
+// Implementation notes:
+//  Names double as identifiers in messages, so they must be unique
+//------------------------------------------------------------------------------
+void serverTopology::addServer(
+	const std::string& inServerName,
+	const boost::asio::ip::udp::endpoint& inServerEndpoint)
+{
+	if(this->m_serverNames.size() >= constants::maximumServers)
+	{
+		throw std::runtime_error(
+			"more than " + std::to_string(constants::maximumServers) + " servers");
+	}
+
+	for(const std::string& serverName : this->m_serverNames)
+	{
+		if(lowercase(serverName) == lowercase(inServerName))
+		{
+			throw std::runtime_error(
+				"duplicate server name " + inServerName);
+		}
+	}
+
+	this->m_serverNames.push_back(inServerName);
+	this->m_serverEndpoints.push_back(inServerEndpoint);
+	this->m_overlayLinks.push_back(std::vector<int16_t>());
+};
+
+//-------------------------------------------------------------- numberOfServers
+// Implementation notes:
+//  Returns the number of servers
+//------------------------------------------------------------------------------
+int16_t serverTopology::numberOfServers() const
+{
+	return static_cast<int16_t>(this->m_serverNames.size());
+};
+
+//----------------------------------------------------------- highestServerIndex
+// Implementation notes:
+//  Returns the index of the last server
+//------------------------------------------------------------------------------
+int16_t serverTopology::highestServerIndex() const
+{
+	return this->numberOfServers() - 1;
+};
+
+//----------------------------------------------------------- serverIndexIsValid
+// Implementation notes:
+//  Valid indices are 0 through highestServerIndex
+//------------------------------------------------------------------------------
+bool serverTopology::serverIndexIsValid(
+	const int16_t& inServerIndex) const
+{
+	return (inServerIndex >= 0) && (inServerIndex <= this->highestServerIndex());
+};
+
+//--------------------------------------------------------------- viewServerName
+// Implementation notes:
+//  Returns a const reference to the server name
+//------------------------------------------------------------------------------
+const std::string& serverTopology::viewServerName(
+	const int16_t& inServerIndex) const
+{
+	return this->m_serverNames[inServerIndex];
+};
+
+//----------------------------------------------------------- viewServerEndpoint
+// Implementation notes:
+//  Returns a const reference to the server endpoint
+//------------------------------------------------------------------------------
+const boost::asio::ip::udp::endpoint& serverTopology::viewServerEndpoint(
+	const int16_t& inServerIndex) const
+{
+	return this->m_serverEndpoints[inServerIndex];
+};
+
+//------------------------------------------------------------ setServerEndpoint
+// Implementation notes:
+//  Sets the server endpoint
+//------------------------------------------------------------------------------
+void serverTopology::setServerEndpoint(
+	const int16_t& inServerIndex,
+	const boost::asio::ip::udp::endpoint& inServerEndpoint)
+{
+	this->m_serverEndpoints[inServerIndex] = inServerEndpoint;
+};
+
+//---------------------------------------------------- serverIndexFromIdentifier
+// Implementation notes:
+//  A single letter is only treated as an index if no server has that name
+//------------------------------------------------------------------------------
+int16_t serverTopology::serverIndexFromIdentifier(
+	const std::string& inIdentifier) const
+{
+	const std::string identifierAsLower(
+		lowercase(inIdentifier));
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->numberOfServers();
+		serverIndex++)
+	{
+		if(lowercase(this->m_serverNames[serverIndex]) == identifierAsLower)
+		{
+			return serverIndex;
+		}
+	}
+
+	if(identifierAsLower.size() == 1
+		&& identifierAsLower[0] >= 'a'
+		&& identifierAsLower[0] <= 'z')
+	{
+		const int16_t serverIndex =
+			static_cast<int16_t>(identifierAsLower[0] - 'a');
+
+		if(this->serverIndexIsValid(serverIndex))
+		{
+			return serverIndex;
+		}
+	}
+
+	return -1;
+};
+
+//---------------------------------------------------------- serverNamesAsString
+// Implementation notes:
+//  Returns the names joined with ", "
+//------------------------------------------------------------------------------
+std::string serverTopology::serverNamesAsString() const
+{
+	std::string outServerNames("");
+
+	for(const std::string& serverName : this->m_serverNames)
+	{
+		if(!outServerNames.empty())
+		{
+			outServerNames += ", ";
+		}
+
+		outServerNames += serverName;
+	}
+
+	return outServerNames;
+};
+
+//-------------------------------------------------------------- viewRoutingMode
+// Implementation notes:
+//  Returns a const reference to the routing mode
+//------------------------------------------------------------------------------
+const serverTopology::RoutingMode& serverTopology::viewRoutingMode() const
+{
+	return this->m_routingMode;
+};
+
+//--------------------------------------------------------------- setRoutingMode
+// Implementation notes:
+//  Sets the routing mode to inRoutingMode
+//------------------------------------------------------------------------------
+void serverTopology::setRoutingMode(
+	const serverTopology::RoutingMode& inRoutingMode)
+{
+	this->m_routingMode = inRoutingMode;
+};
+
+//-------------------------------------------- viewHeartbeatIntervalMilliseconds
+// Implementation notes:
+//  Returns a const reference to the heartbeat interval
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewHeartbeatIntervalMilliseconds() const
+{
+	return this->m_heartbeatIntervalMilliseconds;
+};
+
+//--------------------------------------------- viewSuspicionTimeoutMilliseconds
+// Implementation notes:
+//  Returns a const reference to the suspicion timeout
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewSuspicionTimeoutMilliseconds() const
+{
+	return this->m_suspicionTimeoutMilliseconds;
+};
+
+//----------------------------------------------------------------- setHeartbeat
+// Implementation notes:
+//  Sets the heartbeat interval and suspicion timeout
+//------------------------------------------------------------------------------
+void serverTopology::setHeartbeat(
+	const uint16_t& inHeartbeatIntervalMilliseconds,
+	const uint16_t& inSuspicionTimeoutMilliseconds)
+{
+	this->m_heartbeatIntervalMilliseconds = inHeartbeatIntervalMilliseconds;
+	this->m_suspicionTimeoutMilliseconds = inSuspicionTimeoutMilliseconds;
+};
+
+//-------------------------------------------------- viewReorderHoldMilliseconds
+// Implementation notes:
+//  Returns a const reference to the reorder hold time
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewReorderHoldMilliseconds() const
+{
+	return this->m_reorderHoldMilliseconds;
+};
+
+//--------------------------------------------------------------- setReorderHold
+// Implementation notes:
+//  Sets the reorder hold time
+//------------------------------------------------------------------------------
+void serverTopology::setReorderHold(
+	const uint16_t& inReorderHoldMilliseconds)
+{
+	this->m_reorderHoldMilliseconds = inReorderHoldMilliseconds;
+};
+
+//----------------------------------------------- viewSessionTimeoutMilliseconds
+// Implementation notes:
+//  Returns a const reference to the session timeout
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewSessionTimeoutMilliseconds() const
+{
+	return this->m_sessionTimeoutMilliseconds;
+};
+
+//------------------------------------------------------------ setSessionTimeout
+// Implementation notes:
+//  Sets the session timeout
+//------------------------------------------------------------------------------
+void serverTopology::setSessionTimeout(
+	const uint16_t& inSessionTimeoutMilliseconds)
+{
+	this->m_sessionTimeoutMilliseconds = inSessionTimeoutMilliseconds;
+};
+
+//-------------------------------------------- viewMessageTimeToLiveMilliseconds
+// Implementation notes:
+//  Returns a const reference to the message time to live
+//------------------------------------------------------------------------------
+const uint32_t& serverTopology::viewMessageTimeToLiveMilliseconds() const
+{
+	return this->m_messageTimeToLiveMilliseconds;
+};
+
+//--------------------------------------------------------- setMessageTimeToLive
+// Implementation notes:
+//  Sets the message time to live
+//------------------------------------------------------------------------------
+void serverTopology::setMessageTimeToLive(
+	const uint32_t& inMessageTimeToLiveMilliseconds)
+{
+	this->m_messageTimeToLiveMilliseconds = inMessageTimeToLiveMilliseconds;
+};
+
+//----------------------------------------------------------- viewSpoolDirectory
+// Implementation notes:
+//  Returns a const reference to the spool directory
+//------------------------------------------------------------------------------
+const std::string& serverTopology::viewSpoolDirectory() const
+{
+	return this->m_spoolDirectory;
+};
+
+//------------------------------------------------------------ setSpoolDirectory
+// Implementation notes:
+//  Sets the spool directory
+//------------------------------------------------------------------------------
+void serverTopology::setSpoolDirectory(
+	const std::string& inSpoolDirectory)
+{
+	this->m_spoolDirectory = inSpoolDirectory;
+};
+
+//----------------------------------------------------------------- viewLogLevel
+// Implementation notes:
+//  Returns a const reference to the log level
+//------------------------------------------------------------------------------
+const asyncLog::LogLevel& serverTopology::viewLogLevel() const
+{
+	return this->m_logLevel;
+};
+
+//------------------------------------------------------------ viewTraceSampling
+// Implementation notes:
+//  Returns a const reference to the trace sampling
+//------------------------------------------------------------------------------
+const uint32_t& serverTopology::viewTraceSampling() const
+{
+	return this->m_traceSampling;
+};
+
+//------------------------------------------------------------------ setLogLevel
+// Implementation notes:
+//  Sets the log level and trace sampling
+//------------------------------------------------------------------------------
+void serverTopology::setLogLevel(
+	const asyncLog::LogLevel& inLogLevel,
+	const uint32_t& inTraceSampling)
+{
+	this->m_logLevel = inLogLevel;
+	this->m_traceSampling = inTraceSampling;
+};
+
+//--------------------------------------------------------- viewMetricsDirectory
+// Implementation notes:
+//  Returns a const reference to the metrics directory
+//------------------------------------------------------------------------------
+const std::string& serverTopology::viewMetricsDirectory() const
+{
+	return this->m_metricsDirectory;
+};
+
+//---------------------------------------------- viewMetricsIntervalMilliseconds
+// Implementation notes:
+//  Returns a const reference to the metrics export interval
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewMetricsIntervalMilliseconds() const
+{
+	return this->m_metricsIntervalMilliseconds;
+};
+
+//------------------------------------------------------------- setMetricsExport
+// Implementation notes:
+//  Sets the metrics directory and export interval
+//------------------------------------------------------------------------------
+void serverTopology::setMetricsExport(
+	const std::string& inMetricsDirectory,
+	const uint16_t& inMetricsIntervalMilliseconds)
+{
+	this->m_metricsDirectory = inMetricsDirectory;
+	this->m_metricsIntervalMilliseconds = inMetricsIntervalMilliseconds;
+};
+
+//---------------------------------------------------- viewMessageTraceDirectory
+// Implementation notes:
+//  Returns a const reference to the message trace directory
+//------------------------------------------------------------------------------
+const std::string& serverTopology::viewMessageTraceDirectory() const
+{
+	return this->m_messageTraceDirectory;
+};
+
+//----------------------------------------------------- viewMessageTraceSampling
+// Implementation notes:
+//  Returns a const reference to the message trace sampling
+//------------------------------------------------------------------------------
+const uint32_t& serverTopology::viewMessageTraceSampling() const
+{
+	return this->m_messageTraceSampling;
+};
+
+//------------------------------------------------------------ setMessageTracing
+// Implementation notes:
+//  Sets the message trace directory and sampling
+//------------------------------------------------------------------------------
+void serverTopology::setMessageTracing(
+	const std::string& inMessageTraceDirectory,
+	const uint32_t& inMessageTraceSampling)
+{
+	this->m_messageTraceDirectory = inMessageTraceDirectory;
+	this->m_messageTraceSampling = inMessageTraceSampling;
+};
+
+//--------------------------------------------------------- viewCaptureDirectory
+// Implementation notes:
+//  Returns a const reference to the capture directory
+//------------------------------------------------------------------------------
+const std::string& serverTopology::viewCaptureDirectory() const
+{
+	return this->m_captureDirectory;
+};
+
+//---------------------------------------------------------- setCaptureDirectory
+// Implementation notes:
+//  Sets the capture directory
+//------------------------------------------------------------------------------
+void serverTopology::setCaptureDirectory(
+	const std::string& inCaptureDirectory)
+{
+	this->m_captureDirectory = inCaptureDirectory;
+};
+
+//----------------------------------------------------- viewMembershipFilterBits
+// Implementation notes:
+//  Returns a const reference to the membership filter size
+//------------------------------------------------------------------------------
+const uint16_t& serverTopology::viewMembershipFilterBits() const
+{
+	return this->m_membershipFilterBits;
+};
+
+//------------------------------------------------------ setMembershipFilterBits
+// Implementation notes:
+//  Sets the membership filter size
+//------------------------------------------------------------------------------
+void serverTopology::setMembershipFilterBits(
+	const uint16_t& inMembershipFilterBits)
+{
+	this->m_membershipFilterBits = inMembershipFilterBits;
+};
+
+//---------------------------------------------------------------------- addLink
+// Implementation notes:
+//  Duplicate links and links from a server to itself are ignored
+//------------------------------------------------------------------------------
+void serverTopology::addLink(
+	const int16_t& inFirstServerIndex,
+	const int16_t& inSecondServerIndex)
+{
+	std::vector<int16_t>& firstLinks =
+		this->m_overlayLinks[inFirstServerIndex];
+
+	if(inFirstServerIndex == inSecondServerIndex
+		|| std::find(firstLinks.begin(), firstLinks.end(), inSecondServerIndex)
+			!= firstLinks.end())
+	{
+		return;
+	}
+
+	firstLinks.push_back(inSecondServerIndex);
+	this->m_overlayLinks[inSecondServerIndex].push_back(inFirstServerIndex);
+
+	this->computeOverlayDistances();
+};
+
+//--------------------------------------------------------------- viewNeighbours
+// Implementation notes:
+//  The chain and the mesh follow from the server indices alone
+//------------------------------------------------------------------------------
+std::vector<int16_t> serverTopology::viewNeighbours(
+	const int16_t& inServerIndex) const
+{
+	std::vector<int16_t> outNeighbours;
+
+	switch(this->m_routingMode)
+	{
+		case serverTopology::RoutingMode::rm_CHAIN:
+		{
+			if(this->serverIndexIsValid(inServerIndex - 1))
+			{
+				outNeighbours.push_back(inServerIndex - 1);
+			}
+
+			if(this->serverIndexIsValid(inServerIndex + 1))
+			{
+				outNeighbours.push_back(inServerIndex + 1);
+			}
+			break;
+		}
+		case serverTopology::RoutingMode::rm_MESH:
+		{
+			for(int16_t serverIndex = 0;
+				serverIndex < this->numberOfServers();
+				serverIndex++)
+			{
+				if(serverIndex != inServerIndex)
+				{
+					outNeighbours.push_back(serverIndex);
+				}
+			}
+			break;
+		}
+		case serverTopology::RoutingMode::rm_OVERLAY:
+		{
+			outNeighbours = this->m_overlayLinks[inServerIndex];
+			break;
+		}
+	}
+
+	return outNeighbours;
+};
+
+//--------------------------------------------------------------------- distance
+// Implementation notes:
+//  Only the overlay needs the precomputed table, which is built as links are
+//  added. A server added after the last link has no links, so no path.
+//------------------------------------------------------------------------------
+int16_t serverTopology::distance(
+	const int16_t& inFromServerIndex,
+	const int16_t& inToServerIndex) const
+{
+	if(inFromServerIndex == inToServerIndex)
+	{
+		return 0;
+	}
+
+	switch(this->m_routingMode)
+	{
+		case serverTopology::RoutingMode::rm_CHAIN:
+		{
+			return static_cast<int16_t>(
+				std::abs(inFromServerIndex - inToServerIndex));
+		}
+		case serverTopology::RoutingMode::rm_MESH:
+		{
+			return 1;
+		}
+		case serverTopology::RoutingMode::rm_OVERLAY:
+		default:
+		{
+			if(static_cast<size_t>(inFromServerIndex) >= this->m_overlayDistances.size()
+				|| static_cast<size_t>(inToServerIndex) >= this->m_overlayDistances.size())
+			{
+				return -1;
+			}
+
+			return this->m_overlayDistances[inFromServerIndex][inToServerIndex];
+		}
+	}
+};
+
+//---------------------------------------------------------- routingModeAsString
+// Implementation notes:
+//  Same spelling as the configuration file
+//------------------------------------------------------------------------------
+std::string serverTopology::routingModeAsString() const
+{
+	switch(this->m_routingMode)
+	{
+		case serverTopology::RoutingMode::rm_CHAIN:
+		{
+			return "chain";
+		}
+		case serverTopology::RoutingMode::rm_MESH:
+		{
+			return "mesh";
+		}
+		case serverTopology::RoutingMode::rm_OVERLAY:
+		default:
+		{
+			return "overlay";
+		}
+	}
+};
+
+//------------------------------------------------------ computeOverlayDistances
+// Implementation notes:
+//  Unreachable servers are left at -1
+//------------------------------------------------------------------------------
+void serverTopology::computeOverlayDistances()
+{
+	const int16_t serverCount = this->numberOfServers();
+
+	this->m_overlayDistances.assign(
+		serverCount,
+		std::vector<int16_t>(serverCount, -1));
+
+	for(int16_t source = 0; source < serverCount; source++)
+	{
+		std::vector<int16_t>& distances =
+			this->m_overlayDistances[source];
+
+		std::deque<int16_t> frontier;
+
+		distances[source] = 0;
+		frontier.push_back(source);
+
+		while(!frontier.empty())
+		{
+			const int16_t current = frontier.front();
+			frontier.pop_front();
+
+			for(const int16_t& neighbour : this->m_overlayLinks[current])
+			{
+				if(distances[neighbour] == -1)
+				{
+					distances[neighbour] = distances[current] + 1;
+					frontier.push_back(neighbour);
+				}
+			}
+		}
+	}
+};
\ No newline at end of file
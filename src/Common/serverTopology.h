@@ -0,0 +1,636 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+
+// Project
+#include "asyncLog.h"
+
+class serverTopology
+{
+public:
+
+	enum RoutingMode
+	{
+		rm_CHAIN = 0,
+		rm_MESH = 1,
+		rm_OVERLAY = 2
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the default topology: the original five servers,
+	//  Alpha through Echo, on 127.0.0.1 ports 8080 through 8084.
+	//
+	// Method:    serverTopology
+	// FullName:  serverTopology::serverTopology
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	serverTopology();
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that loads the topology from a configuration file. Each
+	//  non-empty line that is not a comment ('#') is one of:
+	//
+	//    server <name> <IPv4 address> <port>
+	//    routing <chain|mesh|overlay>
+	//    link <name> <name>
+	//    heartbeat <interval ms> <suspicion timeout ms>
+	//    reorder <hold ms>
+	//    session <idle timeout ms>
+	//    ttl <message time to live ms>
+	//    spool <directory>
+	//    log <error|warning|info|trace> [<keep 1 in N trace lines>]
+	//    metrics <directory> [<export interval ms>]
+	//    trace <trace 1 in N messages> <directory>
+	//    capture <directory>
+	//    membership <full|bloom> [<filter bits>]
+	//
+	//  Servers are indexed in the order they appear. Routing defaults to
+	//  the chain, where each server only talks to the servers before and
+	//  after it. Links are only used by the overlay. Throws a
+	//  std::runtime_error naming the offending line if the file is invalid.
+	//
+	// Method:    serverTopology
+	// FullName:  serverTopology::serverTopology
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inConfigurationFilePath
+	//--------------------------------------------------------------------------
+	serverTopology(
+		const std::string& inConfigurationFilePath);
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a topology built in code, such as by the cluster
+	//  harness. Server i is named inServerNames[i] and listens on
+	//  inServerEndpoints[i].
+	//
+	// Method:    serverTopology
+	// FullName:  serverTopology::serverTopology
+	// Access:    public
+	// Returns:
+	// Parameter: const std::vector<std::string>& inServerNames
+	// Parameter: const std::vector<boost::asio::ip::udp::endpoint>& inServerEndpoints
+	//--------------------------------------------------------------------------
+	serverTopology(
+		const std::vector<std::string>& inServerNames,
+		const std::vector<boost::asio::ip::udp::endpoint>& inServerEndpoints);
+
+	//---------------------------------------------------------- numberOfServers
+	// Brief Description
+	//  Returns the number of servers in the federation.
+	//
+	// Method:    numberOfServers
+	// FullName:  serverTopology::numberOfServers
+	// Access:    public
+	// Returns:   int16_t
+	//--------------------------------------------------------------------------
+	int16_t numberOfServers() const;
+
+	//------------------------------------------------------- highestServerIndex
+	// Brief Description
+	//  Returns the index of the last server in the federation.
+	//
+	// Method:    highestServerIndex
+	// FullName:  serverTopology::highestServerIndex
+	// Access:    public
+	// Returns:   int16_t
+	//--------------------------------------------------------------------------
+	int16_t highestServerIndex() const;
+
+	//------------------------------------------------------- serverIndexIsValid
+	// Brief Description
+	//  Used to determine if a server index, such as that of an adjacent
+	//  server, refers to a server of the federation.
+	//
+	// Method:    serverIndexIsValid
+	// FullName:  serverTopology::serverIndexIsValid
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool serverIndexIsValid(
+		const int16_t& inServerIndex) const;
+
+	//----------------------------------------------------------- viewServerName
+	// Brief Description
+	//  Returns the name of the server associated with the given server index.
+	//
+	// Method:    viewServerName
+	// FullName:  serverTopology::viewServerName
+	// Access:    public
+	// Returns:   const std::string&
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	const std::string& viewServerName(
+		const int16_t& inServerIndex) const;
+
+	//------------------------------------------------------- viewServerEndpoint
+	// Brief Description
+	//  Returns the address and listening port of the server associated with
+	//  the given server index.
+	//
+	// Method:    viewServerEndpoint
+	// FullName:  serverTopology::viewServerEndpoint
+	// Access:    public
+	// Returns:   const boost::asio::ip::udp::endpoint&
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	const boost::asio::ip::udp::endpoint& viewServerEndpoint(
+		const int16_t& inServerIndex) const;
+
+	//-------------------------------------------------------- setServerEndpoint
+	// Brief Description
+	//  Sets where the server at the given index is sent to. A server listens
+	//  on the port of its own endpoint, so a proxy can be put in front of
+	//  the others by changing theirs.
+	//
+	// Method:    setServerEndpoint
+	// FullName:  serverTopology::setServerEndpoint
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	// Parameter: const boost::asio::ip::udp::endpoint& inServerEndpoint
+	//--------------------------------------------------------------------------
+	void setServerEndpoint(
+		const int16_t& inServerIndex,
+		const boost::asio::ip::udp::endpoint& inServerEndpoint);
+
+	//------------------------------------------------ serverIndexFromIdentifier
+	// Brief Description
+	//  Converts what a user typed to select a server into its index. Either
+	//  the server's name (case insensitive) or a single letter, where 'a' is
+	//  the first server, is accepted. Returns -1 if nothing matches.
+	//
+	// Method:    serverIndexFromIdentifier
+	// FullName:  serverTopology::serverIndexFromIdentifier
+	// Access:    public
+	// Returns:   int16_t
+	// Parameter: const std::string& inIdentifier
+	//--------------------------------------------------------------------------
+	int16_t serverIndexFromIdentifier(
+		const std::string& inIdentifier) const;
+
+	//------------------------------------------------------ serverNamesAsString
+	// Brief Description
+	//  Returns the server names as a comma separated list, for prompts.
+	//
+	// Method:    serverNamesAsString
+	// FullName:  serverTopology::serverNamesAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string serverNamesAsString() const;
+
+	//---------------------------------------------------------- viewRoutingMode
+	// Brief Description
+	//  Returns how servers are connected to each other.
+	//
+	// Method:    viewRoutingMode
+	// FullName:  serverTopology::viewRoutingMode
+	// Access:    public
+	// Returns:   const serverTopology::RoutingMode&
+	//--------------------------------------------------------------------------
+	const serverTopology::RoutingMode& viewRoutingMode() const;
+
+	//----------------------------------------------------------- setRoutingMode
+	// Brief Description
+	//  Sets how servers are connected to each other.
+	//
+	// Method:    setRoutingMode
+	// FullName:  serverTopology::setRoutingMode
+	// Access:    public
+	// Returns:   void
+	// Parameter: const serverTopology::RoutingMode& inRoutingMode
+	//--------------------------------------------------------------------------
+	void setRoutingMode(
+		const serverTopology::RoutingMode& inRoutingMode);
+
+	//------------------------------------------------------------------ addLink
+	// Brief Description
+	//  Connects two servers in the overlay. Links work both ways.
+	//
+	// Method:    addLink
+	// FullName:  serverTopology::addLink
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int16_t& inFirstServerIndex
+	// Parameter: const int16_t& inSecondServerIndex
+	//--------------------------------------------------------------------------
+	void addLink(
+		const int16_t& inFirstServerIndex,
+		const int16_t& inSecondServerIndex);
+
+	//----------------------------------------------------------- viewNeighbours
+	// Brief Description
+	//  Returns the servers the given server exchanges messages with
+	//  directly under the current routing mode.
+	//
+	// Method:    viewNeighbours
+	// FullName:  serverTopology::viewNeighbours
+	// Access:    public
+	// Returns:   std::vector<int16_t>
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	std::vector<int16_t> viewNeighbours(
+		const int16_t& inServerIndex) const;
+
+	//----------------------------------------------------------------- distance
+	// Brief Description
+	//  Returns the number of hops on the shortest path between two servers
+	//  under the current routing mode, or -1 if there is no path.
+	//
+	// Method:    distance
+	// FullName:  serverTopology::distance
+	// Access:    public
+	// Returns:   int16_t
+	// Parameter: const int16_t& inFromServerIndex
+	// Parameter: const int16_t& inToServerIndex
+	//--------------------------------------------------------------------------
+	int16_t distance(
+		const int16_t& inFromServerIndex,
+		const int16_t& inToServerIndex) const;
+
+	//------------------------------------------------------ routingModeAsString
+	// Brief Description
+	//  Returns the routing mode as it is written in the configuration file.
+	//
+	// Method:    routingModeAsString
+	// FullName:  serverTopology::routingModeAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string routingModeAsString() const;
+
+	//---------------------------------------- viewHeartbeatIntervalMilliseconds
+	// Brief Description
+	//  Returns how often a server pings its neighbouring servers.
+	//
+	// Method:    viewHeartbeatIntervalMilliseconds
+	// FullName:  serverTopology::viewHeartbeatIntervalMilliseconds
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewHeartbeatIntervalMilliseconds() const;
+
+	//----------------------------------------- viewSuspicionTimeoutMilliseconds
+	// Brief Description
+	//  Returns how long a neighbouring server may stay silent before it is
+	//  considered down.
+	//
+	// Method:    viewSuspicionTimeoutMilliseconds
+	// FullName:  serverTopology::viewSuspicionTimeoutMilliseconds
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewSuspicionTimeoutMilliseconds() const;
+
+	//------------------------------------------------------------- setHeartbeat
+	// Brief Description
+	//  Sets how often servers ping each other and how long a server may stay
+	//  silent before it is considered down.
+	//
+	// Method:    setHeartbeat
+	// FullName:  serverTopology::setHeartbeat
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint16_t& inHeartbeatIntervalMilliseconds
+	// Parameter: const uint16_t& inSuspicionTimeoutMilliseconds
+	//--------------------------------------------------------------------------
+	void setHeartbeat(
+		const uint16_t& inHeartbeatIntervalMilliseconds,
+		const uint16_t& inSuspicionTimeoutMilliseconds);
+
+	//---------------------------------------------- viewReorderHoldMilliseconds
+	// Brief Description
+	//  Returns how long a client holds a message that arrived before an
+	//  earlier one from the same sender, waiting for the earlier one.
+	//
+	// Method:    viewReorderHoldMilliseconds
+	// FullName:  serverTopology::viewReorderHoldMilliseconds
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewReorderHoldMilliseconds() const;
+
+	//----------------------------------------------------------- setReorderHold
+	// Brief Description
+	//  Sets how long a client holds a message that arrived out of order.
+	//  0 shows messages as soon as they arrive.
+	//
+	// Method:    setReorderHold
+	// FullName:  serverTopology::setReorderHold
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint16_t& inReorderHoldMilliseconds
+	//--------------------------------------------------------------------------
+	void setReorderHold(
+		const uint16_t& inReorderHoldMilliseconds);
+
+	//------------------------------------------- viewSessionTimeoutMilliseconds
+	// Brief Description
+	//  Returns how long a server keeps a client that it has not heard from.
+	//
+	// Method:    viewSessionTimeoutMilliseconds
+	// FullName:  serverTopology::viewSessionTimeoutMilliseconds
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewSessionTimeoutMilliseconds() const;
+
+	//-------------------------------------------------------- setSessionTimeout
+	// Brief Description
+	//  Sets how long a server keeps a client that it has not heard from. The
+	//  client is then disconnected as if it had exited.
+	//
+	// Method:    setSessionTimeout
+	// FullName:  serverTopology::setSessionTimeout
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint16_t& inSessionTimeoutMilliseconds
+	//--------------------------------------------------------------------------
+	void setSessionTimeout(
+		const uint16_t& inSessionTimeoutMilliseconds);
+
+	//---------------------------------------- viewMessageTimeToLiveMilliseconds
+	// Brief Description
+	//  Returns how long a server keeps a message it has not delivered, when
+	//  the message does not carry its own time to live.
+	//
+	// Method:    viewMessageTimeToLiveMilliseconds
+	// FullName:  serverTopology::viewMessageTimeToLiveMilliseconds
+	// Access:    public
+	// Returns:   const uint32_t&
+	//--------------------------------------------------------------------------
+	const uint32_t& viewMessageTimeToLiveMilliseconds() const;
+
+	//----------------------------------------------------- setMessageTimeToLive
+	// Brief Description
+	//  Sets how long a server keeps a message it has not delivered. The
+	//  message is then dropped and counted as expired.
+	//
+	// Method:    setMessageTimeToLive
+	// FullName:  serverTopology::setMessageTimeToLive
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint32_t& inMessageTimeToLiveMilliseconds
+	//--------------------------------------------------------------------------
+	void setMessageTimeToLive(
+		const uint32_t& inMessageTimeToLiveMilliseconds);
+
+	//------------------------------------------------------- viewSpoolDirectory
+	// Brief Description
+	//  Returns the directory servers keep their undelivered messages in,
+	//  one subdirectory per server. Empty if they are only kept in memory.
+	//
+	// Method:    viewSpoolDirectory
+	// FullName:  serverTopology::viewSpoolDirectory
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewSpoolDirectory() const;
+
+	//-------------------------------------------------------- setSpoolDirectory
+	// Brief Description
+	//  Sets the directory servers keep their undelivered messages in, so
+	//  they survive a restart. Empty keeps them in memory only.
+	//
+	// Method:    setSpoolDirectory
+	// FullName:  serverTopology::setSpoolDirectory
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inSpoolDirectory
+	//--------------------------------------------------------------------------
+	void setSpoolDirectory(
+		const std::string& inSpoolDirectory);
+
+	//------------------------------------------------------------- viewLogLevel
+	// Brief Description
+	//  Returns the most verbose level servers log at.
+	//
+	// Method:    viewLogLevel
+	// FullName:  serverTopology::viewLogLevel
+	// Access:    public
+	// Returns:   const asyncLog::LogLevel&
+	//--------------------------------------------------------------------------
+	const asyncLog::LogLevel& viewLogLevel() const;
+
+	//-------------------------------------------------------- viewTraceSampling
+	// Brief Description
+	//  Returns N, where servers only log 1 in N trace lines.
+	//
+	// Method:    viewTraceSampling
+	// FullName:  serverTopology::viewTraceSampling
+	// Access:    public
+	// Returns:   const uint32_t&
+	//--------------------------------------------------------------------------
+	const uint32_t& viewTraceSampling() const;
+
+	//-------------------------------------------------------------- setLogLevel
+	// Brief Description
+	//  Sets the most verbose level servers log at, and how many trace lines
+	//  they skip for each one logged. The default, trace with every line
+	//  kept, logs every message received.
+	//
+	// Method:    setLogLevel
+	// FullName:  serverTopology::setLogLevel
+	// Access:    public
+	// Returns:   void
+	// Parameter: const asyncLog::LogLevel& inLogLevel
+	// Parameter: const uint32_t& inTraceSampling
+	//--------------------------------------------------------------------------
+	void setLogLevel(
+		const asyncLog::LogLevel& inLogLevel,
+		const uint32_t& inTraceSampling);
+
+	//----------------------------------------------------- viewMetricsDirectory
+	// Brief Description
+	//  Returns the directory servers write their metrics to, one file per
+	//  server. Empty if they do not write them.
+	//
+	// Method:    viewMetricsDirectory
+	// FullName:  serverTopology::viewMetricsDirectory
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewMetricsDirectory() const;
+
+	//------------------------------------------ viewMetricsIntervalMilliseconds
+	// Brief Description
+	//  Returns how often servers write their metrics.
+	//
+	// Method:    viewMetricsIntervalMilliseconds
+	// FullName:  serverTopology::viewMetricsIntervalMilliseconds
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewMetricsIntervalMilliseconds() const;
+
+	//--------------------------------------------------------- setMetricsExport
+	// Brief Description
+	//  Sets the directory servers write their metrics to and how often.
+	//  Empty stops them writing metrics.
+	//
+	// Method:    setMetricsExport
+	// FullName:  serverTopology::setMetricsExport
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inMetricsDirectory
+	// Parameter: const uint16_t& inMetricsIntervalMilliseconds
+	//--------------------------------------------------------------------------
+	void setMetricsExport(
+		const std::string& inMetricsDirectory,
+		const uint16_t& inMetricsIntervalMilliseconds);
+
+	//------------------------------------------------ viewMessageTraceDirectory
+	// Brief Description
+	//  Returns the directory servers write the traces of the messages they
+	//  deliver to, one file per server. Empty if no message is traced.
+	//
+	// Method:    viewMessageTraceDirectory
+	// FullName:  serverTopology::viewMessageTraceDirectory
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewMessageTraceDirectory() const;
+
+	//------------------------------------------------- viewMessageTraceSampling
+	// Brief Description
+	//  Returns N, where servers trace 1 in N messages sent by their clients.
+	//
+	// Method:    viewMessageTraceSampling
+	// FullName:  serverTopology::viewMessageTraceSampling
+	// Access:    public
+	// Returns:   const uint32_t&
+	//--------------------------------------------------------------------------
+	const uint32_t& viewMessageTraceSampling() const;
+
+	//-------------------------------------------------------- setMessageTracing
+	// Brief Description
+	//  Sets the directory servers write message traces to, and how many
+	//  messages they let through for each one traced. An empty directory
+	//  turns tracing off.
+	//
+	// Method:    setMessageTracing
+	// FullName:  serverTopology::setMessageTracing
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inMessageTraceDirectory
+	// Parameter: const uint32_t& inMessageTraceSampling
+	//--------------------------------------------------------------------------
+	void setMessageTracing(
+		const std::string& inMessageTraceDirectory,
+		const uint32_t& inMessageTraceSampling);
+
+	//----------------------------------------------------- viewCaptureDirectory
+	// Brief Description
+	//  Returns the directory servers record the datagrams they receive to,
+	//  one capture file per server. Empty if they do not record them.
+	//
+	// Method:    viewCaptureDirectory
+	// FullName:  serverTopology::viewCaptureDirectory
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewCaptureDirectory() const;
+
+	//------------------------------------------------------ setCaptureDirectory
+	// Brief Description
+	//  Sets the directory servers record the datagrams they receive to, to
+	//  be replayed later. Empty turns recording off.
+	//
+	// Method:    setCaptureDirectory
+	// FullName:  serverTopology::setCaptureDirectory
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inCaptureDirectory
+	//--------------------------------------------------------------------------
+	void setCaptureDirectory(
+		const std::string& inCaptureDirectory);
+
+	//------------------------------------------------- viewMembershipFilterBits
+	// Brief Description
+	//  Returns the size of the Bloom filters servers sync their client
+	//  lists as, or 0 if they sync the full lists.
+	//
+	// Method:    viewMembershipFilterBits
+	// FullName:  serverTopology::viewMembershipFilterBits
+	// Access:    public
+	// Returns:   const uint16_t&
+	//--------------------------------------------------------------------------
+	const uint16_t& viewMembershipFilterBits() const;
+
+	//-------------------------------------------------- setMembershipFilterBits
+	// Brief Description
+	//  Sets the size of the Bloom filters servers sync their client lists
+	//  as. 0 syncs the full lists.
+	//
+	// Method:    setMembershipFilterBits
+	// FullName:  serverTopology::setMembershipFilterBits
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint16_t& inMembershipFilterBits
+	//--------------------------------------------------------------------------
+	void setMembershipFilterBits(
+		const uint16_t& inMembershipFilterBits);
+
+private:
+
+	//---------------------------------------------------------------- addServer
+	// Brief Description
+	//  Appends a server to the topology, it is assigned the next index.
+	//  Throws a std::runtime_error if the name is already in use, or if the
+	//  topology already has the most servers sessions can tell apart.
+	//
+	// Method:    addServer
+	// FullName:  serverTopology::addServer
+	// Access:    private
+	// Returns:   void
+	// Parameter: const std::string& inServerName
+	// Parameter: const boost::asio::ip::udp::endpoint& inServerEndpoint
+	//--------------------------------------------------------------------------
+	void addServer(
+		const std::string& inServerName,
+		const boost::asio::ip::udp::endpoint& inServerEndpoint);
+
+	//-------------------------------------------------- computeOverlayDistances
+	// Brief Description
+	//  Recomputes the hop count between every pair of servers in the
+	//  overlay, one breadth first search per server.
+	//
+	// Method:    computeOverlayDistances
+	// FullName:  serverTopology::computeOverlayDistances
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void computeOverlayDistances();
+
+	// Member Variables
+	std::vector<std::string> m_serverNames;
+	std::vector<boost::asio::ip::udp::endpoint> m_serverEndpoints;
+	serverTopology::RoutingMode m_routingMode;
+	std::vector<std::vector<int16_t>> m_overlayLinks;
+	std::vector<std::vector<int16_t>> m_overlayDistances;
+	uint16_t m_heartbeatIntervalMilliseconds;
+	uint16_t m_suspicionTimeoutMilliseconds;
+	uint16_t m_reorderHoldMilliseconds;
+	uint16_t m_sessionTimeoutMilliseconds;
+	uint32_t m_messageTimeToLiveMilliseconds;
+	std::string m_spoolDirectory;
+	asyncLog::LogLevel m_logLevel;
+	uint32_t m_traceSampling;
+	std::string m_metricsDirectory;
+	uint16_t m_metricsIntervalMilliseconds;
+	std::string m_messageTraceDirectory;
+	uint32_t m_messageTraceSampling;
+	std::string m_captureDirectory;
+	uint16_t m_membershipFilterBits;
+};
\ No newline at end of file
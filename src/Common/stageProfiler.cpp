@@ -0,0 +1,371 @@
+// STL
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+// Boost
+#include <boost/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+// Project
+#include "stageProfiler.h"
+#include "constants.h"
+
+#ifdef CPSC3780_PROFILE
+
+namespace
+{
+	//----------------------------------------------------------- nowNanoseconds
+	// Implementation notes:
+	//  The steady clock, stages are only compared within this process
+	//--------------------------------------------------------------------------
+	int64_t nowNanoseconds()
+	{
+		return boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+			boost::chrono::steady_clock::now().time_since_epoch()).count();
+	};
+}
+
+//---------------------------------------------------------------- threadProfile
+// Implementation notes:
+//  The open stages are only touched by the thread that owns the profile.
+//  The totals and the most recent stages are updated by it as stages
+//  close, under a mutex no other thread takes except to report.
+//------------------------------------------------------------------------------
+class stageProfiler::threadProfile
+{
+public:
+	class openStage
+	{
+	public:
+		openStage(
+			const char* inName,
+			const int64_t& inStartNanoseconds) :
+			m_name(inName),
+			m_startNanoseconds(inStartNanoseconds),
+			m_nestedNanoseconds(0)
+		{
+		};
+
+		const char* m_name;
+		int64_t m_startNanoseconds;
+		int64_t m_nestedNanoseconds;
+	};
+
+	class stageTotals
+	{
+	public:
+		stageTotals() :
+			m_calls(0),
+			m_nanoseconds(0),
+			m_selfNanoseconds(0)
+		{
+		};
+
+		uint64_t m_calls;
+		int64_t m_nanoseconds;
+
+		// not spent in nested stages
+		int64_t m_selfNanoseconds;
+	};
+
+	class completedStage
+	{
+	public:
+		completedStage() :
+			m_name(nullptr),
+			m_startNanoseconds(0),
+			m_nanoseconds(0)
+		{
+		};
+
+		const char* m_name;
+		int64_t m_startNanoseconds;
+		int64_t m_nanoseconds;
+	};
+
+	threadProfile(
+		const uint32_t& inThreadNumber) :
+		m_threadNumber(inThreadNumber),
+		m_stages(constants::profileStagesPerThread),
+		m_stagesCompleted(0)
+	{
+	};
+
+	const uint32_t m_threadNumber;
+
+	// the names of the open stages are also kept on their own, as the key
+	// of the totals
+	std::vector<openStage> m_open;
+	std::vector<const char*> m_path;
+
+	boost::mutex m_mutex;
+	std::map<std::vector<const char*>, stageTotals> m_totalsByPath;
+
+	// a ring of the most recent stages, for the Chrome trace
+	std::vector<completedStage> m_stages;
+	uint64_t m_stagesCompleted;
+};
+
+//-------------------------------------------------------------- profileRegistry
+// Implementation notes:
+//  Profiles are kept after their thread exits, so they are still reported
+//------------------------------------------------------------------------------
+class stageProfiler::profileRegistry
+{
+public:
+	profileRegistry() :
+		m_startNanoseconds(nowNanoseconds())
+	{
+	};
+
+	const int64_t m_startNanoseconds;
+
+	boost::mutex m_mutex;
+	std::vector<boost::shared_ptr<threadProfile>> m_profiles;
+};
+
+//-------------------------------------------------------------------- isEnabled
+// Implementation notes:
+//  This build times stages
+//------------------------------------------------------------------------------
+bool stageProfiler::isEnabled()
+{
+	return true;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  Each thread's totals are copied under its mutex, so the thread is only
+//  held up for the copy
+//------------------------------------------------------------------------------
+std::string stageProfiler::asString()
+{
+	profileRegistry& profiles = stageProfiler::registry();
+
+	boost::lock_guard<boost::mutex> lock(profiles.m_mutex);
+
+	std::stringstream ss;
+
+	for(const boost::shared_ptr<threadProfile>& profile : profiles.m_profiles)
+	{
+		std::map<std::vector<const char*>, threadProfile::stageTotals> totalsByPath;
+
+		{
+			boost::lock_guard<boost::mutex> profileLock(profile->m_mutex);
+			totalsByPath = profile->m_totalsByPath;
+		}
+
+		for(const auto& totals : totalsByPath)
+		{
+			ss << "thread " << profile->m_threadNumber << " " << totals.first.front();
+
+			for(size_t i = 1; i < totals.first.size(); i++)
+			{
+				ss << ";" << totals.first[i];
+			}
+
+			ss << " calls " << totals.second.m_calls
+				<< ", total " << totals.second.m_nanoseconds / 1000
+				<< " us, self " << totals.second.m_selfNanoseconds / 1000
+				<< " us, mean " << totals.second.m_nanoseconds / static_cast<int64_t>(totals.second.m_calls)
+				<< " ns\n";
+		}
+	}
+
+	return ss.str();
+};
+
+//------------------------------------------------------------------- writeFiles
+// Implementation notes:
+//  Chrome trace times are in microseconds, from when the first stage was
+//  opened. Stages shorter than a microsecond are kept with a fraction.
+//------------------------------------------------------------------------------
+bool stageProfiler::writeFiles(
+	const std::string& inPathPrefix)
+{
+	profileRegistry& profiles = stageProfiler::registry();
+
+	boost::lock_guard<boost::mutex> lock(profiles.m_mutex);
+
+	std::ofstream folded(
+		(inPathPrefix + ".folded").c_str(),
+		std::ios::trunc);
+
+	std::ofstream chromeTrace(
+		(inPathPrefix + ".json").c_str(),
+		std::ios::trunc);
+
+	chromeTrace << "{\"traceEvents\":[";
+
+	bool firstStage = true;
+
+	for(const boost::shared_ptr<threadProfile>& profile : profiles.m_profiles)
+	{
+		boost::lock_guard<boost::mutex> profileLock(profile->m_mutex);
+
+		for(const auto& totals : profile->m_totalsByPath)
+		{
+			folded << "thread " << profile->m_threadNumber;
+
+			for(const char* name : totals.first)
+			{
+				folded << ";" << name;
+			}
+
+			folded << " " << totals.second.m_selfNanoseconds / 1000 << "\n";
+		}
+
+		const uint64_t stagesKept = std::min<uint64_t>(
+			profile->m_stagesCompleted,
+			profile->m_stages.size());
+
+		for(uint64_t i = 0; i < stagesKept; i++)
+		{
+			const threadProfile::completedStage& stage = profile->m_stages[i];
+
+			chromeTrace << (firstStage ? "\n" : ",\n")
+				<< "{\"name\":\"" << stage.m_name
+				<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << profile->m_threadNumber
+				<< ",\"ts\":" << (stage.m_startNanoseconds - profiles.m_startNanoseconds) / 1000.0
+				<< ",\"dur\":" << stage.m_nanoseconds / 1000.0 << "}";
+
+			firstStage = false;
+		}
+	}
+
+	chromeTrace << "\n]}\n";
+
+	return folded.good() && chromeTrace.good();
+};
+
+//------------------------------------------------------------------------ enter
+// Implementation notes:
+//  The clock is read last, so registering the thread is not timed
+//------------------------------------------------------------------------------
+void stageProfiler::enter(
+	const char* inName)
+{
+	threadProfile& profile = stageProfiler::profileOfThread();
+
+	profile.m_path.push_back(inName);
+
+	profile.m_open.push_back(threadProfile::openStage(
+		inName,
+		nowNanoseconds()));
+};
+
+//------------------------------------------------------------------------ leave
+// Implementation notes:
+//  The stage's time is added to the stage it is nested in, which subtracts
+//  it from its own time when it closes
+//------------------------------------------------------------------------------
+void stageProfiler::leave()
+{
+	const int64_t now = nowNanoseconds();
+
+	threadProfile& profile = stageProfiler::profileOfThread();
+
+	if(profile.m_open.empty())
+	{
+		return;
+	}
+
+	const threadProfile::openStage& stage = profile.m_open.back();
+	const int64_t elapsed = now - stage.m_startNanoseconds;
+
+	{
+		boost::lock_guard<boost::mutex> lock(profile.m_mutex);
+
+		threadProfile::stageTotals& totals = profile.m_totalsByPath[profile.m_path];
+
+		totals.m_calls++;
+		totals.m_nanoseconds += elapsed;
+		totals.m_selfNanoseconds += elapsed - stage.m_nestedNanoseconds;
+
+		threadProfile::completedStage& completed =
+			profile.m_stages[profile.m_stagesCompleted++ % profile.m_stages.size()];
+
+		completed.m_name = stage.m_name;
+		completed.m_startNanoseconds = stage.m_startNanoseconds;
+		completed.m_nanoseconds = elapsed;
+	}
+
+	profile.m_open.pop_back();
+	profile.m_path.pop_back();
+
+	if(!profile.m_open.empty())
+	{
+		profile.m_open.back().m_nestedNanoseconds += elapsed;
+	}
+};
+
+//-------------------------------------------------------------- profileOfThread
+// Implementation notes:
+//  Threads are numbered in the order they first open a stage
+//------------------------------------------------------------------------------
+stageProfiler::threadProfile& stageProfiler::profileOfThread()
+{
+	thread_local threadProfile* profile = nullptr;
+
+	if(profile == nullptr)
+	{
+		profileRegistry& profiles = stageProfiler::registry();
+
+		boost::lock_guard<boost::mutex> lock(profiles.m_mutex);
+
+		profiles.m_profiles.push_back(boost::shared_ptr<threadProfile>(
+			new threadProfile(static_cast<uint32_t>(profiles.m_profiles.size()))));
+
+		profile = profiles.m_profiles.back().get();
+	}
+
+	return *profile;
+};
+
+//--------------------------------------------------------------------- registry
+// Implementation notes:
+//  A function static, so it exists before the first stage of any thread
+//------------------------------------------------------------------------------
+stageProfiler::profileRegistry& stageProfiler::registry()
+{
+	static profileRegistry profiles;
+
+	return profiles;
+};
+
+#else
+
+//-------------------------------------------------------------------- isEnabled
+// Implementation notes:
+//  This build does not time stages
+//------------------------------------------------------------------------------
+bool stageProfiler::isEnabled()
+{
+	return false;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  Nothing to report
+//------------------------------------------------------------------------------
+std::string stageProfiler::asString()
+{
+	return "";
+};
+
+//------------------------------------------------------------------- writeFiles
+// Implementation notes:
+//  No files are written
+//------------------------------------------------------------------------------
+bool stageProfiler::writeFiles(
+	const std::string&)
+{
+	return false;
+};
+
+#endif
\ No newline at end of file
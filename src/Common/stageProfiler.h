@@ -0,0 +1,132 @@
+#pragma once
+
+// STL
+#include <string>
+#include <cstdint>
+
+// Stages are only timed in builds with CPSC3780_PROFILE defined. In other
+// builds a scopedStage is empty and compiles to nothing.
+class stageProfiler
+{
+public:
+
+	// Times the scope it is declared in. Stages opened while it is open on
+	// the same thread are nested under it. The name must be a string
+	// literal, it is kept by pointer.
+	class scopedStage
+	{
+	public:
+#ifdef CPSC3780_PROFILE
+		explicit scopedStage(
+			const char* inName)
+		{
+			stageProfiler::enter(inName);
+		};
+
+		~scopedStage()
+		{
+			stageProfiler::leave();
+		};
+#else
+		explicit scopedStage(
+			const char*)
+		{
+		};
+#endif
+	};
+
+	//---------------------------------------------------------------- isEnabled
+	// Brief Description
+	//  Returns true if this build times stages.
+	//
+	// Method:    isEnabled
+	// FullName:  stageProfiler::isEnabled
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	static bool isEnabled();
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns one line per thread and nesting of stages, with the number
+	//  of calls, the total time and the time not spent in nested stages,
+	//  in microseconds, and the mean time per call in nanoseconds. Empty
+	//  if this build does not time stages.
+	//
+	// Method:    asString
+	// FullName:  stageProfiler::asString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	static std::string asString();
+
+	//--------------------------------------------------------------- writeFiles
+	// Brief Description
+	//  Writes <prefix>.folded, the time not spent in nested stages of each
+	//  nesting as "thread;stage;stage microseconds" lines for flame graph
+	//  tools, and <prefix>.json, the most recent stages of each thread as
+	//  a Chrome trace. Returns false if this build does not time stages or
+	//  a file could not be written.
+	//
+	// Method:    writeFiles
+	// FullName:  stageProfiler::writeFiles
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::string& inPathPrefix
+	//--------------------------------------------------------------------------
+	static bool writeFiles(
+		const std::string& inPathPrefix);
+
+private:
+
+	class threadProfile;
+	class profileRegistry;
+
+	//-------------------------------------------------------------------- enter
+	// Brief Description
+	//  Opens a stage on the calling thread.
+	//
+	// Method:    enter
+	// FullName:  stageProfiler::enter
+	// Access:    private
+	// Returns:   void
+	// Parameter: const char* inName
+	//--------------------------------------------------------------------------
+	static void enter(
+		const char* inName);
+
+	//-------------------------------------------------------------------- leave
+	// Brief Description
+	//  Closes the innermost open stage of the calling thread and adds its
+	//  time to the thread's totals.
+	//
+	// Method:    leave
+	// FullName:  stageProfiler::leave
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	static void leave();
+
+	//---------------------------------------------------------- profileOfThread
+	// Brief Description
+	//  Returns the calling thread's profile, registering it the first time.
+	//
+	// Method:    profileOfThread
+	// FullName:  stageProfiler::profileOfThread
+	// Access:    private
+	// Returns:   stageProfiler::threadProfile&
+	//--------------------------------------------------------------------------
+	static threadProfile& profileOfThread();
+
+	//----------------------------------------------------------------- registry
+	// Brief Description
+	//  Returns the profiles of every thread that opened a stage, created on
+	//  first use.
+	//
+	// Method:    registry
+	// FullName:  stageProfiler::registry
+	// Access:    private
+	// Returns:   stageProfiler::profileRegistry&
+	//--------------------------------------------------------------------------
+	static profileRegistry& registry();
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+// STL
+#include <sstream>
+#include <string>
+
+// Project
+#include "backlogAccounting.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Nothing admitted yet
+//------------------------------------------------------------------------------
+backlogAccounting::backlogAccounting(
+	const uint32_t& inRecipientMessageQuota,
+	const uint32_t& inRecipientByteQuota,
+	const uint32_t& inServerMessageQuota,
+	const uint32_t& inServerByteQuota) :
+	m_recipientMessageQuota(inRecipientMessageQuota),
+	m_recipientByteQuota(inRecipientByteQuota),
+	m_serverMessageQuota(inServerMessageQuota),
+	m_serverByteQuota(inServerByteQuota),
+	m_messages(0),
+	m_bytes(0),
+	m_deadLetters(dl_COUNT, 0)
+{
+};
+
+//------------------------------------------------------------------------ admit
+// Implementation notes:
+//  The server quota is checked first, a recipient is not blamed for the
+//  server being full
+//------------------------------------------------------------------------------
+bool backlogAccounting::admit(
+	const std::string& inRecipient,
+	const size_t& inBytes)
+{
+	if(this->m_messages + 1 > this->m_serverMessageQuota
+		|| this->m_bytes + inBytes > this->m_serverByteQuota)
+	{
+		this->recordDeadLetter(
+			dl_SERVER_QUOTA);
+
+		return false;
+	}
+
+	recipientUsage& usage = this->m_usageByRecipient[inRecipient];
+
+	if(usage.m_messages + 1 > this->m_recipientMessageQuota
+		|| usage.m_bytes + inBytes > this->m_recipientByteQuota)
+	{
+		if(usage.m_messages == 0)
+		{
+			this->m_usageByRecipient.erase(
+				inRecipient);
+		}
+
+		this->recordDeadLetter(
+			dl_RECIPIENT_QUOTA);
+
+		return false;
+	}
+
+	usage.m_messages++;
+	usage.m_bytes += inBytes;
+
+	this->m_messages++;
+	this->m_bytes += inBytes;
+
+	return true;
+};
+
+//---------------------------------------------------------------------- release
+// Implementation notes:
+//  A recipient with nothing left is forgotten, so the map only holds the
+//  recipients that have a backlog
+//------------------------------------------------------------------------------
+void backlogAccounting::release(
+	const std::string& inRecipient,
+	const size_t& inBytes)
+{
+	std::map<std::string, recipientUsage>::iterator usage =
+		this->m_usageByRecipient.find(inRecipient);
+
+	if(usage == this->m_usageByRecipient.end())
+	{
+		return;
+	}
+
+	usage->second.m_messages--;
+	usage->second.m_bytes -= inBytes;
+
+	this->m_messages--;
+	this->m_bytes -= inBytes;
+
+	if(usage->second.m_messages == 0)
+	{
+		this->m_usageByRecipient.erase(
+			usage);
+	}
+};
+
+//------------------------------------------------------------- recordDeadLetter
+// Implementation notes:
+//  Counted by reason
+//------------------------------------------------------------------------------
+void backlogAccounting::recordDeadLetter(
+	const DeadLetterReason& inReason)
+{
+	this->m_deadLetters[inReason]++;
+};
+
+//-------------------------------------------------------------- viewDeadLetters
+// Implementation notes:
+//  Returns a const reference to the count for the reason
+//------------------------------------------------------------------------------
+const uint64_t& backlogAccounting::viewDeadLetters(
+	const DeadLetterReason& inReason) const
+{
+	return this->m_deadLetters[inReason];
+};
+
+//----------------------------------------------------------------- viewMessages
+// Implementation notes:
+//  Returns a const reference to the number of messages kept
+//------------------------------------------------------------------------------
+const uint64_t& backlogAccounting::viewMessages() const
+{
+	return this->m_messages;
+};
+
+//-------------------------------------------------------------------- viewBytes
+// Implementation notes:
+//  Returns a const reference to the payload bytes kept
+//------------------------------------------------------------------------------
+const uint64_t& backlogAccounting::viewBytes() const
+{
+	return this->m_bytes;
+};
+
+//----------------------------------------------------------- statisticsAsString
+// Implementation notes:
+//  Same layout as the outbox statistics
+//------------------------------------------------------------------------------
+std::string backlogAccounting::statisticsAsString() const
+{
+	std::stringstream ss;
+
+	ss << "backlog " << this->m_messages << " messages"
+		<< ", " << this->m_bytes << " bytes"
+		<< ", expired " << this->m_deadLetters[dl_EXPIRED]
+		<< ", over recipient quota " << this->m_deadLetters[dl_RECIPIENT_QUOTA]
+		<< ", over server quota " << this->m_deadLetters[dl_SERVER_QUOTA]
+		<< ", recipient gone " << this->m_deadLetters[dl_RECIPIENT_GONE];
+
+	return ss.str();
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class backlogAccounting
+{
+public:
+
+	enum DeadLetterReason
+	{
+		dl_EXPIRED,
+		dl_RECIPIENT_QUOTA,
+		dl_SERVER_QUOTA,
+		dl_RECIPIENT_GONE,
+		dl_COUNT
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the accounting of the messages a server keeps for
+	//  recipients, both those waiting for their client to get them and those
+	//  held until their destination is known. Each recipient may have at most
+	//  the given number of messages and payload bytes, and so may the server
+	//  over every recipient. Messages given up on are counted as dead
+	//  letters, by reason.
+	//
+	// Method:    backlogAccounting
+	// FullName:  backlogAccounting::backlogAccounting
+	// Access:    public
+	// Returns:
+	// Parameter: const uint32_t& inRecipientMessageQuota
+	// Parameter: const uint32_t& inRecipientByteQuota
+	// Parameter: const uint32_t& inServerMessageQuota
+	// Parameter: const uint32_t& inServerByteQuota
+	//--------------------------------------------------------------------------
+	backlogAccounting(
+		const uint32_t& inRecipientMessageQuota,
+		const uint32_t& inRecipientByteQuota,
+		const uint32_t& inServerMessageQuota,
+		const uint32_t& inServerByteQuota);
+
+	//-------------------------------------------------------------------- admit
+	// Brief Description
+	//  Charges a message of the given payload size to the recipient and
+	//  returns true if both quotas allow it. Otherwise counts it as a dead
+	//  letter and returns false, and the message must be dropped.
+	//
+	// Method:    admit
+	// FullName:  backlogAccounting::admit
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const std::string& inRecipient
+	// Parameter: const size_t& inBytes
+	//--------------------------------------------------------------------------
+	bool admit(
+		const std::string& inRecipient,
+		const size_t& inBytes);
+
+	//------------------------------------------------------------------ release
+	// Brief Description
+	//  Returns a message admitted for the recipient to the quotas, once it
+	//  was delivered, handed on or given up on.
+	//
+	// Method:    release
+	// FullName:  backlogAccounting::release
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inRecipient
+	// Parameter: const size_t& inBytes
+	//--------------------------------------------------------------------------
+	void release(
+		const std::string& inRecipient,
+		const size_t& inBytes);
+
+	//--------------------------------------------------------- recordDeadLetter
+	// Brief Description
+	//  Counts a message given up on for the given reason.
+	//
+	// Method:    recordDeadLetter
+	// FullName:  backlogAccounting::recordDeadLetter
+	// Access:    public
+	// Returns:   void
+	// Parameter: const DeadLetterReason& inReason
+	//--------------------------------------------------------------------------
+	void recordDeadLetter(
+		const DeadLetterReason& inReason);
+
+	//---------------------------------------------------------- viewDeadLetters
+	// Brief Description
+	//  Returns the number of messages given up on for the given reason.
+	//
+	// Method:    viewDeadLetters
+	// FullName:  backlogAccounting::viewDeadLetters
+	// Access:    public
+	// Returns:   const uint64_t&
+	// Parameter: const DeadLetterReason& inReason
+	//--------------------------------------------------------------------------
+	const uint64_t& viewDeadLetters(
+		const DeadLetterReason& inReason) const;
+
+	//------------------------------------------------------------- viewMessages
+	// Brief Description
+	//  Returns the number of messages the server keeps.
+	//
+	// Method:    viewMessages
+	// FullName:  backlogAccounting::viewMessages
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewMessages() const;
+
+	//---------------------------------------------------------------- viewBytes
+	// Brief Description
+	//  Returns the payload bytes of the messages the server keeps.
+	//
+	// Method:    viewBytes
+	// FullName:  backlogAccounting::viewBytes
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewBytes() const;
+
+	//------------------------------------------------------- statisticsAsString
+	// Brief Description
+	//  Returns the backlog and the dead letters on one line.
+	//
+	// Method:    statisticsAsString
+	// FullName:  backlogAccounting::statisticsAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string statisticsAsString() const;
+
+private:
+
+	class recipientUsage
+	{
+	public:
+		recipientUsage() :
+			m_messages(0),
+			m_bytes(0)
+		{
+		};
+
+		uint32_t m_messages;
+		uint64_t m_bytes;
+	};
+
+	// Member Variables
+	uint32_t m_recipientMessageQuota;
+	uint32_t m_recipientByteQuota;
+	uint32_t m_serverMessageQuota;
+	uint32_t m_serverByteQuota;
+
+	std::map<std::string, recipientUsage> m_usageByRecipient;
+	uint64_t m_messages;
+	uint64_t m_bytes;
+	std::vector<uint64_t> m_deadLetters;
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+// Project
+#include "bloomFilter.h"
+#include "../Common/constants.h"
+
+namespace
+{
+	// six bits to a character, and none of them a delimiter
+	const std::string encodingAlphabet(
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_");
+
+	const uint16_t maximumHashes = 16;
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  No bits, so mayContain() is always false
+//------------------------------------------------------------------------------
+bloomFilter::bloomFilter() :
+	m_hashes(0)
+{
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The best number of hashes is the bits per name times ln 2. A filter for
+//  more names than bits still gets one.
+//------------------------------------------------------------------------------
+bloomFilter::bloomFilter(
+	const uint16_t& inBits,
+	const size_t& inExpectedNames) :
+	m_bits(inBits, false)
+{
+	const double bestHashes = std::round(
+		static_cast<double>(inBits) / std::max<size_t>(inExpectedNames, 1) * std::log(2.0));
+
+	this->m_hashes = static_cast<uint16_t>(std::min<double>(
+		std::max<double>(bestHashes, 1.0),
+		maximumHashes));
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The size and hash count are checked before anything is allocated, so a
+//  corrupt datagram cannot ask for a huge filter
+//------------------------------------------------------------------------------
+bloomFilter::bloomFilter(
+	const std::string& inEncoded) :
+	m_hashes(0)
+{
+	std::stringstream fields(inEncoded);
+
+	std::string bitsAsString("");
+	std::string hashesAsString("");
+	std::string encodedBits("");
+
+	std::getline(fields, bitsAsString, constants::syncIdentifierDelimiter());
+	std::getline(fields, hashesAsString, constants::syncIdentifierDelimiter());
+	std::getline(fields, encodedBits, constants::syncIdentifierDelimiter());
+
+	const unsigned long bits = std::stoul(bitsAsString);
+	const unsigned long hashes = std::stoul(hashesAsString);
+
+	if(bits == 0
+		|| bits > constants::membershipFilterMaximumBits
+		|| hashes == 0
+		|| hashes > maximumHashes
+		|| encodedBits.size() != (bits + 5) / 6)
+	{
+		throw std::runtime_error(
+			"Malformed membership filter");
+	}
+
+	this->m_bits.assign(bits, false);
+	this->m_hashes = static_cast<uint16_t>(hashes);
+
+	for(size_t i = 0; i < encodedBits.size(); i++)
+	{
+		const size_t value = encodingAlphabet.find(encodedBits[i]);
+
+		if(value == std::string::npos)
+		{
+			throw std::runtime_error(
+				"Malformed membership filter");
+		}
+
+		for(size_t bit = 0; bit < 6 && 6 * i + bit < bits; bit++)
+		{
+			this->m_bits[6 * i + bit] = ((value >> bit) & 1) != 0;
+		}
+	}
+};
+
+//-------------------------------------------------------------------------- add
+// Implementation notes:
+//  Does nothing to an empty filter
+//------------------------------------------------------------------------------
+void bloomFilter::add(
+	const boost::string_view& inName)
+{
+	if(this->m_bits.empty())
+	{
+		return;
+	}
+
+	const uint64_t nameHash = bloomFilter::hashName(
+		inName);
+
+	for(uint16_t i = 0; i < this->m_hashes; i++)
+	{
+		this->m_bits[this->bitIndex(nameHash, i)] = true;
+	}
+};
+
+//------------------------------------------------------------------- mayContain
+// Implementation notes:
+//  Stops at the first bit that is not set
+//------------------------------------------------------------------------------
+bool bloomFilter::mayContain(
+	const boost::string_view& inName) const
+{
+	if(this->m_bits.empty())
+	{
+		return false;
+	}
+
+	const uint64_t nameHash = bloomFilter::hashName(
+		inName);
+
+	for(uint16_t i = 0; i < this->m_hashes; i++)
+	{
+		if(!this->m_bits[this->bitIndex(nameHash, i)])
+		{
+			return false;
+		}
+	}
+
+	return true;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  The last character holds fewer than six bits if the size is not a
+//  multiple of six
+//------------------------------------------------------------------------------
+std::string bloomFilter::asString() const
+{
+	std::string outEncoded(
+		std::to_string(this->m_bits.size()) + constants::syncIdentifierDelimiter()
+		+ std::to_string(this->m_hashes) + constants::syncIdentifierDelimiter());
+
+	for(size_t i = 0; i < this->m_bits.size(); i += 6)
+	{
+		size_t value = 0;
+
+		for(size_t bit = 0; bit < 6 && i + bit < this->m_bits.size(); bit++)
+		{
+			if(this->m_bits[i + bit])
+			{
+				value |= static_cast<size_t>(1) << bit;
+			}
+		}
+
+		outEncoded += encodingAlphabet[value];
+	}
+
+	return outEncoded;
+};
+
+//--------------------------------------------------------------------- viewBits
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+uint16_t bloomFilter::viewBits() const
+{
+	return static_cast<uint16_t>(this->m_bits.size());
+};
+
+//--------------------------------------------------------------------- bitIndex
+// Implementation notes:
+//  The second half of the hash is made odd so it is never 0, which would
+//  give every hash the same bit
+//------------------------------------------------------------------------------
+size_t bloomFilter::bitIndex(
+	const uint64_t& inNameHash,
+	const uint16_t& inHashIndex) const
+{
+	const uint64_t first = inNameHash & 0xFFFFFFFF;
+	const uint64_t second = (inNameHash >> 32) | 1;
+
+	return static_cast<size_t>(
+		(first + inHashIndex * second) % this->m_bits.size());
+};
+
+//--------------------------------------------------------------------- hashName
+// Implementation notes:
+//  Same hash as the name pool's index
+//------------------------------------------------------------------------------
+uint64_t bloomFilter::hashName(
+	const boost::string_view& inName)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(const char& character : inName)
+	{
+		hash ^= static_cast<unsigned char>(character);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/utility/string_view.hpp>
+
+// A set of names that can answer "no" exactly and "maybe" otherwise, in a
+// fixed number of bits however many names it holds. Servers sync their
+// client lists as these when the lists would not fit a datagram well.
+class bloomFilter
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty filter, which contains nothing.
+	//
+	// Method:    bloomFilter
+	// FullName:  bloomFilter::bloomFilter
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	bloomFilter();
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a filter of inBits bits sized for about
+	//  inExpectedNames names, which sets the number of hashes that makes
+	//  false positives least likely.
+	//
+	// Method:    bloomFilter
+	// FullName:  bloomFilter::bloomFilter
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inBits
+	// Parameter: const size_t& inExpectedNames
+	//--------------------------------------------------------------------------
+	bloomFilter(
+		const uint16_t& inBits,
+		const size_t& inExpectedNames);
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that reads a filter written by asString(). Throws a
+	//  std::runtime_error if it is malformed.
+	//
+	// Method:    bloomFilter
+	// FullName:  bloomFilter::bloomFilter
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inEncoded
+	//--------------------------------------------------------------------------
+	bloomFilter(
+		const std::string& inEncoded);
+
+	//---------------------------------------------------------------------- add
+	// Brief Description
+	//  Adds the name to the filter.
+	//
+	// Method:    add
+	// FullName:  bloomFilter::add
+	// Access:    public
+	// Returns:   void
+	// Parameter: const boost::string_view& inName
+	//--------------------------------------------------------------------------
+	void add(
+		const boost::string_view& inName);
+
+	//--------------------------------------------------------------- mayContain
+	// Brief Description
+	//  Returns false if the name was certainly never added, true if it
+	//  probably was.
+	//
+	// Method:    mayContain
+	// FullName:  bloomFilter::mayContain
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const boost::string_view& inName
+	//--------------------------------------------------------------------------
+	bool mayContain(
+		const boost::string_view& inName) const;
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns the filter as its size, its number of hashes and its bits, six
+	//  to a character, separated by the sync identifier delimiter. None of
+	//  the characters are in the message delimiter.
+	//
+	// Method:    asString
+	// FullName:  bloomFilter::asString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asString() const;
+
+	//----------------------------------------------------------------- viewBits
+	// Brief Description
+	//  Returns the size of the filter in bits, 0 for an empty filter.
+	//
+	// Method:    viewBits
+	// FullName:  bloomFilter::viewBits
+	// Access:    public
+	// Returns:   uint16_t
+	//--------------------------------------------------------------------------
+	uint16_t viewBits() const;
+
+private:
+
+	//----------------------------------------------------------------- bitIndex
+	// Brief Description
+	//  Returns the bit the given hash of the name sets, by double hashing
+	//  one 64-bit hash of the name.
+	//
+	// Method:    bitIndex
+	// FullName:  bloomFilter::bitIndex
+	// Access:    private
+	// Returns:   size_t
+	// Parameter: const uint64_t& inNameHash
+	// Parameter: const uint16_t& inHashIndex
+	//--------------------------------------------------------------------------
+	size_t bitIndex(
+		const uint64_t& inNameHash,
+		const uint16_t& inHashIndex) const;
+
+	//----------------------------------------------------------------- hashName
+	// Brief Description
+	//  Returns the FNV-1a hash of the name.
+	//
+	// Method:    hashName
+	// FullName:  bloomFilter::hashName
+	// Access:    private static
+	// Returns:   uint64_t
+	// Parameter: const boost::string_view& inName
+	//--------------------------------------------------------------------------
+	static uint64_t hashName(
+		const boost::string_view& inName);
+
+	// Member Variables
+	std::vector<bool> m_bits;
+	uint16_t m_hashes;
+};
\ No newline at end of file
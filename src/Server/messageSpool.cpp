@@ -0,0 +1,716 @@
+// STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// Project
+#include "messageSpool.h"
+#include "../Common/constants.h"
+
+namespace
+{
+	// length, checksum, identifier, deadline, kind, recipient length
+	const uint32_t recordHeaderBytes = 4 + 4 + 8 + 8 + 1 + 2;
+	const uint32_t recordChecksumOffset = 4;
+	const uint32_t recordIdentifierOffset = 8;
+	const uint32_t recordDeadlineOffset = 16;
+	const uint32_t recordKindOffset = 24;
+	const uint32_t recordRecipientOffset = 25;
+
+	const std::string segmentPrefix("segment-");
+	const std::string spoolExtension(".spool");
+
+	//--------------------------------------------------------------- checksumOf
+	// Implementation notes:
+	//  FNV-1a, enough to tell a record cut short by a crash from a whole one
+	//--------------------------------------------------------------------------
+	uint32_t checksumOf(
+		const char* inBytes,
+		const size_t& inLength)
+	{
+		uint32_t hash = 2166136261u;
+
+		for(size_t i = 0; i < inLength; i++)
+		{
+			hash ^= static_cast<uint8_t>(inBytes[i]);
+			hash *= 16777619u;
+		}
+
+		return hash;
+	};
+
+	//--------------------------------------------------------------- createFile
+	// Implementation notes:
+	//  The file is extended with zeros, so a record length of 0 marks the end
+	//  of a segment and an identifier of 0 the end of the removed index
+	//--------------------------------------------------------------------------
+	void createFile(
+		const std::string& inPath,
+		const uint64_t& inBytes)
+	{
+		{
+			std::ofstream file(
+				inPath.c_str(),
+				std::ios::binary | std::ios::trunc);
+		}
+
+		boost::filesystem::resize_file(
+			inPath,
+			inBytes);
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The removed index is read first, so removed records are skipped while
+//  the segments are read. Segments with nothing live left are deleted and
+//  the index is rewritten to list only what is still in a segment, so a
+//  restart reads each live record once and little else. The last segment
+//  is appended to again.
+//------------------------------------------------------------------------------
+messageSpool::messageSpool(
+	const std::string& inDirectory,
+	const uint32_t& inSegmentBytes) :
+	m_directory(inDirectory),
+	m_segmentBytes(inSegmentBytes),
+	m_nextIdentifier(1),
+	m_headNumber(0),
+	m_headFlushedBytes(0),
+	m_removedCount(0),
+	m_removedFlushedCount(0),
+	m_removedCapacity(0),
+	m_synchronizations(0),
+	m_segmentsCompacted(0),
+	m_segmentsDeleted(0)
+{
+	boost::filesystem::create_directories(
+		this->m_directory);
+
+	const std::string removedPath(
+		this->m_directory + "/removed" + spoolExtension);
+
+	std::set<uint64_t> removedIdentifiers;
+
+	if(boost::filesystem::exists(removedPath)
+		&& boost::filesystem::file_size(removedPath) >= sizeof(uint64_t))
+	{
+		const boost::interprocess::file_mapping file(
+			removedPath.c_str(),
+			boost::interprocess::read_only);
+
+		const boost::interprocess::mapped_region region(
+			file,
+			boost::interprocess::read_only);
+
+		const char* slots = static_cast<const char*>(region.get_address());
+
+		for(size_t slot = 0; slot < region.get_size() / sizeof(uint64_t); slot++)
+		{
+			uint64_t identifier = 0;
+
+			std::memcpy(&identifier, slots + slot * sizeof(uint64_t), sizeof(uint64_t));
+
+			if(identifier == 0)
+			{
+				break;
+			}
+
+			removedIdentifiers.insert(identifier);
+		}
+	}
+
+	std::vector<uint32_t> segmentNumbers;
+
+	for(boost::filesystem::directory_iterator entry(this->m_directory);
+		entry != boost::filesystem::directory_iterator();
+		entry++)
+	{
+		const std::string fileName(
+			entry->path().filename().string());
+
+		if(fileName.size() > segmentPrefix.size() + spoolExtension.size()
+			&& fileName.compare(0, segmentPrefix.size(), segmentPrefix) == 0
+			&& fileName.compare(fileName.size() - spoolExtension.size(), spoolExtension.size(), spoolExtension) == 0)
+		{
+			segmentNumbers.push_back(static_cast<uint32_t>(std::stoul(
+				fileName.substr(segmentPrefix.size()))));
+		}
+	}
+
+	std::sort(
+		segmentNumbers.begin(),
+		segmentNumbers.end());
+
+	for(const uint32_t& segmentNumber : segmentNumbers)
+	{
+		this->recoverSegment(
+			segmentNumber,
+			removedIdentifiers);
+	}
+
+	const uint32_t headNumber =
+		segmentNumbers.empty() ? 0 : segmentNumbers.back();
+
+	for(const uint32_t& segmentNumber : segmentNumbers)
+	{
+		if(segmentNumber != headNumber
+			&& this->m_segments[segmentNumber].m_liveRecords.empty())
+		{
+			boost::filesystem::remove(
+				this->segmentPath(segmentNumber));
+
+			this->m_segments.erase(
+				segmentNumber);
+		}
+	}
+
+	this->openHead(
+		headNumber);
+
+	this->rewriteRemovedIndex();
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The regions are unmapped by their own destructors
+//------------------------------------------------------------------------------
+messageSpool::~messageSpool()
+{
+	this->flushHead();
+
+	if(this->m_removedCount > this->m_removedFlushedCount)
+	{
+		this->m_removedRegion.flush(
+			this->m_removedFlushedCount * sizeof(uint64_t),
+			(this->m_removedCount - this->m_removedFlushedCount) * sizeof(uint64_t),
+			false);
+	}
+};
+
+//---------------------------------------------------------------- takeRecovered
+// Implementation notes:
+//  Swapped out, the records are only needed once
+//------------------------------------------------------------------------------
+std::vector<messageSpool::spooledEntry> messageSpool::takeRecovered()
+{
+	std::vector<spooledEntry> recovered;
+
+	recovered.swap(
+		this->m_recovered);
+
+	return recovered;
+};
+
+//----------------------------------------------------------------------- append
+// Implementation notes:
+//  The record is encoded straight into the mapped head segment, so an
+//  append costs about as much as copying the message into memory. Fields
+//  are in this machine's byte order, the spool is only read back by the
+//  server that wrote it.
+//------------------------------------------------------------------------------
+uint64_t messageSpool::append(
+	const RecordKind& inKind,
+	const std::string& inRecipient,
+	const int64_t& inDeadlineMilliseconds,
+	const std::vector<char>& inMessage)
+{
+	const uint64_t recordBytes =
+		recordHeaderBytes + inRecipient.size() + inMessage.size();
+
+	if(recordBytes > this->m_segmentBytes
+		|| inRecipient.size() > UINT16_MAX)
+	{
+		return 0;
+	}
+
+	const uint32_t length = static_cast<uint32_t>(recordBytes);
+	const uint64_t identifier = this->m_nextIdentifier++;
+	const uint8_t kind = static_cast<uint8_t>(inKind);
+	const uint16_t recipientLength = static_cast<uint16_t>(inRecipient.size());
+
+	char* record = this->reserve(
+		length);
+
+	std::memcpy(record, &length, sizeof(length));
+	std::memcpy(record + recordIdentifierOffset, &identifier, sizeof(identifier));
+	std::memcpy(record + recordDeadlineOffset, &inDeadlineMilliseconds, sizeof(inDeadlineMilliseconds));
+	std::memcpy(record + recordKindOffset, &kind, sizeof(kind));
+	std::memcpy(record + recordRecipientOffset, &recipientLength, sizeof(recipientLength));
+	std::memcpy(record + recordHeaderBytes, inRecipient.data(), inRecipient.size());
+
+	if(!inMessage.empty())
+	{
+		std::memcpy(record + recordHeaderBytes + inRecipient.size(), inMessage.data(), inMessage.size());
+	}
+
+	const uint32_t checksum = checksumOf(
+		record + recordIdentifierOffset,
+		length - recordIdentifierOffset);
+
+	std::memcpy(record + recordChecksumOffset, &checksum, sizeof(checksum));
+
+	this->commit(
+		identifier,
+		length);
+
+	return identifier;
+};
+
+//----------------------------------------------------------------------- remove
+// Implementation notes:
+//  A full index is rewritten twice as large, without the records whose
+//  segments were deleted since it was last written
+//------------------------------------------------------------------------------
+void messageSpool::remove(
+	const uint64_t& inIdentifier)
+{
+	std::map<uint64_t, uint32_t>::iterator owner =
+		this->m_segmentOfRecord.find(inIdentifier);
+
+	if(owner == this->m_segmentOfRecord.end())
+	{
+		return;
+	}
+
+	spoolSegment& segment = this->m_segments[owner->second];
+
+	std::map<uint64_t, recordLocation>::iterator record =
+		segment.m_liveRecords.find(inIdentifier);
+
+	segment.m_liveBytes -= record->second.m_bytes;
+	segment.m_liveRecords.erase(record);
+	segment.m_removedIdentifiers.push_back(inIdentifier);
+
+	this->m_segmentOfRecord.erase(owner);
+
+	if(this->m_removedCount == this->m_removedCapacity)
+	{
+		// the rewrite lists this record too
+		this->rewriteRemovedIndex();
+		return;
+	}
+
+	std::memcpy(
+		static_cast<char*>(this->m_removedRegion.get_address()) + this->m_removedCount * sizeof(uint64_t),
+		&inIdentifier,
+		sizeof(uint64_t));
+
+	this->m_removedCount++;
+};
+
+//------------------------------------------------------------------ synchronize
+// Implementation notes:
+//  Called by the server's spool thread every few milliseconds, so one flush
+//  covers every message routed in between. Deleting or compacting a
+//  segment only happens after the removals that allow it are on disk.
+//------------------------------------------------------------------------------
+void messageSpool::synchronize()
+{
+	this->flushHead();
+
+	if(this->m_removedCount > this->m_removedFlushedCount)
+	{
+		this->m_removedRegion.flush(
+			this->m_removedFlushedCount * sizeof(uint64_t),
+			(this->m_removedCount - this->m_removedFlushedCount) * sizeof(uint64_t),
+			false);
+
+		this->m_removedFlushedCount = this->m_removedCount;
+	}
+
+	this->m_synchronizations++;
+
+	uint64_t removedInSegments = 0;
+
+	for(std::map<uint32_t, spoolSegment>::iterator segment = this->m_segments.begin();
+		segment != this->m_segments.end();
+		segment++)
+	{
+		removedInSegments += segment->second.m_removedIdentifiers.size();
+
+		if(segment->first == this->m_headNumber)
+		{
+			continue;
+		}
+
+		if(segment->second.m_liveRecords.empty())
+		{
+			boost::system::error_code ignoredError;
+
+			boost::filesystem::remove(
+				this->segmentPath(segment->first),
+				ignoredError);
+
+			this->m_segments.erase(
+				segment);
+
+			this->m_segmentsDeleted++;
+
+			return;
+		}
+
+		if(segment->second.m_liveBytes * 100
+			< static_cast<uint64_t>(segment->second.m_writtenBytes) * constants::spoolCompactionPercent)
+		{
+			this->compactSegment(
+				segment->first);
+
+			return;
+		}
+	}
+
+	// most of the index lists records whose segments are gone
+	if(this->m_removedCount > 2 * removedInSegments + constants::spoolRemovedIndexSlots)
+	{
+		this->rewriteRemovedIndex();
+	}
+};
+
+//-------------------------------------------------------------- viewLiveRecords
+// Implementation notes:
+//  Every live record has an owning segment
+//------------------------------------------------------------------------------
+size_t messageSpool::viewLiveRecords() const
+{
+	return this->m_segmentOfRecord.size();
+};
+
+//----------------------------------------------------------- statisticsAsString
+// Implementation notes:
+//  Same layout as the outbox statistics
+//------------------------------------------------------------------------------
+std::string messageSpool::statisticsAsString() const
+{
+	std::stringstream ss;
+
+	ss << "spooled " << this->m_segmentOfRecord.size()
+		<< ", segments " << this->m_segments.size()
+		<< ", removed index " << this->m_removedCount
+		<< ", synchronized " << this->m_synchronizations
+		<< ", compacted " << this->m_segmentsCompacted
+		<< ", deleted " << this->m_segmentsDeleted;
+
+	return ss.str();
+};
+
+//------------------------------------------------------------------ segmentPath
+// Implementation notes:
+//  Zero padded, so the files list in the order they were written
+//------------------------------------------------------------------------------
+std::string messageSpool::segmentPath(
+	const uint32_t& inSegmentNumber) const
+{
+	std::stringstream ss;
+
+	ss << this->m_directory << "/" << segmentPrefix
+		<< std::setw(8) << std::setfill('0') << inSegmentNumber
+		<< spoolExtension;
+
+	return ss.str();
+};
+
+//--------------------------------------------------------------- recoverSegment
+// Implementation notes:
+//  A compaction that was cut short can leave a record in two segments,
+//  only its first copy is read back. The records after a bad one are
+//  dropped with it, they were appended after it and never synchronized.
+//------------------------------------------------------------------------------
+void messageSpool::recoverSegment(
+	const uint32_t& inSegmentNumber,
+	const std::set<uint64_t>& inRemovedIdentifiers)
+{
+	const boost::interprocess::file_mapping file(
+		this->segmentPath(inSegmentNumber).c_str(),
+		boost::interprocess::read_only);
+
+	const boost::interprocess::mapped_region region(
+		file,
+		boost::interprocess::read_only);
+
+	const char* base = static_cast<const char*>(region.get_address());
+	const size_t size = region.get_size();
+
+	spoolSegment& segment = this->m_segments[inSegmentNumber];
+
+	uint32_t offset = 0;
+
+	while(offset + recordHeaderBytes <= size)
+	{
+		const char* record = base + offset;
+
+		uint32_t length = 0;
+		uint32_t checksum = 0;
+		uint64_t identifier = 0;
+		int64_t deadline = 0;
+		uint8_t kind = 0;
+		uint16_t recipientLength = 0;
+
+		std::memcpy(&length, record, sizeof(length));
+
+		if(length < recordHeaderBytes || length > size - offset)
+		{
+			break;
+		}
+
+		std::memcpy(&checksum, record + recordChecksumOffset, sizeof(checksum));
+
+		if(checksum != checksumOf(record + recordIdentifierOffset, length - recordIdentifierOffset))
+		{
+			break;
+		}
+
+		std::memcpy(&identifier, record + recordIdentifierOffset, sizeof(identifier));
+		std::memcpy(&deadline, record + recordDeadlineOffset, sizeof(deadline));
+		std::memcpy(&kind, record + recordKindOffset, sizeof(kind));
+		std::memcpy(&recipientLength, record + recordRecipientOffset, sizeof(recipientLength));
+
+		if(recordHeaderBytes + recipientLength > length)
+		{
+			break;
+		}
+
+		this->m_nextIdentifier = std::max(
+			this->m_nextIdentifier,
+			identifier + 1);
+
+		if(inRemovedIdentifiers.count(identifier) > 0)
+		{
+			segment.m_removedIdentifiers.push_back(identifier);
+		}
+		else if(this->m_segmentOfRecord.count(identifier) == 0)
+		{
+			segment.m_liveRecords.insert(std::make_pair(
+				identifier,
+				recordLocation(offset, length)));
+
+			segment.m_liveBytes += length;
+
+			this->m_segmentOfRecord[identifier] = inSegmentNumber;
+
+			this->m_recovered.push_back(spooledEntry(
+				identifier,
+				static_cast<RecordKind>(kind),
+				std::string(record + recordHeaderBytes, recipientLength),
+				deadline,
+				std::vector<char>(record + recordHeaderBytes + recipientLength, record + length)));
+		}
+
+		offset += length;
+	}
+
+	segment.m_writtenBytes = offset;
+};
+
+//--------------------------------------------------------------------- openHead
+// Implementation notes:
+//  The previous head, if any, must already be flushed
+//------------------------------------------------------------------------------
+void messageSpool::openHead(
+	const uint32_t& inSegmentNumber)
+{
+	const std::string path(
+		this->segmentPath(inSegmentNumber));
+
+	if(!boost::filesystem::exists(path))
+	{
+		createFile(
+			path,
+			this->m_segmentBytes);
+	}
+
+	boost::interprocess::file_mapping(
+		path.c_str(),
+		boost::interprocess::read_write).swap(this->m_headFile);
+
+	boost::interprocess::mapped_region(
+		this->m_headFile,
+		boost::interprocess::read_write).swap(this->m_headRegion);
+
+	this->m_headNumber = inSegmentNumber;
+	this->m_headFlushedBytes = this->m_segments[inSegmentNumber].m_writtenBytes;
+};
+
+//---------------------------------------------------------------------- reserve
+// Implementation notes:
+//  A full head is flushed before it is unmapped, so it never needs to be
+//  mapped again to be synchronized
+//------------------------------------------------------------------------------
+char* messageSpool::reserve(
+	const uint32_t& inBytes)
+{
+	if(this->m_segments[this->m_headNumber].m_writtenBytes + inBytes
+		> this->m_headRegion.get_size())
+	{
+		this->flushHead();
+
+		this->openHead(
+			this->m_headNumber + 1);
+	}
+
+	return static_cast<char*>(this->m_headRegion.get_address())
+		+ this->m_segments[this->m_headNumber].m_writtenBytes;
+};
+
+//----------------------------------------------------------------------- commit
+// Implementation notes:
+//  The record is at the old end of the head segment
+//------------------------------------------------------------------------------
+void messageSpool::commit(
+	const uint64_t& inIdentifier,
+	const uint32_t& inBytes)
+{
+	spoolSegment& head = this->m_segments[this->m_headNumber];
+
+	head.m_liveRecords.insert(std::make_pair(
+		inIdentifier,
+		recordLocation(head.m_writtenBytes, inBytes)));
+
+	head.m_liveBytes += inBytes;
+	head.m_writtenBytes += inBytes;
+
+	this->m_segmentOfRecord[inIdentifier] = this->m_headNumber;
+};
+
+//-------------------------------------------------------------------- flushHead
+// Implementation notes:
+//  Only the pages appended to since the last flush are written
+//------------------------------------------------------------------------------
+void messageSpool::flushHead()
+{
+	const uint32_t writtenBytes =
+		this->m_segments[this->m_headNumber].m_writtenBytes;
+
+	if(writtenBytes > this->m_headFlushedBytes)
+	{
+		this->m_headRegion.flush(
+			this->m_headFlushedBytes,
+			writtenBytes - this->m_headFlushedBytes,
+			false);
+
+		this->m_headFlushedBytes = writtenBytes;
+	}
+};
+
+//--------------------------------------------------------------- compactSegment
+// Implementation notes:
+//  Records keep their identifiers when copied. The segment is unmapped
+//  before its file is deleted, which Windows requires.
+//------------------------------------------------------------------------------
+void messageSpool::compactSegment(
+	const uint32_t& inSegmentNumber)
+{
+	{
+		const boost::interprocess::file_mapping file(
+			this->segmentPath(inSegmentNumber).c_str(),
+			boost::interprocess::read_only);
+
+		const boost::interprocess::mapped_region region(
+			file,
+			boost::interprocess::read_only);
+
+		const char* base = static_cast<const char*>(region.get_address());
+
+		for(const std::pair<const uint64_t, recordLocation>& record :
+			this->m_segments[inSegmentNumber].m_liveRecords)
+		{
+			char* copy = this->reserve(
+				record.second.m_bytes);
+
+			std::memcpy(copy, base + record.second.m_offset, record.second.m_bytes);
+
+			this->commit(
+				record.first,
+				record.second.m_bytes);
+		}
+	}
+
+	this->flushHead();
+
+	boost::system::error_code ignoredError;
+
+	boost::filesystem::remove(
+		this->segmentPath(inSegmentNumber),
+		ignoredError);
+
+	this->m_segments.erase(
+		inSegmentNumber);
+
+	this->m_segmentsCompacted++;
+};
+
+//---------------------------------------------------------- rewriteRemovedIndex
+// Implementation notes:
+//  The new index is written and flushed under another name, then renamed
+//  over the old one, so a crash leaves one or the other whole
+//------------------------------------------------------------------------------
+void messageSpool::rewriteRemovedIndex()
+{
+	std::vector<uint64_t> identifiers;
+
+	for(const std::pair<const uint32_t, spoolSegment>& segment : this->m_segments)
+	{
+		identifiers.insert(
+			identifiers.end(),
+			segment.second.m_removedIdentifiers.begin(),
+			segment.second.m_removedIdentifiers.end());
+	}
+
+	const uint64_t capacity = std::max<uint64_t>(
+		constants::spoolRemovedIndexSlots,
+		2 * identifiers.size());
+
+	const std::string removedPath(
+		this->m_directory + "/removed" + spoolExtension);
+
+	const std::string rewrittenPath(
+		removedPath + ".new");
+
+	createFile(
+		rewrittenPath,
+		capacity * sizeof(uint64_t));
+
+	{
+		const boost::interprocess::file_mapping file(
+			rewrittenPath.c_str(),
+			boost::interprocess::read_write);
+
+		boost::interprocess::mapped_region region(
+			file,
+			boost::interprocess::read_write);
+
+		if(!identifiers.empty())
+		{
+			std::memcpy(region.get_address(), identifiers.data(), identifiers.size() * sizeof(uint64_t));
+
+			region.flush(
+				0,
+				identifiers.size() * sizeof(uint64_t),
+				false);
+		}
+	}
+
+	boost::interprocess::mapped_region().swap(this->m_removedRegion);
+	boost::interprocess::file_mapping().swap(this->m_removedFile);
+
+	boost::filesystem::rename(
+		rewrittenPath,
+		removedPath);
+
+	boost::interprocess::file_mapping(
+		removedPath.c_str(),
+		boost::interprocess::read_write).swap(this->m_removedFile);
+
+	boost::interprocess::mapped_region(
+		this->m_removedFile,
+		boost::interprocess::read_write).swap(this->m_removedRegion);
+
+	this->m_removedCount = identifiers.size();
+	this->m_removedFlushedCount = identifiers.size();
+	this->m_removedCapacity = capacity;
+};
\ No newline at end of file
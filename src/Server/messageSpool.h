@@ -0,0 +1,330 @@
+#pragma once
+
+// STL
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+class messageSpool
+{
+public:
+
+	enum RecordKind
+	{
+		sk_DELIVERY,
+		sk_HELD
+	};
+
+	class spooledEntry
+	{
+	public:
+		spooledEntry(
+			const uint64_t& inIdentifier,
+			const RecordKind& inKind,
+			const std::string& inRecipient,
+			const int64_t& inDeadlineMilliseconds,
+			const std::vector<char>& inMessage) :
+			m_identifier(inIdentifier),
+			m_kind(inKind),
+			m_recipient(inRecipient),
+			m_deadlineMilliseconds(inDeadlineMilliseconds),
+			m_message(inMessage)
+		{
+		};
+
+		uint64_t m_identifier;
+		RecordKind m_kind;
+		std::string m_recipient;
+		int64_t m_deadlineMilliseconds;
+		std::vector<char> m_message;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that opens the spool in the directory, creating it if
+	//  needed. The records that were never removed are read back, and can
+	//  be taken with takeRecovered(). New records are appended to memory
+	//  mapped segment files of the given size. Throws a std::exception if
+	//  the directory or a file in it cannot be opened.
+	//
+	// Method:    messageSpool
+	// FullName:  messageSpool::messageSpool
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inDirectory
+	// Parameter: const uint32_t& inSegmentBytes
+	//--------------------------------------------------------------------------
+	messageSpool(
+		const std::string& inDirectory,
+		const uint32_t& inSegmentBytes);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Writes what was appended or removed since the last synchronize to
+	//  disk before unmapping the files.
+	//
+	// Method:    ~messageSpool
+	// FullName:  messageSpool::~messageSpool
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~messageSpool();
+
+	//------------------------------------------------------------ takeRecovered
+	// Brief Description
+	//  Returns the records read back when the spool was opened, in the
+	//  order they were appended, and forgets them.
+	//
+	// Method:    takeRecovered
+	// FullName:  messageSpool::takeRecovered
+	// Access:    public
+	// Returns:   std::vector<spooledEntry>
+	//--------------------------------------------------------------------------
+	std::vector<spooledEntry> takeRecovered();
+
+	//------------------------------------------------------------------- append
+	// Brief Description
+	//  Appends a record and returns its identifier, or 0 if the record does
+	//  not fit in a segment. The record is only in memory until the next
+	//  synchronize.
+	//
+	// Method:    append
+	// FullName:  messageSpool::append
+	// Access:    public
+	// Returns:   uint64_t
+	// Parameter: const RecordKind& inKind
+	// Parameter: const std::string& inRecipient
+	// Parameter: const int64_t& inDeadlineMilliseconds
+	// Parameter: const std::vector<char>& inMessage
+	//--------------------------------------------------------------------------
+	uint64_t append(
+		const RecordKind& inKind,
+		const std::string& inRecipient,
+		const int64_t& inDeadlineMilliseconds,
+		const std::vector<char>& inMessage);
+
+	//------------------------------------------------------------------- remove
+	// Brief Description
+	//  Marks the record as no longer needed, in the index of removed
+	//  records, once it was ACKed or given up on. Its bytes are reclaimed
+	//  when its segment is compacted.
+	//
+	// Method:    remove
+	// FullName:  messageSpool::remove
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint64_t& inIdentifier
+	//--------------------------------------------------------------------------
+	void remove(
+		const uint64_t& inIdentifier);
+
+	//-------------------------------------------------------------- synchronize
+	// Brief Description
+	//  Writes every record appended and removed since the last call to disk
+	//  in one flush per file, then deletes or compacts at most one segment
+	//  that is mostly removed records.
+	//
+	// Method:    synchronize
+	// FullName:  messageSpool::synchronize
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void synchronize();
+
+	//---------------------------------------------------------- viewLiveRecords
+	// Brief Description
+	//  Returns the number of records appended and not yet removed.
+	//
+	// Method:    viewLiveRecords
+	// FullName:  messageSpool::viewLiveRecords
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewLiveRecords() const;
+
+	//------------------------------------------------------- statisticsAsString
+	// Brief Description
+	//  Returns the record, segment and synchronize counters on one line.
+	//
+	// Method:    statisticsAsString
+	// FullName:  messageSpool::statisticsAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string statisticsAsString() const;
+
+private:
+
+	class recordLocation
+	{
+	public:
+		recordLocation(
+			const uint32_t& inOffset,
+			const uint32_t& inBytes) :
+			m_offset(inOffset),
+			m_bytes(inBytes)
+		{
+		};
+
+		uint32_t m_offset;
+		uint32_t m_bytes;
+	};
+
+	class spoolSegment
+	{
+	public:
+		spoolSegment() :
+			m_writtenBytes(0),
+			m_liveBytes(0)
+		{
+		};
+
+		uint32_t m_writtenBytes;
+		uint64_t m_liveBytes;
+		std::map<uint64_t, recordLocation> m_liveRecords;
+		std::vector<uint64_t> m_removedIdentifiers;
+	};
+
+	//-------------------------------------------------------------- segmentPath
+	// Brief Description
+	//  Returns the path of the segment file with the given number.
+	//
+	// Method:    segmentPath
+	// FullName:  messageSpool::segmentPath
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: const uint32_t& inSegmentNumber
+	//--------------------------------------------------------------------------
+	std::string segmentPath(
+		const uint32_t& inSegmentNumber) const;
+
+	//----------------------------------------------------------- recoverSegment
+	// Brief Description
+	//  Reads the records of a segment file back, up to the first one that is
+	//  cut short or does not match its checksum. Removed records are only
+	//  remembered by identifier.
+	//
+	// Method:    recoverSegment
+	// FullName:  messageSpool::recoverSegment
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint32_t& inSegmentNumber
+	// Parameter: const std::set<uint64_t>& inRemovedIdentifiers
+	//--------------------------------------------------------------------------
+	void recoverSegment(
+		const uint32_t& inSegmentNumber,
+		const std::set<uint64_t>& inRemovedIdentifiers);
+
+	//----------------------------------------------------------------- openHead
+	// Brief Description
+	//  Maps the segment with the given number for appending, creating it
+	//  if it does not exist.
+	//
+	// Method:    openHead
+	// FullName:  messageSpool::openHead
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint32_t& inSegmentNumber
+	//--------------------------------------------------------------------------
+	void openHead(
+		const uint32_t& inSegmentNumber);
+
+	//------------------------------------------------------------------ reserve
+	// Brief Description
+	//  Returns where a record of the given size goes at the end of the head
+	//  segment, starting a new segment if it does not fit. The record is
+	//  written there directly, then committed.
+	//
+	// Method:    reserve
+	// FullName:  messageSpool::reserve
+	// Access:    private
+	// Returns:   char*
+	// Parameter: const uint32_t& inBytes
+	//--------------------------------------------------------------------------
+	char* reserve(
+		const uint32_t& inBytes);
+
+	//------------------------------------------------------------------- commit
+	// Brief Description
+	//  Records that the record written where reserve() pointed is live.
+	//
+	// Method:    commit
+	// FullName:  messageSpool::commit
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint64_t& inIdentifier
+	// Parameter: const uint32_t& inBytes
+	//--------------------------------------------------------------------------
+	void commit(
+		const uint64_t& inIdentifier,
+		const uint32_t& inBytes);
+
+	//---------------------------------------------------------------- flushHead
+	// Brief Description
+	//  Writes the part of the head segment appended since it was last
+	//  flushed to disk.
+	//
+	// Method:    flushHead
+	// FullName:  messageSpool::flushHead
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushHead();
+
+	//----------------------------------------------------------- compactSegment
+	// Brief Description
+	//  Copies the live records of a segment to the head and deletes the
+	//  segment file once the copies are on disk.
+	//
+	// Method:    compactSegment
+	// FullName:  messageSpool::compactSegment
+	// Access:    private
+	// Returns:   void
+	// Parameter: const uint32_t& inSegmentNumber
+	//--------------------------------------------------------------------------
+	void compactSegment(
+		const uint32_t& inSegmentNumber);
+
+	//------------------------------------------------------ rewriteRemovedIndex
+	// Brief Description
+	//  Replaces the index of removed records with one that only lists the
+	//  records still in a segment file.
+	//
+	// Method:    rewriteRemovedIndex
+	// FullName:  messageSpool::rewriteRemovedIndex
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void rewriteRemovedIndex();
+
+	// Member Variables
+	std::string m_directory;
+	uint32_t m_segmentBytes;
+	std::map<uint32_t, spoolSegment> m_segments;
+	std::map<uint64_t, uint32_t> m_segmentOfRecord;
+	std::vector<spooledEntry> m_recovered;
+	uint64_t m_nextIdentifier;
+
+	// the head segment is the only one kept mapped, records are appended to it
+	uint32_t m_headNumber;
+	uint32_t m_headFlushedBytes;
+	boost::interprocess::file_mapping m_headFile;
+	boost::interprocess::mapped_region m_headRegion;
+
+	// removed records are listed as 8 byte identifiers, 0 marks the end
+	uint64_t m_removedCount;
+	uint64_t m_removedFlushedCount;
+	uint64_t m_removedCapacity;
+	boost::interprocess::file_mapping m_removedFile;
+	boost::interprocess::mapped_region m_removedRegion;
+
+	uint64_t m_synchronizations;
+	uint64_t m_segmentsCompacted;
+	uint64_t m_segmentsDeleted;
+};
\ No newline at end of file
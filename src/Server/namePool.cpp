@@ -0,0 +1,138 @@
+// STL
+#include <cassert>
+
+// Project
+#include "namePool.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The first entry is never used, so handles start at 1
+//------------------------------------------------------------------------------
+namePool::namePool() :
+	m_names(1)
+{
+};
+
+//---------------------------------------------------------------------- acquire
+// Implementation notes:
+//  A name is copied only when it is new. Freed handles are reused first.
+//------------------------------------------------------------------------------
+namePool::handle namePool::acquire(
+	const boost::string_view& inName)
+{
+	handle outHandle = this->find(
+		inName);
+
+	if(outHandle == 0)
+	{
+		if(this->m_freeHandles.empty())
+		{
+			outHandle = static_cast<handle>(this->m_names.size());
+
+			this->m_names.push_back(
+				internedName());
+		}
+		else
+		{
+			outHandle = this->m_freeHandles.back();
+
+			this->m_freeHandles.pop_back();
+		}
+
+		std::string& name = this->m_names[outHandle].m_name;
+
+		name.assign(
+			inName.data(),
+			inName.size());
+
+		this->m_handlesByName.insert(std::make_pair(
+			boost::string_view(name),
+			outHandle));
+	}
+
+	this->m_names[outHandle].m_references++;
+
+	return outHandle;
+};
+
+//---------------------------------------------------------------------- release
+// Implementation notes:
+//  The name is taken out of the index before it is cleared, the index key
+//  points into it
+//------------------------------------------------------------------------------
+void namePool::release(
+	const handle& inHandle)
+{
+	assert(inHandle != 0 && inHandle < this->m_names.size());
+
+	internedName& entry = this->m_names[inHandle];
+
+	assert(entry.m_references > 0);
+
+	if(--entry.m_references > 0)
+	{
+		return;
+	}
+
+	this->m_handlesByName.erase(
+		boost::string_view(entry.m_name));
+
+	// the memory is given back too, a long name is not kept for the next
+	std::string().swap(
+		entry.m_name);
+
+	this->m_freeHandles.push_back(
+		inHandle);
+};
+
+//------------------------------------------------------------------------- find
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+namePool::handle namePool::find(
+	const boost::string_view& inName) const
+{
+	std::unordered_map<boost::string_view, handle, nameHash>::const_iterator found =
+		this->m_handlesByName.find(inName);
+
+	return found == this->m_handlesByName.end()
+		? 0
+		: found->second;
+};
+
+//--------------------------------------------------------------------- viewName
+// Implementation notes:
+//  Returns a const reference to the name of the handle
+//------------------------------------------------------------------------------
+const std::string& namePool::viewName(
+	const handle& inHandle) const
+{
+	return this->m_names[inHandle].m_name;
+};
+
+//----------------------------------------------------------------- viewInterned
+// Implementation notes:
+//  Returns the number of names in the index
+//------------------------------------------------------------------------------
+size_t namePool::viewInterned() const
+{
+	return this->m_handlesByName.size();
+};
+
+//--------------------------------------------------------- nameHash::operator()
+// Implementation notes:
+//  FNV-1a, names are short
+//------------------------------------------------------------------------------
+size_t namePool::nameHash::operator()(
+	const boost::string_view& inName) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(const char& character : inName)
+	{
+		hash ^= static_cast<unsigned char>(character);
+		hash *= 1099511628211ULL;
+	}
+
+	return static_cast<size_t>(hash);
+};
\ No newline at end of file
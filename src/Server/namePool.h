@@ -0,0 +1,126 @@
+#pragma once
+
+// STL
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/utility/string_view.hpp>
+
+class namePool
+{
+public:
+
+	// a handle stays the same for as long as its name has references, and
+	// is given to another name after that. 0 is never a name's.
+	typedef uint32_t handle;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty pool of interned names. Every list of
+	//  clients or channels on a server refers to its names by handle, so
+	//  each name is stored once however many lists it is in.
+	//
+	// Method:    namePool
+	// FullName:  namePool::namePool
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	namePool();
+
+	//------------------------------------------------------------------ acquire
+	// Brief Description
+	//  Returns the handle of the name, interning it if it is new, and adds
+	//  a reference to it.
+	//
+	// Method:    acquire
+	// FullName:  namePool::acquire
+	// Access:    public
+	// Returns:   namePool::handle
+	// Parameter: const boost::string_view& inName
+	//--------------------------------------------------------------------------
+	handle acquire(
+		const boost::string_view& inName);
+
+	//------------------------------------------------------------------ release
+	// Brief Description
+	//  Removes a reference to the name. The name is forgotten with its last
+	//  reference.
+	//
+	// Method:    release
+	// FullName:  namePool::release
+	// Access:    public
+	// Returns:   void
+	// Parameter: const handle& inHandle
+	//--------------------------------------------------------------------------
+	void release(
+		const handle& inHandle);
+
+	//--------------------------------------------------------------------- find
+	// Brief Description
+	//  Returns the handle of the name, or 0 if nothing refers to it.
+	//
+	// Method:    find
+	// FullName:  namePool::find
+	// Access:    public
+	// Returns:   namePool::handle
+	// Parameter: const boost::string_view& inName
+	//--------------------------------------------------------------------------
+	handle find(
+		const boost::string_view& inName) const;
+
+	//----------------------------------------------------------------- viewName
+	// Brief Description
+	//  Returns a const reference to the name of the handle.
+	//
+	// Method:    viewName
+	// FullName:  namePool::viewName
+	// Access:    public
+	// Returns:   const std::string&
+	// Parameter: const handle& inHandle
+	//--------------------------------------------------------------------------
+	const std::string& viewName(
+		const handle& inHandle) const;
+
+	//------------------------------------------------------------- viewInterned
+	// Brief Description
+	//  Returns the number of names in the pool.
+	//
+	// Method:    viewInterned
+	// FullName:  namePool::viewInterned
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewInterned() const;
+
+private:
+
+	class internedName
+	{
+	public:
+		internedName() :
+			m_references(0)
+		{
+		};
+
+		std::string m_name;
+		uint32_t m_references;
+	};
+
+	// the index is keyed by views of the names in the entries, which a
+	// deque never moves
+	class nameHash
+	{
+	public:
+		size_t operator()(
+			const boost::string_view& inName) const;
+	};
+
+	// Member Variables
+	std::deque<internedName> m_names;
+	std::vector<handle> m_freeHandles;
+	std::unordered_map<boost::string_view, handle, nameHash> m_handlesByName;
+};
\ No newline at end of file
@@ -0,0 +1,398 @@
+// STL
+#include <algorithm>
+#include <limits>
+#include <string>
+
+// Project
+#include "reliableLink.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The first sequence number is chosen by the server so that a restarted
+//  server's relays are numbered after the ones from before the restart.
+//------------------------------------------------------------------------------
+reliableLink::reliableLink(
+	const std::string& inLocalName,
+	const std::string& inPeerName,
+	const int64_t& inFirstSequenceNumber) :
+	m_localName(inLocalName),
+	m_peerName(inPeerName),
+	m_nextSequenceNumber(inFirstSequenceNumber),
+	m_retransmitTimer(
+		constants::relayInitialRetransmitMilliseconds,
+		constants::relayMinimumRetransmitMilliseconds,
+		constants::relayMaximumRetransmitMilliseconds),
+	m_transmissionCount(0),
+	m_nextExpectedSequenceNumber(0),
+	m_relaysSent(0),
+	m_retransmissions(0),
+	m_duplicatesReceived(0)
+{
+};
+
+//---------------------------------------------------------------------- enqueue
+// Implementation notes:
+//  Sequence numbers are assigned when a relay is first sent
+//------------------------------------------------------------------------------
+void reliableLink::enqueue(
+	const encodedMessage::pointer& inRelay)
+{
+	this->m_queued.push_back(
+		inRelay);
+};
+
+//----------------------------------------------------------------- takeSendable
+// Implementation notes:
+//  The window base is stamped on every transmission, so the peer can skip
+//  past anything this server no longer waits on, such as after the peer
+//  restarted. The relays themselves are encoded once, when enqueued.
+//------------------------------------------------------------------------------
+std::vector<reliableLink::relayTransmission> reliableLink::takeSendable(
+	const linkClock::time_point& inNow)
+{
+	std::vector<relayTransmission> outTransmissions;
+
+	uint16_t retransmitted = 0;
+
+	bool timedOut = false;
+
+	for(std::map<int64_t, inFlightRelay>::iterator it = this->m_inFlight.begin();
+		it != this->m_inFlight.end() && retransmitted < constants::relayRetransmitBurst;
+		it++)
+	{
+		const double waitedMilliseconds =
+			boost::chrono::duration<double, boost::milli>(
+				inNow - it->second.m_timeSent).count();
+
+		const bool expired =
+			waitedMilliseconds >= this->m_retransmitTimer.viewTimeoutMilliseconds();
+
+		// later relays were ACKed while this one was not, it was most
+		// likely lost, so it is sent again without waiting for the timer
+		const bool skipped =
+			it->second.m_timesSkipped >= constants::relayFastRetransmitThreshold;
+
+		if(expired || skipped)
+		{
+			timedOut = timedOut || expired;
+
+			it->second.m_timeSent = inNow;
+			it->second.m_transmissionOrder = ++this->m_transmissionCount;
+			it->second.m_transmissions++;
+			it->second.m_timesSkipped = 0;
+
+			outTransmissions.push_back(relayTransmission(
+				it->second.m_relay,
+				it->first,
+				this->viewWindowBase()));
+
+			retransmitted++;
+		}
+	}
+
+	this->m_retransmissions += retransmitted;
+
+	if(timedOut)
+	{
+		this->m_retransmitTimer.backOff();
+	}
+
+	// the window spans sequence numbers from the oldest unacknowledged
+	// relay, so a lost relay holds back new ones as well
+	while(!this->m_queued.empty()
+		&& this->m_nextSequenceNumber - this->viewWindowBase()
+			< constants::relayWindowSize)
+	{
+		const int64_t sequenceNumber = this->m_nextSequenceNumber++;
+
+		const encodedMessage::pointer relay(
+			this->m_queued.front());
+
+		this->m_queued.pop_front();
+
+		outTransmissions.push_back(relayTransmission(
+			relay,
+			sequenceNumber,
+			std::min(this->viewWindowBase(), sequenceNumber)));
+
+		this->m_inFlight.insert(std::make_pair(
+			sequenceNumber,
+			inFlightRelay(relay, inNow, ++this->m_transmissionCount)));
+
+		this->m_relaysSent++;
+	}
+
+	return outTransmissions;
+};
+
+//------------------------------------------------------- receiveAcknowledgement
+// Implementation notes:
+//  Only relays sent once are sampled, a retransmitted relay's ACK could be
+//  for either transmission (Karn's algorithm). For the same reason the
+//  timeout backoff is only ended by the ACK of a relay sent once, an ACK of
+//  a retransmission may be for the transmission that timed out.
+//------------------------------------------------------------------------------
+void reliableLink::receiveAcknowledgement(
+	const dataMessage& inAcknowledgement,
+	const linkClock::time_point& inNow)
+{
+	// ranges of acknowledged sequence numbers, first to last
+	std::vector<std::pair<int64_t, int64_t>> acknowledged;
+
+	acknowledged.push_back(std::make_pair(
+		std::numeric_limits<int64_t>::min(),
+		inAcknowledgement.viewSequenceNumber()));
+
+	for(const std::string& selectiveAcknowledgement :
+		inAcknowledgement.viewServerSyncPayload())
+	{
+		try
+		{
+			const size_t separator = selectiveAcknowledgement.find('-', 1);
+
+			acknowledged.push_back(std::make_pair(
+				std::stoll(selectiveAcknowledgement.substr(0, separator)),
+				std::stoll(selectiveAcknowledgement.substr(separator + 1))));
+		}
+		catch(std::exception& exception)
+		{
+			// malformed, ignore it
+		}
+	}
+
+	bool anyAcknowledged = false;
+	bool anySampled = false;
+	uint64_t latestTransmissionAcknowledged = 0;
+
+	for(const std::pair<int64_t, int64_t>& range : acknowledged)
+	{
+		std::map<int64_t, inFlightRelay>::iterator it =
+			this->m_inFlight.lower_bound(range.first);
+
+		while(it != this->m_inFlight.end() && it->first <= range.second)
+		{
+			if(it->second.m_transmissions == 1)
+			{
+				this->m_retransmitTimer.addSample(
+					boost::chrono::duration<double, boost::milli>(
+						inNow - it->second.m_timeSent).count());
+
+				anySampled = true;
+			}
+
+			latestTransmissionAcknowledged = std::max(
+				latestTransmissionAcknowledged,
+				it->second.m_transmissionOrder);
+
+			anyAcknowledged = true;
+
+			it = this->m_inFlight.erase(it);
+		}
+	}
+
+	if(!anyAcknowledged)
+	{
+		return;
+	}
+
+	// only relays transmitted after a relay can show it was skipped, its
+	// own retransmission may still be on its way
+	for(std::pair<const int64_t, inFlightRelay>& entry : this->m_inFlight)
+	{
+		if(entry.second.m_transmissionOrder < latestTransmissionAcknowledged)
+		{
+			entry.second.m_timesSkipped++;
+		}
+	}
+
+	if(anySampled)
+	{
+		this->m_retransmitTimer.reset();
+	}
+};
+
+//----------------------------------------------------------- takeUnacknowledged
+// Implementation notes:
+//  Sequence numbers are not reused, the peer skips them via the window base
+//------------------------------------------------------------------------------
+std::vector<encodedMessage::pointer> reliableLink::takeUnacknowledged()
+{
+	std::vector<encodedMessage::pointer> outRelays;
+
+	for(const std::pair<const int64_t, inFlightRelay>& entry : this->m_inFlight)
+	{
+		outRelays.push_back(
+			entry.second.m_relay);
+	}
+
+	outRelays.insert(
+		outRelays.end(),
+		this->m_queued.begin(),
+		this->m_queued.end());
+
+	this->m_inFlight.clear();
+	this->m_queued.clear();
+
+	return outRelays;
+};
+
+//---------------------------------------------------------------------- receive
+// Implementation notes:
+//  Relays too far ahead of the window are dropped unacknowledged, the
+//  sender retransmits them once the window has moved.
+//------------------------------------------------------------------------------
+bool reliableLink::receive(
+	const dataMessage& inRelayMessage)
+{
+	const int64_t sequenceNumber =
+		inRelayMessage.viewLinkSequenceNumber();
+
+	if(inRelayMessage.viewLinkWindowBase() > this->m_nextExpectedSequenceNumber)
+	{
+		this->m_nextExpectedSequenceNumber =
+			inRelayMessage.viewLinkWindowBase();
+
+		this->m_receivedAhead.erase(
+			this->m_receivedAhead.begin(),
+			this->m_receivedAhead.lower_bound(this->m_nextExpectedSequenceNumber));
+	}
+
+	if(sequenceNumber < this->m_nextExpectedSequenceNumber
+		|| this->m_receivedAhead.count(sequenceNumber) > 0)
+	{
+		this->m_duplicatesReceived++;
+		return false;
+	}
+
+	if(sequenceNumber - this->m_nextExpectedSequenceNumber
+		>= 4 * constants::relayWindowSize)
+	{
+		return false;
+	}
+
+	this->m_receivedAhead.insert(
+		sequenceNumber);
+
+	while(!this->m_receivedAhead.empty()
+		&& *this->m_receivedAhead.begin() == this->m_nextExpectedSequenceNumber)
+	{
+		this->m_receivedAhead.erase(this->m_receivedAhead.begin());
+		this->m_nextExpectedSequenceNumber++;
+	}
+
+	return true;
+};
+
+//-------------------------------------------------------- createAcknowledgement
+// Implementation notes:
+//  The selective part lists ranges of relays received out of order, as
+//  "first-last", in the same format as a sync payload
+//------------------------------------------------------------------------------
+dataMessage reliableLink::createAcknowledgement() const
+{
+	std::vector<std::string> selectiveAcknowledgements;
+
+	std::set<int64_t>::const_iterator it = this->m_receivedAhead.begin();
+
+	while(it != this->m_receivedAhead.end()
+		&& selectiveAcknowledgements.size()
+			< constants::relaySelectiveAcknowledgementLimit)
+	{
+		const int64_t first = *it;
+		int64_t last = first;
+
+		while(++it != this->m_receivedAhead.end() && *it == last + 1)
+		{
+			last++;
+		}
+
+		selectiveAcknowledgements.push_back(
+			std::to_string(first) + "-" + std::to_string(last));
+	}
+
+	return dataMessage(
+		this->m_nextExpectedSequenceNumber - 1,
+		constants::MessageType::mt_SERVER_ACK,
+		this->m_localName,
+		this->m_peerName,
+		selectiveAcknowledgements,
+		-1);
+};
+
+//----------------------------------------------------------------- viewInFlight
+// Implementation notes:
+//  Returns the number of relays waiting on an ACK
+//------------------------------------------------------------------------------
+size_t reliableLink::viewInFlight() const
+{
+	return this->m_inFlight.size();
+};
+
+//------------------------------------------------------------------- viewQueued
+// Implementation notes:
+//  Returns the number of relays not yet sent
+//------------------------------------------------------------------------------
+size_t reliableLink::viewQueued() const
+{
+	return this->m_queued.size();
+};
+
+//--------------------------------------------------------------- viewRelaysSent
+// Implementation notes:
+//  Returns a const reference to the number of relays sent
+//------------------------------------------------------------------------------
+const uint64_t& reliableLink::viewRelaysSent() const
+{
+	return this->m_relaysSent;
+};
+
+//---------------------------------------------------------- viewRetransmissions
+// Implementation notes:
+//  Returns a const reference to the number of retransmissions
+//------------------------------------------------------------------------------
+const uint64_t& reliableLink::viewRetransmissions() const
+{
+	return this->m_retransmissions;
+};
+
+//------------------------------------------------------- viewDuplicatesReceived
+// Implementation notes:
+//  Returns a const reference to the number of duplicates received
+//------------------------------------------------------------------------------
+const uint64_t& reliableLink::viewDuplicatesReceived() const
+{
+	return this->m_duplicatesReceived;
+};
+
+//---------------------------------------------------- viewRoundTripMilliseconds
+// Implementation notes:
+//  Returns a const reference to the smoothed round trip time
+//------------------------------------------------------------------------------
+const double& reliableLink::viewRoundTripMilliseconds() const
+{
+	return this->m_retransmitTimer.viewRoundTripMilliseconds();
+};
+
+//-------------------------------------------- viewRetransmitTimeoutMilliseconds
+// Implementation notes:
+//  Returns a const reference to the retransmit timer
+//------------------------------------------------------------------------------
+const double& reliableLink::viewRetransmitTimeoutMilliseconds() const
+{
+	return this->m_retransmitTimer.viewTimeoutMilliseconds();
+};
+
+//--------------------------------------------------------------- viewWindowBase
+// Implementation notes:
+//  The in flight relays are ordered by sequence number
+//------------------------------------------------------------------------------
+int64_t reliableLink::viewWindowBase() const
+{
+	if(this->m_inFlight.empty())
+	{
+		return this->m_nextSequenceNumber;
+	}
+
+	return this->m_inFlight.begin()->first;
+};
\ No newline at end of file
@@ -0,0 +1,285 @@
+#pragma once
+
+// STL
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/chrono.hpp>
+
+// Project
+#include "../Common/dataMessage.h"
+#include "../Common/encodedMessage.h"
+#include "../Common/retransmitTimer.h"
+
+class reliableLink
+{
+public:
+
+	typedef boost::chrono::steady_clock linkClock;
+
+	class relayTransmission
+	{
+	public:
+		relayTransmission(
+			const encodedMessage::pointer& inRelay,
+			const int64_t& inLinkSequenceNumber,
+			const int64_t& inLinkWindowBase) :
+			m_relay(inRelay),
+			m_linkSequenceNumbers(dataMessage::linkSequenceNumbersAsString(
+				inLinkSequenceNumber,
+				inLinkWindowBase))
+		{
+		};
+
+		// shared with the link, only the link sequence numbers are encoded
+		// for each transmission
+		encodedMessage::pointer m_relay;
+		std::string m_linkSequenceNumbers;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the reliable link from this server to a peer server.
+	//  Both directions are tracked: the relays this server sends and waits
+	//  on ACKs for, and the relays it receives from the peer and ACKs.
+	//
+	// Method:    reliableLink
+	// FullName:  reliableLink::reliableLink
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inLocalName
+	// Parameter: const std::string& inPeerName
+	// Parameter: const int64_t& inFirstSequenceNumber
+	//--------------------------------------------------------------------------
+	reliableLink(
+		const std::string& inLocalName,
+		const std::string& inPeerName,
+		const int64_t& inFirstSequenceNumber);
+
+	//------------------------------------------------------------------ enqueue
+	// Brief Description
+	//  Queues a relay to be sent to the peer once the window allows.
+	//
+	// Method:    enqueue
+	// FullName:  reliableLink::enqueue
+	// Access:    public
+	// Returns:   void
+	// Parameter: const encodedMessage::pointer& inRelay
+	//--------------------------------------------------------------------------
+	void enqueue(
+		const encodedMessage::pointer& inRelay);
+
+	//------------------------------------------------------------- takeSendable
+	// Brief Description
+	//  Returns the messages that should be put on the wire now: relays whose
+	//  retransmit timer expired, then queued relays while they are within
+	//  the window size of the oldest relay waiting on an ACK. Each timeout
+	//  doubles the retransmit timer, and only a few relays are retransmitted
+	//  per call, so a silent peer is not flooded. Each is returned with the
+	//  link sequence numbers to send it with.
+	//
+	// Method:    takeSendable
+	// FullName:  reliableLink::takeSendable
+	// Access:    public
+	// Returns:   std::vector<relayTransmission>
+	// Parameter: const linkClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	std::vector<relayTransmission> takeSendable(
+		const linkClock::time_point& inNow);
+
+	//--------------------------------------------------- receiveAcknowledgement
+	// Brief Description
+	//  Processes an ACK from the peer. Its sequence number acknowledges
+	//  every relay up to and including it, and its payload lists ranges of
+	//  relays received out of order. Relays sent only once give round trip
+	//  time samples for the retransmit timer, and only their ACKs end its
+	//  backoff. A relay that later relays were ACKed past several times is
+	//  retransmitted without waiting for its timer.
+	//
+	// Method:    receiveAcknowledgement
+	// FullName:  reliableLink::receiveAcknowledgement
+	// Access:    public
+	// Returns:   void
+	// Parameter: const dataMessage& inAcknowledgement
+	// Parameter: const linkClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	void receiveAcknowledgement(
+		const dataMessage& inAcknowledgement,
+		const linkClock::time_point& inNow);
+
+	//------------------------------------------------------- takeUnacknowledged
+	// Brief Description
+	//  Removes and returns every relay not yet acknowledged, oldest first.
+	//  Used when the peer is down so the relays can be routed another way.
+	//
+	// Method:    takeUnacknowledged
+	// FullName:  reliableLink::takeUnacknowledged
+	// Access:    public
+	// Returns:   std::vector<encodedMessage::pointer>
+	//--------------------------------------------------------------------------
+	std::vector<encodedMessage::pointer> takeUnacknowledged();
+
+	//------------------------------------------------------------------ receive
+	// Brief Description
+	//  Records a relay received from the peer. Returns true the first time a
+	//  relay is received and false for a duplicate, which must not be
+	//  processed again.
+	//
+	// Method:    receive
+	// FullName:  reliableLink::receive
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const dataMessage& inRelayMessage
+	//--------------------------------------------------------------------------
+	bool receive(
+		const dataMessage& inRelayMessage);
+
+	//---------------------------------------------------- createAcknowledgement
+	// Brief Description
+	//  Returns the ACK describing every relay received from the peer so far.
+	//
+	// Method:    createAcknowledgement
+	// FullName:  reliableLink::createAcknowledgement
+	// Access:    public
+	// Returns:   dataMessage
+	//--------------------------------------------------------------------------
+	dataMessage createAcknowledgement() const;
+
+	//------------------------------------------------------------- viewInFlight
+	// Brief Description
+	//  Returns the number of relays sent and waiting on an ACK.
+	//
+	// Method:    viewInFlight
+	// FullName:  reliableLink::viewInFlight
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewInFlight() const;
+
+	//--------------------------------------------------------------- viewQueued
+	// Brief Description
+	//  Returns the number of relays waiting for room in the window.
+	//
+	// Method:    viewQueued
+	// FullName:  reliableLink::viewQueued
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewQueued() const;
+
+	//----------------------------------------------------------- viewRelaysSent
+	// Brief Description
+	//  Returns the number of relays sent for the first time.
+	//
+	// Method:    viewRelaysSent
+	// FullName:  reliableLink::viewRelaysSent
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewRelaysSent() const;
+
+	//------------------------------------------------------ viewRetransmissions
+	// Brief Description
+	//  Returns the number of relays sent again after their timer expired.
+	//
+	// Method:    viewRetransmissions
+	// FullName:  reliableLink::viewRetransmissions
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewRetransmissions() const;
+
+	//--------------------------------------------------- viewDuplicatesReceived
+	// Brief Description
+	//  Returns the number of relays from the peer that were received again.
+	//
+	// Method:    viewDuplicatesReceived
+	// FullName:  reliableLink::viewDuplicatesReceived
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewDuplicatesReceived() const;
+
+	//------------------------------------------------ viewRoundTripMilliseconds
+	// Brief Description
+	//  Returns the smoothed round trip time to the peer, 0 before the first
+	//  sample.
+	//
+	// Method:    viewRoundTripMilliseconds
+	// FullName:  reliableLink::viewRoundTripMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewRoundTripMilliseconds() const;
+
+	//---------------------------------------- viewRetransmitTimeoutMilliseconds
+	// Brief Description
+	//  Returns the current retransmit timer.
+	//
+	// Method:    viewRetransmitTimeoutMilliseconds
+	// FullName:  reliableLink::viewRetransmitTimeoutMilliseconds
+	// Access:    public
+	// Returns:   const double&
+	//--------------------------------------------------------------------------
+	const double& viewRetransmitTimeoutMilliseconds() const;
+
+private:
+
+	//----------------------------------------------------------- viewWindowBase
+	// Brief Description
+	//  Returns the lowest link sequence number still waiting on an ACK, or
+	//  the next one to be used if none is.
+	//
+	// Method:    viewWindowBase
+	// FullName:  reliableLink::viewWindowBase
+	// Access:    private
+	// Returns:   int64_t
+	//--------------------------------------------------------------------------
+	int64_t viewWindowBase() const;
+
+	class inFlightRelay
+	{
+	public:
+		inFlightRelay(
+			const encodedMessage::pointer& inRelay,
+			const linkClock::time_point& inTimeSent,
+			const uint64_t& inTransmissionOrder) :
+			m_relay(inRelay),
+			m_timeSent(inTimeSent),
+			m_transmissionOrder(inTransmissionOrder),
+			m_transmissions(1),
+			m_timesSkipped(0)
+		{
+		};
+
+		encodedMessage::pointer m_relay;
+		linkClock::time_point m_timeSent;
+		uint64_t m_transmissionOrder;
+		uint16_t m_transmissions;
+		uint16_t m_timesSkipped;
+	};
+
+	// Member Variables
+	std::string m_localName;
+	std::string m_peerName;
+
+	// sending side
+	int64_t m_nextSequenceNumber;
+	std::deque<encodedMessage::pointer> m_queued;
+	std::map<int64_t, inFlightRelay> m_inFlight;
+	retransmitTimer m_retransmitTimer;
+	uint64_t m_transmissionCount;
+
+	// receiving side
+	int64_t m_nextExpectedSequenceNumber;
+	std::set<int64_t> m_receivedAhead;
+
+	uint64_t m_relaysSent;
+	uint64_t m_retransmissions;
+	uint64_t m_duplicatesReceived;
+};
\ No newline at end of file
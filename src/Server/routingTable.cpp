@@ -0,0 +1,108 @@
+// STL
+#include <algorithm>
+#include <deque>
+
+// Project
+#include "routingTable.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Every server starts out up
+//------------------------------------------------------------------------------
+routingTable::routingTable(
+	const serverTopology& inTopology,
+	const int16_t& inServerIndex) :
+	m_topology(inTopology),
+	m_index(inServerIndex),
+	m_neighbours(inTopology.viewNeighbours(inServerIndex)),
+	m_nextHopByServerIndex(inTopology.numberOfServers(), -1)
+{
+	this->update(
+		std::vector<bool>(inTopology.numberOfServers(), true));
+};
+
+//----------------------------------------------------------------------- update
+// Implementation notes:
+//  Breadth first search from this server through the servers that are up.
+//  Each server reached inherits the first hop of the server it was reached
+//  from, so ties go to the neighbour listed first.
+//------------------------------------------------------------------------------
+void routingTable::update(
+	const std::vector<bool>& inServerIsUp)
+{
+	std::fill(
+		this->m_nextHopByServerIndex.begin(),
+		this->m_nextHopByServerIndex.end(),
+		-1);
+
+	std::deque<int16_t> toVisit;
+
+	for(const int16_t& neighbour : this->m_neighbours)
+	{
+		if(inServerIsUp[neighbour])
+		{
+			this->m_nextHopByServerIndex[neighbour] = neighbour;
+			toVisit.push_back(neighbour);
+		}
+	}
+
+	while(!toVisit.empty())
+	{
+		const int16_t current = toVisit.front();
+		toVisit.pop_front();
+
+		for(const int16_t& next : this->m_topology.viewNeighbours(current))
+		{
+			if(next != this->m_index
+				&& inServerIsUp[next]
+				&& this->m_nextHopByServerIndex[next] == -1)
+			{
+				this->m_nextHopByServerIndex[next] =
+					this->m_nextHopByServerIndex[current];
+
+				toVisit.push_back(next);
+			}
+		}
+	}
+};
+
+//------------------------------------------------------------------ viewNextHop
+// Implementation notes:
+//  Table lookup, -1 for this server or an unreachable one
+//------------------------------------------------------------------------------
+int16_t routingTable::viewNextHop(
+	const int16_t& inDestinationServerIndex) const
+{
+	return this->m_nextHopByServerIndex[inDestinationServerIndex];
+};
+
+//--------------------------------------------------------------- viewNeighbours
+// Implementation notes:
+//  Returns a const reference to the neighbours
+//------------------------------------------------------------------------------
+const std::vector<int16_t>& routingTable::viewNeighbours() const
+{
+	return this->m_neighbours;
+};
+
+//-------------------------------------------------------------- shouldAdvertise
+// Implementation notes:
+//  This server is on the neighbour's shortest path to the origin exactly
+//  when the neighbour is one hop farther from the origin than this server.
+//------------------------------------------------------------------------------
+bool routingTable::shouldAdvertise(
+	const int16_t& inOriginServerIndex,
+	const int16_t& inNeighbourServerIndex) const
+{
+	if(inOriginServerIndex == this->m_index)
+	{
+		return true;
+	}
+
+	const int16_t distanceFromHere =
+		this->m_topology.distance(this->m_index, inOriginServerIndex);
+
+	return (distanceFromHere != -1)
+		&& (this->m_topology.distance(inNeighbourServerIndex, inOriginServerIndex)
+			== distanceFromHere + 1);
+};
\ No newline at end of file
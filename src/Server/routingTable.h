@@ -0,0 +1,96 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// Project
+#include "../Common/serverTopology.h"
+
+class routingTable
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the routing table of one server. The next hop towards
+	//  every other server follows from the routing mode of the topology.
+	//
+	// Method:    routingTable
+	// FullName:  routingTable::routingTable
+	// Access:    public
+	// Returns:
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	routingTable(
+		const serverTopology& inTopology,
+		const int16_t& inServerIndex);
+
+	//------------------------------------------------------------------- update
+	// Brief Description
+	//  Recomputes the next hops so that paths avoid the servers that are
+	//  down. Servers only reachable through a down server become
+	//  unreachable.
+	//
+	// Method:    update
+	// FullName:  routingTable::update
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::vector<bool>& inServerIsUp
+	//--------------------------------------------------------------------------
+	void update(
+		const std::vector<bool>& inServerIsUp);
+
+	//-------------------------------------------------------------- viewNextHop
+	// Brief Description
+	//  Returns the neighbour a message destined for a client on the given
+	//  server should be sent to. In a mesh this is the server itself, on the
+	//  chain it is the adjacent server in that direction. Returns -1 if the
+	//  server cannot be reached.
+	//
+	// Method:    viewNextHop
+	// FullName:  routingTable::viewNextHop
+	// Access:    public
+	// Returns:   int16_t
+	// Parameter: const int16_t& inDestinationServerIndex
+	//--------------------------------------------------------------------------
+	int16_t viewNextHop(
+		const int16_t& inDestinationServerIndex) const;
+
+	//----------------------------------------------------------- viewNeighbours
+	// Brief Description
+	//  Returns the servers this server exchanges messages with directly.
+	//
+	// Method:    viewNeighbours
+	// FullName:  routingTable::viewNeighbours
+	// Access:    public
+	// Returns:   const std::vector<int16_t>&
+	//--------------------------------------------------------------------------
+	const std::vector<int16_t>& viewNeighbours() const;
+
+	//---------------------------------------------------------- shouldAdvertise
+	// Brief Description
+	//  Used to determine if the client list of the origin server should be
+	//  synced to the neighbour. It should if the neighbour's shortest path
+	//  to the origin goes through this server, so that each list travels
+	//  away from its origin and never back towards it.
+	//
+	// Method:    shouldAdvertise
+	// FullName:  routingTable::shouldAdvertise
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const int16_t& inOriginServerIndex
+	// Parameter: const int16_t& inNeighbourServerIndex
+	//--------------------------------------------------------------------------
+	bool shouldAdvertise(
+		const int16_t& inOriginServerIndex,
+		const int16_t& inNeighbourServerIndex) const;
+
+private:
+	// Member Variables
+	const serverTopology& m_topology;
+	int16_t m_index;
+	std::vector<int16_t> m_neighbours;
+	std::vector<int16_t> m_nextHopByServerIndex;
+};
\ No newline at end of file
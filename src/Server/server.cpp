@@ -1,102 +1,207 @@
 // STL
 #include <cstdint>
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
 
 // Boost
 #include <boost/array.hpp>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/filesystem.hpp>
 
 // Project
 #include "server.h"
 #include "../Common/constants.h"
+#include "../Common/acknowledgementFrame.h"
+#include "../Common/asyncLog.h"
+#include "../Common/stageProfiler.h"
 
 //------------------------------------------------------------------ constructor
 // Implementation notes:
-//  Initializes the server based on the specified listeningPort
+//  Initializes the server based on its entry in the topology. Other
+//  servers are reached at the addresses given in the topology, no host
+//  name resolution is done.
 //------------------------------------------------------------------------------
 server::server(
-	const uint16_t& inListeningPort,
-	const int8_t& inServerIndex,
+	const serverTopology& inTopology,
+	const int16_t& inServerIndex,
 	boost::asio::io_service& ioService) :
-	m_resolver(ioService),
-	m_ioService(&ioService),
+	m_topology(inTopology),
+	m_routingTable(m_topology, inServerIndex),
 	m_UDPsocket(
 		ioService,
 		boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(),
-		inListeningPort)),
+		inTopology.viewServerEndpoint(inServerIndex).port())),
+	m_ioService(&ioService),
 	m_index(inServerIndex),
 	m_terminate(false),
 	m_sequenceNumber(0),
-	m_leftAdjacentServerIndex(inServerIndex - 1),
-	m_leftAdjacentServerConnection(nullptr),
-	m_rightAdjacentServerIndex(inServerIndex + 1),
-	m_rightAdjacentServerConnection(nullptr)
+	m_backlog(
+		constants::recipientMessageQuota,
+		constants::recipientByteQuota,
+		constants::serverMessageQuota,
+		constants::serverByteQuota),
+	m_retryHeldMessagesNow(false),
+	m_nextSessionIdentifier((static_cast<uint32_t>(inServerIndex) << 24) + 1),
+	m_cachedNow(heartbeatClock::now()),
+	m_sessionWheel(
+		constants::sessionWheelSlotCount,
+		constants::sessionWheelTickMilliseconds,
+		m_cachedNow),
+	m_clientsEvicted(0),
+	m_clientsServedByServerIndex(inTopology.numberOfServers()),
+	m_membershipVersionByServerIndex(inTopology.numberOfServers(), 0),
+	m_channelsServedByServerIndex(inTopology.numberOfServers()),
+	m_channelVersionByServerIndex(inTopology.numberOfServers(), 0),
+	m_clientListAssemblyByServerIndex(inTopology.numberOfServers()),
+	m_channelListAssemblyByServerIndex(inTopology.numberOfServers()),
+	m_membershipFilterByServerIndex(inTopology.numberOfServers()),
+	m_timeOfListRequestByServerIndex(inTopology.numberOfServers()),
+	m_heldClientUpdatesByServerIndex(inTopology.numberOfServers()),
+	m_heldChannelUpdatesByServerIndex(inTopology.numberOfServers()),
+	m_serverIsUp(inTopology.numberOfServers(), true),
+	m_lastHeardFromServerIndex(
+		inTopology.numberOfServers(),
+		heartbeatClock::now()),
+	m_receiveErrors(&m_metrics.addCounter("errors.receive")),
+	m_sendErrors(&m_metrics.addCounter("errors.send")),
+	m_unknownSessions(&m_metrics.addCounter("errors.unknown_session")),
+	m_invalidUsernames(&m_metrics.addCounter("errors.invalid_username")),
+	m_syncPayloadBytes(&m_metrics.addCounter("sync.payload_bytes")),
+	m_listRequests(&m_metrics.addCounter("sync.list_requests")),
+	m_namesRuledOut(&m_metrics.addCounter("sync.names_ruled_out")),
+	m_handlingLatency(&m_metrics.addHistogram("latency.handling_us")),
+	m_deliveryLatency(&m_metrics.addHistogram("latency.delivery_us")),
+	m_clientSendsSinceTrace(0),
+	m_nextTraceIdentifier(0)
 {
 	const std::string serverName(
-		constants::serverIndexToServerName(inServerIndex));
-
-	std::cout << serverName << " server started." << std::endl;
-	std::cout << "Listening on port: " << inListeningPort << std::endl;
-
-	// Left Adjacent Server query setup
-	if(constants::leftAdjacentServerIndexIsValid(
-		this->m_leftAdjacentServerIndex))
+		this->m_topology.viewServerName(inServerIndex));
+
+	asyncLog::setLevel(
+		this->m_topology.viewLogLevel(),
+		this->m_topology.viewTraceSampling());
+
+	asyncLog::write(
+		asyncLog::ll_INFO,
+		"{} server started.",
+		serverName);
+	asyncLog::write(
+		asyncLog::ll_INFO,
+		"Listening on port: {}",
+		this->m_UDPsocket.local_endpoint().port());
+	asyncLog::write(
+		asyncLog::ll_INFO,
+		"Routing: {}",
+		this->m_topology.routingModeAsString());
+
+	// this server's list versions start from the time it started, so
+	// lists from before a restart are replaced rather than kept
+	this->m_membershipVersionByServerIndex[inServerIndex] =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count();
+
+	this->m_channelVersionByServerIndex[inServerIndex] =
+		this->m_membershipVersionByServerIndex[inServerIndex];
+
+	// relays are numbered from the time the server started, so the numbers
+	// keep increasing across restarts
+	const int64_t firstLinkSequenceNumber =
+		this->m_membershipVersionByServerIndex[inServerIndex] * 1000;
+
+	// Every server can be reached directly at its address in the topology,
+	// the routing table decides which of them this server talks to.
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
 	{
-		const std::string leftAdjacentServerAddress =
-			constants::serverHostName(this->m_leftAdjacentServerIndex);
+		this->m_serverConnections.push_back(remoteConnection(
+			this->m_topology.viewServerName(serverIndex),
+			this->m_topology.viewServerEndpoint(serverIndex)));
+
+		this->m_serverLinks.push_back(reliableLink(
+			serverName,
+			this->m_topology.viewServerName(serverIndex),
+			firstLinkSequenceNumber));
+	}
 
-		const std::string leftAdjacentServerPort =
-			std::to_string(
-				constants::serverListeningPorts[this->m_leftAdjacentServerIndex]);
+	// one counter per message type, named after it
+	for(int type = constants::MessageType::mt_UNDEFINED;
+		type <= constants::MessageType::mt_SERVER_SYNC_REQUEST;
+		type++)
+	{
+		std::string typeName("undefined");
 
-		boost::asio::ip::udp::resolver::query serverQuery(
-			boost::asio::ip::udp::v4(),
-			leftAdjacentServerAddress,
-			leftAdjacentServerPort);
+		if(type != constants::MessageType::mt_UNDEFINED)
+		{
+			typeName = dataMessage(
+				0,
+				static_cast<constants::MessageType>(type),
+				serverName,
+				serverName,
+				"blank").viewMessageTypeAsString();
+
+			std::replace(
+				typeName.begin(),
+				typeName.end(),
+				' ',
+				'_');
+		}
 
-		boost::asio::ip::udp::endpoint leftAdjacentServerEndPoint =
-			*this->m_resolver.resolve(serverQuery);
+		this->m_messagesReceivedByType.push_back(
+			&this->m_metrics.addCounter("received." + typeName));
+	}
 
-		this->m_leftAdjacentServerConnection = new remoteConnection(
-			constants::serverIndexToServerName(this->m_leftAdjacentServerIndex),
-			leftAdjacentServerEndPoint);
+	if(!this->m_topology.viewMetricsDirectory().empty())
+	{
+		boost::filesystem::create_directories(
+			this->m_topology.viewMetricsDirectory());
 	}
 
-	// Right Adjacent Server query setup
-	if(constants::rightAdjacentServerIndexIsValid(
-		this->m_rightAdjacentServerIndex))
+	// trace identifiers start from the time the server started, like the
+	// link sequence numbers, so they are not reused across restarts
+	if(!this->m_topology.viewMessageTraceDirectory().empty())
 	{
-		const std::string rightAdjacentServerAddress =
-			constants::serverHostName(this->m_rightAdjacentServerIndex);
+		boost::filesystem::create_directories(
+			this->m_topology.viewMessageTraceDirectory());
+
+		this->m_traceFile.open(
+			(this->m_topology.viewMessageTraceDirectory() + "/" + serverName + ".traces").c_str(),
+			std::ios::app);
 
-		const std::string rightAdjacentServerPort =
-			std::to_string(
-				constants::serverListeningPorts[this->m_rightAdjacentServerIndex]);
+		this->m_nextTraceIdentifier = firstLinkSequenceNumber;
+	}
+
+	if(!this->m_topology.viewCaptureDirectory().empty())
+	{
+		boost::filesystem::create_directories(
+			this->m_topology.viewCaptureDirectory());
 
-		boost::asio::ip::udp::resolver::query serverQuery(
-			boost::asio::ip::udp::v4(),
-			rightAdjacentServerAddress,
-			rightAdjacentServerPort);
+		this->m_capture.reset(new datagramCapture(
+			this->m_topology.viewCaptureDirectory() + "/" + serverName + ".capture",
+			serverName));
+	}
 
-		boost::asio::ip::udp::endpoint rightAdjacentServerEndPoint =
-			*this->m_resolver.resolve(serverQuery);
+	// undelivered messages from before a restart are picked up again
+	if(!this->m_topology.viewSpoolDirectory().empty())
+	{
+		this->m_spool.reset(new messageSpool(
+			this->m_topology.viewSpoolDirectory() + "/" + serverName,
+			constants::spoolSegmentBytes));
 
-		this->m_rightAdjacentServerConnection = new remoteConnection(
-			constants::serverIndexToServerName(this->m_rightAdjacentServerIndex),
-			rightAdjacentServerEndPoint);
+		this->recoverSpooledMessages();
 	}
 };
 
 //------------------------------------------------------------------- destructor
 // Implementation notes:
-//  Delete adjacent server connections
+//  Close the socket
 //------------------------------------------------------------------------------
 server::~server()
 {
-	delete this->m_leftAdjacentServerConnection;
-	delete this->m_rightAdjacentServerConnection;
-
 	this->m_UDPsocket.close();
 };
 
@@ -122,49 +227,297 @@ void server::run()
 	// thread that attempts to forward messages where the target 
 	// client was not found previously
 	this->m_threads.create_thread(
-		boost::bind(&server::attemptForward, this));
+		boost::bind(&server::runPeriodically, this,
+			&server::attemptForward, constants::forwardIntervalMilliseconds));
+
+	// thread that sends membership changes and retransmits relays
+	this->m_threads.create_thread(
+		boost::bind(&server::runPeriodically, this,
+			&server::flushServerLinks, constants::forwardIntervalMilliseconds));
+
+	// thread that turns the session wheel and disconnects idle clients
+	this->m_threads.create_thread(
+		boost::bind(&server::runPeriodically, this,
+			&server::expireIdleClients, constants::sessionWheelTickMilliseconds));
+
+	// thread that drops messages past their deadline
+	this->m_threads.create_thread(
+		boost::bind(&server::runPeriodically, this,
+			&server::expireBacklog, constants::backlogSweepIntervalMilliseconds));
+
+	if(this->m_spool)
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::runPeriodically, this,
+				&server::synchronizeSpool, constants::spoolSynchronizeIntervalMilliseconds));
+	}
+
+	if(this->m_capture)
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::runPeriodically, this,
+				&server::flushCapture, constants::captureFlushIntervalMilliseconds));
+	}
+
+	if(!this->m_topology.viewMetricsDirectory().empty())
+	{
+		this->m_threads.create_thread(
+			boost::bind(&server::exportMetrics, this));
+	}
+
+	// thread for heartbeats and detecting servers that are down
+	this->m_threads.create_thread(
+		boost::bind(&server::monitorServers, this));
 
 	this->m_threads.join_all();
 };
 
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  Sleeping threads are interrupted, the listening thread is blocked in
+//  receive_from() so it is woken up with a ping sent to this server.
+//------------------------------------------------------------------------------
+void server::stop()
+{
+	this->m_terminate = true;
+
+	this->m_threads.interrupt_all();
+
+	try
+	{
+		boost::system::error_code ignoredError;
+
+		const std::string serverName(
+			this->m_topology.viewServerName(this->m_index));
+
+		const dataMessage wakeUpMessage(
+			0,
+			constants::MessageType::mt_PING,
+			serverName,
+			serverName,
+			"blank");
+
+		const boost::asio::ip::udp::endpoint thisServerEndPoint(
+			boost::asio::ip::address_v4::loopback(),
+			this->m_UDPsocket.local_endpoint().port());
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(wakeUpMessage.asCharVector()),
+			thisServerEndPoint, 0, ignoredError);
+	}
+	catch(std::exception& exception)
+	{
+		asyncLog::write(
+			asyncLog::ll_WARNING,
+			"Could not wake the listening thread: {}",
+			exception.what());
+	}
+};
+
+//---------------------------------------------------------- serverIndexOfClient
+// Implementation notes:
+//  Locked wrapper around lookupServerIndexOfClient for other threads
+//------------------------------------------------------------------------------
+int16_t server::serverIndexOfClient(
+	const std::string& inClientIdentifier)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->lookupServerIndexOfClient(
+		inClientIdentifier);
+};
+
+//--------------------------------------------------------- serverHasSubscribers
+// Implementation notes:
+//  Locked wrapper around channelIsServedBy for other threads
+//------------------------------------------------------------------------------
+bool server::serverHasSubscribers(
+	const std::string& inChannel,
+	const int16_t& inServerIndex)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->channelIsServedBy(
+		inChannel,
+		inServerIndex);
+};
+
+//--------------------------------------------------------------- clientsEvicted
+// Implementation notes:
+//  Read while holding the mutex
+//------------------------------------------------------------------------------
+uint64_t server::clientsEvicted()
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->m_clientsEvicted;
+};
+
+//--------------------------------------------------------- syncPayloadBytesSent
+// Implementation notes:
+//  Read while holding the mutex
+//------------------------------------------------------------------------------
+uint64_t server::syncPayloadBytesSent()
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->m_syncPayloadBytes->view();
+};
+
+//------------------------------------------------------------ backlogStatistics
+// Implementation notes:
+//  Copied while holding the mutex
+//------------------------------------------------------------------------------
+backlogAccounting server::backlogStatistics()
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->m_backlog;
+};
+
+//-------------------------------------------------------------- spoolStatistics
+// Implementation notes:
+//  Read while holding the mutex
+//------------------------------------------------------------------------------
+std::string server::spoolStatistics()
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	if(!this->m_spool)
+	{
+		return "";
+	}
+
+	return this->m_spool->statisticsAsString();
+};
+
+//-------------------------------------------------------------- metricsAsString
+// Implementation notes:
+//  Only the gauges are sampled while holding the mutex
+//------------------------------------------------------------------------------
+std::string server::metricsAsString(
+	const std::string& inPrefix)
+{
+	{
+		boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+		this->sampleMetrics();
+	}
+
+	return this->m_metrics.asString(
+		inPrefix);
+};
+
 //------------------------------------------------------------------- listenLoop
 // Implementation notes:
-//  Listen and acts via UDP
+//  Listen and acts via UDP. The member lists are shared with the forwarding
+//  and sync threads, so each message is handled while holding the mutex.
 //------------------------------------------------------------------------------
 void server::listenLoopUDP()
 {
+	// a datagram can be as large as the buffer, which is only allocated
+	// once, and just the received bytes are copied out of it
+	std::vector<char> receiveBuffer(constants::receiveBufferLength);
+
 	while(!this->m_terminate)
 	{
 		try
 		{
-			const uint16_t arbitraryLength = 256;
-
-			std::vector<char> receivedPayload(arbitraryLength);
-
 			boost::system::error_code error;
 
 			boost::asio::ip::udp::endpoint clientEndpoint;
 
 			// receive_from() populates the client endpoint
-			this->m_UDPsocket.receive_from(
-				boost::asio::buffer(receivedPayload),
-				clientEndpoint, 0, error);
+			const size_t receivedLength =
+				this->m_UDPsocket.receive_from(
+					boost::asio::buffer(receiveBuffer),
+					clientEndpoint, 0, error);
 
 			if(error && error != boost::asio::error::message_size)
 			{
 				throw boost::system::system_error(error);
 			}
 
+			const std::vector<char> receivedPayload(
+				receiveBuffer.begin(),
+				receiveBuffer.begin() + receivedLength);
+
+			if(this->m_terminate)
+			{
+				break;
+			}
+
+			// handling is timed from here, waiting for the mutex included
+			const heartbeatClock::time_point receivedAt = heartbeatClock::now();
+
+			stageProfiler::scopedStage handleStage("handle");
+
+			boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+			// recorded before parsing, datagrams that do not parse are
+			// replayed too
+			if(this->m_capture)
+			{
+				this->m_capture->record(
+					receivedAt,
+					clientEndpoint,
+					receivedPayload);
+			}
+
 			dataMessage message(
 				receivedPayload);
 
-			std::cout << "Received " << message.viewMessageTypeAsString();
-			std::cout << " message from " << message.viewSourceIdentifier();
+			if(message.viewMessageType() < this->m_messagesReceivedByType.size())
+			{
+				this->m_messagesReceivedByType[message.viewMessageType()]->add();
+			}
+
+			// heartbeats would drown out everything else
+			if(message.viewMessageType() == constants::MessageType::mt_PING)
+			{
+				stageProfiler::scopedStage stage("heartbeat");
+
+				this->receiveHeartbeat(
+					message);
+				continue;
+			}
+
+			// appended to the line logged for the message
+			const char* note = "";
+
+			// 0 unless a connected client sent it
+			uint32_t session = 0;
+
+			// a connect always names the client, whatever it starts with
+			if(message.viewMessageType() != constants::MessageType::mt_CLIENT_CONNECT
+				&& !this->resolveSession(message, clientEndpoint, session))
+			{
+				continue;
+			}
+
+			// any message from a client keeps its session alive
+			this->refreshClientActivity(
+				session);
 
 			switch(message.viewMessageType())
 			{
 				case constants::MessageType::mt_CLIENT_CONNECT:
 				{
+					stageProfiler::scopedStage stage("client connect");
+
+					if(!dataMessage::isValidUsername(message.viewSourceIdentifier()))
+					{
+						this->m_invalidUsernames->add();
+
+						asyncLog::write(
+							asyncLog::ll_WARNING,
+							"Refused connection: {} is not a valid username",
+							message.viewSourceIdentifier());
+
+						note = " (invalid username)";
+						break;
+					}
+
 					this->addClientConnection(
 						message.viewSourceIdentifier(),
 						clientEndpoint);
@@ -172,52 +525,134 @@ void server::listenLoopUDP()
 				}
 				case constants::MessageType::mt_CLIENT_DISCONNECT:
 				{
+					stageProfiler::scopedStage stage("client disconnect");
+
 					this->removeClientConnection(
 						message.viewSourceIdentifier());
 					break;
 				}
 				case constants::MessageType::mt_CLIENT_SEND:
 				{
-					this->processClientSendMessage(
-						message);
+					stageProfiler::scopedStage stage("client send");
+
+					if(this->acknowledgeClientSend(message, clientEndpoint, session))
+					{
+						this->processClientSendMessage(
+							message);
+					}
+					else
+					{
+						note = " (duplicate)";
+					}
+					break;
+				}
+				case constants::MessageType::mt_CLIENT_JOIN:
+				case constants::MessageType::mt_CLIENT_LEAVE:
+				{
+					stageProfiler::scopedStage stage("client subscription");
+
+					// sent reliably, the same way as chat messages
+					if(this->acknowledgeClientSend(message, clientEndpoint, session))
+					{
+						this->updateSubscription(
+							message,
+							clientEndpoint);
+					}
+					else
+					{
+						note = " (duplicate)";
+					}
 					break;
 				}
 				case constants::MessageType::mt_CLIENT_GET:
 				{
+					stageProfiler::scopedStage stage("client get");
+
 					this->sendMessagesToClient(
-						message.viewSourceIdentifier());
+						session);
 					break;
 				}
 				case constants::MessageType::mt_CLIENT_ACK:
 				{
+					stageProfiler::scopedStage stage("client ack");
+
+					// an ACK from a session still has the session as its source
 					this->removeReceivedMessageFromList(
-						message);
+						message,
+						session == 0
+							? message.viewSourceIdentifier()
+							: this->m_connectedClients.find(session)->second.viewIdentifier());
 					break;
 				}
 				case constants::MessageType::mt_SERVER_SEND:
 				{
-					this->processServerRelayMessage(
-						message);
+					stageProfiler::scopedStage stage("server relay");
+
+					this->receiveServerRelay(
+						message,
+						clientEndpoint);
 					break;
 				}
 				case constants::MessageType::mt_SERVER_ACK:
 				{
-					// #TODO necessary?
+					stageProfiler::scopedStage stage("server ack");
+
+					this->receiveServerAcknowledgement(
+						message);
 					break;
 				}
 				case constants::MessageType::mt_SERVER_SYNC:
+				case constants::MessageType::mt_SERVER_CHANNEL_SYNC:
+				case constants::MessageType::mt_SERVER_SUMMARY:
+				case constants::MessageType::mt_SERVER_SYNC_REQUEST:
 				{
-					this->receiveClientsFromAdjacentServers(
-						message);
+					stageProfiler::scopedStage stage("server sync");
+
+					if(message.viewMessageType() == constants::MessageType::mt_SERVER_SUMMARY)
+					{
+						this->receiveMembershipSummary(
+							message);
+					}
+					else if(message.viewMessageType() == constants::MessageType::mt_SERVER_SYNC_REQUEST)
+					{
+						this->receiveListRequest(
+							message);
+					}
+					else
+					{
+						this->receiveClientsFromAdjacentServers(
+							message);
+					}
 
-					std::cout << " (Origin: " << constants::serverIndexToServerName(
-						message.viewServerSyncPayloadOriginIndex()) << ")" << std::endl;
+					asyncLog::write(
+						asyncLog::ll_TRACE,
+						"Received {} message from {} (Origin: {})",
+						message.viewMessageTypeAsString(),
+						message.viewSourceIdentifier(),
+						this->m_topology.viewServerName(
+							message.viewServerSyncPayloadOriginIndex()));
+
+					this->m_handlingLatency->record(
+						boost::chrono::duration_cast<boost::chrono::microseconds>(
+							heartbeatClock::now() - receivedAt).count());
 					continue;
+				}
+				case constants::MessageType::mt_SERVER_CLIENT_JOINED:
+				case constants::MessageType::mt_SERVER_CLIENT_LEFT:
+				case constants::MessageType::mt_SERVER_CHANNEL_ADDED:
+				case constants::MessageType::mt_SERVER_CHANNEL_REMOVED:
+				{
+					stageProfiler::scopedStage stage("membership update");
+
+					// sent over the links like relays, and ACKed the same way
+					this->receiveServerRelay(
+						message,
+						clientEndpoint);
 					break;
 				}
 				case constants::MessageType::mt_PING:
 				{
-					// Do nothing
+					// Handled before the switch
 					break;
 				}
 				default:
@@ -226,11 +661,25 @@ void server::listenLoopUDP()
 				}
 			}
 
-			std::cout << std::endl;
+			// the type name is built on every call, skip it when not tracing
+			if(asyncLog::enabled(asyncLog::ll_TRACE))
+			{
+				asyncLog::write(
+					asyncLog::ll_TRACE,
+					"Received {} message from {}{}",
+					message.viewMessageTypeAsString(),
+					message.viewSourceIdentifier(),
+					note);
+			}
+
+			this->m_handlingLatency->record(
+				boost::chrono::duration_cast<boost::chrono::microseconds>(
+					heartbeatClock::now() - receivedAt).count());
 		}
 		catch(...)
 		{
-
+			// datagrams that do not parse, and sockets that fail
+			this->m_receiveErrors->add();
 		}
 	}
 };
@@ -240,503 +689,2988 @@ void server::listenLoopUDP()
 //  Sends all messages destined for the client who sent the get request
 //------------------------------------------------------------------------------
 void server::sendMessagesToClient(
-	const std::string& inClientIdentifier)
+	const uint32_t& inSessionIdentifier)
 {
-	boost::system::error_code ignoredError;
+	boost::system::error_code error;
+
+	std::unordered_map<uint32_t, remoteConnection>::const_iterator targetClient =
+		this->m_connectedClients.find(inSessionIdentifier);
 
-	for(const remoteConnection& targetClient : this->m_connectedClients)
+	if(targetClient == this->m_connectedClients.end())
 	{
-		if(targetClient.viewIdentifier() == inClientIdentifier)
+		return;
+	}
+
+	std::map<std::string, std::list<pendingMessage>>::iterator pending =
+		this->m_messageListByClient.find(targetClient->second.viewIdentifier());
+
+	if(pending == this->m_messageListByClient.end())
+	{
+		return;
+	}
+
+	for(pendingMessage& currentMessage : pending->second)
+	{
+		if(currentMessage.m_deliveredMicroseconds == 0
+			&& currentMessage.m_message->viewMessage().viewTrace().isTraced())
+		{
+			currentMessage.m_deliveredMicroseconds = messageTrace::nowMicroseconds();
+		}
+
+		try
 		{
-			for(const dataMessage& currentMessage : this->m_messageList)
+			stageProfiler::scopedStage stage("send_to");
+
+			this->m_UDPsocket.send_to(
+				currentMessage.m_message->viewBuffers(),
+				targetClient->second.viewEndpoint(), 0, error);
+
+			if(error)
 			{
-				if(currentMessage.viewDestinationIdentifier() == inClientIdentifier)
-				{
-					try
-					{
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(currentMessage.asCharVector()),
-							targetClient.viewEndpoint(), 0, ignoredError);
-					}
-					catch(std::exception& exception)
-					{
-						// std::cout << exception.what() << std::endl;
-					}
-				}
-				else
-				{
-					// Do nothing, message is not destined for the 
-					// client that issued the get
-				}
+				this->m_sendErrors->add();
 			}
-
-			break;
 		}
-		else
+		catch(std::exception& exception)
 		{
-			// Do nothing, target client is not the one we want
+			// std::cout << exception.what() << std::endl;
 		}
 	}
 };
 
 //------------------------------------------------ removeReceivedMessageFromList
 // Implementation notes:
-//  Removes the message the client confirmed to have received from the list
+//  Only the list of the client that sent the ACK is walked, once, whatever
+//  the number of messages the frame acknowledges. An ACK with a "blank"
+//  payload comes from an older client and acknowledges the one message
+//  with its sequence number. What is removed no longer counts against the
+//  client's quota.
 //------------------------------------------------------------------------------
 void server::removeReceivedMessageFromList(
-	const dataMessage& inMessage)
+	const dataMessage& inMessage,
+	const std::string& inClientIdentifier)
 {
-	for(std::list<dataMessage>::iterator it = this->m_messageList.begin();
-		it != this->m_messageList.end();
-		it++)
+	std::map<std::string, std::list<pendingMessage>>::iterator pending =
+		this->m_messageListByClient.find(inClientIdentifier);
+
+	if(pending == this->m_messageListByClient.end())
 	{
-		if(it->viewSequenceNumber() == inMessage.viewSequenceNumber())
-		{
-			this->m_messageList.erase(it);
-			break;
-		}
-		else
-		{
-			continue;
-		}
+		return;
 	}
-};
 
-//----------------------------------------------------- processClientSendMessage
-// Implementation notes:
-//  Determines if the message the client sent should be kept on this server
-//  or if it should be forwarded to another server
-//------------------------------------------------------------------------------
-void server::processClientSendMessage(
-	const dataMessage& inMessage)
-{
-	const std::string destinationID(
-		inMessage.viewDestinationIdentifier());
+	std::list<pendingMessage>& messageList = pending->second;
 
-	// check this server's client list first
-	for(const remoteConnection& currentClient : this->m_connectedClients)
+	const heartbeatClock::time_point now = heartbeatClock::now();
+
+	if(inMessage.viewPayload() == "blank")
 	{
-		if(currentClient.viewIdentifier() == destinationID)
+		for(std::list<pendingMessage>::iterator it = messageList.begin();
+			it != messageList.end();
+			it++)
 		{
-			// destination client was found on this server, stop searching
-			// and add to the message list of this server
-			this->addToMessageList(
-				inMessage);
+			const dataMessage& acknowledgedMessage = it->m_message->viewMessage();
 
-			return;
-		}
-		else
-		{
-			// client does not match, continue searching
-			continue;
+			if(acknowledgedMessage.viewSequenceNumber() == inMessage.viewSequenceNumber())
+			{
+				this->m_backlog.release(
+					pending->first,
+					acknowledgedMessage.viewPayload().size());
+
+				this->unspoolMessage(
+					it->m_spoolIdentifier);
+
+				this->m_deliveryLatency->record(
+					boost::chrono::duration_cast<boost::chrono::microseconds>(
+						now - it->m_queuedAt).count());
+
+				this->recordTrace(
+					*it,
+					messageTrace::nowMicroseconds());
+
+				messageList.erase(it);
+				break;
+			}
 		}
 	}
-
-	// check clients on servers to the left
-	for(int8_t serverIndex = 0;
-		serverIndex < this->m_index;
-		serverIndex++)
+	else
 	{
-		for(size_t i = 0;
-			i < this->m_clientsServedByServerIndex[serverIndex].size();
-			i++)
+		const acknowledgementFrame frame(
+			inMessage);
+
+		std::list<pendingMessage>::iterator it = messageList.begin();
+
+		while(it != messageList.end())
 		{
-			if(this->m_clientsServedByServerIndex[serverIndex][i] == destinationID)
+			const dataMessage& acknowledgedMessage = it->m_message->viewMessage();
+
+			if(frame.contains(acknowledgedMessage.viewSourceIdentifier(), acknowledgedMessage.viewSequenceNumber()))
 			{
+				this->m_backlog.release(
+					pending->first,
+					acknowledgedMessage.viewPayload().size());
 
-				if(this->m_leftAdjacentServerConnection != nullptr)
-				{
-					try
-					{
-						boost::system::error_code ignoredError;
+				this->unspoolMessage(
+					it->m_spoolIdentifier);
 
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(inMessage.asCharVector()),
-							this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+				this->m_deliveryLatency->record(
+					boost::chrono::duration_cast<boost::chrono::microseconds>(
+						now - it->m_queuedAt).count());
 
-					}
-					catch(std::exception& exception)
-					{
-						// std::cout << exception.what() << std::endl;
-					}
-				}
-				else
-				{
-					// programming error, should never make it here
-					assert(false);
-				}
+				this->recordTrace(
+					*it,
+					messageTrace::nowMicroseconds());
 
-				return;
+				it = messageList.erase(it);
 			}
 			else
 			{
-				// client does not match, continue searching
-				continue;
+				it++;
 			}
 		}
 	}
 
-	// check clients on servers to the right
-	for(int8_t serverIndex = constants::highestServerIndex;
-		serverIndex > this->m_index;
-		serverIndex--)
+	if(messageList.empty())
 	{
-		for(size_t i = 0;
-			i < this->m_clientsServedByServerIndex[serverIndex].size();
-			i++)
-		{
-			if(this->m_clientsServedByServerIndex[serverIndex][i] == destinationID)
-			{
-
-				if(this->m_rightAdjacentServerConnection != nullptr)
-				{
-					try
-					{
-						boost::system::error_code ignoredError;
-
-						this->m_UDPsocket.send_to(
-							boost::asio::buffer(inMessage.asCharVector()),
-							this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+		this->m_messageListByClient.erase(pending);
+	}
+};
 
-					}
-					catch(std::exception& exception)
+//----------------------------------------------------- processClientSendMessage
+// Implementation notes:
+//  Records this server as the origin of the message, unless it was already
+//  set by a server that relayed it here, then routes it
+//------------------------------------------------------------------------------
+void server::processClientSendMessage(
+	const dataMessage& inMessage)
+{
+	dataMessage messageToRoute(inMessage);
+
+	if(messageToRoute.viewServerSyncPayloadOriginIndex() == -1)
+	{
+		messageToRoute.setServerSyncPayloadOriginIndex(
+			this->m_index);
+	}
+
+	if(this->m_traceFile.is_open()
+		&& ++this->m_clientSendsSinceTrace >= this->m_topology.viewMessageTraceSampling())
+	{
+		this->m_clientSendsSinceTrace = 0;
+
+		messageToRoute.setTrace(
+			messageTrace(++this->m_nextTraceIdentifier));
+	}
+
+	messageToRoute.stampTrace(
+		this->m_index,
+		messageTrace::ts_RECEIVE);
+
+	stageProfiler::scopedStage stage("route");
+
+	this->routeMessage(
+		messageToRoute,
+		true,
+		this->deadlineOf(messageToRoute));
+};
+
+//-------------------------------------------------------- acknowledgeClientSend
+// Implementation notes:
+//  Only the most recent sequence numbers of each client are remembered.
+//  Once that many are, anything older than all of them is taken to be a
+//  retransmission. Sends that are not from a connected client are ACKed
+//  but not remembered, so made up names cannot grow the table.
+//------------------------------------------------------------------------------
+bool server::acknowledgeClientSend(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint,
+	const uint32_t& inSessionIdentifier)
+{
+	const dataMessage ackMessage(
+		inMessage.viewSequenceNumber(),
+		constants::MessageType::mt_SERVER_ACK,
+		this->m_topology.viewServerName(this->m_index),
+		inMessage.viewSourceIdentifier(),
+		"blank");
+
+	boost::system::error_code error;
+
+	{
+		stageProfiler::scopedStage stage("send_to");
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(ackMessage.asCharVector()),
+			inClientEndpoint, 0, error);
+	}
+
+	if(error)
+	{
+		this->m_sendErrors->add();
+	}
+
+	if(inSessionIdentifier == 0)
+	{
+		return true;
+	}
+
+	std::set<int64_t>& received =
+		this->m_sendsReceivedBySession[inSessionIdentifier];
+
+	// a client never has sends more than the span apart waiting on an ACK,
+	// so a message older than all of these was received already
+	const size_t rememberedSends = 2 * constants::clientSequenceSpan;
+
+	if(received.count(inMessage.viewSequenceNumber()) > 0
+		|| (received.size() >= rememberedSends
+			&& inMessage.viewSequenceNumber() < *received.begin()))
+	{
+		return false;
+	}
+
+	received.insert(
+		inMessage.viewSequenceNumber());
+
+	if(received.size() > rememberedSends)
+	{
+		received.erase(received.begin());
+	}
+
+	return true;
+};
+
+//---------------------------------------------------- processServerRelayMessage
+// Implementation notes:
+//  A relayed message is routed the same way as one sent by a local client,
+//  using this server's knowledge of where the destination client is. Its
+//  deadline is carried as the time it had left when it was relayed.
+//  Membership updates come over the same links and are applied instead.
+//------------------------------------------------------------------------------
+void server::processServerRelayMessage(
+	const dataMessage& inMessage)
+{
+	if(inMessage.viewMessageType() != constants::MessageType::mt_SERVER_SEND)
+	{
+		this->receiveMembershipUpdate(
+			inMessage);
+
+		return;
+	}
+
+	if(inMessage.viewTrace().isTraced())
+	{
+		dataMessage tracedMessage(inMessage);
+
+		tracedMessage.stampTrace(
+			this->m_index,
+			messageTrace::ts_RECEIVE);
+
+		this->routeMessage(
+			tracedMessage,
+			true,
+			this->deadlineOf(tracedMessage));
+
+		return;
+	}
+
+	this->routeMessage(
+		inMessage,
+		true,
+		this->deadlineOf(inMessage));
+};
+
+//----------------------------------------------------------------- routeMessage
+// Implementation notes:
+//  Determines if the message should be kept on this server, relayed
+//  towards the server the destination client is on, or held until that
+//  server is known
+//------------------------------------------------------------------------------
+void server::routeMessage(
+	const dataMessage& inMessage,
+	const bool& inEnforceHopLimit,
+	const heartbeatClock::time_point& inDeadline)
+{
+	if(inMessage.isBroadcast() || inMessage.isChannel())
+	{
+		this->routeBroadcast(
+			inMessage,
+			inDeadline);
+
+		return;
+	}
+
+	if(inMessage.isMulticast())
+	{
+		this->routeMulticast(
+			inMessage,
+			inEnforceHopLimit,
+			inDeadline);
+
+		return;
+	}
+
+	const int16_t destinationServerIndex =
+		this->lookupServerIndexOfClient(
+			inMessage.viewDestinationIdentifier());
+
+	if(destinationServerIndex == this->m_index)
+	{
+		// destination client is connected to this server
+		this->addToMessageList(
+			inMessage,
+			inDeadline);
+
+		return;
+	}
+
+	// a message that has made more hops than there are servers is chasing
+	// out of date client lists, hold it until the lists are synced
+	if(destinationServerIndex != -1
+		&& (!inEnforceHopLimit
+			|| inMessage.viewHopCount() < this->m_topology.numberOfServers()))
+	{
+		const int16_t nextHop =
+			this->m_routingTable.viewNextHop(destinationServerIndex);
+
+		if(nextHop != -1)
+		{
+			this->relayToServer(
+				inMessage,
+				nextHop,
+				inDeadline);
+
+			return;
+		}
+	}
+
+	// the client is in no list, but a filter may say which server has it
+	if(destinationServerIndex == -1
+		&& this->m_topology.viewMembershipFilterBits() != 0)
+	{
+		this->confirmClientLocation(
+			inMessage.viewDestinationIdentifier());
+	}
+
+	// if we make it here, as per the requirements, we hold on to the message
+	this->addToMessageListOfUnassociatedClients(
+		inMessage,
+		inDeadline);
+};
+
+//--------------------------------------------------------------- routeBroadcast
+// Implementation notes:
+//  The target servers are split by the neighbour each is reached through,
+//  and each neighbour is sent one copy naming only its share. Every server
+//  removes itself, so a copy never comes back and each link carries the
+//  broadcast once. Servers that cannot be reached are skipped, their
+//  clients miss the broadcast as if they had connected after it. A channel
+//  message targets the servers known to have subscribers when it is sent.
+//------------------------------------------------------------------------------
+void server::routeBroadcast(
+	const dataMessage& inMessage,
+	const heartbeatClock::time_point& inDeadline)
+{
+	std::vector<int16_t> targetServerIndices =
+		inMessage.viewTargetServerIndices();
+
+	// not relayed yet, every server with recipients is a target
+	if(targetServerIndices.empty())
+	{
+		for(int16_t serverIndex = 0;
+			serverIndex < this->m_topology.numberOfServers();
+			serverIndex++)
+		{
+			if(inMessage.isBroadcast()
+				|| this->channelIsServedBy(inMessage.viewDestinationIdentifier(), serverIndex))
+			{
+				targetServerIndices.push_back(serverIndex);
+			}
+		}
+	}
+
+	std::map<int16_t, std::vector<int16_t>> targetServerIndicesByNextHop;
+
+	for(const int16_t& targetServerIndex : targetServerIndices)
+	{
+		if(targetServerIndex == this->m_index)
+		{
+			std::vector<remoteConnection> recipients;
+
+			if(inMessage.isBroadcast())
+			{
+				for(const std::pair<const uint32_t, remoteConnection>& currentClient :
+					this->m_connectedClients)
+				{
+					if(currentClient.second.viewIdentifier() != inMessage.viewSourceIdentifier())
 					{
-						// std::cout << exception.what() << std::endl;
+						recipients.push_back(currentClient.second);
 					}
 				}
-				else
-				{
-					// programming error, should never make it here
-					assert(false);
-				}
-
-				return;
 			}
 			else
 			{
-				// client does not match, continue searching
-				continue;
+				std::map<std::string, subscriberEndpoints>::const_iterator channel =
+					this->m_subscribersByChannel.find(inMessage.viewDestinationIdentifier());
+
+				if(channel != this->m_subscribersByChannel.end())
+				{
+					recipients.reserve(
+						channel->second.size());
+
+					for(const std::pair<const std::string, boost::asio::ip::udp::endpoint>& subscriber :
+						channel->second)
+					{
+						if(subscriber.first != inMessage.viewSourceIdentifier())
+						{
+							recipients.push_back(
+								remoteConnection(subscriber.first, subscriber.second));
+						}
+					}
+				}
 			}
+
+			this->fanOutToClients(
+				inMessage,
+				recipients,
+				inDeadline);
+
+			continue;
+		}
+
+		if(!this->m_topology.serverIndexIsValid(targetServerIndex))
+		{
+			continue;
+		}
+
+		const int16_t nextHop =
+			this->m_routingTable.viewNextHop(targetServerIndex);
+
+		if(nextHop != -1)
+		{
+			targetServerIndicesByNextHop[nextHop].push_back(
+				targetServerIndex);
+		}
+	}
+
+	for(const std::pair<const int16_t, std::vector<int16_t>>& share :
+		targetServerIndicesByNextHop)
+	{
+		dataMessage relayMessage(inMessage);
+
+		relayMessage.setTargetServerIndices(
+			share.second);
+
+		this->relayToServer(
+			relayMessage,
+			share.first,
+			inDeadline);
+	}
+};
+
+//--------------------------------------------------------------- routeMulticast
+// Implementation notes:
+//  The same split as a broadcast, by the recipients listed instead of by
+//  server. A recipient that cannot be routed yet is held as a private
+//  message, so the rest are not held back with it.
+//------------------------------------------------------------------------------
+void server::routeMulticast(
+	const dataMessage& inMessage,
+	const bool& inEnforceHopLimit,
+	const heartbeatClock::time_point& inDeadline)
+{
+	std::vector<remoteConnection> localRecipients;
+	std::map<int16_t, std::string> recipientsByNextHop;
+
+	for(const std::string& recipient : inMessage.viewRecipients())
+	{
+		const int16_t destinationServerIndex =
+			this->lookupServerIndexOfClient(
+				recipient);
+
+		if(destinationServerIndex == this->m_index)
+		{
+			localRecipients.push_back(
+				this->m_connectedClients.find(
+					this->m_sessionsByClient.find(recipient)->second)->second);
+
+			continue;
+		}
+
+		int16_t nextHop = -1;
+
+		// the same hop limit as a private message
+		if(destinationServerIndex != -1
+			&& (!inEnforceHopLimit
+				|| inMessage.viewHopCount() < this->m_topology.numberOfServers()))
+		{
+			nextHop = this->m_routingTable.viewNextHop(destinationServerIndex);
+		}
+
+		if(nextHop == -1)
+		{
+			dataMessage heldMessage(inMessage);
+
+			heldMessage.setDestinationIdentifier(
+				recipient);
+
+			this->addToMessageListOfUnassociatedClients(
+				heldMessage,
+				inDeadline);
+
+			continue;
+		}
+
+		std::string& recipients = recipientsByNextHop[nextHop];
+
+		if(!recipients.empty())
+		{
+			recipients += constants::multicastDelimiter();
+		}
+
+		recipients += recipient;
+	}
+
+	this->fanOutToClients(
+		inMessage,
+		localRecipients,
+		inDeadline);
+
+	for(const std::pair<const int16_t, std::string>& share : recipientsByNextHop)
+	{
+		dataMessage relayMessage(inMessage);
+
+		relayMessage.setDestinationIdentifier(
+			share.second);
+
+		this->relayToServer(
+			relayMessage,
+			share.first,
+			inDeadline);
+	}
+};
+
+//-------------------------------------------------------------- fanOutToClients
+// Implementation notes:
+//  One copy of the message, encoded once, is shared by every recipient.
+//  Each is sent it straight away, and it stays in their message lists, so
+//  a get sends it again until it is ACKed. A recipient whose list is full
+//  is neither sent it nor keeps it.
+//------------------------------------------------------------------------------
+void server::fanOutToClients(
+	const dataMessage& inMessage,
+	const std::vector<remoteConnection>& inRecipients,
+	const heartbeatClock::time_point& inDeadline)
+{
+	if(inRecipients.empty())
+	{
+		return;
+	}
+
+	dataMessage deliveredMessage(inMessage);
+
+	deliveredMessage.setMessageType(
+		constants::MessageType::mt_SERVER_SEND);
+
+	deliveredMessage.stampTrace(
+		this->m_index,
+		messageTrace::ts_QUEUE);
+
+	const sharedMessage sharedCopy(
+		boost::make_shared<const encodedMessage>(deliveredMessage));
+
+	// each recipient has its own spool record, of the same bytes
+	const std::vector<char> spooledCopy = this->m_spool
+		? deliveredMessage.asCharVector()
+		: std::vector<char>();
+
+	boost::system::error_code error;
+
+	const heartbeatClock::time_point queuedAt = heartbeatClock::now();
+
+	// the message is sent to each recipient as it is queued
+	const int64_t deliveredMicroseconds = deliveredMessage.viewTrace().isTraced()
+		? messageTrace::nowMicroseconds()
+		: 0;
+
+	for(const remoteConnection& recipient : inRecipients)
+	{
+		if(!this->m_backlog.admit(recipient.viewIdentifier(), inMessage.viewPayload().size()))
+		{
+			continue;
+		}
+
+		std::list<pendingMessage>& messageList =
+			this->m_messageListByClient[recipient.viewIdentifier()];
+
+		messageList.push_back(
+			pendingMessage(
+				sharedCopy,
+				inDeadline,
+				this->spoolMessage(messageSpool::sk_DELIVERY, recipient.viewIdentifier(), spooledCopy, inDeadline),
+				queuedAt));
+
+		messageList.back().m_deliveredMicroseconds = deliveredMicroseconds;
+
+		stageProfiler::scopedStage stage("send_to");
+
+		this->m_UDPsocket.send_to(
+			sharedCopy->viewBuffers(),
+			recipient.viewEndpoint(), 0, error);
+
+		if(error)
+		{
+			this->m_sendErrors->add();
+		}
+	}
+};
+
+//---------------------------------------------------------------- relayToServer
+// Implementation notes:
+//  Relayed messages are sent as server sends, so the receiving server
+//  processes them as relays rather than as new messages from a client.
+//  The link to the server numbers them and sends them as its window allows,
+//  from one encoding however many times they are retransmitted, so a
+//  retransmission carries the time to live the relay was queued with.
+//------------------------------------------------------------------------------
+void server::relayToServer(
+	const dataMessage& inMessage,
+	const int16_t& inServerIndex,
+	const heartbeatClock::time_point& inDeadline)
+{
+	if(inDeadline <= this->m_cachedNow)
+	{
+		this->m_backlog.recordDeadLetter(
+			backlogAccounting::dl_EXPIRED);
+
+		return;
+	}
+
+	dataMessage relayMessage(inMessage);
+
+	relayMessage.setMessageType(
+		constants::MessageType::mt_SERVER_SEND);
+
+	relayMessage.incrementHopCount();
+
+	relayMessage.stampTrace(
+		this->m_index,
+		messageTrace::ts_FORWARD);
+
+	relayMessage.setTimeToLive(
+		std::max<int64_t>(
+			1,
+			boost::chrono::duration_cast<boost::chrono::milliseconds>(
+				inDeadline - this->m_cachedNow).count()));
+
+	this->m_serverLinks[inServerIndex].enqueue(
+		boost::make_shared<const encodedMessage>(relayMessage));
+
+	this->flushServerLink(
+		inServerIndex);
+};
+
+//-------------------------------------------------------------- flushServerLink
+// Implementation notes:
+//  A relay that fails to send is left to the retransmit timer
+//------------------------------------------------------------------------------
+void server::flushServerLink(
+	const int16_t& inServerIndex)
+{
+	for(const reliableLink::relayTransmission& transmission :
+		this->m_serverLinks[inServerIndex].takeSendable(heartbeatClock::now()))
+	{
+		this->sendRelayToServer(
+			transmission,
+			inServerIndex);
+	}
+};
+
+//----------------------------------------------------------- receiveServerRelay
+// Implementation notes:
+//  The relaying server is identified by the endpoint it sent from. Relays
+//  without a link sequence number, or from an unknown endpoint, are
+//  processed without an ACK as before.
+//------------------------------------------------------------------------------
+void server::receiveServerRelay(
+	const dataMessage& inRelayMessage,
+	const boost::asio::ip::udp::endpoint& inSenderEndpoint)
+{
+	int16_t senderIndex = -1;
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
+	{
+		if(this->m_serverConnections[serverIndex].viewEndpoint() == inSenderEndpoint)
+		{
+			senderIndex = serverIndex;
+			break;
+		}
+	}
+
+	if(senderIndex == -1 || inRelayMessage.viewLinkSequenceNumber() == 0)
+	{
+		this->processServerRelayMessage(
+			inRelayMessage);
+
+		return;
+	}
+
+	const bool firstReceipt =
+		this->m_serverLinks[senderIndex].receive(
+			inRelayMessage);
+
+	// duplicates are ACKed too, the previous ACK may have been lost
+	this->sendToServer(
+		this->m_serverLinks[senderIndex].createAcknowledgement(),
+		senderIndex);
+
+	if(firstReceipt)
+	{
+		this->processServerRelayMessage(
+			inRelayMessage);
+	}
+};
+
+//------------------------------------------------- receiveServerAcknowledgement
+// Implementation notes:
+//  An ACK can open the window, so queued relays are sent right away
+//------------------------------------------------------------------------------
+void server::receiveServerAcknowledgement(
+	const dataMessage& inAcknowledgement)
+{
+	const int16_t serverIndex =
+		this->m_topology.serverIndexFromIdentifier(
+			inAcknowledgement.viewSourceIdentifier());
+
+	if(serverIndex == -1 || serverIndex == this->m_index)
+	{
+		return;
+	}
+
+	this->m_serverLinks[serverIndex].receiveAcknowledgement(
+		inAcknowledgement,
+		heartbeatClock::now());
+
+	this->flushServerLink(
+		serverIndex);
+};
+
+//----------------------------------------------------------------- serverLinkAt
+// Implementation notes:
+//  Returns a copy, taken while holding the mutex
+//------------------------------------------------------------------------------
+reliableLink server::serverLinkAt(
+	const int16_t& inServerIndex)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->m_serverLinks[inServerIndex];
+};
+
+//----------------------------------------------------------------- sendToServer
+// Implementation notes:
+//  The error code is checked rather than ignored, a failed send is reported
+//  to the caller
+//------------------------------------------------------------------------------
+bool server::sendToServer(
+	const dataMessage& inMessage,
+	const int16_t& inServerIndex)
+{
+	boost::system::error_code error;
+
+	std::vector<char> datagram;
+
+	{
+		stageProfiler::scopedStage stage("encode");
+
+		datagram = inMessage.asCharVector();
+	}
+
+	{
+		stageProfiler::scopedStage stage("send_to");
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(datagram),
+			this->m_serverConnections[inServerIndex].viewEndpoint(), 0, error);
+	}
+
+	if(error)
+	{
+		this->m_sendErrors->add();
+
+		asyncLog::write(
+			asyncLog::ll_WARNING,
+			"Unable to send to {}: {}",
+			this->m_topology.viewServerName(inServerIndex),
+			error.message());
+
+		return false;
+	}
+
+	return true;
+};
+
+//------------------------------------------------------------ sendRelayToServer
+// Implementation notes:
+//  The same error handling as sendToServer
+//------------------------------------------------------------------------------
+bool server::sendRelayToServer(
+	const reliableLink::relayTransmission& inTransmission,
+	const int16_t& inServerIndex)
+{
+	boost::system::error_code error;
+
+	{
+		stageProfiler::scopedStage stage("send_to");
+
+		this->m_UDPsocket.send_to(
+			inTransmission.m_relay->viewBuffersForRelay(
+				inTransmission.m_linkSequenceNumbers),
+			this->m_serverConnections[inServerIndex].viewEndpoint(), 0, error);
+	}
+
+	if(error)
+	{
+		this->m_sendErrors->add();
+
+		asyncLog::write(
+			asyncLog::ll_WARNING,
+			"Unable to send to {}: {}",
+			this->m_topology.viewServerName(inServerIndex),
+			error.message());
+
+		return false;
+	}
+
+	return true;
+};
+
+//---------------------------------------------------------- listenLoopBluetooth
+// Implementation notes:
+//  Listens and acts via Bluetooth
+//------------------------------------------------------------------------------
+void server::listenLoopBluetooth()
+{
+	while(!this->m_terminate)
+	{
+		// #TODO_MT implement
+
+		// sleep, so the placeholder loop does not spin a core
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::updateIntervalMilliseconds));
+	}
+};
+
+//--------------------------------------------------------------- attemptForward
+// Implementation notes:
+//  Also keeps the cached clock current for the other threads. Held messages
+//  are taken out before they are retried, since a retry may hold them again.
+//------------------------------------------------------------------------------
+void server::attemptForward()
+{
+	this->m_cachedNow = heartbeatClock::now();
+
+	// held messages are retried when their backoff is up, or all at once
+	// when a client or server they may be waiting on appears
+	std::multimap<heartbeatClock::time_point, heldMessage>::iterator lastDue =
+		this->m_retryHeldMessagesNow
+			? this->m_messageListOfUnassociatedClients.end()
+			: this->m_messageListOfUnassociatedClients.upper_bound(this->m_cachedNow);
+
+	std::vector<heldMessage> messagesToCheck;
+
+	for(std::multimap<heartbeatClock::time_point, heldMessage>::iterator it =
+			this->m_messageListOfUnassociatedClients.begin();
+		it != lastDue;
+		it++)
+	{
+		messagesToCheck.push_back(
+			it->second);
+	}
+
+	this->m_messageListOfUnassociatedClients.erase(
+		this->m_messageListOfUnassociatedClients.begin(),
+		lastDue);
+
+	this->m_retryHeldMessagesNow = false;
+
+	for(const heldMessage& messageToCheck : messagesToCheck)
+	{
+		this->retryHeldMessage(
+			messageToCheck);
+	}
+};
+
+//------------------------------------------------------------ flushServerLinks
+// Implementation notes:
+//  The membership changes go first, so they share the sends of the relays
+//------------------------------------------------------------------------------
+void server::flushServerLinks()
+{
+	this->flushMembershipChanges();
+
+	for(const int16_t& neighbour : this->m_routingTable.viewNeighbours())
+	{
+		this->flushServerLink(
+			neighbour);
+	}
+};
+
+//------------------------------------------------------------ synchronizeSpool
+// Implementation notes:
+//  Everything spooled since the last time is written at once
+//------------------------------------------------------------------------------
+void server::synchronizeSpool()
+{
+	this->m_spool->synchronize();
+};
+
+//----------------------------------------------------------------- flushCapture
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+void server::flushCapture()
+{
+	this->m_capture->flush();
+};
+
+//-------------------------------------------------------------- runPeriodically
+// Implementation notes:
+//  Each periodic task has a thread of its own, so a slow one does not hold
+//  up the others beyond the mutex they share
+//------------------------------------------------------------------------------
+void server::runPeriodically(
+	const periodicTask& inTask,
+	const uint16_t& inIntervalMilliseconds)
+{
+	while(!this->m_terminate)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+			(this->*inTask)();
+		}
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			inIntervalMilliseconds));
+	}
+};
+
+//---------------------------------------------------------------- exportMetrics
+// Implementation notes:
+//  Only the gauges are sampled while holding the mutex, the file is written
+//  without holding up the other threads
+//------------------------------------------------------------------------------
+void server::exportMetrics()
+{
+	while(!this->m_terminate)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+			this->sampleMetrics();
+		}
+
+		this->m_metrics.writeToFile(
+			this->m_topology.viewMetricsDirectory() + "/"
+			+ this->m_topology.viewServerName(this->m_index) + ".metrics");
+
+		// profiling builds write the stage times of the whole process
+		if(stageProfiler::isEnabled())
+		{
+			stageProfiler::writeFiles(
+				this->m_topology.viewMetricsDirectory() + "/"
+				+ this->m_topology.viewServerName(this->m_index) + ".profile");
+		}
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			this->m_topology.viewMetricsIntervalMilliseconds()));
+	}
+};
+
+//------------------------------------------------------------- sendSyncPayloads
+// Implementation notes:
+//  Sends the sync payloads for this server and all known servers to the
+//  neighbouring servers. This is done as one UDP message per server.
+//  Changes are already propagated as they happen, this repairs lists that
+//  missed an update.
+//------------------------------------------------------------------------------
+void server::sendSyncPayloads()
+{
+	while(!this->m_terminate)
+	{
+		{
+			stageProfiler::scopedStage stage("sync");
+
+			boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+			for(const int16_t& neighbour : this->m_routingTable.viewNeighbours())
+			{
+				if(this->m_serverIsUp[neighbour])
+				{
+					this->sendSyncPayloadsToServer(
+						neighbour);
+				}
+			}
+		}
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			constants::syncIntervalMilliseconds));
+	}
+};
+
+//----------------------------------------------------- sendSyncPayloadsToServer
+// Implementation notes:
+//  Sends the known client lists the neighbour learns through this server.
+//  On the chain, this is every list from the other side of this server.
+//  Empty lists are sent too, once a server has had clients, so that the
+//  last client leaving is synced. The sequence number of a sync is the
+//  version of the list. The lists of channels with subscribers are synced
+//  the same way. With membership filters, a client list longer than its
+//  filter is sent as a summary instead, so no list costs more than the
+//  filter however many clients it has.
+//------------------------------------------------------------------------------
+void server::sendSyncPayloadsToServer(
+	const int16_t& inServerIndex)
+{
+	const uint16_t filterBits =
+		this->m_topology.viewMembershipFilterBits();
+
+	for(int16_t i = 0; i < this->m_topology.numberOfServers(); i++)
+	{
+		if(this->m_membershipVersionByServerIndex[i] == 0
+			|| !this->m_routingTable.shouldAdvertise(i, inServerIndex))
+		{
+			continue;
+		}
+
+		size_t listLength = 0;
+
+		if(filterBits != 0)
+		{
+			for(const namePool::handle& client : this->m_clientsServedByServerIndex[i])
+			{
+				listLength += this->m_names.viewName(client).size() + 1;
+			}
+		}
+
+		// a filter is written six bits to a character
+		if(listLength > static_cast<size_t>(filterBits + 5) / 6)
+		{
+			this->sendMembershipSummary(
+				i,
+				inServerIndex);
+		}
+		else
+		{
+			this->sendClientList(
+				i,
+				inServerIndex);
+		}
+
+		if(this->m_channelVersionByServerIndex[i] != 0)
+		{
+			this->sendNameList(
+				this->m_channelVersionByServerIndex[i],
+				constants::MessageType::mt_SERVER_CHANNEL_SYNC,
+				this->m_channelsServedByServerIndex[i],
+				i,
+				inServerIndex);
+		}
+	}
+};
+
+//--------------------------------------------------------------- sendClientList
+// Implementation notes:
+//  The sequence number is the version of the list
+//------------------------------------------------------------------------------
+void server::sendClientList(
+	const int16_t& inOriginIndex,
+	const int16_t& inServerIndex)
+{
+	this->m_syncPayloadBytes->add(
+		this->sendNameList(
+			this->m_membershipVersionByServerIndex[inOriginIndex],
+			constants::MessageType::mt_SERVER_SYNC,
+			this->m_clientsServedByServerIndex[inOriginIndex],
+			inOriginIndex,
+			inServerIndex));
+};
+
+//----------------------------------------------------------------- sendNameList
+// Implementation notes:
+//  The payload of a part is its number and the number of parts, followed
+//  by its names, each ending with the sync delimiter. A part has at least
+//  one name, so a name longer than the part length is still sent. An
+//  empty list is one part without names.
+//------------------------------------------------------------------------------
+size_t server::sendNameList(
+	const int64_t& inVersion,
+	const constants::MessageType& inMessageType,
+	const std::vector<namePool::handle>& inList,
+	const int16_t& inOriginIndex,
+	const int16_t& inServerIndex)
+{
+	std::vector<std::string> parts(1);
+
+	for(const namePool::handle& name : inList)
+	{
+		const std::string& currentName =
+			this->m_names.viewName(name);
+
+		if(!parts.back().empty()
+			&& parts.back().size() + currentName.size() + 1 > constants::syncListPartLength)
+		{
+			parts.push_back("");
+		}
+
+		parts.back() += currentName;
+		parts.back() += constants::syncIdentifierDelimiter();
+	}
+
+	const std::string partCount(
+		std::to_string(parts.size()) + constants::syncIdentifierDelimiter());
+
+	size_t outBytes = 0;
+
+	for(size_t part = 0; part < parts.size(); part++)
+	{
+		dataMessage syncMessageToSend(
+			inVersion,
+			inMessageType,
+			this->m_topology.viewServerName(this->m_index),
+			this->m_topology.viewServerName(inServerIndex),
+			std::to_string(part) + constants::syncIdentifierDelimiter()
+			+ partCount
+			+ parts[part]);
+
+		syncMessageToSend.setServerSyncPayloadOriginIndex(
+			inOriginIndex);
+
+		outBytes += syncMessageToSend.viewPayload().size();
+
+		this->sendToServer(
+			syncMessageToSend,
+			inServerIndex);
+	}
+
+	return outBytes;
+};
+
+//-------------------------------------------------------- sendMembershipSummary
+// Implementation notes:
+//  The payload is the number of clients followed by the filter. The filter
+//  is rebuilt from the list every time, the list is already exact and a
+//  few thousand bits are cheap to hash into once per sync.
+//------------------------------------------------------------------------------
+void server::sendMembershipSummary(
+	const int16_t& inOriginIndex,
+	const int16_t& inServerIndex)
+{
+	const std::vector<namePool::handle>& clients =
+		this->m_clientsServedByServerIndex[inOriginIndex];
+
+	bloomFilter summary(
+		this->m_topology.viewMembershipFilterBits(),
+		clients.size());
+
+	for(const namePool::handle& client : clients)
+	{
+		summary.add(
+			this->m_names.viewName(client));
+	}
+
+	dataMessage summaryMessageToSend(
+		this->m_membershipVersionByServerIndex[inOriginIndex],
+		constants::MessageType::mt_SERVER_SUMMARY,
+		this->m_topology.viewServerName(this->m_index),
+		this->m_topology.viewServerName(inServerIndex),
+		std::to_string(clients.size()) + constants::syncIdentifierDelimiter()
+		+ summary.asString());
+
+	summaryMessageToSend.setServerSyncPayloadOriginIndex(
+		inOriginIndex);
+
+	this->m_syncPayloadBytes->add(
+		summaryMessageToSend.viewPayload().size());
+
+	this->sendToServer(
+		summaryMessageToSend,
+		inServerIndex);
+};
+
+//--------------------------------------------------------------- monitorServers
+// Implementation notes:
+//  Pings go to every neighbour, including those that are down, since that
+//  is how a recovered server learns this server is still up
+//------------------------------------------------------------------------------
+void server::monitorServers()
+{
+	while(!this->m_terminate)
+	{
+		{
+			boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+			const heartbeatClock::time_point now = heartbeatClock::now();
+
+			std::vector<int16_t> serversDown;
+
+			for(const int16_t& neighbour : this->m_routingTable.viewNeighbours())
+			{
+				const dataMessage heartbeatMessage(
+					this->sequenceNumber(),
+					constants::MessageType::mt_PING,
+					this->m_topology.viewServerName(this->m_index),
+					this->m_topology.viewServerName(neighbour),
+					"heartbeat");
+
+				this->sendToServer(
+					heartbeatMessage,
+					neighbour);
+
+				const int64_t silentMilliseconds =
+					boost::chrono::duration_cast<boost::chrono::milliseconds>(
+						now - this->m_lastHeardFromServerIndex[neighbour]).count();
+
+				if(this->m_serverIsUp[neighbour]
+					&& silentMilliseconds > this->m_topology.viewSuspicionTimeoutMilliseconds())
+				{
+					this->m_serverIsUp[neighbour] = false;
+					serversDown.push_back(neighbour);
+
+					asyncLog::write(
+						asyncLog::ll_INFO,
+						"{} is down, detected after {} ms without a heartbeat",
+						this->m_topology.viewServerName(neighbour),
+						silentMilliseconds);
+				}
+			}
+
+			if(!serversDown.empty())
+			{
+				this->m_routingTable.update(
+					this->m_serverIsUp);
+			}
+
+			// relays still waiting on a server that is down are routed
+			// again, either around it or into the held messages
+			for(const int16_t& serverDown : serversDown)
+			{
+				for(const sharedMessage& relay :
+					this->m_serverLinks[serverDown].takeUnacknowledged())
+				{
+					// membership updates are dropped instead, the server
+					// is sent the whole lists when it is back
+					if(relay->viewMessage().viewMessageType()
+						!= constants::MessageType::mt_SERVER_SEND)
+					{
+						continue;
+					}
+
+					this->routeMessage(
+						relay->viewMessage(),
+						false,
+						this->deadlineOf(relay->viewMessage()));
+				}
+			}
+		}
+
+		// sleep
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			this->m_topology.viewHeartbeatIntervalMilliseconds()));
+	}
+};
+
+//------------------------------------------------------------- receiveHeartbeat
+// Implementation notes:
+//  The ping this server sends itself to stop is ignored. A server coming
+//  back is sent the client lists straight away instead of at the next sync.
+//------------------------------------------------------------------------------
+void server::receiveHeartbeat(
+	const dataMessage& inHeartbeatMessage)
+{
+	const int16_t serverIndex =
+		this->m_topology.serverIndexFromIdentifier(
+			inHeartbeatMessage.viewSourceIdentifier());
+
+	if(serverIndex == -1 || serverIndex == this->m_index)
+	{
+		return;
+	}
+
+	const heartbeatClock::time_point now = heartbeatClock::now();
+
+	if(!this->m_serverIsUp[serverIndex])
+	{
+		asyncLog::write(
+			asyncLog::ll_INFO,
+			"{} is back, after {} ms without a heartbeat",
+			this->m_topology.viewServerName(serverIndex),
+			boost::chrono::duration_cast<boost::chrono::milliseconds>(
+				now - this->m_lastHeardFromServerIndex[serverIndex]).count());
+
+		this->m_serverIsUp[serverIndex] = true;
+
+		this->m_routingTable.update(
+			this->m_serverIsUp);
+
+		// held messages may be routable through it again
+		this->m_retryHeldMessagesNow = true;
+
+		this->sendSyncPayloadsToServer(
+			serverIndex);
+	}
+
+	this->m_lastHeardFromServerIndex[serverIndex] = now;
+};
+
+//----------------------------------------------------------------- serverIsUp
+// Implementation notes:
+//  Locked, for other threads
+//------------------------------------------------------------------------------
+bool server::serverIsUp(
+	const int16_t& inServerIndex)
+{
+	boost::lock_guard<boost::mutex> lock(this->m_mutex);
+
+	return this->m_serverIsUp[inServerIndex];
+};
+
+//--------------------------------------------------------------- sequenceNumber
+// Implementation notes:
+//  Increments the sequence number every time it is used, self explanatory.
+//------------------------------------------------------------------------------
+const int64_t& server::sequenceNumber()
+{
+	return ++this->m_sequenceNumber;
+};
+
+//------------------------------------------------- sendClientsToAdjacentServers
+// Implementation notes:
+//  Receives the list of clients, or of channels, from an adjacent server
+//  and stores them, unless a newer version of the list was already received.
+//  A client list that changed may have the destination of a held message.
+//------------------------------------------------------------------------------
+void server::receiveClientsFromAdjacentServers(
+	const dataMessage& inSyncMessage)
+{
+	const bool isChannelList =
+		inSyncMessage.viewMessageType() == constants::MessageType::mt_SERVER_CHANNEL_SYNC;
+
+	std::vector<std::vector<namePool::handle>>& lists = isChannelList
+		? this->m_channelsServedByServerIndex
+		: this->m_clientsServedByServerIndex;
+
+	std::vector<int64_t>& versions = isChannelList
+		? this->m_channelVersionByServerIndex
+		: this->m_membershipVersionByServerIndex;
+
+	const int16_t originIndex =
+		inSyncMessage.viewServerSyncPayloadOriginIndex();
+
+	if(!this->m_topology.serverIndexIsValid(originIndex)
+		|| originIndex == this->m_index
+		|| inSyncMessage.viewSequenceNumber()
+			< versions[originIndex])
+	{
+		return;
+	}
+
+	std::vector<std::string> names;
+
+	if(!this->assembleNameList(
+		isChannelList
+			? this->m_channelListAssemblyByServerIndex[originIndex]
+			: this->m_clientListAssemblyByServerIndex[originIndex],
+		inSyncMessage,
+		names))
+	{
+		return;
+	}
+
+	const bool changed = this->rewriteNameList(
+		lists[originIndex],
+		names);
+
+	if(!isChannelList && changed)
+	{
+		this->m_retryHeldMessagesNow = true;
+	}
+
+	// a full list is exact, its last filter would only cost list requests
+	if(!isChannelList)
+	{
+		this->m_membershipFilterByServerIndex[originIndex] =
+			bloomFilter();
+	}
+
+	versions[originIndex] =
+		inSyncMessage.viewSequenceNumber();
+
+	this->applyHeldMembershipUpdates(
+		isChannelList,
+		originIndex);
+};
+
+//------------------------------------------------------------- assembleNameList
+// Implementation notes:
+//  A list of one part, the usual case, is returned without touching the
+//  assembly. The parts of a version are the same from every sender, so
+//  parts of it from different neighbours, or from a later sync, complete
+//  it too. A list whose parts keep being lost is never applied, the list
+//  already held stays until a later sync arrives whole.
+//------------------------------------------------------------------------------
+bool server::assembleNameList(
+	listAssembly& inAssembly,
+	const dataMessage& inSyncMessage,
+	std::vector<std::string>& outNames)
+{
+	std::vector<std::string> fields =
+		inSyncMessage.viewServerSyncPayload();
+
+	if(fields.size() < 2)
+	{
+		throw std::runtime_error(
+			"Malformed list part");
+	}
+
+	const size_t part = std::stoul(fields[0]);
+	const size_t partCount = std::stoul(fields[1]);
+
+	if(partCount == 0
+		|| partCount > constants::syncListMaximumParts
+		|| part >= partCount)
+	{
+		throw std::runtime_error(
+			"Malformed list part");
+	}
+
+	fields.erase(
+		fields.begin(),
+		fields.begin() + 2);
+
+	if(partCount == 1)
+	{
+		outNames.swap(
+			fields);
+
+		return true;
+	}
+
+	const int64_t& version =
+		inSyncMessage.viewSequenceNumber();
+
+	if(version < inAssembly.m_version)
+	{
+		return false;
+	}
+
+	if(version != inAssembly.m_version
+		|| inAssembly.m_parts.size() != partCount)
+	{
+		inAssembly.m_version = version;
+		inAssembly.m_parts.assign(partCount, std::vector<std::string>());
+		inAssembly.m_partReceived.assign(partCount, false);
+		inAssembly.m_partsReceived = 0;
+	}
+
+	if(inAssembly.m_partReceived[part])
+	{
+		return false;
+	}
+
+	inAssembly.m_parts[part].swap(
+		fields);
+
+	inAssembly.m_partReceived[part] = true;
+	inAssembly.m_partsReceived++;
+
+	if(inAssembly.m_partsReceived < partCount)
+	{
+		return false;
+	}
+
+	outNames.clear();
+
+	for(const std::vector<std::string>& names : inAssembly.m_parts)
+	{
+		outNames.insert(
+			outNames.end(),
+			names.begin(),
+			names.end());
+	}
+
+	inAssembly.m_parts.clear();
+	inAssembly.m_partReceived.clear();
+	inAssembly.m_partsReceived = 0;
+
+	return true;
+};
+
+//----------------------------------------------------- receiveMembershipSummary
+// Implementation notes:
+//  A Bloom filter has no false negatives, so a name it rules out is not in
+//  the origin's list and is removed straight away. A name it does not rule
+//  out may still be stale, and a client may be missing, either of which
+//  shows as a count that differs from the list's.
+//------------------------------------------------------------------------------
+void server::receiveMembershipSummary(
+	const dataMessage& inSummaryMessage)
+{
+	const int16_t originIndex =
+		inSummaryMessage.viewServerSyncPayloadOriginIndex();
+
+	if(!this->m_topology.serverIndexIsValid(originIndex)
+		|| originIndex == this->m_index
+		|| inSummaryMessage.viewSequenceNumber()
+			< this->m_membershipVersionByServerIndex[originIndex])
+	{
+		return;
+	}
+
+	const std::string& payload =
+		inSummaryMessage.viewPayload();
+
+	const size_t countEnd =
+		payload.find(constants::syncIdentifierDelimiter());
+
+	if(countEnd == std::string::npos)
+	{
+		throw std::runtime_error(
+			"Malformed membership summary");
+	}
+
+	const size_t count = std::stoul(
+		payload.substr(0, countEnd));
+
+	const bloomFilter summary(
+		payload.substr(countEnd + 1));
+
+	std::vector<namePool::handle>& clients =
+		this->m_clientsServedByServerIndex[originIndex];
+
+	std::vector<namePool::handle> remaining;
+
+	remaining.reserve(
+		clients.size());
+
+	for(const namePool::handle& client : clients)
+	{
+		if(summary.mayContain(this->m_names.viewName(client)))
+		{
+			remaining.push_back(client);
+		}
+		else
+		{
+			this->m_names.release(
+				client);
+
+			this->m_namesRuledOut->add();
+		}
+	}
+
+	clients.swap(
+		remaining);
+
+	this->m_membershipFilterByServerIndex[originIndex] =
+		summary;
+
+	this->m_membershipVersionByServerIndex[originIndex] =
+		inSummaryMessage.viewSequenceNumber();
+
+	this->applyHeldMembershipUpdates(
+		false,
+		originIndex);
+
+	if(clients.size() != count)
+	{
+		this->requestClientList(
+			originIndex);
+	}
+};
+
+//----------------------------------------------------------- receiveListRequest
+// Implementation notes:
+//  The list is sent to the server that asked, which is a neighbour, in
+//  parts like a periodic sync. A list this server has not heard of yet is
+//  not sent, the neighbour asks again after the next summary.
+//------------------------------------------------------------------------------
+void server::receiveListRequest(
+	const dataMessage& inRequestMessage)
+{
+	const int16_t originIndex =
+		inRequestMessage.viewServerSyncPayloadOriginIndex();
+
+	const int16_t requesterIndex =
+		this->m_topology.serverIndexFromIdentifier(
+			inRequestMessage.viewSourceIdentifier());
+
+	if(!this->m_topology.serverIndexIsValid(originIndex)
+		|| !this->m_topology.serverIndexIsValid(requesterIndex)
+		|| requesterIndex == this->m_index
+		|| this->m_membershipVersionByServerIndex[originIndex] == 0)
+	{
+		return;
+	}
+
+	this->sendClientList(
+		originIndex,
+		requesterIndex);
+};
+
+//------------------------------------------------------------ requestClientList
+// Implementation notes:
+//  The next hop towards the origin has the list the summary came from, or
+//  a newer one. A request that is lost is made again at the next summary.
+//------------------------------------------------------------------------------
+void server::requestClientList(
+	const int16_t& inOriginIndex)
+{
+	const heartbeatClock::time_point now = heartbeatClock::now();
+
+	if(now - this->m_timeOfListRequestByServerIndex[inOriginIndex]
+		< boost::chrono::milliseconds(constants::syncIntervalMilliseconds))
+	{
+		return;
+	}
+
+	const int16_t nextHop =
+		this->m_routingTable.viewNextHop(inOriginIndex);
+
+	if(nextHop == -1)
+	{
+		return;
+	}
+
+	dataMessage requestMessage(
+		this->sequenceNumber(),
+		constants::MessageType::mt_SERVER_SYNC_REQUEST,
+		this->m_topology.viewServerName(this->m_index),
+		this->m_topology.viewServerName(nextHop),
+		"list");
+
+	requestMessage.setServerSyncPayloadOriginIndex(
+		inOriginIndex);
+
+	this->sendToServer(
+		requestMessage,
+		nextHop);
+
+	this->m_timeOfListRequestByServerIndex[inOriginIndex] = now;
+
+	this->m_listRequests->add();
+};
+
+//-------------------------------------------------------- confirmClientLocation
+// Implementation notes:
+//  Asking only the servers whose filter may have the client keeps an
+//  unknown name from costing a list request to every server. The list
+//  that comes back retries the held messages if it has the client.
+//------------------------------------------------------------------------------
+void server::confirmClientLocation(
+	const std::string& inClientIdentifier)
+{
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
+	{
+		if(serverIndex != this->m_index
+			&& this->m_serverIsUp[serverIndex]
+			&& this->m_membershipFilterByServerIndex[serverIndex].mayContain(inClientIdentifier))
+		{
+			this->requestClientList(
+				serverIndex);
+		}
+	}
+};
+
+//------------------------------------------------------ receiveMembershipUpdate
+// Implementation notes:
+//  Passed on straight away, a server further on holds it itself if need
+//  be. Updates that are not newer than the list are duplicates or arrived
+//  after a sync that already contained them. The links retransmit a lost
+//  update but do not keep the order, so one that follows a version the
+//  list has not reached yet waits for it.
+//------------------------------------------------------------------------------
+void server::receiveMembershipUpdate(
+	const dataMessage& inUpdateMessage)
+{
+	const constants::MessageType& updateType =
+		inUpdateMessage.viewMessageType();
+
+	const bool isChannelUpdate =
+		updateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED
+		|| updateType == constants::MessageType::mt_SERVER_CHANNEL_REMOVED;
+
+	std::vector<int64_t>& versions = isChannelUpdate
+		? this->m_channelVersionByServerIndex
+		: this->m_membershipVersionByServerIndex;
+
+	const int16_t originIndex =
+		inUpdateMessage.viewServerSyncPayloadOriginIndex();
+
+	if(!this->m_topology.serverIndexIsValid(originIndex)
+		|| originIndex == this->m_index
+		|| inUpdateMessage.viewSequenceNumber()
+			<= versions[originIndex])
+	{
+		return;
+	}
+
+	const std::vector<std::string> fields =
+		inUpdateMessage.viewServerSyncPayload();
+
+	if(fields.empty())
+	{
+		throw std::runtime_error(
+			"Malformed membership update");
+	}
+
+	const int64_t previousVersion = std::stoll(
+		fields.front());
+
+	this->forwardMembershipUpdate(
+		inUpdateMessage);
+
+	if(previousVersion > versions[originIndex]
+		&& previousVersion - versions[originIndex] < constants::membershipUpdateHoldVersions)
+	{
+		std::vector<std::map<int64_t, dataMessage>>& held = isChannelUpdate
+			? this->m_heldChannelUpdatesByServerIndex
+			: this->m_heldClientUpdatesByServerIndex;
+
+		held[originIndex].insert(std::make_pair(
+			previousVersion,
+			inUpdateMessage));
+
+		return;
+	}
+
+	this->applyMembershipUpdate(
+		inUpdateMessage);
+
+	this->applyHeldMembershipUpdates(
+		isChannelUpdate,
+		originIndex);
+};
+
+//------------------------------------------------------ publishMembershipChange
+// Implementation notes:
+//  The list changes now, so this server routes by it straight away. The
+//  version only moves when the change is sent, a sync in between carries
+//  the change under the old version and the update repeats it.
+//------------------------------------------------------------------------------
+void server::publishMembershipChange(
+	const constants::MessageType& inUpdateType,
+	const std::string& inClientUsername)
+{
+	const bool isChannelUpdate =
+		inUpdateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED
+		|| inUpdateType == constants::MessageType::mt_SERVER_CHANNEL_REMOVED;
+
+	std::vector<namePool::handle>& list = isChannelUpdate
+		? this->m_channelsServedByServerIndex[this->m_index]
+		: this->m_clientsServedByServerIndex[this->m_index];
+
+	if(inUpdateType == constants::MessageType::mt_SERVER_CLIENT_JOINED
+		|| inUpdateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED)
+	{
+		this->addToNameList(
+			list,
+			inClientUsername);
+	}
+	else
+	{
+		this->removeFromNameList(
+			list,
+			inClientUsername);
+	}
+
+	this->m_pendingMembershipChanges.push_back(std::make_pair(
+		inUpdateType,
+		inClientUsername));
+};
+
+//------------------------------------------------------- flushMembershipChanges
+// Implementation notes:
+//  Consecutive changes of the same type share an update, so the order of a
+//  client leaving and joining again is kept. The payload is the version
+//  the update follows, then its names, which fit a list part like a sync.
+//------------------------------------------------------------------------------
+void server::flushMembershipChanges()
+{
+	std::vector<std::pair<constants::MessageType, std::string>> changes;
+
+	changes.swap(
+		this->m_pendingMembershipChanges);
+
+	size_t first = 0;
+
+	while(first < changes.size())
+	{
+		const constants::MessageType updateType =
+			changes[first].first;
+
+		int64_t& version =
+			updateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED
+			|| updateType == constants::MessageType::mt_SERVER_CHANNEL_REMOVED
+				? this->m_channelVersionByServerIndex[this->m_index]
+				: this->m_membershipVersionByServerIndex[this->m_index];
+
+		std::vector<std::string> fields(
+			1,
+			std::to_string(version));
+
+		size_t namesLength = 0;
+		size_t last = first;
+
+		while(last < changes.size()
+			&& changes[last].first == updateType
+			&& (last == first
+				|| namesLength + changes[last].second.size() + 1 <= constants::syncListPartLength))
+		{
+			fields.push_back(
+				changes[last].second);
+
+			namesLength += changes[last].second.size() + 1;
+			last++;
+		}
+
+		const dataMessage updateMessage(
+			++version,
+			updateType,
+			this->m_topology.viewServerName(this->m_index),
+			"",
+			fields,
+			this->m_index);
+
+		this->forwardMembershipUpdate(
+			updateMessage);
+
+		first = last;
+	}
+};
+
+//-------------------------------------------------------- applyMembershipUpdate
+// Implementation notes:
+//  The first field is the version the update follows, the rest are names
+//------------------------------------------------------------------------------
+void server::applyMembershipUpdate(
+	const dataMessage& inUpdateMessage)
+{
+	const constants::MessageType& updateType =
+		inUpdateMessage.viewMessageType();
+
+	const bool isChannelUpdate =
+		updateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED
+		|| updateType == constants::MessageType::mt_SERVER_CHANNEL_REMOVED;
+
+	const int16_t originIndex =
+		inUpdateMessage.viewServerSyncPayloadOriginIndex();
+
+	std::vector<namePool::handle>& list = isChannelUpdate
+		? this->m_channelsServedByServerIndex[originIndex]
+		: this->m_clientsServedByServerIndex[originIndex];
+
+	const std::vector<std::string> fields =
+		inUpdateMessage.viewServerSyncPayload();
+
+	for(size_t i = 1; i < fields.size(); i++)
+	{
+		if(updateType == constants::MessageType::mt_SERVER_CLIENT_JOINED
+			|| updateType == constants::MessageType::mt_SERVER_CHANNEL_ADDED)
+		{
+			this->addToNameList(
+				list,
+				fields[i]);
+		}
+		else
+		{
+			this->removeFromNameList(
+				list,
+				fields[i]);
+		}
+	}
+
+	// the clients that joined may have messages held for them
+	if(updateType == constants::MessageType::mt_SERVER_CLIENT_JOINED)
+	{
+		this->m_retryHeldMessagesNow = true;
+	}
+
+	if(isChannelUpdate)
+	{
+		this->m_channelVersionByServerIndex[originIndex] =
+			inUpdateMessage.viewSequenceNumber();
+	}
+	else
+	{
+		this->m_membershipVersionByServerIndex[originIndex] =
+			inUpdateMessage.viewSequenceNumber();
+	}
+};
+
+//--------------------------------------------------- applyHeldMembershipUpdates
+// Implementation notes:
+//  Held updates are keyed by the version they follow. Those that follow an
+//  older version than the list's are already in it, by a sync.
+//------------------------------------------------------------------------------
+void server::applyHeldMembershipUpdates(
+	const bool& inIsChannelList,
+	const int16_t& inOriginIndex)
+{
+	std::map<int64_t, dataMessage>& held = inIsChannelList
+		? this->m_heldChannelUpdatesByServerIndex[inOriginIndex]
+		: this->m_heldClientUpdatesByServerIndex[inOriginIndex];
+
+	const int64_t& version = inIsChannelList
+		? this->m_channelVersionByServerIndex[inOriginIndex]
+		: this->m_membershipVersionByServerIndex[inOriginIndex];
+
+	held.erase(
+		held.begin(),
+		held.lower_bound(version));
+
+	while(!held.empty() && held.begin()->first == version)
+	{
+		const dataMessage updateMessage(
+			held.begin()->second);
+
+		held.erase(
+			held.begin());
+
+		this->applyMembershipUpdate(
+			updateMessage);
+	}
+};
+
+//------------------------------------------------------ forwardMembershipUpdate
+// Implementation notes:
+//  Uses the same rule as the periodic sync, so an update travels away from
+//  its origin and reaches every server once. It is encoded once for every
+//  link.
+//------------------------------------------------------------------------------
+void server::forwardMembershipUpdate(
+	const dataMessage& inUpdateMessage)
+{
+	const int16_t originIndex =
+		inUpdateMessage.viewServerSyncPayloadOriginIndex();
+
+	const sharedMessage updateMessage(
+		boost::make_shared<const encodedMessage>(inUpdateMessage));
+
+	for(const int16_t& neighbour : this->m_routingTable.viewNeighbours())
+	{
+		if(!this->m_serverIsUp[neighbour]
+			|| !this->m_routingTable.shouldAdvertise(originIndex, neighbour))
+		{
+			// a server that is down is sent the whole lists once it is back
+			continue;
+		}
+
+		this->m_serverLinks[neighbour].enqueue(
+			updateMessage);
+
+		this->flushServerLink(
+			neighbour);
+	}
+};
+
+//---------------------------------------------------- lookupServerIndexOfClient
+// Implementation notes:
+//  Searches this server's clients first, then the lists from the last sync.
+//  A name that is in no list is not in the pool, which most lookups for
+//  unknown clients stop at.
+//------------------------------------------------------------------------------
+int16_t server::lookupServerIndexOfClient(
+	const std::string& inClientIdentifier) const
+{
+	if(this->m_sessionsByClient.count(inClientIdentifier) > 0)
+	{
+		return this->m_index;
+	}
+
+	const namePool::handle client =
+		this->m_names.find(inClientIdentifier);
+
+	if(client == 0)
+	{
+		return -1;
+	}
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
+	{
+		if(serverIndex != this->m_index
+			&& std::binary_search(
+				this->m_clientsServedByServerIndex[serverIndex].begin(),
+				this->m_clientsServedByServerIndex[serverIndex].end(),
+				client))
+		{
+			return serverIndex;
+		}
+	}
+
+	return -1;
+};
+
+//---------------------------------------------------------- addClientConnection
+// Implementation notes:
+//  Adds a new client connection to the connections list
+//------------------------------------------------------------------------------
+void server::addClientConnection(
+	const std::string& inClientUsername,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+{
+	// connecting again, from wherever, replaces the previous session. A
+	// client numbers its messages from the start again when it reconnects.
+	std::unordered_map<std::string, uint32_t>::iterator previous =
+		this->m_sessionsByClient.find(inClientUsername);
+
+	if(previous != this->m_sessionsByClient.end())
+	{
+		this->m_connectedClients.erase(
+			previous->second);
+
+		this->m_sessionWheel.cancel(
+			previous->second);
+
+		this->m_sendsReceivedBySession.erase(
+			previous->second);
+
+		this->m_sessionsByClient.erase(
+			previous);
+	}
+
+	// the low bits wrap after many connections, past any still in use
+	while((this->m_nextSessionIdentifier & 0x00FFFFFF) == 0
+		|| this->m_connectedClients.count(this->m_nextSessionIdentifier) > 0)
+	{
+		this->m_nextSessionIdentifier =
+			(static_cast<uint32_t>(this->m_index) << 24)
+			+ ((this->m_nextSessionIdentifier + 1) & 0x00FFFFFF);
+	}
+
+	const remoteConnection connection(
+		inClientUsername,
+		inClientEndpoint,
+		this->m_nextSessionIdentifier++);
+
+	this->m_connectedClients.insert(std::make_pair(
+		connection.viewSessionIdentifier(),
+		connection));
+
+	this->m_sessionsByClient.insert(std::make_pair(
+		inClientUsername,
+		connection.viewSessionIdentifier()));
+
+	this->sendClientSession(
+		inClientUsername,
+		connection.viewSessionIdentifier(),
+		inClientEndpoint);
+
+	this->m_sessionWheel.schedule(
+		connection.viewSessionIdentifier(),
+		connection.viewTimeOfLastActivity()
+		+ boost::chrono::milliseconds(this->m_topology.viewSessionTimeoutMilliseconds()));
+
+	// messages may be held for it
+	this->m_retryHeldMessagesNow = true;
+
+	this->publishMembershipChange(
+		constants::MessageType::mt_SERVER_CLIENT_JOINED,
+		inClientUsername);
+};
+
+//--------------------------------------------------------------- resolveSession
+// Implementation notes:
+//  The endpoint must be the one the client connected from, so a session
+//  given out again after a restart is not taken for an older one, and a
+//  relay naming a client of this server as its source is not taken for the
+//  client. A session that is not a 32-bit number is refused like an
+//  unknown one. Connects are not passed here, they name the client.
+//------------------------------------------------------------------------------
+bool server::resolveSession(
+	dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint,
+	uint32_t& outSessionIdentifier)
+{
+	outSessionIdentifier = 0;
+
+	if(!inMessage.isFromSession())
+	{
+		// a client that missed its session reply sends its username
+		std::unordered_map<std::string, uint32_t>::const_iterator session =
+			this->m_sessionsByClient.find(inMessage.viewSourceIdentifier());
+
+		if(session != this->m_sessionsByClient.end()
+			&& this->m_connectedClients.find(session->second)->second.viewEndpoint()
+				== inClientEndpoint)
+		{
+			outSessionIdentifier = session->second;
+		}
+
+		return true;
+	}
+
+	uint32_t sessionIdentifier = 0;
+
+	std::unordered_map<uint32_t, remoteConnection>::const_iterator client =
+		inMessage.parseSessionIdentifier(sessionIdentifier)
+			? this->m_connectedClients.find(sessionIdentifier)
+			: this->m_connectedClients.end();
+
+	if(client != this->m_connectedClients.end()
+		&& client->second.viewEndpoint() == inClientEndpoint)
+	{
+		outSessionIdentifier = sessionIdentifier;
+
+		// gets and acknowledgements go no further, and are handled by session
+		switch(inMessage.viewMessageType())
+		{
+			case constants::MessageType::mt_CLIENT_DISCONNECT:
+			case constants::MessageType::mt_CLIENT_SEND:
+			case constants::MessageType::mt_CLIENT_JOIN:
+			case constants::MessageType::mt_CLIENT_LEAVE:
+			{
+				inMessage.setSourceIdentifier(
+					client->second.viewIdentifier());
+
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	this->m_unknownSessions->add();
+
+	this->sendClientSession(
+		inMessage.viewSourceIdentifier(),
+		0,
+		inClientEndpoint);
+
+	return false;
+};
+
+//------------------------------------------------------------ sendClientSession
+// Implementation notes:
+//  Not retransmitted, a client that misses it goes on sending its username
+//------------------------------------------------------------------------------
+void server::sendClientSession(
+	const std::string& inClientIdentifier,
+	const uint32_t& inSessionIdentifier,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+{
+	const dataMessage sessionMessage(
+		this->sequenceNumber(),
+		constants::MessageType::mt_SERVER_SESSION,
+		this->m_topology.viewServerName(this->m_index),
+		inClientIdentifier,
+		std::to_string(inSessionIdentifier));
+
+	boost::system::error_code error;
+
+	{
+		stageProfiler::scopedStage stage("send_to");
+
+		this->m_UDPsocket.send_to(
+			boost::asio::buffer(sessionMessage.asCharVector()),
+			inClientEndpoint, 0, error);
+	}
+
+	if(error)
+	{
+		this->m_sendErrors->add();
+	}
+};
+
+//------------------------------------------------------- removeClientConnection
+// Implementation notes:
+//  Remove the matching client connection from the connections list and
+//  announce that the client left
+//------------------------------------------------------------------------------
+void server::removeClientConnection(
+	const std::string& inClientUsername)
+{
+	std::unordered_map<std::string, uint32_t>::iterator session =
+		this->m_sessionsByClient.find(inClientUsername);
+
+	if(session != this->m_sessionsByClient.end())
+	{
+		this->m_connectedClients.erase(
+			session->second);
+
+		this->m_sessionWheel.cancel(
+			session->second);
+
+		this->m_sendsReceivedBySession.erase(
+			session->second);
+
+		this->m_sessionsByClient.erase(
+			session);
+
+		this->publishMembershipChange(
+			constants::MessageType::mt_SERVER_CLIENT_LEFT,
+			inClientUsername);
+	}
+
+	// a client leaves its channels when it disconnects
+	std::map<std::string, subscriberEndpoints>::iterator channel =
+		this->m_subscribersByChannel.begin();
+
+	while(channel != this->m_subscribersByChannel.end())
+	{
+		if(channel->second.erase(inClientUsername) == 0
+			|| !channel->second.empty())
+		{
+			channel++;
+			continue;
+		}
+
+		const std::string channelName(channel->first);
+
+		channel = this->m_subscribersByChannel.erase(channel);
+
+		this->publishMembershipChange(
+			constants::MessageType::mt_SERVER_CHANNEL_REMOVED,
+			channelName);
+	}
+};
+
+//-------------------------------------------------------- refreshClientActivity
+// Implementation notes:
+//  Session 0 is anything not sent by a connected client, resolveSession
+//  already matched the endpoint of the rest
+//------------------------------------------------------------------------------
+void server::refreshClientActivity(
+	const uint32_t& inSessionIdentifier)
+{
+	if(inSessionIdentifier == 0)
+	{
+		return;
+	}
+
+	std::unordered_map<uint32_t, remoteConnection>::iterator client =
+		this->m_connectedClients.find(inSessionIdentifier);
+
+	if(client != this->m_connectedClients.end())
+	{
+		client->second.refreshTimeOfLastActivity(
+			this->m_cachedNow);
+	}
+};
+
+//------------------------------------------------------------ expireIdleClients
+// Implementation notes:
+//  Called by the expiry thread every wheel tick, so each call usually
+//  visits one slot. The forwarding thread keeps the cached clock current
+//  in between.
+//------------------------------------------------------------------------------
+void server::expireIdleClients()
+{
+	this->m_cachedNow = heartbeatClock::now();
+
+	const boost::chrono::milliseconds sessionTimeout(
+		this->m_topology.viewSessionTimeoutMilliseconds());
+
+	for(const uint32_t& sessionIdentifier :
+		this->m_sessionWheel.advance(this->m_cachedNow))
+	{
+		std::unordered_map<uint32_t, remoteConnection>::const_iterator client =
+			this->m_connectedClients.find(sessionIdentifier);
+
+		if(client == this->m_connectedClients.end())
+		{
+			continue;
+		}
+
+		const heartbeatClock::time_point deadline =
+			client->second.viewTimeOfLastActivity() + sessionTimeout;
+
+		if(deadline > this->m_cachedNow)
+		{
+			this->m_sessionWheel.schedule(
+				sessionIdentifier,
+				deadline);
+
+			continue;
+		}
+
+		// the connection goes with removeClientConnection
+		const std::string clientUsername(
+			client->second.viewIdentifier());
+
+		asyncLog::write(
+			asyncLog::ll_INFO,
+			"{} timed out, nothing heard for {} ms",
+			clientUsername,
+			sessionTimeout.count());
+
+		this->removeClientConnection(
+			clientUsername);
+
+		// nobody is left to get these
+		std::map<std::string, std::list<pendingMessage>>::iterator pending =
+			this->m_messageListByClient.find(clientUsername);
+
+		if(pending != this->m_messageListByClient.end())
+		{
+			for(const pendingMessage& droppedMessage : pending->second)
+			{
+				this->m_backlog.release(
+					clientUsername,
+					droppedMessage.m_message->viewMessage().viewPayload().size());
+
+				this->unspoolMessage(
+					droppedMessage.m_spoolIdentifier);
+
+				this->m_backlog.recordDeadLetter(
+					backlogAccounting::dl_RECIPIENT_GONE);
+			}
+
+			this->m_messageListByClient.erase(
+				pending);
 		}
-	}
 
-	// if we make it here, as per the requirements, we hold on to the message
-	this->addToMessageListOfUnassociatedClients(
-		inMessage);
+		this->m_clientsEvicted++;
+	}
 };
 
-//---------------------------------------------------- processServerRelayMessage
+//----------------------------------------------------------- updateSubscription
 // Implementation notes:
-//  Determines if a message relayed from another server has reached
-//  the destination or if it must be relayed further
+//  Only the first subscriber joining and the last one leaving change the
+//  channels this server has subscribers for, and only those are announced
 //------------------------------------------------------------------------------
-void server::processServerRelayMessage(
-	const dataMessage& inMessage)
+void server::updateSubscription(
+	const dataMessage& inMessage,
+	const boost::asio::ip::udp::endpoint& inClientEndpoint)
 {
-	if(inMessage.viewDestinationIdentifier()
-		== constants::serverIndexToServerName(this->m_index))
+	const std::string& channelName =
+		inMessage.viewPayload();
+
+	if(channelName.size() < 2
+		|| channelName[0] != constants::channelPrefix()
+		|| channelName.find(constants::multicastDelimiter()) != std::string::npos)
 	{
-		this->addToMessageList(
-			inMessage);
+		return;
 	}
-	else
+
+	if(inMessage.viewMessageType() == constants::MessageType::mt_CLIENT_JOIN)
 	{
-		if(inMessage.viewServerSyncPayloadOriginIndex() < this->m_index)
-		{
-			// forward right
-			if(this->m_rightAdjacentServerConnection != nullptr)
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
+		const bool isNewChannel =
+			this->m_subscribersByChannel.count(channelName) == 0;
 
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(inMessage.asCharVector()),
-						this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
-			else
-			{
-				// programming error, should never make it here
-				assert(false);
-			}
-		}
-		else
+		this->m_subscribersByChannel[channelName][inMessage.viewSourceIdentifier()] =
+			inClientEndpoint;
+
+		if(isNewChannel)
 		{
-			// forward left
-			if(this->m_leftAdjacentServerConnection != nullptr)
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
+			this->publishMembershipChange(
+				constants::MessageType::mt_SERVER_CHANNEL_ADDED,
+				channelName);
+		}
 
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(inMessage.asCharVector()),
-						this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
+		return;
+	}
 
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
-			else
-			{
-				// programming error, should never make it here
-				assert(false);
-			}
-		}
+	std::map<std::string, subscriberEndpoints>::iterator channel =
+		this->m_subscribersByChannel.find(channelName);
+
+	if(channel == this->m_subscribersByChannel.end()
+		|| channel->second.erase(inMessage.viewSourceIdentifier()) == 0
+		|| !channel->second.empty())
+	{
+		return;
 	}
+
+	this->m_subscribersByChannel.erase(
+		channel);
+
+	this->publishMembershipChange(
+		constants::MessageType::mt_SERVER_CHANNEL_REMOVED,
+		channelName);
 };
 
-//---------------------------------------------------------- listenLoopBluetooth
+//------------------------------------------------------------ channelIsServedBy
 // Implementation notes:
-//  Listens and acts via Bluetooth
+//  This server's own subscribers are looked up in the subscription index,
+//  other servers' in the lists from the last sync
 //------------------------------------------------------------------------------
-void server::listenLoopBluetooth()
+bool server::channelIsServedBy(
+	const std::string& inChannel,
+	const int16_t& inServerIndex) const
 {
-	while(!this->m_terminate)
+	if(inServerIndex == this->m_index)
 	{
-		// #TODO_MT implement
+		return this->m_subscribersByChannel.count(inChannel) > 0;
 	}
+
+	return this->nameListContains(
+		this->m_channelsServedByServerIndex[inServerIndex],
+		inChannel);
 };
 
-//--------------------------------------------------------------- attemptForward
+//------------------------------------------------------------- nameListContains
 // Implementation notes:
-//  Listens and acts via Bluetooth
+//  The lists are sorted by handle
 //------------------------------------------------------------------------------
-void server::attemptForward()
+bool server::nameListContains(
+	const std::vector<namePool::handle>& inList,
+	const std::string& inName) const
 {
-	while(!this->m_terminate)
+	const namePool::handle name =
+		this->m_names.find(inName);
+
+	return name != 0
+		&& std::binary_search(inList.begin(), inList.end(), name);
+};
+
+//---------------------------------------------------------------- addToNameList
+// Implementation notes:
+//  The list holds a reference to each of its names
+//------------------------------------------------------------------------------
+void server::addToNameList(
+	std::vector<namePool::handle>& inList,
+	const std::string& inName)
+{
+	if(this->nameListContains(inList, inName))
 	{
-		// handle potential weird behavior with deletions
-		const size_t currentMessageListSize =
-			this->m_messageListOfUnassociatedClients.size();
+		return;
+	}
 
-		for(size_t i = 0; i < currentMessageListSize; i++)
-		{
+	const namePool::handle name =
+		this->m_names.acquire(inName);
 
-			const dataMessage messageToCheck =
-				this->m_messageListOfUnassociatedClients.front();
+	inList.insert(
+		std::lower_bound(inList.begin(), inList.end(), name),
+		name);
+};
 
-			this->m_messageListOfUnassociatedClients.pop_front();
+//----------------------------------------------------------- removeFromNameList
+// Implementation notes:
+//  Self explanatory
+//------------------------------------------------------------------------------
+void server::removeFromNameList(
+	std::vector<namePool::handle>& inList,
+	const std::string& inName)
+{
+	const namePool::handle name =
+		this->m_names.find(inName);
 
-			this->processClientSendMessage(
-				messageToCheck);
-		}
+	std::vector<namePool::handle>::iterator position =
+		std::lower_bound(inList.begin(), inList.end(), name);
 
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::forwardIntervalMilliseconds));
+	if(name == 0 || position == inList.end() || *position != name)
+	{
+		return;
 	}
+
+	inList.erase(
+		position);
+
+	this->m_names.release(
+		name);
 };
 
-//------------------------------------------------------------- sendSyncPayloads
+//-------------------------------------------------------------- rewriteNameList
 // Implementation notes:
-//  Sends the sync payloads for this server and all known servers to adjacent
-//  servers if they exists. This is done as one UDP message per server.
+//  A name already in the list keeps the list's reference and is only looked
+//  up. Every other name gets a new reference, so a name repeated in the
+//  payload gives back its extra ones. The names the payload no longer has
+//  are found by walking the old and new lists together, and released.
 //------------------------------------------------------------------------------
-void server::sendSyncPayloads()
+bool server::rewriteNameList(
+	std::vector<namePool::handle>& inList,
+	const std::vector<std::string>& inNames)
 {
-	while(!this->m_terminate)
+	std::vector<namePool::handle> rewritten;
+	rewritten.reserve(inNames.size());
+
+	bool changed = false;
+
+	for(const std::string& currentName : inNames)
 	{
-		std::vector<std::string> thisServersClients;
+		namePool::handle name = this->m_names.find(currentName);
 
-		for(const remoteConnection& currentClient : this->m_connectedClients)
+		if(name == 0 || !std::binary_search(inList.begin(), inList.end(), name))
 		{
-			thisServersClients.push_back(currentClient.viewIdentifier());
+			name = this->m_names.acquire(currentName);
+			changed = true;
 		}
 
-		this->m_clientsServedByServerIndex[this->m_index] =
-			thisServersClients;
+		rewritten.push_back(name);
+	}
 
-		this->sendSyncPayloadsLeft();
-		this->sendSyncPayloadsRight();
+	std::sort(
+		rewritten.begin(),
+		rewritten.end());
 
-		// sleep
-		boost::this_thread::sleep(
-			boost::posix_time::millisec(
-			constants::syncIntervalMilliseconds));
+	std::vector<namePool::handle>::iterator last = rewritten.begin();
+
+	for(std::vector<namePool::handle>::iterator it = rewritten.begin();
+		it != rewritten.end();
+		it++)
+	{
+		if(it != rewritten.begin() && *it == *(last - 1))
+		{
+			if(!std::binary_search(inList.begin(), inList.end(), *it))
+			{
+				this->m_names.release(*it);
+			}
+
+			continue;
+		}
+
+		*last++ = *it;
+	}
+
+	rewritten.erase(
+		last,
+		rewritten.end());
+
+	std::vector<namePool::handle>::const_iterator kept = rewritten.begin();
+
+	for(const namePool::handle& previous : inList)
+	{
+		while(kept != rewritten.end() && *kept < previous)
+		{
+			kept++;
+		}
+
+		if(kept == rewritten.end() || *kept != previous)
+		{
+			this->m_names.release(previous);
+			changed = true;
+		}
 	}
+
+	inList.swap(
+		rewritten);
+
+	return changed;
 };
 
-//--------------------------------------------------------- sendSyncPayloadsLeft
+//------------------------------------------------------------- addToMessageList
 // Implementation notes:
-//  Sends all known sync payloads to the left adjacent server
+//  Add a new message to the message list, if the client has room for it
 //------------------------------------------------------------------------------
-void server::sendSyncPayloadsLeft()
+void server::addToMessageList(
+	const dataMessage& inMessage,
+	const heartbeatClock::time_point& inDeadline)
 {
-	if(this->m_leftAdjacentServerConnection != nullptr)
+	if(!this->m_backlog.admit(inMessage.viewDestinationIdentifier(), inMessage.viewPayload().size()))
 	{
-		for(int8_t i = this->m_index; i <= constants::highestServerIndex; i++)
-		{
-			const size_t clientListSize =
-				this->m_clientsServedByServerIndex[i].size();
-
-			if(clientListSize == 0)
-			{
-				continue;
-			}
-			else
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
-
-					const dataMessage syncMessageToSend(
-						this->sequenceNumber(),
-						constants::MessageType::mt_SERVER_SYNC,
-						constants::serverIndexToServerName(this->m_index),
-						constants::serverIndexToServerName(this->m_leftAdjacentServerIndex),
-						this->m_clientsServedByServerIndex[i],
-						i);
-
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(syncMessageToSend.asCharVector()),
-						this->m_leftAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
-		}
+		return;
 	}
-	else
+
+	dataMessage deliveredMessage(inMessage);
+
+	deliveredMessage.setMessageType(
+		constants::MessageType::mt_SERVER_SEND);
+
+	deliveredMessage.stampTrace(
+		this->m_index,
+		messageTrace::ts_QUEUE);
+
+	const uint64_t spoolIdentifier = this->m_spool
+		? this->spoolMessage(
+			messageSpool::sk_DELIVERY,
+			deliveredMessage.viewDestinationIdentifier(),
+			deliveredMessage.asCharVector(),
+			inDeadline)
+		: 0;
+
+	this->m_messageListByClient[deliveredMessage.viewDestinationIdentifier()].push_back(
+		pendingMessage(
+			boost::make_shared<const encodedMessage>(deliveredMessage),
+			inDeadline,
+			spoolIdentifier,
+			heartbeatClock::now()));
+};
+
+//---------------------------------------- addToMessageListOfUnassociatedClients
+// Implementation notes:
+//  Add a new message to the message list of unassociated clients, counted
+//  against the quota of the client it is for. The first retry is after the
+//  shortest backoff.
+//------------------------------------------------------------------------------
+void server::addToMessageListOfUnassociatedClients(
+	const dataMessage& inMessage,
+	const heartbeatClock::time_point& inDeadline)
+{
+	if(!this->m_backlog.admit(inMessage.viewDestinationIdentifier(), inMessage.viewPayload().size()))
 	{
-		// Do nothing
+		return;
 	}
+
+	dataMessage heldCopy(inMessage);
+
+	heldCopy.setMessageType(
+		constants::MessageType::mt_CLIENT_SEND);
+
+	heldCopy.stampTrace(
+		this->m_index,
+		messageTrace::ts_HELD);
+
+	const uint64_t spoolIdentifier = this->m_spool
+		? this->spoolMessage(
+			messageSpool::sk_HELD,
+			heldCopy.viewDestinationIdentifier(),
+			heldCopy.asCharVector(),
+			inDeadline)
+		: 0;
+
+	this->m_messageListOfUnassociatedClients.insert(std::make_pair(
+		this->m_cachedNow + boost::chrono::milliseconds(constants::heldRetryMinimumMilliseconds),
+		heldMessage(heldCopy, inDeadline, 0, spoolIdentifier)));
 };
 
-//--------------------------------------------------------- sendSyncPaylodsRight
+//------------------------------------------------------------- retryHeldMessage
 // Implementation notes:
-//  Sends all known sync payloads to the right adjacent server
+//  A message held again stays counted against the quota and keeps its
+//  spool record. One that can be routed is released and unspooled first,
+//  since routing it counts and spools it again wherever it is kept. Held
+//  messages are routed without the hop limit, in case that is why they
+//  were held.
 //------------------------------------------------------------------------------
-void server::sendSyncPayloadsRight()
+void server::retryHeldMessage(
+	const heldMessage& inHeldMessage)
 {
-	if(this->m_rightAdjacentServerConnection != nullptr)
+	const dataMessage& message = inHeldMessage.m_message;
+
+	if(inHeldMessage.m_deadline <= this->m_cachedNow)
+	{
+		this->m_backlog.release(
+			message.viewDestinationIdentifier(),
+			message.viewPayload().size());
+
+		this->unspoolMessage(
+			inHeldMessage.m_spoolIdentifier);
+
+		this->m_backlog.recordDeadLetter(
+			backlogAccounting::dl_EXPIRED);
+
+		return;
+	}
+
+	const int16_t destinationServerIndex =
+		this->lookupServerIndexOfClient(
+			message.viewDestinationIdentifier());
+
+	if(destinationServerIndex == -1
+		|| (destinationServerIndex != this->m_index
+			&& this->m_routingTable.viewNextHop(destinationServerIndex) == -1))
 	{
-		for(int8_t i = this->m_index; i >= 0; i--)
+		const uint16_t attempts = inHeldMessage.m_attempts + 1;
+
+		uint32_t backoff = constants::heldRetryMaximumMilliseconds;
+
+		if(attempts < 16)
 		{
-			const size_t clientListSize =
-				this->m_clientsServedByServerIndex[i].size();
+			backoff = std::min<uint32_t>(
+				backoff,
+				static_cast<uint32_t>(constants::heldRetryMinimumMilliseconds) << attempts);
+		}
+
+		this->m_messageListOfUnassociatedClients.insert(std::make_pair(
+			this->m_cachedNow + boost::chrono::milliseconds(backoff),
+			heldMessage(message, inHeldMessage.m_deadline, attempts, inHeldMessage.m_spoolIdentifier)));
+
+		return;
+	}
+
+	this->m_backlog.release(
+		message.viewDestinationIdentifier(),
+		message.viewPayload().size());
+
+	this->unspoolMessage(
+		inHeldMessage.m_spoolIdentifier);
+
+	this->routeMessage(
+		message,
+		false,
+		inHeldMessage.m_deadline);
+};
 
-			if(clientListSize == 0)
+//---------------------------------------------------------------- expireBacklog
+// Implementation notes:
+//  Walks every message list, since messages with their own time to live
+//  are not kept in deadline order
+//------------------------------------------------------------------------------
+void server::expireBacklog()
+{
+	std::map<std::string, std::list<pendingMessage>>::iterator pending =
+		this->m_messageListByClient.begin();
+
+	while(pending != this->m_messageListByClient.end())
+	{
+		std::list<pendingMessage>::iterator it = pending->second.begin();
+
+		while(it != pending->second.end())
+		{
+			if(it->m_deadline > this->m_cachedNow)
 			{
+				it++;
 				continue;
 			}
-			else
-			{
-				try
-				{
-					boost::system::error_code ignoredError;
-
-					const dataMessage syncMessageToSend(
-						this->sequenceNumber(),
-						constants::MessageType::mt_SERVER_SYNC,
-						constants::serverIndexToServerName(this->m_index),
-						constants::serverIndexToServerName(this->m_rightAdjacentServerIndex),
-						this->m_clientsServedByServerIndex[i],
-						i);
-
-					this->m_UDPsocket.send_to(
-						boost::asio::buffer(syncMessageToSend.asCharVector()),
-						this->m_rightAdjacentServerConnection->viewEndpoint(), 0, ignoredError);
-				}
-				catch(std::exception& exception)
-				{
-					// std::cout << exception.what() << std::endl;
-				}
-			}
+
+			this->m_backlog.release(
+				pending->first,
+				it->m_message->viewMessage().viewPayload().size());
+
+			this->unspoolMessage(
+				it->m_spoolIdentifier);
+
+			this->m_backlog.recordDeadLetter(
+				backlogAccounting::dl_EXPIRED);
+
+			it = pending->second.erase(it);
 		}
-	}
-	else
-	{
-		// Do nothing
-	}
 
+		if(pending->second.empty())
+		{
+			pending = this->m_messageListByClient.erase(pending);
+		}
+		else
+		{
+			pending++;
+		}
+	}
 };
 
-//--------------------------------------------------------------- sequenceNumber
+//------------------------------------------------------------------- deadlineOf
 // Implementation notes:
-//  Increments the sequence number every time it is used, self explanatory.
+//  Uses the clock cached by the forwarding thread
 //------------------------------------------------------------------------------
-const int64_t& server::sequenceNumber()
+server::heartbeatClock::time_point server::deadlineOf(
+	const dataMessage& inMessage) const
 {
-	return ++this->m_sequenceNumber;
+	const int64_t timeToLive = inMessage.viewTimeToLiveMilliseconds() > 0
+		? inMessage.viewTimeToLiveMilliseconds()
+		: static_cast<int64_t>(this->m_topology.viewMessageTimeToLiveMilliseconds());
+
+	return this->m_cachedNow + boost::chrono::milliseconds(timeToLive);
 };
 
-//------------------------------------------------- sendClientsToAdjacentServers
+//----------------------------------------------------------------- spoolMessage
 // Implementation notes:
-//  Receives the list of clients from an adjacent server and stores them.
+//  The wall clock deadline is the time left before the steady one, counted
+//  from now
 //------------------------------------------------------------------------------
-void server::receiveClientsFromAdjacentServers(
-	const dataMessage& inSyncMessage)
+uint64_t server::spoolMessage(
+	const messageSpool::RecordKind& inKind,
+	const std::string& inRecipient,
+	const std::vector<char>& inEncodedMessage,
+	const heartbeatClock::time_point& inDeadline)
 {
-	this->m_clientsServedByServerIndex[inSyncMessage.viewServerSyncPayloadOriginIndex()] =
-		inSyncMessage.viewServerSyncPayload();
+	if(!this->m_spool)
+	{
+		return 0;
+	}
+
+	const int64_t deadlineMilliseconds =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count()
+		+ boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			inDeadline - this->m_cachedNow).count();
+
+	return this->m_spool->append(
+		inKind,
+		inRecipient,
+		deadlineMilliseconds,
+		inEncodedMessage);
 };
 
-//---------------------------------------------------------- addClientConnection
+//--------------------------------------------------------------- unspoolMessage
 // Implementation notes:
-//  Adds a new client connection to the connections list
+//  Messages that were never spooled have the identifier 0
 //------------------------------------------------------------------------------
-void server::addClientConnection(
-	const std::string& inClientUsername,
-	const boost::asio::ip::udp::endpoint& inClientEndpoint)
+void server::unspoolMessage(
+	const uint64_t& inSpoolIdentifier)
 {
-	this->m_connectedClients.push_back(
-		remoteConnection(inClientUsername, inClientEndpoint));
+	if(this->m_spool && inSpoolIdentifier != 0)
+	{
+		this->m_spool->remove(
+			inSpoolIdentifier);
+	}
 };
 
-//------------------------------------------------------- removeClientConnection
+//------------------------------------------------------- recoverSpooledMessages
 // Implementation notes:
-//  Remove the matching client connection from the connections list
+//  Called from the constructor, before any thread runs. The messages keep
+//  their spool records. Held messages are retried straight away, since
+//  their backoff is not spooled.
 //------------------------------------------------------------------------------
-void server::removeClientConnection(
-	const std::string& inClientUsername)
+void server::recoverSpooledMessages()
 {
-	for(std::vector<remoteConnection>::iterator it = this->m_connectedClients.begin();
-		it != this->m_connectedClients.end();
-		it++)
+	const heartbeatClock::time_point start = heartbeatClock::now();
+
+	const int64_t nowMilliseconds =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count();
+
+	size_t recoveredMessages = 0;
+
+	for(const messageSpool::spooledEntry& entry : this->m_spool->takeRecovered())
 	{
-		if(it->viewIdentifier() == inClientUsername)
+		const dataMessage message(
+			entry.m_message);
+
+		const heartbeatClock::time_point deadline =
+			this->m_cachedNow
+			+ boost::chrono::milliseconds(entry.m_deadlineMilliseconds - nowMilliseconds);
+
+		if(deadline <= this->m_cachedNow)
 		{
-			this->m_connectedClients.erase(it);
+			this->m_spool->remove(
+				entry.m_identifier);
+
+			this->m_backlog.recordDeadLetter(
+				backlogAccounting::dl_EXPIRED);
+
+			continue;
+		}
+
+		if(!this->m_backlog.admit(entry.m_recipient, message.viewPayload().size()))
+		{
+			this->m_spool->remove(
+				entry.m_identifier);
+
+			continue;
 		}
-		break;
+
+		if(entry.m_kind == messageSpool::sk_DELIVERY)
+		{
+			this->m_messageListByClient[entry.m_recipient].push_back(
+				pendingMessage(
+					boost::make_shared<const encodedMessage>(message),
+					deadline,
+					entry.m_identifier,
+					heartbeatClock::now()));
+		}
+		else
+		{
+			this->m_messageListOfUnassociatedClients.insert(std::make_pair(
+				this->m_cachedNow,
+				heldMessage(message, deadline, 0, entry.m_identifier)));
+		}
+
+		recoveredMessages++;
 	}
+
+	this->m_spool->synchronize();
+
+	asyncLog::write(
+		asyncLog::ll_INFO,
+		"Recovered {} spooled messages in {} ms",
+		recoveredMessages,
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			heartbeatClock::now() - start).count());
 };
 
-//------------------------------------------------------------- addToMessageList
+//---------------------------------------------------------------- sampleMetrics
 // Implementation notes:
-//  Add a new message to the message list
+//  Gauges are looked up by name, this only runs when the metrics are read
 //------------------------------------------------------------------------------
-void server::addToMessageList(
-	dataMessage message)
+void server::sampleMetrics()
 {
-	message.setMessageType(
-		constants::MessageType::mt_SERVER_SEND);
+	this->m_metrics.addGauge("clients.connected").set(
+		this->m_connectedClients.size());
+
+	this->m_metrics.addGauge("names.interned").set(
+		this->m_names.viewInterned());
+
+	this->m_metrics.addGauge("backlog.recipients").set(
+		this->m_messageListByClient.size());
+
+	this->m_metrics.addGauge("backlog.held").set(
+		this->m_messageListOfUnassociatedClients.size());
+
+	this->m_metrics.addGauge("backlog.messages").set(
+		this->m_backlog.viewMessages());
+
+	this->m_metrics.addGauge("backlog.bytes").set(
+		this->m_backlog.viewBytes());
+
+	this->m_metrics.addGauge("dead_letters.expired").set(
+		this->m_backlog.viewDeadLetters(backlogAccounting::dl_EXPIRED));
+
+	this->m_metrics.addGauge("dead_letters.recipient_quota").set(
+		this->m_backlog.viewDeadLetters(backlogAccounting::dl_RECIPIENT_QUOTA));
+
+	this->m_metrics.addGauge("dead_letters.server_quota").set(
+		this->m_backlog.viewDeadLetters(backlogAccounting::dl_SERVER_QUOTA));
+
+	this->m_metrics.addGauge("dead_letters.recipient_gone").set(
+		this->m_backlog.viewDeadLetters(backlogAccounting::dl_RECIPIENT_GONE));
+
+	// relays are counted per link, which tells the directions apart
+	for(const int16_t& neighbour : this->m_routingTable.viewNeighbours())
+	{
+		const reliableLink& link = this->m_serverLinks[neighbour];
+		const std::string prefix("link." + this->m_topology.viewServerName(neighbour) + ".");
+
+		this->m_metrics.addGauge(prefix + "relays_sent").set(
+			link.viewRelaysSent());
 
-	this->m_messageList.push_back(
-		message);
+		this->m_metrics.addGauge(prefix + "retransmissions").set(
+			link.viewRetransmissions());
+
+		this->m_metrics.addGauge(prefix + "duplicates_received").set(
+			link.viewDuplicatesReceived());
+
+		this->m_metrics.addGauge(prefix + "in_flight").set(
+			link.viewInFlight());
+
+		this->m_metrics.addGauge(prefix + "queued").set(
+			link.viewQueued());
+
+		this->m_metrics.addGauge(prefix + "round_trip_us").set(
+			static_cast<int64_t>(link.viewRoundTripMilliseconds() * 1000.0));
+	}
 };
 
-//---------------------------------------- addToMessageListOfUnassociatedClients
+//------------------------------------------------------------------ recordTrace
 // Implementation notes:
-//  Add a new message to the message list of unassociated clients
+//  Flushed line by line, so traces can be read while the server runs. Only
+//  sampled messages get here.
 //------------------------------------------------------------------------------
-void server::addToMessageListOfUnassociatedClients(
-	dataMessage message)
+void server::recordTrace(
+	const pendingMessage& inMessage,
+	const int64_t& inAcknowledgedMicroseconds)
 {
-	message.setMessageType(
-		constants::MessageType::mt_CLIENT_SEND);
+	const dataMessage& message = inMessage.m_message->viewMessage();
+
+	if(!message.viewTrace().isTraced() || !this->m_traceFile.is_open())
+	{
+		return;
+	}
+
+	messageTrace completedTrace(message.viewTrace());
+
+	if(inMessage.m_deliveredMicroseconds != 0)
+	{
+		completedTrace.stamp(
+			this->m_index,
+			messageTrace::ts_DELIVER,
+			inMessage.m_deliveredMicroseconds);
+	}
+
+	completedTrace.stamp(
+		this->m_index,
+		messageTrace::ts_ACKNOWLEDGE,
+		inAcknowledgedMicroseconds);
 
-	this->m_messageListOfUnassociatedClients.push_back(
-		message);
+	this->m_traceFile << completedTrace.asString() << std::endl;
 };
\ No newline at end of file
@@ -3,10 +3,18 @@
 // Boost
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 
 // STL
+#include <atomic>
+#include <fstream>
 #include <vector>
 #include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
 #include <string>
 #include <utility>
 #include <cstdint>
@@ -14,6 +22,17 @@
 // Project
 #include "../Common/remoteConnection.h"
 #include "../Common/dataMessage.h"
+#include "../Common/datagramCapture.h"
+#include "../Common/encodedMessage.h"
+#include "../Common/metricsRegistry.h"
+#include "../Common/serverTopology.h"
+#include "backlogAccounting.h"
+#include "bloomFilter.h"
+#include "messageSpool.h"
+#include "namePool.h"
+#include "routingTable.h"
+#include "reliableLink.h"
+#include "sessionWheel.h"
 
 class server
 {
@@ -21,19 +40,20 @@ public:
 
 	//-------------------------------------------------------------- constructor
 	// Brief Description
-	//  Constructor for the server
+	//  Constructor for the server. The server listens on the port given for
+	//  inServerIndex in the topology.
 	//
 	// Method:    server
 	// FullName:  server::server
 	// Access:    public 
 	// Returns:   
-	// Parameter: const uint16_t& inListeningPort
-	// Parameter: const int8_t& inServerIndex
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const int16_t& inServerIndex
 	// Parameter: boost::asio::io_service& ioService
 	//--------------------------------------------------------------------------
 	server(
-		const uint16_t& inListeningPort,
-		const int8_t& inServerIndex,
+		const serverTopology& inTopology,
+		const int16_t& inServerIndex,
 		boost::asio::io_service& ioService);
 
 	//--------------------------------------------------------------- destructor
@@ -59,8 +79,210 @@ public:
 	//--------------------------------------------------------------------------
 	void run();
 
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Signals every loop of the server to terminate. run() returns once
+	//  all of the threads have finished.
+	//
+	// Method:    stop
+	// FullName:  server::stop
+	// Access:    public 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stop();
+
+	//------------------------------------------------------ serverIndexOfClient
+	// Brief Description
+	//  Returns the index of the server this server believes the client is
+	//  connected to, or -1 if the client is unknown. Used to observe how
+	//  quickly a client becomes known across servers.
+	//
+	// Method:    serverIndexOfClient
+	// FullName:  server::serverIndexOfClient
+	// Access:    public 
+	// Returns:   int16_t
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	int16_t serverIndexOfClient(
+		const std::string& inClientIdentifier);
+
+	//--------------------------------------------------------------- serverIsUp
+	// Brief Description
+	//  Returns false if this server has detected that the given neighbouring
+	//  server is down. Used to observe failure detection and recovery.
+	//
+	// Method:    serverIsUp
+	// FullName:  server::serverIsUp
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool serverIsUp(
+		const int16_t& inServerIndex);
+
+	//----------------------------------------------------- serverHasSubscribers
+	// Brief Description
+	//  Returns true if this server believes the given server has clients
+	//  subscribed to the channel. Used to observe how quickly a channel
+	//  becomes known across servers.
+	//
+	// Method:    serverHasSubscribers
+	// FullName:  server::serverHasSubscribers
+	// Access:    public 
+	// Returns:   bool
+	// Parameter: const std::string& inChannel
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool serverHasSubscribers(
+		const std::string& inChannel,
+		const int16_t& inServerIndex);
+
+	//----------------------------------------------------------- clientsEvicted
+	// Brief Description
+	//  Returns the number of clients this server disconnected because it had
+	//  not heard from them for the session timeout.
+	//
+	// Method:    clientsEvicted
+	// FullName:  server::clientsEvicted
+	// Access:    public 
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t clientsEvicted();
+
+	//----------------------------------------------------- syncPayloadBytesSent
+	// Brief Description
+	//  Returns the number of bytes of client lists and summaries this server
+	//  sent in its periodic syncs.
+	//
+	// Method:    syncPayloadBytesSent
+	// FullName:  server::syncPayloadBytesSent
+	// Access:    public 
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t syncPayloadBytesSent();
+
+	//-------------------------------------------------------- backlogStatistics
+	// Brief Description
+	//  Returns a copy of the accounting of the messages this server keeps
+	//  for recipients, with the counts of messages it gave up on.
+	//
+	// Method:    backlogStatistics
+	// FullName:  server::backlogStatistics
+	// Access:    public 
+	// Returns:   backlogAccounting
+	//--------------------------------------------------------------------------
+	backlogAccounting backlogStatistics();
+
+	//---------------------------------------------------------- spoolStatistics
+	// Brief Description
+	//  Returns the counters of the spool undelivered messages are kept in,
+	//  or an empty string if they are only kept in memory.
+	//
+	// Method:    spoolStatistics
+	// FullName:  server::spoolStatistics
+	// Access:    public 
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string spoolStatistics();
+
+	//------------------------------------------------------------- serverLinkAt
+	// Brief Description
+	//  Returns a copy of the reliable link to the given server, for its
+	//  statistics.
+	//
+	// Method:    serverLinkAt
+	// FullName:  server::serverLinkAt
+	// Access:    public 
+	// Returns:   reliableLink
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	reliableLink serverLinkAt(
+		const int16_t& inServerIndex);
+
+	//---------------------------------------------------------- metricsAsString
+	// Brief Description
+	//  Returns the server's metrics whose names start with the prefix, one
+	//  per line: messages received by type, receive and send errors, queue
+	//  depths, relays per link and latency histograms in microseconds.
+	//
+	// Method:    metricsAsString
+	// FullName:  server::metricsAsString
+	// Access:    public 
+	// Returns:   std::string
+	// Parameter: const std::string& inPrefix
+	//--------------------------------------------------------------------------
+	std::string metricsAsString(
+		const std::string& inPrefix = "");
+
 private:
 
+	typedef boost::chrono::steady_clock heartbeatClock;
+	typedef encodedMessage::pointer sharedMessage;
+	typedef std::map<std::string, boost::asio::ip::udp::endpoint> subscriberEndpoints;
+
+	class pendingMessage
+	{
+	public:
+		pendingMessage(
+			const sharedMessage& inMessage,
+			const heartbeatClock::time_point& inDeadline,
+			const uint64_t& inSpoolIdentifier,
+			const heartbeatClock::time_point& inQueuedAt) :
+			m_message(inMessage),
+			m_deadline(inDeadline),
+			m_spoolIdentifier(inSpoolIdentifier),
+			m_queuedAt(inQueuedAt),
+			m_deliveredMicroseconds(0)
+		{
+		};
+
+		sharedMessage m_message;
+		heartbeatClock::time_point m_deadline;
+		uint64_t m_spoolIdentifier;
+		heartbeatClock::time_point m_queuedAt;
+
+		// when a traced message was first sent to its client, 0 until then
+		int64_t m_deliveredMicroseconds;
+	};
+
+	class heldMessage
+	{
+	public:
+		heldMessage(
+			const dataMessage& inMessage,
+			const heartbeatClock::time_point& inDeadline,
+			const uint16_t& inAttempts,
+			const uint64_t& inSpoolIdentifier) :
+			m_message(inMessage),
+			m_deadline(inDeadline),
+			m_attempts(inAttempts),
+			m_spoolIdentifier(inSpoolIdentifier)
+		{
+		};
+
+		dataMessage m_message;
+		heartbeatClock::time_point m_deadline;
+		uint16_t m_attempts;
+		uint64_t m_spoolIdentifier;
+	};
+
+	class listAssembly
+	{
+	public:
+		listAssembly() :
+			m_version(0),
+			m_partsReceived(0)
+		{
+		};
+
+		// the names of each part of the version being assembled, and which
+		// parts have arrived
+		int64_t m_version;
+		std::vector<std::vector<std::string>> m_parts;
+		std::vector<bool> m_partReceived;
+		uint16_t m_partsReceived;
+	};
+
 	//------------------------------------------------------------ listenLoopUDP
 	// Brief Description
 	//  The server's listening loop for UDP. It receives messages from clients
@@ -82,26 +304,29 @@ private:
 	// FullName:  server::sendMessagesToClient
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const uint32_t& inSessionIdentifier
 	//--------------------------------------------------------------------------
 	void sendMessagesToClient(
-		const std::string& inClientIdentifier);
+		const uint32_t& inSessionIdentifier);
 
 	//-------------------------------------------- removeReceivedMessageFromList
 	// Brief Description
-	//  Removes the corresponding message specified via the input parameter
-	//  from the message list. This is usually done in response to getting
-	//  an ACK from the client. Once a message has been confirmed received
-	//  by the intended client, it is no longer necessary to store it on the
-	//  server.
+	//  Removes the messages acknowledged by a client ACK from that client's
+	//  message list. An ACK is a frame naming any number of messages by
+	//  sender and sequence number range. Once a message has been confirmed
+	//  received by the intended client, it is no longer necessary to store
+	//  it on the server.
 	//
 	// Method:    removeReceivedMessageFromList
 	// FullName:  server::removeReceivedMessageFromList
 	// Access:    private 
 	// Returns:   void
 	// Parameter: const dataMessage& inMessage
+	// Parameter: const std::string& inClientIdentifier
 	//--------------------------------------------------------------------------
 	void removeReceivedMessageFromList(
-		const dataMessage& inMessage);
+		const dataMessage& inMessage,
+		const std::string& inClientIdentifier);
 
 
 	//------------------------------------------------- processClientSendMessage
@@ -122,6 +347,26 @@ private:
 	void processClientSendMessage(
 		const dataMessage& inMessage);
 
+	//---------------------------------------------------- acknowledgeClientSend
+	// Brief Description
+	//  ACKs a message sent by a client, so the client stops retransmitting
+	//  it. Returns true the first time a message is received and false for
+	//  a retransmission of a message already received, which must not be
+	//  routed again. Only the sends of a connected client are remembered.
+	//
+	// Method:    acknowledgeClientSend
+	// FullName:  server::acknowledgeClientSend
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	// Parameter: const uint32_t& inSessionIdentifier
+	//--------------------------------------------------------------------------
+	bool acknowledgeClientSend(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint,
+		const uint32_t& inSessionIdentifier);
+
 	
 	//------------------------------------------------ processServerRelayMessage
 	// Brief Description
@@ -139,6 +384,181 @@ private:
 	void processServerRelayMessage(
 		const dataMessage& inMessage);
 
+	//------------------------------------------------------------- routeMessage
+	// Brief Description
+	//  Keeps the message if its destination client is connected to this
+	//  server, otherwise relays it to the next hop towards the server the
+	//  client is on. Under mesh routing that is the destination server
+	//  itself. Messages for unknown clients are held, as are messages that
+	//  have been relayed more times than there are servers when
+	//  inEnforceHopLimit is set, since those are following stale client
+	//  lists. Broadcasts and multicasts are passed on to be split up. The
+	//  message is given up on at the deadline, wherever it is kept.
+	//
+	// Method:    routeMessage
+	// FullName:  server::routeMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const bool& inEnforceHopLimit
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void routeMessage(
+		const dataMessage& inMessage,
+		const bool& inEnforceHopLimit,
+		const heartbeatClock::time_point& inDeadline);
+
+	//----------------------------------------------------------- routeBroadcast
+	// Brief Description
+	//  Delivers a broadcast to this server's clients, or a channel message
+	//  to this server's subscribers, other than its sender, if this server
+	//  is one of its targets, and relays one copy to each neighbour that
+	//  leads to the remaining targets.
+	//
+	// Method:    routeBroadcast
+	// FullName:  server::routeBroadcast
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void routeBroadcast(
+		const dataMessage& inMessage,
+		const heartbeatClock::time_point& inDeadline);
+
+	//----------------------------------------------------------- routeMulticast
+	// Brief Description
+	//  Delivers a multicast to the recipients connected to this server and
+	//  relays one copy to each neighbour that leads to the others, listing
+	//  only the recipients reached through it.
+	//
+	// Method:    routeMulticast
+	// FullName:  server::routeMulticast
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const bool& inEnforceHopLimit
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void routeMulticast(
+		const dataMessage& inMessage,
+		const bool& inEnforceHopLimit,
+		const heartbeatClock::time_point& inDeadline);
+
+	//---------------------------------------------------------- fanOutToClients
+	// Brief Description
+	//  Adds a message to the message list of each recipient and sends it to
+	//  them, from one shared copy. Recipients over their quota are skipped.
+	//
+	// Method:    fanOutToClients
+	// FullName:  server::fanOutToClients
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const std::vector<remoteConnection>& inRecipients
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void fanOutToClients(
+		const dataMessage& inMessage,
+		const std::vector<remoteConnection>& inRecipients,
+		const heartbeatClock::time_point& inDeadline);
+
+	//------------------------------------------------------------ relayToServer
+	// Brief Description
+	//  Sends a copy of the message to the given server as a server relay,
+	//  incrementing its hop count and setting its time to live to what is
+	//  left before the deadline. The relay is retransmitted until the server
+	//  ACKs it. A message past its deadline is dropped instead.
+	//
+	// Method:    relayToServer
+	// FullName:  server::relayToServer
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const int16_t& inServerIndex
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void relayToServer(
+		const dataMessage& inMessage,
+		const int16_t& inServerIndex,
+		const heartbeatClock::time_point& inDeadline);
+
+	//------------------------------------------------------------- sendToServer
+	// Brief Description
+	//  Sends the message to the given server. Returns false, after reporting
+	//  the error, if the message could not be sent.
+	//
+	// Method:    sendToServer
+	// FullName:  server::sendToServer
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool sendToServer(
+		const dataMessage& inMessage,
+		const int16_t& inServerIndex);
+
+	//-------------------------------------------------------- sendRelayToServer
+	// Brief Description
+	//  Sends a relay taken from the link to the given server, from its
+	//  shared encoding. Returns false, after reporting the error, if the
+	//  relay could not be sent.
+	//
+	// Method:    sendRelayToServer
+	// FullName:  server::sendRelayToServer
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const reliableLink::relayTransmission& inTransmission
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool sendRelayToServer(
+		const reliableLink::relayTransmission& inTransmission,
+		const int16_t& inServerIndex);
+
+	//---------------------------------------------------------- flushServerLink
+	// Brief Description
+	//  Sends whatever the link to the given server has ready: relays whose
+	//  retransmit timer expired and queued relays that fit in the window.
+	//
+	// Method:    flushServerLink
+	// FullName:  server::flushServerLink
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	void flushServerLink(
+		const int16_t& inServerIndex);
+
+	//------------------------------------------------------- receiveServerRelay
+	// Brief Description
+	//  Receives a relay from another server, ACKs it, and processes it
+	//  unless it is a duplicate of a relay already received.
+	//
+	// Method:    receiveServerRelay
+	// FullName:  server::receiveServerRelay
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inRelayMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inSenderEndpoint
+	//--------------------------------------------------------------------------
+	void receiveServerRelay(
+		const dataMessage& inRelayMessage,
+		const boost::asio::ip::udp::endpoint& inSenderEndpoint);
+
+	//--------------------------------------------- receiveServerAcknowledgement
+	// Brief Description
+	//  Receives an ACK for relays this server sent to another server.
+	//
+	// Method:    receiveServerAcknowledgement
+	// FullName:  server::receiveServerAcknowledgement
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inAcknowledgement
+	//--------------------------------------------------------------------------
+	void receiveServerAcknowledgement(
+		const dataMessage& inAcknowledgement);
+
 	//------------------------------------------------------ listenLoopBluetooth
 	// Brief Description
 	//  The server's listening loop for Bluetooth. It receives messages from 
@@ -153,9 +573,10 @@ private:
 
 	//----------------------------------------------------------- attemptForward
 	// Brief Description
-	//  Periodically cycles through all the messages on this server and
-	//  determines if they should be forwarded to another server, or kept
-	//  on this server instead.
+	//  Retries the held messages whose backoff is up, or all of them when a
+	//  client or server they may be waiting on appeared, forwarding each to
+	//  the server its client is on now or holding it again. Refreshes the
+	//  cached clock first. Run every forwarding interval.
 	//
 	// Method:    attemptForward
 	// FullName:  server::attemptForward
@@ -164,10 +585,77 @@ private:
 	//--------------------------------------------------------------------------
 	void attemptForward();
 
+	//--------------------------------------------------------- flushServerLinks
+	// Brief Description
+	//  Sends this tick's membership changes, and whatever the links to the
+	//  neighbours have ready, relays whose retransmit timer expired among
+	//  them. Run every forwarding interval.
+	//
+	// Method:    flushServerLinks
+	// FullName:  server::flushServerLinks
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushServerLinks();
+
+	//--------------------------------------------------------- synchronizeSpool
+	// Brief Description
+	//  Writes the spool segments to disk. Only run when there is a spool.
+	//
+	// Method:    synchronizeSpool
+	// FullName:  server::synchronizeSpool
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void synchronizeSpool();
+
+	//------------------------------------------------------------- flushCapture
+	// Brief Description
+	//  Appends the datagrams captured since the last flush to the capture
+	//  file. Only run when capturing.
+	//
+	// Method:    flushCapture
+	// FullName:  server::flushCapture
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushCapture();
+
+	// a task run under the mutex at an interval of its own
+	typedef void (server::*periodicTask)();
+
+	//---------------------------------------------------------- runPeriodically
+	// Brief Description
+	//  Runs the task while holding the mutex, then sleeps the interval,
+	//  until the server stops. The loop of each periodic task's thread.
+	//
+	// Method:    runPeriodically
+	// FullName:  server::runPeriodically
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const periodicTask& inTask
+	// Parameter: const uint16_t& inIntervalMilliseconds
+	//--------------------------------------------------------------------------
+	void runPeriodically(
+		const periodicTask& inTask,
+		const uint16_t& inIntervalMilliseconds);
+
+	//------------------------------------------------------------ exportMetrics
+	// Brief Description
+	//  Writes the metrics to the metrics directory every metrics interval,
+	//  until the server stops. Only run when the topology names one.
+	//
+	// Method:    exportMetrics
+	// FullName:  server::exportMetrics
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void exportMetrics();
+
 	//--------------------------------------------------------- sendSyncPayloads
 	// Brief Description
 	//  The main sync loop between servers. This routinely forwards all known
-	//  client lists for each server to the adjacent servers.
+	//  client lists for each server to the neighbouring servers.
 	//
 	// Method:    sendSyncPayloads
 	// FullName:  server::sendSyncPayloads
@@ -176,36 +664,113 @@ private:
 	//--------------------------------------------------------------------------
 	void sendSyncPayloads();
 
-	//----------------------------------------------------- sendSyncPayloadsLeft
+	//------------------------------------------------- sendSyncPayloadsToServer
 	// Brief Description
-	//  Helper function that forwards the client lists to the left adjacent
-	//  server.
+	//  Helper function that forwards the client lists to a neighbouring
+	//  server. Only the lists the neighbour would learn through this server
+	//  are sent, so that no list is sent back towards where it came from.
 	//
-	// Method:    sendSyncPayloadsLeft
-	// FullName:  server::sendSyncPayloadsLeft
+	// Method:    sendSyncPayloadsToServer
+	// FullName:  server::sendSyncPayloadsToServer
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
 	//--------------------------------------------------------------------------
-	void sendSyncPayloadsLeft();
+	void sendSyncPayloadsToServer(
+		const int16_t& inServerIndex);
 
-	//---------------------------------------------------- sendSyncPayloadsRight
+	//----------------------------------------------------------- sendClientList
 	// Brief Description
-	//  Helper function that forwards the client lists to the right adjacent
-	//  server.
+	//  Sends the list of clients this server knows the origin server has to
+	//  a neighbouring server, by name.
 	//
-	// Method:    sendSyncPayloadsRight
-	// FullName:  server::sendSyncPayloadsRight
+	// Method:    sendClientList
+	// FullName:  server::sendClientList
 	// Access:    private 
 	// Returns:   void
+	// Parameter: const int16_t& inOriginIndex
+	// Parameter: const int16_t& inServerIndex
 	//--------------------------------------------------------------------------
-	void sendSyncPayloadsRight();
+	void sendClientList(
+		const int16_t& inOriginIndex,
+		const int16_t& inServerIndex);
+
+	//------------------------------------------------------------- sendNameList
+	// Brief Description
+	//  Sends a list of clients or channels to a neighbouring server, in as
+	//  many parts as it takes to keep each datagram under the part length.
+	//  Every part carries the version of the list, its own number and the
+	//  number of parts. Returns the payload bytes sent.
+	//
+	// Method:    sendNameList
+	// FullName:  server::sendNameList
+	// Access:    private 
+	// Returns:   size_t
+	// Parameter: const int64_t& inVersion
+	// Parameter: const constants::MessageType& inMessageType
+	// Parameter: const std::vector<namePool::handle>& inList
+	// Parameter: const int16_t& inOriginIndex
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	size_t sendNameList(
+		const int64_t& inVersion,
+		const constants::MessageType& inMessageType,
+		const std::vector<namePool::handle>& inList,
+		const int16_t& inOriginIndex,
+		const int16_t& inServerIndex);
+
+	//---------------------------------------------------- sendMembershipSummary
+	// Brief Description
+	//  Sends the list of clients this server knows the origin server has to
+	//  a neighbouring server, as its length and a Bloom filter of the names,
+	//  whose size does not depend on the number of clients.
+	//
+	// Method:    sendMembershipSummary
+	// FullName:  server::sendMembershipSummary
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const int16_t& inOriginIndex
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	void sendMembershipSummary(
+		const int16_t& inOriginIndex,
+		const int16_t& inServerIndex);
+
+	//----------------------------------------------------------- monitorServers
+	// Brief Description
+	//  The failure detection loop. Every heartbeat interval, pings the
+	//  neighbouring servers and declares any neighbour that has not been
+	//  heard from within the suspicion timeout down. Messages are routed
+	//  around servers that are down where the topology allows it, and held
+	//  until the server is back otherwise.
+	//
+	// Method:    monitorServers
+	// FullName:  server::monitorServers
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void monitorServers();
+
+	//--------------------------------------------------------- receiveHeartbeat
+	// Brief Description
+	//  Records that a neighbouring server is alive, and brings it back into
+	//  the routes if it was down.
+	//
+	// Method:    receiveHeartbeat
+	// FullName:  server::receiveHeartbeat
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inHeartbeatMessage
+	//--------------------------------------------------------------------------
+	void receiveHeartbeat(
+		const dataMessage& inHeartbeatMessage);
 
 	const int64_t& sequenceNumber();
 
 	//---------------------------------------- receiveClientsFromAdjacentServers
 	// Brief Description
 	//  Receives the sync sent from an adjacent server and populates the 
-	//  appropriate list of usernames via the data message.
+	//  appropriate list of usernames, or of channels, via the data message.
 	//
 	// Method:    receiveClientsFromAdjacentServers
 	// FullName:  server::receiveClientsFromAdjacentServers
@@ -216,6 +781,195 @@ private:
 	void receiveClientsFromAdjacentServers(
 		const dataMessage& inSyncMessage);
 
+	//--------------------------------------------------------- assembleNameList
+	// Brief Description
+	//  Adds a part of a synced list to the parts of its version received so
+	//  far. Returns true, with every name of the list, once all of its parts
+	//  have arrived, and false until then. Parts of an older version than
+	//  the one being assembled are ignored, a newer version starts over.
+	//
+	// Method:    assembleNameList
+	// FullName:  server::assembleNameList
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: listAssembly& inAssembly
+	// Parameter: const dataMessage& inSyncMessage
+	// Parameter: std::vector<std::string>& outNames
+	//--------------------------------------------------------------------------
+	bool assembleNameList(
+		listAssembly& inAssembly,
+		const dataMessage& inSyncMessage,
+		std::vector<std::string>& outNames);
+
+	//------------------------------------------------- receiveMembershipSummary
+	// Brief Description
+	//  Receives the summary of a server's client list from a neighbour. The
+	//  names the filter rules out are removed from this server's copy of the
+	//  list. If the copy is then not as long as the list, it missed a client
+	//  and the full list is requested.
+	//
+	// Method:    receiveMembershipSummary
+	// FullName:  server::receiveMembershipSummary
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inSummaryMessage
+	//--------------------------------------------------------------------------
+	void receiveMembershipSummary(
+		const dataMessage& inSummaryMessage);
+
+	//------------------------------------------------------- receiveListRequest
+	// Brief Description
+	//  Sends the neighbour that asked for it the full list of clients of the
+	//  server it names.
+	//
+	// Method:    receiveListRequest
+	// FullName:  server::receiveListRequest
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inRequestMessage
+	//--------------------------------------------------------------------------
+	void receiveListRequest(
+		const dataMessage& inRequestMessage);
+
+	//-------------------------------------------------------- requestClientList
+	// Brief Description
+	//  Asks the neighbour towards the origin server for its full list of
+	//  clients, at most once per sync interval.
+	//
+	// Method:    requestClientList
+	// FullName:  server::requestClientList
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const int16_t& inOriginIndex
+	//--------------------------------------------------------------------------
+	void requestClientList(
+		const int16_t& inOriginIndex);
+
+	//---------------------------------------------------- confirmClientLocation
+	// Brief Description
+	//  Called when a client is in no list. The full list of every server
+	//  whose filter may have the client is requested, which either adds it
+	//  or shows the filter was a false positive.
+	//
+	// Method:    confirmClientLocation
+	// FullName:  server::confirmClientLocation
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	void confirmClientLocation(
+		const std::string& inClientIdentifier);
+
+	//-------------------------------------------------- receiveMembershipUpdate
+	// Brief Description
+	//  Receives clients joining or leaving another server, or channels
+	//  gaining or losing their subscribers there, applies them to that
+	//  server's list and forwards them on immediately, so the changes cross
+	//  the federation without waiting for the periodic sync. An update that
+	//  arrives ahead of the one before it is held until that one arrives or
+	//  a sync overtakes both.
+	//
+	// Method:    receiveMembershipUpdate
+	// FullName:  server::receiveMembershipUpdate
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inUpdateMessage
+	//--------------------------------------------------------------------------
+	void receiveMembershipUpdate(
+		const dataMessage& inUpdateMessage);
+
+	//-------------------------------------------------- publishMembershipChange
+	// Brief Description
+	//  Called when a client connects to or disconnects from this server, or
+	//  a channel gains its first or loses its last subscriber here. Applies
+	//  the change to this server's list, it is sent to the neighbouring
+	//  servers with the other changes of the same tick.
+	//
+	// Method:    publishMembershipChange
+	// FullName:  server::publishMembershipChange
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const constants::MessageType& inUpdateType
+	// Parameter: const std::string& inClientUsername
+	//--------------------------------------------------------------------------
+	void publishMembershipChange(
+		const constants::MessageType& inUpdateType,
+		const std::string& inClientUsername);
+
+	//--------------------------------------------------- flushMembershipChanges
+	// Brief Description
+	//  Sends the membership changes published since the last call as
+	//  updates, as few as fit a datagram, each under a new version of the
+	//  list. Called from flushServerLinks every tick.
+	//
+	// Method:    flushMembershipChanges
+	// FullName:  server::flushMembershipChanges
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushMembershipChanges();
+
+	//--------------------------------------------------- applyMembershipUpdate
+	// Brief Description
+	//  Adds or removes the names of an update in its origin's list and
+	//  moves the list to the update's version.
+	//
+	// Method:    applyMembershipUpdate
+	// FullName:  server::applyMembershipUpdate
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inUpdateMessage
+	//--------------------------------------------------------------------------
+	void applyMembershipUpdate(
+		const dataMessage& inUpdateMessage);
+
+	//---------------------------------------------- applyHeldMembershipUpdates
+	// Brief Description
+	//  Applies the held updates of a server that now follow its list's
+	//  version, and drops those the list already contains. Called whenever
+	//  the version of the list changes.
+	//
+	// Method:    applyHeldMembershipUpdates
+	// FullName:  server::applyHeldMembershipUpdates
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const bool& inIsChannelList
+	// Parameter: const int16_t& inOriginIndex
+	//--------------------------------------------------------------------------
+	void applyHeldMembershipUpdates(
+		const bool& inIsChannelList,
+		const int16_t& inOriginIndex);
+
+	//-------------------------------------------------- forwardMembershipUpdate
+	// Brief Description
+	//  Sends a membership update to the neighbours that learn about the
+	//  origin server's clients through this server, over the reliable links
+	//  the relays use.
+	//
+	// Method:    forwardMembershipUpdate
+	// FullName:  server::forwardMembershipUpdate
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inUpdateMessage
+	//--------------------------------------------------------------------------
+	void forwardMembershipUpdate(
+		const dataMessage& inUpdateMessage);
+
+	//------------------------------------------------ lookupServerIndexOfClient
+	// Brief Description
+	//  Returns the index of the server the client is connected to, as far as
+	//  this server knows, or -1 if the client is unknown. The caller must
+	//  hold the server's mutex.
+	//
+	// Method:    lookupServerIndexOfClient
+	// FullName:  server::lookupServerIndexOfClient
+	// Access:    private 
+	// Returns:   int16_t
+	// Parameter: const std::string& inClientIdentifier
+	//--------------------------------------------------------------------------
+	int16_t lookupServerIndexOfClient(
+		const std::string& inClientIdentifier) const;
+
 	//------------------------------------------------------ addClientConnection
 	// Brief Description
 	//  Used by the server to add a new client connection when it receives a
@@ -234,6 +988,46 @@ private:
 		const std::string& inClientUsername,
 		const boost::asio::ip::udp::endpoint& inClientEndpoint);
 
+	//----------------------------------------------------------- resolveSession
+	// Brief Description
+	//  Sets outSessionIdentifier to the session of the connected client that
+	//  sent the message, or 0 if it was not sent by one. A session this
+	//  server does not know, because it restarted or timed the client out,
+	//  is refused: the client is told so and the message is dropped,
+	//  returning false. The username is put back as the source only of the
+	//  messages handled by username: sends, joins, leaves and disconnects.
+	//
+	// Method:    resolveSession
+	// FullName:  server::resolveSession
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	// Parameter: uint32_t& outSessionIdentifier
+	//--------------------------------------------------------------------------
+	bool resolveSession(
+		dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint,
+		uint32_t& outSessionIdentifier);
+
+	//-------------------------------------------------------- sendClientSession
+	// Brief Description
+	//  Tells a client the session it should send instead of its username, or
+	//  with 0 that it has none and should connect again.
+	//
+	// Method:    sendClientSession
+	// FullName:  server::sendClientSession
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const std::string& inClientIdentifier
+	// Parameter: const uint32_t& inSessionIdentifier
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	//--------------------------------------------------------------------------
+	void sendClientSession(
+		const std::string& inClientIdentifier,
+		const uint32_t& inSessionIdentifier,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+
 	//--------------------------------------------------- removeClientConnection
 	// Brief Description
 	//  Removes the client connection. The client will no longer be associated
@@ -248,56 +1042,375 @@ private:
 	void removeClientConnection(
 		const std::string& inClientUsername);
 
+	//---------------------------------------------------- refreshClientActivity
+	// Brief Description
+	//  Records that the client with the session was heard from. The session
+	//  deadline moves on the wheel only when the old one comes up, so this
+	//  is a lookup and a store.
+	//
+	// Method:    refreshClientActivity
+	// FullName:  server::refreshClientActivity
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const uint32_t& inSessionIdentifier
+	//--------------------------------------------------------------------------
+	void refreshClientActivity(
+		const uint32_t& inSessionIdentifier);
+
+	//-------------------------------------------------------- expireIdleClients
+	// Brief Description
+	//  Updates the cached clock and turns the session wheel. Clients whose
+	//  deadline came up are scheduled again if they were heard from since,
+	//  and otherwise disconnected and their undelivered messages dropped.
+	//
+	// Method:    expireIdleClients
+	// FullName:  server::expireIdleClients
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void expireIdleClients();
+
+	//------------------------------------------------------- updateSubscription
+	// Brief Description
+	//  Subscribes the client that sent a join to the channel it names, or
+	//  unsubscribes the client that sent a leave. The other servers are told
+	//  when the channel gains its first subscriber here or loses its last.
+	//
+	// Method:    updateSubscription
+	// FullName:  server::updateSubscription
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const boost::asio::ip::udp::endpoint& inClientEndpoint
+	//--------------------------------------------------------------------------
+	void updateSubscription(
+		const dataMessage& inMessage,
+		const boost::asio::ip::udp::endpoint& inClientEndpoint);
+
+	//-------------------------------------------------------- channelIsServedBy
+	// Brief Description
+	//  Used to determine if the given server has clients subscribed to the
+	//  channel, as far as this server knows.
+	//
+	// Method:    channelIsServedBy
+	// FullName:  server::channelIsServedBy
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const std::string& inChannel
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	bool channelIsServedBy(
+		const std::string& inChannel,
+		const int16_t& inServerIndex) const;
+
+	//--------------------------------------------------------- nameListContains
+	// Brief Description
+	//  Returns whether the name is in a list of clients or channels.
+	//
+	// Method:    nameListContains
+	// FullName:  server::nameListContains
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: const std::vector<namePool::handle>& inList
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	bool nameListContains(
+		const std::vector<namePool::handle>& inList,
+		const std::string& inName) const;
+
+	//------------------------------------------------------------ addToNameList
+	// Brief Description
+	//  Adds the name to a list of clients or channels, if it is not in it.
+	//
+	// Method:    addToNameList
+	// FullName:  server::addToNameList
+	// Access:    private 
+	// Returns:   void
+	// Parameter: std::vector<namePool::handle>& inList
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	void addToNameList(
+		std::vector<namePool::handle>& inList,
+		const std::string& inName);
+
+	//------------------------------------------------------- removeFromNameList
+	// Brief Description
+	//  Removes the name from a list of clients or channels, if it is in it.
+	//
+	// Method:    removeFromNameList
+	// FullName:  server::removeFromNameList
+	// Access:    private 
+	// Returns:   void
+	// Parameter: std::vector<namePool::handle>& inList
+	// Parameter: const std::string& inName
+	//--------------------------------------------------------------------------
+	void removeFromNameList(
+		std::vector<namePool::handle>& inList,
+		const std::string& inName);
+
+	//---------------------------------------------------------- rewriteNameList
+	// Brief Description
+	//  Makes a list of clients or channels hold the names of a sync payload.
+	//  Only the names that joined or left the list are interned or released.
+	//  Returns whether the list changed.
+	//
+	// Method:    rewriteNameList
+	// FullName:  server::rewriteNameList
+	// Access:    private 
+	// Returns:   bool
+	// Parameter: std::vector<namePool::handle>& inList
+	// Parameter: const std::vector<std::string>& inNames
+	//--------------------------------------------------------------------------
+	bool rewriteNameList(
+		std::vector<namePool::handle>& inList,
+		const std::vector<std::string>& inNames);
+
 	//--------------------------------------------------------- addToMessageList
 	// Brief Description
 	//  Helper function. Adds a data message to the list of messages that
-	//  haven't been delivered to a client.
+	//  haven't been delivered to a client, encoded once for every get,
+	//  unless the client is over its quota.
 	//
 	// Method:    addToMessageList
 	// FullName:  server::addToMessageList
 	// Access:    private 
 	// Returns:   void
-	// Parameter: const dataMessage& message
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const heartbeatClock::time_point& inDeadline
 	//--------------------------------------------------------------------------
 	void addToMessageList(
-		dataMessage message);
+		const dataMessage& inMessage,
+		const heartbeatClock::time_point& inDeadline);
 
 	//------------------------------------ addToMessageListOfUnassociatedClients
 	// Brief Description
 	//  Adds a message to the list that contains all messages for which the
 	//  server was unable to determine what server serves that client. This
 	//  list is periodically checked and the server will attempt to
-	//  find the server associated with a particular client.
+	//  find the server associated with a particular client, waiting longer
+	//  after each attempt that fails.
 	//
 	// Method:    addToMessageListOfUnassociatedClients
 	// FullName:  server::addToMessageListOfUnassociatedClients
 	// Access:    private 
 	// Returns:   void
-	// Parameter: dataMessage message
+	// Parameter: const dataMessage& inMessage
+	// Parameter: const heartbeatClock::time_point& inDeadline
 	//--------------------------------------------------------------------------
 	void addToMessageListOfUnassociatedClients(
-		dataMessage message);
+		const dataMessage& inMessage,
+		const heartbeatClock::time_point& inDeadline);
+
+	//--------------------------------------------------------- retryHeldMessage
+	// Brief Description
+	//  Routes a held message whose retry came up if its destination can now
+	//  be reached, otherwise holds it again for twice as long as the last
+	//  time. Gives up on it past its deadline.
+	//
+	// Method:    retryHeldMessage
+	// FullName:  server::retryHeldMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const heldMessage& inHeldMessage
+	//--------------------------------------------------------------------------
+	void retryHeldMessage(
+		const heldMessage& inHeldMessage);
+
+	//------------------------------------------------------------ expireBacklog
+	// Brief Description
+	//  Gives up on the messages waiting for a client to get them that are
+	//  past their deadline.
+	//
+	// Method:    expireBacklog
+	// FullName:  server::expireBacklog
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void expireBacklog();
+
+	//--------------------------------------------------------------- deadlineOf
+	// Brief Description
+	//  Returns the time until which a message that just arrived is kept,
+	//  from its time to live or the default one.
+	//
+	// Method:    deadlineOf
+	// FullName:  server::deadlineOf
+	// Access:    private 
+	// Returns:   heartbeatClock::time_point
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	heartbeatClock::time_point deadlineOf(
+		const dataMessage& inMessage) const;
+
+	//------------------------------------------------------------- spoolMessage
+	// Brief Description
+	//  Appends an undelivered message to the spool, if there is one, and
+	//  returns its spool identifier, 0 if it was not spooled. The deadline
+	//  is stored as wall clock time, so it still holds after a restart.
+	//
+	// Method:    spoolMessage
+	// FullName:  server::spoolMessage
+	// Access:    private 
+	// Returns:   uint64_t
+	// Parameter: const messageSpool::RecordKind& inKind
+	// Parameter: const std::string& inRecipient
+	// Parameter: const std::vector<char>& inEncodedMessage
+	// Parameter: const heartbeatClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	uint64_t spoolMessage(
+		const messageSpool::RecordKind& inKind,
+		const std::string& inRecipient,
+		const std::vector<char>& inEncodedMessage,
+		const heartbeatClock::time_point& inDeadline);
+
+	//----------------------------------------------------------- unspoolMessage
+	// Brief Description
+	//  Removes a message that was ACKed or given up on from the spool.
+	//
+	// Method:    unspoolMessage
+	// FullName:  server::unspoolMessage
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const uint64_t& inSpoolIdentifier
+	//--------------------------------------------------------------------------
+	void unspoolMessage(
+		const uint64_t& inSpoolIdentifier);
+
+	//--------------------------------------------------- recoverSpooledMessages
+	// Brief Description
+	//  Puts the messages read back from the spool when the server started
+	//  back in the message lists and the held messages. Those past their
+	//  deadline are dropped.
+	//
+	// Method:    recoverSpooledMessages
+	// FullName:  server::recoverSpooledMessages
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void recoverSpooledMessages();
+
+	//------------------------------------------------------------ sampleMetrics
+	// Brief Description
+	//  Sets the gauges of the metrics to the current queue depths, client
+	//  count and link counters, which are only kept under the mutex.
+	//
+	// Method:    sampleMetrics
+	// FullName:  server::sampleMetrics
+	// Access:    private 
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void sampleMetrics();
+
+	//-------------------------------------------------------------- recordTrace
+	// Brief Description
+	//  Writes the trace of a traced message its client ACKed to the trace
+	//  file, with the times it was first sent to the client and ACKed
+	//  stamped last.
+	//
+	// Method:    recordTrace
+	// FullName:  server::recordTrace
+	// Access:    private 
+	// Returns:   void
+	// Parameter: const pendingMessage& inMessage
+	// Parameter: const int64_t& inAcknowledgedMicroseconds
+	//--------------------------------------------------------------------------
+	void recordTrace(
+		const pendingMessage& inMessage,
+		const int64_t& inAcknowledgedMicroseconds);
 
 	// Member Variables
+	const serverTopology m_topology;
+	routingTable m_routingTable;
 	boost::asio::ip::udp::socket m_UDPsocket;
-	boost::asio::ip::udp::resolver m_resolver;
 	boost::asio::io_service* m_ioService;
-	int8_t m_index;
+	int16_t m_index;
 	boost::thread_group m_threads;
+	boost::mutex m_mutex;
 
-	bool m_terminate;
+	// written by stop() from another thread
+	std::atomic<bool> m_terminate;
 	int64_t m_sequenceNumber;
 
-	std::list<dataMessage> m_messageList;
-	std::list<dataMessage> m_messageListOfUnassociatedClients;
+	// messages kept for recipients, the held ones by when they are retried
+	std::map<std::string, std::list<pendingMessage>> m_messageListByClient;
+	std::multimap<heartbeatClock::time_point, heldMessage> m_messageListOfUnassociatedClients;
+	backlogAccounting m_backlog;
+	bool m_retryHeldMessagesNow;
+
+	// null unless the topology names a spool directory
+	boost::scoped_ptr<messageSpool> m_spool;
+
+	// each connection is given a session, numbered from 1 in the low bits
+	// with this server's index in the top byte, so no two servers give out
+	// the same one. Connected clients are kept by session, which every
+	// datagram from a client carries once it has one, and are only looked
+	// up by name to deliver to them.
+	std::unordered_map<uint32_t, remoteConnection> m_connectedClients;
+	std::unordered_map<std::string, uint32_t> m_sessionsByClient;
+	std::unordered_map<uint32_t, std::set<int64_t>> m_sendsReceivedBySession;
+	uint32_t m_nextSessionIdentifier;
+
+	// clients are disconnected once idle for the session timeout. Messages
+	// are timestamped with the clock cached by the forwarding thread, the
+	// expiry thread refreshes it too as it turns the wheel.
+	heartbeatClock::time_point m_cachedNow;
+	sessionWheel m_sessionWheel;
+	uint64_t m_clientsEvicted;
+
+	std::vector<remoteConnection> m_serverConnections;
+	std::vector<reliableLink> m_serverLinks;
+
+	// the names in the lists of clients and channels each server has are
+	// interned once, the lists hold their handles in order
+	namePool m_names;
+	std::vector<std::vector<namePool::handle>> m_clientsServedByServerIndex;
+	std::vector<int64_t> m_membershipVersionByServerIndex;
+
+	// channel to the endpoints of this server's subscribers, and the
+	// channels each server has subscribers for, synced like the client lists
+	std::map<std::string, subscriberEndpoints> m_subscribersByChannel;
+	std::vector<std::vector<namePool::handle>> m_channelsServedByServerIndex;
+	std::vector<int64_t> m_channelVersionByServerIndex;
+
+	// the lists synced in several parts, until all the parts are in
+	std::vector<listAssembly> m_clientListAssemblyByServerIndex;
+	std::vector<listAssembly> m_channelListAssemblyByServerIndex;
+
+	// with membership filters, the last filter received for each server's
+	// client list, and when its full list was last asked for
+	std::vector<bloomFilter> m_membershipFilterByServerIndex;
+	std::vector<heartbeatClock::time_point> m_timeOfListRequestByServerIndex;
+
+	// this server's membership changes since the last forwarding tick, and
+	// the updates from each server that arrived ahead of one still being
+	// retransmitted, by the version they follow
+	std::vector<std::pair<constants::MessageType, std::string>> m_pendingMembershipChanges;
+	std::vector<std::map<int64_t, dataMessage>> m_heldClientUpdatesByServerIndex;
+	std::vector<std::map<int64_t, dataMessage>> m_heldChannelUpdatesByServerIndex;
 
-	std::vector<remoteConnection> m_connectedClients;
+	std::vector<bool> m_serverIsUp;
+	std::vector<heartbeatClock::time_point> m_lastHeardFromServerIndex;
 
-	int8_t m_leftAdjacentServerIndex;
-	remoteConnection* m_leftAdjacentServerConnection;
+	// counters and histograms are updated without the mutex, and are looked
+	// up once. The gauges are sampled before the metrics are read.
+	metricsRegistry m_metrics;
+	std::vector<metricsRegistry::counter*> m_messagesReceivedByType;
+	metricsRegistry::counter* m_receiveErrors;
+	metricsRegistry::counter* m_sendErrors;
+	metricsRegistry::counter* m_unknownSessions;
+	metricsRegistry::counter* m_invalidUsernames;
+	metricsRegistry::counter* m_syncPayloadBytes;
+	metricsRegistry::counter* m_listRequests;
+	metricsRegistry::counter* m_namesRuledOut;
+	metricsRegistry::latencyHistogram* m_handlingLatency;
+	metricsRegistry::latencyHistogram* m_deliveryLatency;
 
-	int8_t m_rightAdjacentServerIndex;
-	remoteConnection* m_rightAdjacentServerConnection;
+	// 1 in N messages from clients is traced, and the traces of the ones
+	// this server delivers are appended to its trace file
+	std::ofstream m_traceFile;
+	uint32_t m_clientSendsSinceTrace;
+	uint64_t m_nextTraceIdentifier;
 
-	std::vector<std::string> m_clientsServedByServerIndex[constants::numberOfServers];
+	// every datagram received, when asked to record them for replay
+	boost::scoped_ptr<datagramCapture> m_capture;
 };
\ No newline at end of file
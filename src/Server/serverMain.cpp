@@ -1,5 +1,6 @@
 // STL
 #include <iostream>
+#include <fstream>
 #include <cstdint>
 
 // Boost
@@ -7,38 +8,45 @@
 
 // Project
 #include "server.h"
+#include "../Common/asyncLog.h"
+#include "../Common/serverTopology.h"
 
-int main()
+int main(int argc, char* argv[])
 {
 	try
 	{
-		char identifier;
-		bool identifierIsValid;
+		// the configuration file can be given as the first argument,
+		// otherwise servers.cfg is used if present
+		const std::string configurationFilePath(
+			(argc > 1) ? argv[1] : "servers.cfg");
 
-		do 
+		const serverTopology topology(
+			(argc > 1 || std::ifstream(configurationFilePath).good())
+			? serverTopology(configurationFilePath)
+			: serverTopology());
+
+		std::string identifier("");
+		int16_t serverIndex = -1;
+
+		do
 		{
-			std::cout << "Which server instance to launch? ('A' - 'E')" << std::endl;
+			std::cout << "Which server instance to launch? ("
+				<< topology.serverNamesAsString() << ")" << std::endl;
 			std::cin >> identifier;
 
-			identifierIsValid = 
-				constants::identifierIsValid(identifier);
+			serverIndex =
+				topology.serverIndexFromIdentifier(identifier);
 
-			if(!identifierIsValid)
+			if(serverIndex == -1)
 			{
 				std::cout << identifier << " is invalid. Please try again." << std::endl;
 			}
-		} while (!identifierIsValid);
-
-		const uint8_t serverIndex(
-			constants::charToServerIndex(identifier));
-
-		const uint16_t listeningPort(
-			constants::serverIndexToListeningPort(serverIndex));
+		} while (serverIndex == -1);
 
 		boost::asio::io_service ioService;
 
 		server serverInstance(
-			listeningPort,
+			topology,
 			serverIndex,
 			ioService);
 
@@ -46,6 +54,9 @@ int main()
 	}
 	catch(std::exception& exception)
 	{
+		// whatever the server logged before failing goes first
+		asyncLog::flush();
+
 		std::cout << exception.what() << std::endl;
 	}
 
@@ -0,0 +1,134 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "sessionWheel.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The wheel starts at tick 0, ticks before it have nothing to expire
+//------------------------------------------------------------------------------
+sessionWheel::sessionWheel(
+	const uint16_t& inSlotCount,
+	const uint16_t& inTickMilliseconds,
+	const wheelClock::time_point& inStart) :
+	m_slots(std::max<uint16_t>(inSlotCount, 1)),
+	m_tickMilliseconds(std::max<uint16_t>(inTickMilliseconds, 1)),
+	m_start(inStart),
+	m_currentTick(0)
+{
+};
+
+//--------------------------------------------------------------------- schedule
+// Implementation notes:
+//  The deadline is rounded up to the end of its tick, so a session never
+//  expires early. A deadline more than a turn of the wheel away shares its
+//  slot with nearer ones, and is skipped until its own tick comes around.
+//------------------------------------------------------------------------------
+void sessionWheel::schedule(
+	const uint32_t& inSessionIdentifier,
+	const wheelClock::time_point& inDeadline)
+{
+	this->cancel(
+		inSessionIdentifier);
+
+	const int64_t tick = std::max(
+		this->tickAt(inDeadline) + 1,
+		this->m_currentTick + 1);
+
+	wheelSlot& slot = this->m_slots[tick % this->m_slots.size()];
+
+	this->m_sessions[inSessionIdentifier] = slot.insert(
+		slot.end(),
+		scheduledSession(inSessionIdentifier, tick));
+};
+
+//----------------------------------------------------------------------- cancel
+// Implementation notes:
+//  The session's tick gives its slot, the iterator its place in the slot
+//------------------------------------------------------------------------------
+void sessionWheel::cancel(
+	const uint32_t& inSessionIdentifier)
+{
+	std::unordered_map<uint32_t, wheelSlot::iterator>::iterator session =
+		this->m_sessions.find(inSessionIdentifier);
+
+	if(session == this->m_sessions.end())
+	{
+		return;
+	}
+
+	this->m_slots[session->second->m_tick % this->m_slots.size()].erase(
+		session->second);
+
+	this->m_sessions.erase(session);
+};
+
+//---------------------------------------------------------------------- advance
+// Implementation notes:
+//  Only the slots of the ticks that passed are visited, and at most one
+//  turn of them, since a longer gap visits every slot anyway
+//------------------------------------------------------------------------------
+std::vector<uint32_t> sessionWheel::advance(
+	const wheelClock::time_point& inNow)
+{
+	std::vector<uint32_t> outExpired;
+
+	const int64_t nowTick = this->tickAt(inNow);
+
+	const int64_t lastTickToVisit = std::min(
+		nowTick,
+		this->m_currentTick + static_cast<int64_t>(this->m_slots.size()));
+
+	for(int64_t tick = this->m_currentTick + 1; tick <= lastTickToVisit; tick++)
+	{
+		wheelSlot& slot = this->m_slots[tick % this->m_slots.size()];
+
+		wheelSlot::iterator it = slot.begin();
+
+		while(it != slot.end())
+		{
+			if(it->m_tick <= nowTick)
+			{
+				outExpired.push_back(it->m_sessionIdentifier);
+				this->m_sessions.erase(it->m_sessionIdentifier);
+				it = slot.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+
+	this->m_currentTick = std::max(
+		this->m_currentTick,
+		nowTick);
+
+	return outExpired;
+};
+
+//---------------------------------------------------------------- viewScheduled
+// Implementation notes:
+//  Returns the number of sessions on the wheel
+//------------------------------------------------------------------------------
+size_t sessionWheel::viewScheduled() const
+{
+	return this->m_sessions.size();
+};
+
+//----------------------------------------------------------------------- tickAt
+// Implementation notes:
+//  Times before the start fall in tick 0
+//------------------------------------------------------------------------------
+int64_t sessionWheel::tickAt(
+	const wheelClock::time_point& inTime) const
+{
+	if(inTime <= this->m_start)
+	{
+		return 0;
+	}
+
+	return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+		inTime - this->m_start).count() / this->m_tickMilliseconds;
+};
\ No newline at end of file
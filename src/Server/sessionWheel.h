@@ -0,0 +1,131 @@
+#pragma once
+
+// STL
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/chrono.hpp>
+
+class sessionWheel
+{
+public:
+
+	typedef boost::chrono::steady_clock wheelClock;
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a hashed timer wheel of session deadlines. Time is
+	//  cut into ticks, and each tick is hashed to one of the slots, so
+	//  scheduling, cancelling and expiring a session takes constant time
+	//  however many sessions there are.
+	//
+	// Method:    sessionWheel
+	// FullName:  sessionWheel::sessionWheel
+	// Access:    public
+	// Returns:
+	// Parameter: const uint16_t& inSlotCount
+	// Parameter: const uint16_t& inTickMilliseconds
+	// Parameter: const wheelClock::time_point& inStart
+	//--------------------------------------------------------------------------
+	sessionWheel(
+		const uint16_t& inSlotCount,
+		const uint16_t& inTickMilliseconds,
+		const wheelClock::time_point& inStart);
+
+	//----------------------------------------------------------------- schedule
+	// Brief Description
+	//  Schedules the session to expire at the deadline, replacing its
+	//  previous deadline if it had one. A deadline that already passed
+	//  expires at the next tick.
+	//
+	// Method:    schedule
+	// FullName:  sessionWheel::schedule
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint32_t& inSessionIdentifier
+	// Parameter: const wheelClock::time_point& inDeadline
+	//--------------------------------------------------------------------------
+	void schedule(
+		const uint32_t& inSessionIdentifier,
+		const wheelClock::time_point& inDeadline);
+
+	//------------------------------------------------------------------- cancel
+	// Brief Description
+	//  Removes the session from the wheel, if it is on it.
+	//
+	// Method:    cancel
+	// FullName:  sessionWheel::cancel
+	// Access:    public
+	// Returns:   void
+	// Parameter: const uint32_t& inSessionIdentifier
+	//--------------------------------------------------------------------------
+	void cancel(
+		const uint32_t& inSessionIdentifier);
+
+	//------------------------------------------------------------------ advance
+	// Brief Description
+	//  Turns the wheel up to the given time, and removes and returns the
+	//  sessions whose deadlines passed, in the order they expired.
+	//
+	// Method:    advance
+	// FullName:  sessionWheel::advance
+	// Access:    public
+	// Returns:   std::vector<uint32_t>
+	// Parameter: const wheelClock::time_point& inNow
+	//--------------------------------------------------------------------------
+	std::vector<uint32_t> advance(
+		const wheelClock::time_point& inNow);
+
+	//------------------------------------------------------------ viewScheduled
+	// Brief Description
+	//  Returns the number of sessions on the wheel.
+	//
+	// Method:    viewScheduled
+	// FullName:  sessionWheel::viewScheduled
+	// Access:    public
+	// Returns:   size_t
+	//--------------------------------------------------------------------------
+	size_t viewScheduled() const;
+
+private:
+
+	class scheduledSession
+	{
+	public:
+		scheduledSession(
+			const uint32_t& inSessionIdentifier,
+			const int64_t& inTick) :
+			m_sessionIdentifier(inSessionIdentifier),
+			m_tick(inTick)
+		{
+		};
+
+		uint32_t m_sessionIdentifier;
+		int64_t m_tick;
+	};
+
+	typedef std::list<scheduledSession> wheelSlot;
+
+	//------------------------------------------------------------------- tickAt
+	// Brief Description
+	//  Returns the tick the given time falls in, counted from the start.
+	//
+	// Method:    tickAt
+	// FullName:  sessionWheel::tickAt
+	// Access:    private
+	// Returns:   int64_t
+	// Parameter: const wheelClock::time_point& inTime
+	//--------------------------------------------------------------------------
+	int64_t tickAt(
+		const wheelClock::time_point& inTime) const;
+
+	// Member Variables
+	std::vector<wheelSlot> m_slots;
+	std::unordered_map<uint32_t, wheelSlot::iterator> m_sessions;
+	uint16_t m_tickMilliseconds;
+	wheelClock::time_point m_start;
+	int64_t m_currentTick;
+};
\ No newline at end of file
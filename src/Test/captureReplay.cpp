@@ -0,0 +1,194 @@
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "captureReplay.h"
+
+namespace
+{
+	typedef boost::chrono::steady_clock replayClock;
+
+	const uint16_t pollIntervalMilliseconds = 1;
+	const uint16_t handlingTimeoutMilliseconds = 3000;
+
+	// as fast as possible is as fast as the server keeps up with, at most
+	// this many datagrams are sent ahead of it so its socket does not drop
+	// them
+	const uint64_t replayWindow = 256;
+
+	//------------------------------------------------------ elapsedMilliseconds
+	// Implementation notes:
+	//  Milliseconds since inStart, as a double for sub-millisecond results
+	//--------------------------------------------------------------------------
+	double elapsedMilliseconds(
+		const replayClock::time_point& inStart)
+	{
+		return boost::chrono::duration<double, boost::milli>(
+			replayClock::now() - inStart).count();
+	};
+
+	//-------------------------------------------------------- datagramsOfServer
+	// Implementation notes:
+	//  The sum of the server's received counters, one per message type
+	//--------------------------------------------------------------------------
+	uint64_t datagramsOfServer(
+		server& inServer)
+	{
+		std::istringstream counters(
+			inServer.metricsAsString("received."));
+
+		uint64_t outDatagrams = 0;
+		std::string name("");
+		uint64_t count = 0;
+
+		while(counters >> name >> count)
+		{
+			outDatagrams += count;
+		}
+
+		return outDatagrams;
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The whole capture is read here, before anything is timed
+//------------------------------------------------------------------------------
+captureReplay::captureReplay(
+	const std::string& inCapturePath) :
+	m_recording(datagramCapture::read(inCapturePath))
+{
+};
+
+//--------------------------------------------------------------- viewServerName
+// Implementation notes:
+//  Returns a const reference to the server name
+//------------------------------------------------------------------------------
+const std::string& captureReplay::viewServerName() const
+{
+	return this->m_recording.m_serverName;
+};
+
+//----------------------------------------------------------------------- replay
+// Implementation notes:
+//  The servers' own heartbeats and syncs are counted as received too, so
+//  the wait may end a little before the last replayed datagram is handled,
+//  and the window may let a few more datagrams ahead.
+//  Replies from the server are left unread, the socket drops them once its
+//  buffer is full.
+//------------------------------------------------------------------------------
+bool captureReplay::replay(
+	clusterHarness& cluster,
+	const double& inSpeed,
+	std::ostream& report) const
+{
+	const int16_t serverIndex = cluster.viewTopology().serverIndexFromIdentifier(
+		this->m_recording.m_serverName);
+
+	const std::vector<datagramCapture::capturedDatagram>& datagrams =
+		this->m_recording.m_datagrams;
+
+	report << "Replay (" << datagrams.size() << " datagrams captured on "
+		<< this->m_recording.m_serverName << ", ";
+
+	if(inSpeed > 0)
+	{
+		report << inSpeed << "x speed)" << std::endl;
+	}
+	else
+	{
+		report << "as fast as possible)" << std::endl;
+	}
+
+	if(serverIndex == -1)
+	{
+		report << "  the cluster has no server " << this->m_recording.m_serverName
+			<< std::endl;
+		return false;
+	}
+
+	if(datagrams.empty())
+	{
+		return true;
+	}
+
+	server& target = cluster.serverAt(serverIndex);
+	const boost::asio::ip::udp::endpoint targetEndpoint(
+		cluster.viewTopology().viewServerEndpoint(serverIndex));
+
+	boost::asio::ip::udp::socket socket(
+		cluster.ioService(),
+		boost::asio::ip::udp::endpoint(targetEndpoint.protocol(), 0));
+
+	const uint64_t firstDatagram = datagramsOfServer(target);
+	const replayClock::time_point start = replayClock::now();
+	uint64_t sent = 0;
+
+	for(const datagramCapture::capturedDatagram& datagram : datagrams)
+	{
+		if(inSpeed > 0)
+		{
+			boost::this_thread::sleep_until(
+				start + boost::chrono::microseconds(
+					static_cast<int64_t>(datagram.m_microseconds / inSpeed)));
+		}
+
+		else
+		{
+			const replayClock::time_point waitStart = replayClock::now();
+
+			while(sent >= datagramsOfServer(target) - firstDatagram + replayWindow
+				&& elapsedMilliseconds(waitStart) < handlingTimeoutMilliseconds)
+			{
+				boost::this_thread::yield();
+			}
+		}
+
+		boost::system::error_code ignoredError;
+
+		socket.send_to(
+			boost::asio::buffer(datagram.m_payload),
+			targetEndpoint, 0, ignoredError);
+
+		sent++;
+	}
+
+	const double sendMilliseconds = elapsedMilliseconds(start);
+
+	while(datagramsOfServer(target) < firstDatagram + datagrams.size()
+		&& elapsedMilliseconds(start) < sendMilliseconds + handlingTimeoutMilliseconds)
+	{
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			pollIntervalMilliseconds));
+	}
+
+	const double handledMilliseconds = elapsedMilliseconds(start);
+	const uint64_t handled = datagramsOfServer(target) - firstDatagram;
+
+	report << std::fixed << std::setprecision(1)
+		<< "  sent in " << sendMilliseconds << " ms ("
+		<< datagrams.size() / (std::max(sendMilliseconds, 0.001) / 1000.0) << " datagrams/s), "
+		<< std::min<uint64_t>(handled, datagrams.size()) << "/" << datagrams.size()
+		<< " received in " << handledMilliseconds << " ms ("
+		<< std::min<uint64_t>(handled, datagrams.size()) / (handledMilliseconds / 1000.0)
+		<< " datagrams/s)" << std::endl;
+
+	// the cost of each datagram, in microseconds
+	std::istringstream latencies(
+		target.metricsAsString("latency.handling"));
+
+	for(std::string line; std::getline(latencies, line); )
+	{
+		report << "  " << this->m_recording.m_serverName << " " << line << std::endl;
+	}
+
+	return handled >= datagrams.size();
+};
\ No newline at end of file
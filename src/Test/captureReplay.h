@@ -0,0 +1,68 @@
+#pragma once
+
+// STL
+#include <ostream>
+#include <string>
+
+// Project
+#include "clusterHarness.h"
+#include "../Common/datagramCapture.h"
+
+class captureReplay
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor that reads a capture file. Throws a std::runtime_error
+	//  if it is not one.
+	//
+	// Method:    captureReplay
+	// FullName:  captureReplay::captureReplay
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inCapturePath
+	//--------------------------------------------------------------------------
+	captureReplay(
+		const std::string& inCapturePath);
+
+	//----------------------------------------------------------- viewServerName
+	// Brief Description
+	//  Returns the name of the server the capture was taken on.
+	//
+	// Method:    viewServerName
+	// FullName:  captureReplay::viewServerName
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewServerName() const;
+
+	//------------------------------------------------------------------- replay
+	// Brief Description
+	//  Sends every datagram of the capture, in order, to the server of the
+	//  running cluster with the same name, at the given multiple of the
+	//  speed they were captured at, or as fast as the server keeps up for
+	//  0. Waits for the server to have received them, then reports the
+	//  send and handling rates and the server's handling latency
+	//  histogram. The datagrams are all sent from one socket, whatever
+	//  their source. Returns false if the cluster has no such server or
+	//  it did not receive every datagram in time.
+	//
+	// Method:    replay
+	// FullName:  captureReplay::replay
+	// Access:    public
+	// Returns:   bool
+	// Parameter: clusterHarness& cluster
+	// Parameter: const double& inSpeed
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool replay(
+		clusterHarness& cluster,
+		const double& inSpeed,
+		std::ostream& report) const;
+
+private:
+
+	// Member Variables
+	datagramCapture::recording m_recording;
+};
\ No newline at end of file
@@ -0,0 +1,2560 @@
+// STL
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Boost
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "captureReplay.h"
+#include "clusterBenchmarks.h"
+#include "clusterHarness.h"
+#include "protocolSimulator.h"
+#include "scriptedClient.h"
+#include "traceReport.h"
+#include "../Common/remoteConnection.h"
+#include "../Common/serverTopology.h"
+
+namespace
+{
+	typedef boost::chrono::steady_clock benchmarkClock;
+
+	const uint16_t pollIntervalMilliseconds = 1;
+	const uint16_t convergenceTimeoutMilliseconds = 30000;
+	const uint16_t deliveryTimeoutMilliseconds = 10000;
+	const uint16_t idleTimeoutMilliseconds = 3000;
+	const uint16_t connectBatchSize = 100;
+	const uint16_t connectRetryMilliseconds = 250;
+	const uint16_t fanOutGetIntervalMilliseconds = 100;
+	const uint16_t fanOutRelaysPerRetransmission = 2;
+	const uint16_t fanOutRelaysPerDuplicate = 4;
+	const uint16_t sessionTimeoutMilliseconds = 1000;
+	const uint16_t sessionGetIntervalMilliseconds = 250;
+	const uint16_t sessionPollIntervalMilliseconds = 10;
+	const uint16_t sessionExpirySyncIntervals = 2;
+	const uint16_t backlogTimeToLiveMilliseconds = 2000;
+	const uint16_t membershipSyncIntervals = 4;
+	const uint32_t simulatedMembershipClients = 500;
+	const uint32_t simulatedMembershipSeconds = 60;
+
+	//------------------------------------------------------ elapsedMilliseconds
+	// Implementation notes:
+	//  Milliseconds since inStart, as a double for sub-millisecond results
+	//--------------------------------------------------------------------------
+	double elapsedMilliseconds(
+		const benchmarkClock::time_point& inStart)
+	{
+		return boost::chrono::duration<double, boost::milli>(
+			benchmarkClock::now() - inStart).count();
+	};
+
+	//------------------------------------------------------------- pollInterval
+	// Implementation notes:
+	//  Sleep between polls, short enough not to dominate the measurements
+	//--------------------------------------------------------------------------
+	void pollInterval()
+	{
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			pollIntervalMilliseconds));
+	};
+
+	//----------------------------------------------------------- waitUntilKnown
+	// Implementation notes:
+	//  Polls the observing server until it maps the client to inServerIndex
+	//--------------------------------------------------------------------------
+	bool waitUntilKnown(
+		clusterHarness& cluster,
+		const int16_t& inObserverIndex,
+		const std::string& inClientIdentifier,
+		const int16_t& inServerIndex)
+	{
+		const benchmarkClock::time_point start = benchmarkClock::now();
+
+		while(elapsedMilliseconds(start) < convergenceTimeoutMilliseconds)
+		{
+			if(cluster.serverAt(inObserverIndex).serverIndexOfClient(
+				inClientIdentifier) == inServerIndex)
+			{
+				return true;
+			}
+
+			pollInterval();
+		}
+
+		return false;
+	};
+
+	//----------------------------------------------------------- checkInvariant
+	// Implementation notes:
+	//  Reports an invariant of a benchmark that does not hold, and returns
+	//  whether it holds
+	//--------------------------------------------------------------------------
+	bool checkInvariant(
+		const bool& inHolds,
+		const std::string& inInvariant,
+		std::ostream& report)
+	{
+		if(!inHolds)
+		{
+			report << "  FAILED: " << inInvariant << std::endl;
+		}
+
+		return inHolds;
+	};
+
+	//-------------------------------------------------------- reportConvergence
+	// Implementation notes:
+	//  Polls every server until it maps the client to inServerIndex, and
+	//  reports the time since inStart at which each one did. Returns whether
+	//  every server did within the convergence timeout.
+	//--------------------------------------------------------------------------
+	bool reportConvergence(
+		clusterHarness& cluster,
+		const benchmarkClock::time_point& inStart,
+		const std::string& inClientIdentifier,
+		const int16_t& inServerIndex,
+		std::ostream& report)
+	{
+		std::vector<bool> converged(cluster.viewTopology().numberOfServers(), false);
+		int16_t remaining = cluster.viewTopology().numberOfServers();
+
+		while(remaining > 0
+			&& elapsedMilliseconds(inStart) < convergenceTimeoutMilliseconds)
+		{
+			for(int16_t serverIndex = 0;
+				serverIndex < cluster.viewTopology().numberOfServers();
+				serverIndex++)
+			{
+				if(!converged[serverIndex]
+					&& cluster.serverAt(serverIndex).serverIndexOfClient(
+						inClientIdentifier) == inServerIndex)
+				{
+					converged[serverIndex] = true;
+					remaining--;
+
+					report << "  " << std::setw(8) << std::left
+						<< cluster.viewTopology().viewServerName(serverIndex)
+						<< std::fixed << std::setprecision(1)
+						<< elapsedMilliseconds(inStart) << " ms" << std::endl;
+				}
+			}
+
+			pollInterval();
+		}
+
+		return checkInvariant(
+			remaining == 0,
+			std::to_string(remaining) + " server(s) did not converge within "
+				+ std::to_string(convergenceTimeoutMilliseconds) + " ms",
+			report);
+	};
+
+	//----------------------------------------------------------- waitForPayload
+	// Implementation notes:
+	//  Polls for messages until one with the payload arrives or the timeout
+	//  since inStart passes
+	//--------------------------------------------------------------------------
+	bool waitForPayload(
+		scriptedClient& receiver,
+		const std::string& inPayload,
+		const benchmarkClock::time_point& inStart,
+		const double& inTimeoutMilliseconds)
+	{
+		while(elapsedMilliseconds(inStart) < inTimeoutMilliseconds)
+		{
+			receiver.requestMessages();
+			pollInterval();
+
+			for(const dataMessage& message : receiver.receiveMessages())
+			{
+				if(message.viewPayload() == inPayload)
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	};
+
+	//-------------------------------------------------------- reportServerState
+	// Implementation notes:
+	//  Polls the neighbours of the server until each sees it in the expected
+	//  state, and reports the time since inStart at which each one did.
+	//  Returns whether every neighbour did within the convergence timeout.
+	//--------------------------------------------------------------------------
+	bool reportServerState(
+		clusterHarness& cluster,
+		const benchmarkClock::time_point& inStart,
+		const int16_t& inServerIndex,
+		const bool& inExpectedUp,
+		std::ostream& report)
+	{
+		bool outAllSeen = true;
+
+		for(const int16_t& neighbour :
+			cluster.viewTopology().viewNeighbours(inServerIndex))
+		{
+			while(cluster.serverAt(neighbour).serverIsUp(inServerIndex) != inExpectedUp
+				&& elapsedMilliseconds(inStart) < convergenceTimeoutMilliseconds)
+			{
+				pollInterval();
+			}
+
+			report << "  seen by " << std::setw(8) << std::left
+				<< cluster.viewTopology().viewServerName(neighbour)
+				<< std::fixed << std::setprecision(1)
+				<< elapsedMilliseconds(inStart) << " ms" << std::endl;
+
+			outAllSeen = checkInvariant(
+				cluster.serverAt(neighbour).serverIsUp(inServerIndex) == inExpectedUp,
+				cluster.viewTopology().viewServerName(neighbour) + " never saw "
+					+ cluster.viewTopology().viewServerName(inServerIndex)
+					+ (inExpectedUp ? " come back" : " go down"),
+				report) && outAllSeen;
+		}
+
+		return outAllSeen;
+	};
+
+	//--------------------------------------------------------- connectInBatches
+	// Implementation notes:
+	//  Connects are not acknowledged, so a batch at a time is sent and each
+	//  client that the server does not know yet is connected again
+	//--------------------------------------------------------------------------
+	bool connectInBatches(
+		clusterHarness& cluster,
+		const int16_t& inServerIndex,
+		std::vector<boost::shared_ptr<scriptedClient>>& clients)
+	{
+		for(size_t batchStart = 0;
+			batchStart < clients.size();
+			batchStart += connectBatchSize)
+		{
+			const size_t batchEnd =
+				std::min(clients.size(), batchStart + connectBatchSize);
+
+			std::vector<bool> known(batchEnd - batchStart, false);
+			size_t remaining = known.size();
+
+			const benchmarkClock::time_point start = benchmarkClock::now();
+
+			while(remaining > 0)
+			{
+				if(elapsedMilliseconds(start) > convergenceTimeoutMilliseconds)
+				{
+					return false;
+				}
+
+				for(size_t i = batchStart; i < batchEnd; i++)
+				{
+					if(!known[i - batchStart])
+					{
+						clients[i]->connect();
+					}
+				}
+
+				const benchmarkClock::time_point attempt = benchmarkClock::now();
+
+				while(remaining > 0
+					&& elapsedMilliseconds(attempt) < connectRetryMilliseconds)
+				{
+					pollInterval();
+
+					for(size_t i = batchStart; i < batchEnd; i++)
+					{
+						if(!known[i - batchStart]
+							&& cluster.serverAt(inServerIndex).serverIndexOfClient(
+								clients[i]->viewUsername()) == inServerIndex)
+						{
+							known[i - batchStart] = true;
+							remaining--;
+						}
+					}
+				}
+			}
+		}
+
+		return true;
+	};
+
+	// the reliable link counters of every server, summed
+	struct relayStatistics
+	{
+		uint64_t relaysSent = 0;
+		uint64_t retransmissions = 0;
+		uint64_t duplicatesReceived = 0;
+		size_t unacknowledged = 0;
+	};
+
+	//---------------------------------------------------- reportRelayStatistics
+	// Implementation notes:
+	//  Sums the reliable link counters of every server, and returns the sums
+	//  for the benchmarks that check them
+	//--------------------------------------------------------------------------
+	relayStatistics reportRelayStatistics(
+		clusterHarness& cluster,
+		std::ostream& report)
+	{
+		relayStatistics statistics;
+
+		for(int16_t serverIndex = 0;
+			serverIndex < cluster.viewTopology().numberOfServers();
+			serverIndex++)
+		{
+			for(int16_t peerIndex = 0;
+				peerIndex < cluster.viewTopology().numberOfServers();
+				peerIndex++)
+			{
+				const reliableLink link(
+					cluster.serverAt(serverIndex).serverLinkAt(peerIndex));
+
+				statistics.relaysSent += link.viewRelaysSent();
+				statistics.retransmissions += link.viewRetransmissions();
+				statistics.duplicatesReceived += link.viewDuplicatesReceived();
+				statistics.unacknowledged += link.viewInFlight() + link.viewQueued();
+			}
+		}
+
+		report << "  relays " << statistics.relaysSent
+			<< ", retransmitted " << statistics.retransmissions
+			<< ", duplicate relays " << statistics.duplicatesReceived
+			<< ", unacknowledged " << statistics.unacknowledged << std::endl;
+
+		return statistics;
+	};
+
+	//---------------------------------------------------------- reportLatencies
+	// Implementation notes:
+	//  Prints mean, median and max of the samples, sorting them in place
+	//--------------------------------------------------------------------------
+	void reportLatencies(
+		std::vector<double>& samples,
+		std::ostream& report)
+	{
+		if(samples.empty())
+		{
+			report << "no samples";
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+
+		double sum = 0;
+
+		for(const double& sample : samples)
+		{
+			sum += sample;
+		}
+
+		report << "mean " << sum / samples.size() << " ms, "
+			<< "p50 " << samples[samples.size() / 2] << " ms, "
+			<< "max " << samples.back() << " ms";
+	};
+
+	//-------------------------------------------------------------- fillBacklog
+	// Implementation notes:
+	//  Sends each sink its messages in one run, so they fit in its delivery
+	//  window, and returns how long it took until the server holds them all,
+	//  or -1 if it never did
+	//--------------------------------------------------------------------------
+	double fillBacklog(
+		clusterHarness& cluster,
+		const int16_t& inServerIndex,
+		scriptedClient& sender,
+		const std::vector<boost::shared_ptr<scriptedClient>>& sinks,
+		const uint32_t& inMessagesPerSink)
+	{
+		const benchmarkClock::time_point start = benchmarkClock::now();
+
+		for(const boost::shared_ptr<scriptedClient>& sink : sinks)
+		{
+			for(uint32_t i = 0; i < inMessagesPerSink; i++)
+			{
+				sender.send(sink->viewUsername(), "spool" + std::to_string(i));
+			}
+		}
+
+		while(elapsedMilliseconds(start) < deliveryTimeoutMilliseconds)
+		{
+			// the sender's window only opens as the server ACKs its messages
+			sender.receiveMessages();
+
+			if(cluster.serverAt(inServerIndex).backlogStatistics().viewMessages()
+				>= sinks.size() * inMessagesPerSink)
+			{
+				return elapsedMilliseconds(start);
+			}
+
+			pollInterval();
+		}
+
+		return -1;
+	};
+}
+
+//-------------------------------------------------------------- syncConvergence
+// Implementation notes:
+//  The time each server learns of the client is recorded separately, since
+//  on the chain the farthest server is expected to be the slowest. The same
+//  is then done for the client disconnecting.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::syncConvergence(
+	const serverTopology& inTopology,
+	std::ostream& report)
+{
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+
+	scriptedClient probe(
+		"probe",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	report << "Sync convergence (client connected to "
+		<< cluster.viewTopology().viewServerName(originIndex) << ")" << std::endl;
+
+	benchmarkClock::time_point start = benchmarkClock::now();
+
+	probe.connect();
+
+	bool passed = reportConvergence(
+		cluster, start, "probe", originIndex, report);
+
+	report << "Sync convergence (client disconnected from "
+		<< cluster.viewTopology().viewServerName(originIndex) << ")" << std::endl;
+
+	start = benchmarkClock::now();
+
+	probe.disconnect();
+
+	passed = reportConvergence(
+		cluster, start, "probe", -1, report) && passed;
+
+	cluster.stop();
+
+	return passed;
+};
+
+//----------------------------------------------------------------- relayLatency
+// Implementation notes:
+//  Each message is sent only after the previous one was delivered, and the
+//  receiver polls continuously, so the time measured is routing and relay
+//  time rather than the interactive client's get interval.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::relayLatency(
+	const serverTopology& inTopology,
+	const uint32_t& inMessagesPerDestination,
+	std::ostream& report)
+{
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+
+	scriptedClient sender(
+		"sender",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	sender.connect();
+
+	report << "Relay latency (" << inMessagesPerDestination
+		<< " messages per destination, "
+		<< inTopology.routingModeAsString() << " routing)" << std::endl;
+
+	bool passed = true;
+
+	for(int16_t serverIndex = 1;
+		serverIndex < cluster.viewTopology().numberOfServers();
+		serverIndex++)
+	{
+		const std::string serverName(
+			cluster.viewTopology().viewServerName(serverIndex));
+
+		scriptedClient receiver(
+			"receiver" + serverName,
+			cluster.viewTopology(),
+			serverIndex,
+			cluster.ioService());
+
+		receiver.connect();
+
+		if(!waitUntilKnown(cluster, originIndex, receiver.viewUsername(), serverIndex))
+		{
+			report << "  " << serverName << ": receiver never became known" << std::endl;
+			passed = false;
+			continue;
+		}
+
+		std::vector<double> latencies;
+		uint32_t lost = 0;
+		uint16_t hops = 0;
+
+		for(uint32_t i = 0; i < inMessagesPerDestination; i++)
+		{
+			const std::string payload("latency" + std::to_string(i));
+
+			const benchmarkClock::time_point start = benchmarkClock::now();
+
+			sender.send(receiver.viewUsername(), payload);
+
+			bool delivered = false;
+
+			while(!delivered
+				&& elapsedMilliseconds(start) < deliveryTimeoutMilliseconds)
+			{
+				receiver.requestMessages();
+				pollInterval();
+
+				// takes the server's ACK out of the sender's outbox
+				sender.receiveMessages();
+
+				for(const dataMessage& message : receiver.receiveMessages())
+				{
+					if(message.viewPayload() == payload)
+					{
+						delivered = true;
+						hops = message.viewHopCount();
+					}
+				}
+			}
+
+			if(delivered)
+			{
+				latencies.push_back(elapsedMilliseconds(start));
+			}
+			else
+			{
+				lost++;
+			}
+		}
+
+		report << "  " << std::setw(8) << std::left << serverName
+			<< hops << " hop(s): " << std::fixed << std::setprecision(2);
+
+		reportLatencies(latencies, report);
+
+		if(!latencies.empty() && hops > 0)
+		{
+			double sum = 0;
+
+			for(const double& latency : latencies)
+			{
+				sum += latency;
+			}
+
+			report << ", per hop " << (sum / latencies.size()) / hops << " ms";
+		}
+
+		report << ", lost " << lost << std::endl;
+
+		passed = checkInvariant(
+			lost == 0,
+			std::to_string(lost) + " message(s) to " + serverName + " not delivered",
+			report) && passed;
+
+		receiver.disconnect();
+	}
+
+	cluster.stop();
+
+	return passed;
+};
+
+//----------------------------------------------------------- deliveryThroughput
+// Implementation notes:
+//  The whole burst is queued in the sender's outbox before the receiver
+//  starts polling, the outbox then paces it. The receiver's delivery buffer
+//  should leave no duplicates and nothing out of order for it to count.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::deliveryThroughput(
+	const serverTopology& inTopology,
+	const uint32_t& inMessageCount,
+	std::ostream& report)
+{
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = cluster.viewTopology().highestServerIndex();
+
+	scriptedClient sender(
+		"sender",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	scriptedClient receiver(
+		"receiver",
+		cluster.viewTopology(),
+		destinationIndex,
+		cluster.ioService());
+
+	sender.connect();
+	receiver.connect();
+
+	report << "Delivery throughput (" << inMessageCount << " messages, "
+		<< cluster.viewTopology().viewServerName(originIndex) << " to "
+		<< cluster.viewTopology().viewServerName(destinationIndex) << ")" << std::endl;
+
+	if(!waitUntilKnown(cluster, originIndex, receiver.viewUsername(), destinationIndex))
+	{
+		report << "  receiver never became known" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	const benchmarkClock::time_point start = benchmarkClock::now();
+
+	for(uint32_t i = 0; i < inMessageCount; i++)
+	{
+		sender.send(receiver.viewUsername(), "throughput" + std::to_string(i));
+	}
+
+	const double sendMilliseconds = elapsedMilliseconds(start);
+
+	std::set<std::string> delivered;
+	uint32_t duplicates = 0;
+	uint32_t outOfOrder = 0;
+	uint32_t highestIndex = 0;
+	benchmarkClock::time_point lastDelivery = benchmarkClock::now();
+	double lastDeliveryMilliseconds = 0;
+
+	while(delivered.size() < inMessageCount
+		&& elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds)
+	{
+		receiver.requestMessages();
+		pollInterval();
+
+		// the sender's window only opens as the server ACKs its messages
+		sender.receiveMessages();
+
+		for(const dataMessage& message : receiver.receiveMessages())
+		{
+			if(delivered.insert(message.viewPayload()).second)
+			{
+				lastDelivery = benchmarkClock::now();
+				lastDeliveryMilliseconds = elapsedMilliseconds(start);
+
+				const uint32_t index = static_cast<uint32_t>(
+					std::stoul(message.viewPayload().substr(std::string("throughput").size())));
+
+				if(index < highestIndex)
+				{
+					outOfOrder++;
+				}
+
+				highestIndex = std::max(highestIndex, index);
+			}
+			else
+			{
+				duplicates++;
+			}
+		}
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  queued in " << sendMilliseconds << " ms, delivered "
+		<< delivered.size() << "/" << inMessageCount << " in "
+		<< lastDeliveryMilliseconds << " ms";
+
+	if(lastDeliveryMilliseconds > 0)
+	{
+		report << " (" << delivered.size() / (lastDeliveryMilliseconds / 1000.0)
+			<< " msg/s)";
+	}
+
+	report << ", duplicates " << duplicates
+		<< ", out of order " << outOfOrder << std::endl;
+
+	bool passed = checkInvariant(
+		delivered.size() == inMessageCount,
+		"delivered " + std::to_string(delivered.size()) + " of "
+			+ std::to_string(inMessageCount) + " messages",
+		report);
+
+	passed = checkInvariant(
+		duplicates == 0,
+		"a message was shown more than once",
+		report) && passed;
+
+	passed = checkInvariant(
+		outOfOrder == 0,
+		"messages were shown out of the order they were sent in",
+		report) && passed;
+
+	report << "  client sends: " << sender.viewOutbox().statisticsAsString()
+		<< std::endl;
+
+	report << "  receiver: " << receiver.viewDeliveryBuffer().statisticsAsString()
+		<< ", ack frames " << receiver.viewAcknowledgementFramesSent()
+		<< std::endl;
+
+	reportRelayStatistics(
+		cluster, report);
+
+	// the receiving server's own histograms, in microseconds
+	std::istringstream latencies(
+		cluster.serverAt(destinationIndex).metricsAsString("latency."));
+
+	for(std::string line; std::getline(latencies, line); )
+	{
+		report << "  " << cluster.viewTopology().viewServerName(destinationIndex)
+			<< " " << line << std::endl;
+	}
+
+	// what was done to the traffic, in an impaired cluster
+	if(cluster.viewProxy() != nullptr)
+	{
+		std::istringstream impairments(
+			cluster.viewProxy()->asString());
+
+		for(std::string line; std::getline(impairments, line); )
+		{
+			report << "  " << line << std::endl;
+		}
+	}
+
+	cluster.stop();
+
+	return passed;
+};
+
+//--------------------------------------------------------------------- failover
+// Implementation notes:
+//  The message is sent once the failure was detected, so it shows how the
+//  routes changed rather than racing the detector.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::failover(
+	const serverTopology& inTopology,
+	std::ostream& report)
+{
+	if(inTopology.numberOfServers() < 3)
+	{
+		report << "Failover needs at least 3 servers" << std::endl;
+		return true;
+	}
+
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t failedIndex = inTopology.numberOfServers() / 2;
+	const int16_t destinationIndex = inTopology.highestServerIndex();
+
+	scriptedClient sender(
+		"sender",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	scriptedClient receiver(
+		"receiver",
+		cluster.viewTopology(),
+		destinationIndex,
+		cluster.ioService());
+
+	sender.connect();
+	receiver.connect();
+
+	report << "Failover (" << inTopology.viewServerName(failedIndex)
+		<< " killed, " << inTopology.routingModeAsString() << " routing, heartbeat "
+		<< inTopology.viewHeartbeatIntervalMilliseconds() << " ms, timeout "
+		<< inTopology.viewSuspicionTimeoutMilliseconds() << " ms)" << std::endl;
+
+	if(!waitUntilKnown(cluster, originIndex, receiver.viewUsername(), destinationIndex))
+	{
+		report << "  receiver never became known" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	benchmarkClock::time_point start = benchmarkClock::now();
+
+	cluster.killServer(failedIndex);
+
+	report << " Detection" << std::endl;
+
+	bool passed = reportServerState(
+		cluster, start, failedIndex, false, report);
+
+	start = benchmarkClock::now();
+
+	sender.send(receiver.viewUsername(), "failover");
+
+	const bool deliveredDuringOutage =
+		waitForPayload(receiver, "failover", start, 1000);
+
+	report << " Message during outage: "
+		<< (deliveredDuringOutage ? "delivered in " : "held for ")
+		<< std::fixed << std::setprecision(1)
+		<< elapsedMilliseconds(start) << " ms" << std::endl;
+
+	start = benchmarkClock::now();
+
+	cluster.restartServer(failedIndex);
+
+	report << " Recovery" << std::endl;
+
+	passed = reportServerState(
+		cluster, start, failedIndex, true, report) && passed;
+
+	if(!deliveredDuringOutage)
+	{
+		const bool delivered =
+			waitForPayload(receiver, "failover", start, deliveryTimeoutMilliseconds);
+
+		report << " Held message: "
+			<< (delivered ? "delivered " : "lost after ")
+			<< std::fixed << std::setprecision(1)
+			<< elapsedMilliseconds(start) << " ms after the restart" << std::endl;
+
+		passed = checkInvariant(
+			delivered,
+			"the message held during the outage was not delivered",
+			report) && passed;
+	}
+
+	cluster.stop();
+
+	return passed;
+};
+
+//----------------------------------------------------------------------- fanOut
+// Implementation notes:
+//  The last server sends each broadcast to every recipient as it arrives.
+//  The recipients only get for what they are still missing, now and then,
+//  to recover the sends their sockets dropped. Each broadcast should cross
+//  every link once, one relay per server other than the first.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::fanOut(
+	const serverTopology& inTopology,
+	const uint32_t& inRecipientCount,
+	const uint32_t& inBroadcastCount,
+	std::ostream& report)
+{
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = cluster.viewTopology().highestServerIndex();
+
+	report << "Fan-out (" << inBroadcastCount << " broadcasts from "
+		<< cluster.viewTopology().viewServerName(originIndex) << " to "
+		<< inRecipientCount << " clients on "
+		<< cluster.viewTopology().viewServerName(destinationIndex) << ")" << std::endl;
+
+	scriptedClient sender(
+		"sender",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	std::vector<boost::shared_ptr<scriptedClient>> recipients;
+
+	try
+	{
+		for(uint32_t i = 0; i < inRecipientCount; i++)
+		{
+			recipients.push_back(boost::make_shared<scriptedClient>(
+				"fan" + std::to_string(i),
+				cluster.viewTopology(),
+				destinationIndex,
+				cluster.ioService()));
+		}
+	}
+	catch(std::exception& exception)
+	{
+		report << "  unable to open " << inRecipientCount << " sockets: "
+			<< exception.what() << std::endl;
+
+		cluster.stop();
+		return false;
+	}
+
+	sender.connect();
+
+	const benchmarkClock::time_point connectStart = benchmarkClock::now();
+
+	if(!connectInBatches(cluster, destinationIndex, recipients))
+	{
+		report << "  recipients never all connected" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  connected in " << elapsedMilliseconds(connectStart) << " ms" << std::endl;
+
+	const benchmarkClock::time_point start = benchmarkClock::now();
+
+	for(uint32_t i = 0; i < inBroadcastCount; i++)
+	{
+		sender.send(constants::broadcastIdentifier(), "fanout" + std::to_string(i));
+	}
+
+	const uint64_t expected =
+		static_cast<uint64_t>(inRecipientCount) * inBroadcastCount;
+
+	std::vector<uint32_t> deliveredByRecipient(inRecipientCount, 0);
+	uint64_t delivered = 0;
+	uint64_t gets = 0;
+	benchmarkClock::time_point lastDelivery = benchmarkClock::now();
+	benchmarkClock::time_point lastGet = benchmarkClock::now();
+	double lastDeliveryMilliseconds = 0;
+
+	while(delivered < expected
+		&& elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds)
+	{
+		const bool getNow =
+			elapsedMilliseconds(lastGet) >= fanOutGetIntervalMilliseconds;
+
+		if(getNow)
+		{
+			lastGet = benchmarkClock::now();
+		}
+
+		// the sender's window only opens as the server ACKs its messages
+		sender.receiveMessages();
+
+		for(uint32_t i = 0; i < inRecipientCount; i++)
+		{
+			const size_t received =
+				recipients[i]->receiveMessages().size();
+
+			if(received > 0)
+			{
+				deliveredByRecipient[i] += static_cast<uint32_t>(received);
+				delivered += received;
+
+				lastDelivery = benchmarkClock::now();
+				lastDeliveryMilliseconds = elapsedMilliseconds(start);
+			}
+
+			if(getNow && deliveredByRecipient[i] < inBroadcastCount)
+			{
+				recipients[i]->requestMessages();
+				gets++;
+			}
+		}
+
+		pollInterval();
+	}
+
+	uint64_t acknowledgementFrames = 0;
+
+	for(const boost::shared_ptr<scriptedClient>& recipient : recipients)
+	{
+		acknowledgementFrames += recipient->viewAcknowledgementFramesSent();
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  delivered " << delivered << "/" << expected << " in "
+		<< lastDeliveryMilliseconds << " ms";
+
+	if(lastDeliveryMilliseconds > 0)
+	{
+		report << " (" << delivered / (lastDeliveryMilliseconds / 1000.0)
+			<< " deliveries/s)";
+	}
+
+	report << ", gets " << gets
+		<< ", ack frames " << acknowledgementFrames << std::endl;
+
+	const relayStatistics relays = reportRelayStatistics(
+		cluster, report);
+
+	// each recipient shows each broadcast once
+	bool passed = checkInvariant(
+		delivered == expected,
+		"delivered " + std::to_string(delivered) + " of "
+			+ std::to_string(expected) + " broadcasts",
+		report);
+
+	// the last server is slow to ACK while it sends a broadcast to every
+	// recipient, which must not be taken for loss on a lossless cluster
+	passed = checkInvariant(
+		relays.retransmissions * fanOutRelaysPerRetransmission <= relays.relaysSent,
+		std::to_string(relays.retransmissions) + " retransmissions for "
+			+ std::to_string(relays.relaysSent) + " relays",
+		report) && passed;
+
+	passed = checkInvariant(
+		relays.duplicatesReceived * fanOutRelaysPerDuplicate <= relays.relaysSent,
+		std::to_string(relays.duplicatesReceived) + " duplicate relays for "
+			+ std::to_string(relays.relaysSent) + " relays",
+		report) && passed;
+
+	cluster.stop();
+
+	return passed;
+};
+
+//---------------------------------------------------------------- channelFanOut
+// Implementation notes:
+//  The joins go through the members' outboxes, which are polled until the
+//  server has ACKed them all. Each message is published once the previous
+//  one reached every member or the idle timeout passed, so the latencies
+//  are not skewed by a queue building up behind the last server. Members
+//  that are missing a message get for it now and then, as in fanOut.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::channelFanOut(
+	const serverTopology& inTopology,
+	const uint32_t& inMemberCount,
+	const uint32_t& inNonMemberCount,
+	const uint32_t& inMessageCount,
+	std::ostream& report)
+{
+	clusterHarness cluster(inTopology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = cluster.viewTopology().highestServerIndex();
+	const std::string channel("#bench");
+
+	report << "Channel (" << inMessageCount << " messages from "
+		<< cluster.viewTopology().viewServerName(originIndex) << " to "
+		<< inMemberCount << " members on "
+		<< cluster.viewTopology().viewServerName(destinationIndex) << ", "
+		<< inNonMemberCount << " non-members)" << std::endl;
+
+	scriptedClient publisher(
+		"publisher",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	std::vector<boost::shared_ptr<scriptedClient>> members;
+	std::vector<boost::shared_ptr<scriptedClient>> nonMembers;
+
+	try
+	{
+		for(uint32_t i = 0; i < inMemberCount; i++)
+		{
+			members.push_back(boost::make_shared<scriptedClient>(
+				"member" + std::to_string(i),
+				cluster.viewTopology(),
+				destinationIndex,
+				cluster.ioService()));
+		}
+
+		for(uint32_t i = 0; i < inNonMemberCount; i++)
+		{
+			nonMembers.push_back(boost::make_shared<scriptedClient>(
+				"bystander" + std::to_string(i),
+				cluster.viewTopology(),
+				destinationIndex,
+				cluster.ioService()));
+		}
+	}
+	catch(std::exception& exception)
+	{
+		report << "  unable to open " << inMemberCount + inNonMemberCount
+			<< " sockets: " << exception.what() << std::endl;
+
+		cluster.stop();
+		return false;
+	}
+
+	publisher.connect();
+
+	if(!connectInBatches(cluster, destinationIndex, members)
+		|| !connectInBatches(cluster, destinationIndex, nonMembers))
+	{
+		report << "  clients never all connected" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	const benchmarkClock::time_point joinStart = benchmarkClock::now();
+
+	for(const boost::shared_ptr<scriptedClient>& member : members)
+	{
+		member->join(channel);
+	}
+
+	size_t pendingJoins = members.size();
+
+	while(pendingJoins > 0
+		&& elapsedMilliseconds(joinStart) < convergenceTimeoutMilliseconds)
+	{
+		pendingJoins = 0;
+
+		for(const boost::shared_ptr<scriptedClient>& member : members)
+		{
+			member->receiveMessages();
+
+			if(!member->viewOutbox().isEmpty())
+			{
+				pendingJoins++;
+			}
+		}
+
+		pollInterval();
+	}
+
+	if(pendingJoins > 0)
+	{
+		report << "  " << pendingJoins << " join(s) never acknowledged" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  joined in " << elapsedMilliseconds(joinStart) << " ms";
+
+	while(!cluster.serverAt(originIndex).serverHasSubscribers(channel, destinationIndex)
+		&& elapsedMilliseconds(joinStart) < convergenceTimeoutMilliseconds)
+	{
+		pollInterval();
+	}
+
+	if(!cluster.serverAt(originIndex).serverHasSubscribers(channel, destinationIndex))
+	{
+		report << ", " << cluster.viewTopology().viewServerName(originIndex)
+			<< " never learned of the subscription" << std::endl;
+
+		cluster.stop();
+		return false;
+	}
+
+	report << ", known to " << cluster.viewTopology().viewServerName(originIndex)
+		<< " after " << elapsedMilliseconds(joinStart) << " ms" << std::endl;
+
+	std::vector<double> firstLatencies;
+	std::vector<double> lastLatencies;
+	uint64_t delivered = 0;
+	uint64_t nonMemberDeliveries = 0;
+	uint64_t gets = 0;
+
+	for(uint32_t messageIndex = 0; messageIndex < inMessageCount; messageIndex++)
+	{
+		std::vector<bool> received(inMemberCount, false);
+		size_t remaining = inMemberCount;
+
+		const benchmarkClock::time_point start = benchmarkClock::now();
+		benchmarkClock::time_point lastDelivery = start;
+		benchmarkClock::time_point lastGet = start;
+
+		publisher.send(channel, "channel" + std::to_string(messageIndex));
+
+		while(remaining > 0
+			&& elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds)
+		{
+			const bool getNow =
+				elapsedMilliseconds(lastGet) >= fanOutGetIntervalMilliseconds;
+
+			if(getNow)
+			{
+				lastGet = benchmarkClock::now();
+			}
+
+			publisher.receiveMessages();
+
+			for(uint32_t i = 0; i < inMemberCount; i++)
+			{
+				for(const dataMessage& message : members[i]->receiveMessages())
+				{
+					if(received[i] || message.viewDestinationIdentifier() != channel)
+					{
+						continue;
+					}
+
+					received[i] = true;
+					remaining--;
+					delivered++;
+
+					lastDelivery = benchmarkClock::now();
+
+					if(remaining + 1 == inMemberCount)
+					{
+						firstLatencies.push_back(elapsedMilliseconds(start));
+					}
+
+					if(remaining == 0)
+					{
+						lastLatencies.push_back(elapsedMilliseconds(start));
+					}
+				}
+
+				if(getNow && !received[i])
+				{
+					members[i]->requestMessages();
+					gets++;
+				}
+			}
+
+			for(const boost::shared_ptr<scriptedClient>& nonMember : nonMembers)
+			{
+				nonMemberDeliveries += nonMember->receiveMessages().size();
+			}
+
+			pollInterval();
+		}
+	}
+
+	// non-members get once, in case the server held something for them
+	for(const boost::shared_ptr<scriptedClient>& nonMember : nonMembers)
+	{
+		nonMember->requestMessages();
+	}
+
+	const benchmarkClock::time_point settle = benchmarkClock::now();
+
+	while(elapsedMilliseconds(settle) < fanOutGetIntervalMilliseconds)
+	{
+		for(const boost::shared_ptr<scriptedClient>& nonMember : nonMembers)
+		{
+			nonMemberDeliveries += nonMember->receiveMessages().size();
+		}
+
+		pollInterval();
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  delivered " << delivered << "/"
+		<< static_cast<uint64_t>(inMemberCount) * inMessageCount
+		<< ", gets " << gets
+		<< ", non-member deliveries " << nonMemberDeliveries << std::endl;
+
+	report << "  first member ";
+	reportLatencies(firstLatencies, report);
+	report << std::endl;
+
+	report << "  last member  ";
+	reportLatencies(lastLatencies, report);
+	report << std::endl;
+
+	reportRelayStatistics(
+		cluster, report);
+
+	bool passed = checkInvariant(
+		delivered == static_cast<uint64_t>(inMemberCount) * inMessageCount,
+		"delivered " + std::to_string(delivered) + " of "
+			+ std::to_string(static_cast<uint64_t>(inMemberCount) * inMessageCount)
+			+ " channel messages",
+		report);
+
+	passed = checkInvariant(
+		nonMemberDeliveries == 0,
+		"clients that did not join received " + std::to_string(nonMemberDeliveries)
+			+ " message(s)",
+		report) && passed;
+
+	cluster.stop();
+
+	return passed;
+};
+
+//---------------------------------------------------------------- sessionExpiry
+// Implementation notes:
+//  The silent clients are the even numbered ones, so they are spread over
+//  every connect batch. Times are from when the last client connected, the
+//  first batch was last heard from a little earlier. The servers are
+//  polled less often than in the other benchmarks, looking up a client
+//  nobody knows goes through every server's list. The last server is given
+//  a couple of sync intervals past the timeout, the longest a lost leave
+//  can take to be repaired, before a silent client it still knows fails.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::sessionExpiry(
+	const serverTopology& inTopology,
+	const uint32_t& inClientCount,
+	std::ostream& report)
+{
+	serverTopology topology(inTopology);
+
+	topology.setSessionTimeout(
+		sessionTimeoutMilliseconds);
+
+	clusterHarness cluster(topology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t observerIndex = cluster.viewTopology().highestServerIndex();
+
+	report << "Session expiry (" << inClientCount << " clients on "
+		<< cluster.viewTopology().viewServerName(originIndex) << ", half silent, timeout "
+		<< sessionTimeoutMilliseconds << " ms)" << std::endl;
+
+	std::vector<boost::shared_ptr<scriptedClient>> clients;
+
+	for(uint32_t i = 0; i < inClientCount; i++)
+	{
+		clients.push_back(boost::make_shared<scriptedClient>(
+			"session" + std::to_string(i),
+			cluster.viewTopology(),
+			originIndex,
+			cluster.ioService()));
+	}
+
+	if(!connectInBatches(cluster, originIndex, clients))
+	{
+		report << "  clients never all connected" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	const benchmarkClock::time_point start = benchmarkClock::now();
+	benchmarkClock::time_point lastGet = start;
+
+	std::vector<double> evictedAfter;
+	std::vector<double> forgottenAfter;
+	std::vector<bool> evicted(inClientCount, false);
+	std::vector<bool> forgotten(inClientCount, false);
+	uint32_t activeEvicted = 0;
+
+	const double durationMilliseconds = sessionTimeoutMilliseconds
+		+ sessionExpirySyncIntervals * constants::syncIntervalMilliseconds;
+
+	while(elapsedMilliseconds(start) < durationMilliseconds)
+	{
+		const bool getNow =
+			elapsedMilliseconds(lastGet) >= sessionGetIntervalMilliseconds;
+
+		if(getNow)
+		{
+			lastGet = benchmarkClock::now();
+		}
+
+		for(uint32_t i = 0; i < inClientCount; i++)
+		{
+			if(i % 2 == 1)
+			{
+				if(getNow)
+				{
+					clients[i]->requestMessages();
+				}
+
+				clients[i]->receiveMessages();
+				continue;
+			}
+
+			if(!evicted[i]
+				&& cluster.serverAt(originIndex).serverIndexOfClient(
+					clients[i]->viewUsername()) == -1)
+			{
+				evicted[i] = true;
+				evictedAfter.push_back(elapsedMilliseconds(start));
+			}
+
+			if(!forgotten[i]
+				&& cluster.serverAt(observerIndex).serverIndexOfClient(
+					clients[i]->viewUsername()) == -1)
+			{
+				forgotten[i] = true;
+				forgottenAfter.push_back(elapsedMilliseconds(start));
+			}
+		}
+
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			sessionPollIntervalMilliseconds));
+	}
+
+	for(uint32_t i = 1; i < inClientCount; i += 2)
+	{
+		if(cluster.serverAt(originIndex).serverIndexOfClient(
+			clients[i]->viewUsername()) != originIndex)
+		{
+			activeEvicted++;
+		}
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  evicted " << evictedAfter.size() << "/" << (inClientCount + 1) / 2
+		<< " silent clients (server counted "
+		<< cluster.serverAt(originIndex).clientsEvicted()
+		<< "), active clients evicted " << activeEvicted << std::endl;
+
+	report << "  evicted by " << cluster.viewTopology().viewServerName(originIndex) << "   ";
+	reportLatencies(evictedAfter, report);
+	report << std::endl;
+
+	report << "  forgotten by " << cluster.viewTopology().viewServerName(observerIndex) << " ";
+	reportLatencies(forgottenAfter, report);
+	report << std::endl;
+
+	const size_t silentCount = (inClientCount + 1) / 2;
+
+	bool passed = checkInvariant(
+		evictedAfter.size() == silentCount,
+		std::to_string(silentCount - evictedAfter.size()) + " silent client(s) not evicted",
+		report);
+
+	passed = checkInvariant(
+		forgottenAfter.size() == silentCount,
+		std::to_string(silentCount - forgottenAfter.size()) + " silent client(s) not forgotten by "
+			+ cluster.viewTopology().viewServerName(observerIndex),
+		report) && passed;
+
+	passed = checkInvariant(
+		activeEvicted == 0,
+		std::to_string(activeEvicted) + " active client(s) evicted",
+		report) && passed;
+
+	cluster.stop();
+
+	return passed;
+};
+
+//---------------------------------------------------------------- backlogBounds
+// Implementation notes:
+//  The backlog is summed over every server, it is kept on the first server
+//  for the absent client and on the last one for the client that never
+//  ACKs. Relays between them are not part of it. The dead letters are
+//  summed the same way.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::backlogBounds(
+	const serverTopology& inTopology,
+	const uint32_t& inMessageCount,
+	std::ostream& report)
+{
+	serverTopology topology(inTopology);
+
+	topology.setMessageTimeToLive(
+		backlogTimeToLiveMilliseconds);
+
+	clusterHarness cluster(topology);
+	cluster.start();
+
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = cluster.viewTopology().highestServerIndex();
+
+	report << "Backlog bounds (" << inMessageCount << " messages each to an absent client and to a client on "
+		<< cluster.viewTopology().viewServerName(destinationIndex) << " that never ACKs, ttl "
+		<< backlogTimeToLiveMilliseconds << " ms)" << std::endl;
+
+	scriptedClient sender(
+		"sender",
+		cluster.viewTopology(),
+		originIndex,
+		cluster.ioService());
+
+	scriptedClient sink(
+		"sink",
+		cluster.viewTopology(),
+		destinationIndex,
+		cluster.ioService());
+
+	sender.connect();
+	sink.connect();
+
+	if(!waitUntilKnown(cluster, originIndex, sink.viewUsername(), destinationIndex))
+	{
+		report << "  sink never became known" << std::endl;
+		cluster.stop();
+		return false;
+	}
+
+	const benchmarkClock::time_point start = benchmarkClock::now();
+
+	for(uint32_t i = 0; i < inMessageCount; i++)
+	{
+		sender.send(sink.viewUsername(), "backlog" + std::to_string(i));
+		sender.send("nobody", "backlog" + std::to_string(i));
+	}
+
+	uint64_t peakMessages = 0;
+	uint64_t peakBytes = 0;
+	uint64_t backlogMessages = 0;
+	double sendMilliseconds = 0;
+	double drainMilliseconds = 0;
+	std::vector<uint64_t> deadLetters(backlogAccounting::dl_COUNT, 0);
+
+	while(elapsedMilliseconds(start) < deliveryTimeoutMilliseconds + 3 * backlogTimeToLiveMilliseconds)
+	{
+		// the sender's window only opens as the server ACKs its messages
+		sender.receiveMessages();
+
+		if(sendMilliseconds == 0 && sender.viewOutbox().isEmpty())
+		{
+			sendMilliseconds = elapsedMilliseconds(start);
+		}
+
+		backlogMessages = 0;
+		uint64_t backlogBytes = 0;
+
+		deadLetters.assign(
+			backlogAccounting::dl_COUNT, 0);
+
+		for(int16_t serverIndex = 0;
+			serverIndex < cluster.viewTopology().numberOfServers();
+			serverIndex++)
+		{
+			const backlogAccounting backlog =
+				cluster.serverAt(serverIndex).backlogStatistics();
+
+			backlogMessages += backlog.viewMessages();
+			backlogBytes += backlog.viewBytes();
+
+			for(uint16_t reason = 0; reason < backlogAccounting::dl_COUNT; reason++)
+			{
+				deadLetters[reason] += backlog.viewDeadLetters(
+					static_cast<backlogAccounting::DeadLetterReason>(reason));
+			}
+		}
+
+		if(backlogMessages > peakMessages)
+		{
+			peakMessages = backlogMessages;
+			peakBytes = backlogBytes;
+		}
+
+		if(sendMilliseconds > 0 && backlogMessages == 0)
+		{
+			drainMilliseconds = elapsedMilliseconds(start) - sendMilliseconds;
+			break;
+		}
+
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			sessionPollIntervalMilliseconds));
+	}
+
+	report << std::fixed << std::setprecision(1)
+		<< "  sent in " << sendMilliseconds << " ms, peak backlog "
+		<< peakMessages << " messages, " << peakBytes << " bytes" << std::endl;
+
+	if(drainMilliseconds > 0)
+	{
+		report << "  drained " << drainMilliseconds << " ms after the last send" << std::endl;
+	}
+	else
+	{
+		report << "  never drained, " << backlogMessages << " messages left" << std::endl;
+	}
+
+	report << "  dead letters: expired " << deadLetters[backlogAccounting::dl_EXPIRED]
+		<< ", over recipient quota " << deadLetters[backlogAccounting::dl_RECIPIENT_QUOTA]
+		<< ", over server quota " << deadLetters[backlogAccounting::dl_SERVER_QUOTA]
+		<< ", recipient gone " << deadLetters[backlogAccounting::dl_RECIPIENT_GONE]
+		<< std::endl;
+
+	const bool passed = checkInvariant(
+		drainMilliseconds > 0,
+		"the backlog never drained",
+		report);
+
+	cluster.stop();
+
+	return passed;
+};
+
+//---------------------------------------------------------------- spoolRecovery
+// Implementation notes:
+//  The backlog is filled once with the messages in memory only, then again
+//  on a new cluster with a spool, to compare the two. The spool is in a
+//  directory of its own under the system's temporary directory, deleted
+//  at the end.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::spoolRecovery(
+	const serverTopology& inTopology,
+	const uint32_t& inSinkCount,
+	const uint32_t& inMessagesPerSink,
+	std::ostream& report)
+{
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = inTopology.highestServerIndex();
+	const uint32_t messageCount = inSinkCount * inMessagesPerSink;
+
+	const boost::filesystem::path spoolDirectory =
+		boost::filesystem::temp_directory_path()
+		/ boost::filesystem::unique_path("cpsc3780-spool-%%%%-%%%%");
+
+	report << "Spool recovery (" << messageCount << " messages from "
+		<< inTopology.viewServerName(originIndex) << " to " << inSinkCount << " clients on "
+		<< inTopology.viewServerName(destinationIndex) << " that do not get them)" << std::endl;
+
+	bool passed = true;
+
+	for(const bool& spooled : {false, true})
+	{
+		serverTopology topology(inTopology);
+
+		if(spooled)
+		{
+			topology.setSpoolDirectory(
+				spoolDirectory.string());
+		}
+
+		clusterHarness cluster(topology);
+		cluster.start();
+
+		scriptedClient sender(
+			"sender",
+			cluster.viewTopology(),
+			originIndex,
+			cluster.ioService());
+
+		std::vector<boost::shared_ptr<scriptedClient>> sinks;
+
+		for(uint32_t i = 0; i < inSinkCount; i++)
+		{
+			sinks.push_back(boost::make_shared<scriptedClient>(
+				"sink" + std::to_string(i),
+				cluster.viewTopology(),
+				destinationIndex,
+				cluster.ioService()));
+		}
+
+		sender.connect();
+
+		if(!connectInBatches(cluster, destinationIndex, sinks)
+			|| !waitUntilKnown(cluster, originIndex, sinks.back()->viewUsername(), destinationIndex))
+		{
+			report << "  sinks never all connected" << std::endl;
+			cluster.stop();
+			return false;
+		}
+
+		const double fillMilliseconds = fillBacklog(
+			cluster,
+			destinationIndex,
+			sender,
+			sinks,
+			inMessagesPerSink);
+
+		report << std::fixed << std::setprecision(1)
+			<< (spooled ? "  spooled:   " : "  in memory: ") << "backlog filled in "
+			<< fillMilliseconds << " ms" << std::endl;
+
+		passed = checkInvariant(
+			fillMilliseconds >= 0,
+			"the backlog was never filled",
+			report) && passed;
+
+		if(!spooled || fillMilliseconds < 0)
+		{
+			cluster.stop();
+			continue;
+		}
+
+		cluster.killServer(
+			destinationIndex);
+
+		const benchmarkClock::time_point restart = benchmarkClock::now();
+
+		cluster.restartServer(
+			destinationIndex);
+
+		const double restartMilliseconds = elapsedMilliseconds(restart);
+		const uint64_t recovered =
+			cluster.serverAt(destinationIndex).backlogStatistics().viewMessages();
+
+		report << "  restarted in " << restartMilliseconds << " ms, recovered "
+			<< recovered << "/" << messageCount << " messages" << std::endl;
+
+		passed = checkInvariant(
+			recovered == messageCount,
+			"recovered " + std::to_string(recovered) + " of "
+				+ std::to_string(messageCount) + " spooled messages",
+			report) && passed;
+
+		// the restarted server has forgotten its clients
+		connectInBatches(
+			cluster,
+			destinationIndex,
+			sinks);
+
+		std::set<std::string> delivered;
+		benchmarkClock::time_point lastDelivery = benchmarkClock::now();
+		benchmarkClock::time_point lastGet = benchmarkClock::now();
+
+		while(elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds
+			&& (delivered.size() < messageCount
+				|| cluster.serverAt(destinationIndex).backlogStatistics().viewMessages() > 0))
+		{
+			// a get sends every message still held, they are spaced out so
+			// the sinks can ACK what they got in between
+			if(elapsedMilliseconds(lastGet) >= fanOutGetIntervalMilliseconds)
+			{
+				lastGet = benchmarkClock::now();
+
+				for(const boost::shared_ptr<scriptedClient>& sink : sinks)
+				{
+					sink->requestMessages();
+				}
+			}
+
+			pollInterval();
+
+			for(const boost::shared_ptr<scriptedClient>& sink : sinks)
+			{
+				for(const dataMessage& message : sink->receiveMessages())
+				{
+					if(delivered.insert(sink->viewUsername() + message.viewPayload()).second)
+					{
+						lastDelivery = benchmarkClock::now();
+					}
+				}
+			}
+		}
+
+		// once ACKed, the spool is emptied at the next synchronize
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			idleTimeoutMilliseconds / 10));
+
+		report << "  delivered " << delivered.size() << "/" << messageCount
+			<< " after the restart" << std::endl;
+
+		passed = checkInvariant(
+			delivered.size() == messageCount,
+			"delivered " + std::to_string(delivered.size()) + " of "
+				+ std::to_string(messageCount) + " messages after the restart",
+			report) && passed;
+
+		report << "  " << cluster.serverAt(destinationIndex).spoolStatistics()
+			<< std::endl;
+
+		cluster.stop();
+	}
+
+	boost::system::error_code ignoredError;
+
+	boost::filesystem::remove_all(
+		spoolDirectory,
+		ignoredError);
+
+	return passed;
+};
+
+//--------------------------------------------------------------- messageTracing
+// Implementation notes:
+//  Every message is traced. The traces are written as the receiver ACKs,
+//  they are complete once the cluster is stopped. Like the spool, they are
+//  in a directory of their own that is deleted at the end.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::messageTracing(
+	const serverTopology& inTopology,
+	const uint32_t& inMessageCount,
+	std::ostream& report)
+{
+	const boost::filesystem::path traceDirectory =
+		boost::filesystem::temp_directory_path()
+		/ boost::filesystem::unique_path("cpsc3780-trace-%%%%-%%%%");
+
+	serverTopology topology(inTopology);
+
+	topology.setMessageTracing(
+		traceDirectory.string(),
+		1);
+
+	bool passed = true;
+
+	{
+		clusterHarness cluster(topology);
+		cluster.start();
+
+		const int16_t originIndex = 0;
+		const int16_t destinationIndex = cluster.viewTopology().highestServerIndex();
+
+		scriptedClient sender(
+			"sender",
+			cluster.viewTopology(),
+			originIndex,
+			cluster.ioService());
+
+		scriptedClient receiver(
+			"receiver",
+			cluster.viewTopology(),
+			destinationIndex,
+			cluster.ioService());
+
+		sender.connect();
+		receiver.connect();
+
+		report << "Message tracing (" << inMessageCount << " messages, "
+			<< cluster.viewTopology().viewServerName(originIndex) << " to "
+			<< cluster.viewTopology().viewServerName(destinationIndex) << ")" << std::endl;
+
+		if(!waitUntilKnown(cluster, originIndex, receiver.viewUsername(), destinationIndex))
+		{
+			report << "  receiver never became known" << std::endl;
+			cluster.stop();
+			return false;
+		}
+
+		for(uint32_t i = 0; i < inMessageCount; i++)
+		{
+			sender.send(receiver.viewUsername(), "trace" + std::to_string(i));
+		}
+
+		std::set<std::string> delivered;
+		benchmarkClock::time_point lastDelivery = benchmarkClock::now();
+
+		while(delivered.size() < inMessageCount
+			&& elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds)
+		{
+			receiver.requestMessages();
+			pollInterval();
+
+			sender.receiveMessages();
+
+			for(const dataMessage& message : receiver.receiveMessages())
+			{
+				if(delivered.insert(message.viewPayload()).second)
+				{
+					lastDelivery = benchmarkClock::now();
+				}
+			}
+		}
+
+		report << "  delivered " << delivered.size() << "/" << inMessageCount
+			<< std::endl;
+
+		passed = checkInvariant(
+			delivered.size() == inMessageCount,
+			"delivered " + std::to_string(delivered.size()) + " of "
+				+ std::to_string(inMessageCount) + " messages",
+			report);
+
+		// the receiver holds its last ACKs back for a moment, it has to keep
+		// polling to send them
+		const benchmarkClock::time_point lastPoll = benchmarkClock::now();
+
+		while(elapsedMilliseconds(lastPoll) < idleTimeoutMilliseconds / 10)
+		{
+			pollInterval();
+			receiver.receiveMessages();
+		}
+
+		cluster.stop();
+	}
+
+	traceReport traces(topology);
+
+	const uint32_t traceCount = traces.addDirectory(traceDirectory.string());
+
+	report << "  " << traceCount
+		<< " traces, step times in microseconds" << std::endl;
+
+	passed = checkInvariant(
+		traceCount == inMessageCount,
+		std::to_string(traceCount) + " traces for "
+			+ std::to_string(inMessageCount) + " messages",
+		report) && passed;
+
+	std::istringstream steps(traces.asString());
+
+	for(std::string line; std::getline(steps, line); )
+	{
+		report << "  " << line << std::endl;
+	}
+
+	boost::system::error_code ignoredError;
+
+	boost::filesystem::remove_all(
+		traceDirectory,
+		ignoredError);
+
+	return passed;
+};
+
+//------------------------------------------------------------- captureAndReplay
+// Implementation notes:
+//  The capture is in a directory of its own that is deleted at the end.
+//  Each replay gets a fresh cluster, so the handling latencies reported are
+//  of the replay only.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::captureAndReplay(
+	const serverTopology& inTopology,
+	const uint32_t& inMessageCount,
+	std::ostream& report)
+{
+	const boost::filesystem::path captureDirectory =
+		boost::filesystem::temp_directory_path()
+		/ boost::filesystem::unique_path("cpsc3780-capture-%%%%-%%%%");
+
+	const int16_t originIndex = 0;
+	const int16_t destinationIndex = inTopology.highestServerIndex();
+
+	report << "Capture and replay (" << inMessageCount << " messages, "
+		<< inTopology.viewServerName(originIndex) << " to "
+		<< inTopology.viewServerName(destinationIndex) << ", captured on "
+		<< inTopology.viewServerName(destinationIndex) << ")" << std::endl;
+
+	bool passed = true;
+
+	{
+		serverTopology topology(inTopology);
+
+		topology.setCaptureDirectory(
+			captureDirectory.string());
+
+		clusterHarness cluster(topology);
+		cluster.start();
+
+		scriptedClient sender(
+			"sender",
+			cluster.viewTopology(),
+			originIndex,
+			cluster.ioService());
+
+		scriptedClient receiver(
+			"receiver",
+			cluster.viewTopology(),
+			destinationIndex,
+			cluster.ioService());
+
+		sender.connect();
+		receiver.connect();
+
+		if(!waitUntilKnown(cluster, originIndex, receiver.viewUsername(), destinationIndex))
+		{
+			report << "  receiver never became known" << std::endl;
+			cluster.stop();
+			return false;
+		}
+
+		for(uint32_t i = 0; i < inMessageCount; i++)
+		{
+			sender.send(receiver.viewUsername(), "replay" + std::to_string(i));
+		}
+
+		std::set<std::string> delivered;
+		benchmarkClock::time_point lastDelivery = benchmarkClock::now();
+
+		while(delivered.size() < inMessageCount
+			&& elapsedMilliseconds(lastDelivery) < idleTimeoutMilliseconds)
+		{
+			receiver.requestMessages();
+			pollInterval();
+
+			sender.receiveMessages();
+
+			for(const dataMessage& message : receiver.receiveMessages())
+			{
+				if(delivered.insert(message.viewPayload()).second)
+				{
+					lastDelivery = benchmarkClock::now();
+				}
+			}
+		}
+
+		report << "  delivered " << delivered.size() << "/" << inMessageCount
+			<< " while capturing" << std::endl;
+
+		passed = checkInvariant(
+			delivered.size() == inMessageCount,
+			"delivered " + std::to_string(delivered.size()) + " of "
+				+ std::to_string(inMessageCount) + " messages while capturing",
+			report);
+
+		cluster.stop();
+	}
+
+	try
+	{
+		const captureReplay replay(
+			(captureDirectory / (inTopology.viewServerName(destinationIndex) + ".capture")).string());
+
+		for(const double& speed : {1.0, 0.0})
+		{
+			clusterHarness cluster(inTopology);
+			cluster.start();
+
+			passed = checkInvariant(
+				replay.replay(cluster, speed, report),
+				"the replay did not handle every captured datagram",
+				report) && passed;
+
+			cluster.stop();
+		}
+	}
+	catch(std::exception& exception)
+	{
+		passed = checkInvariant(
+			false,
+			exception.what(),
+			report);
+	}
+
+	boost::system::error_code ignoredError;
+
+	boost::filesystem::remove_all(
+		captureDirectory,
+		ignoredError);
+
+	return passed;
+};
+
+//--------------------------------------------------------------- simulatedSweep
+// Implementation notes:
+//  Every combination starts from the same seed, so differences come from
+//  the intervals rather than from a luckier run
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::simulatedSweep(
+	const serverTopology& inTopology,
+	std::ostream& report)
+{
+	const std::vector<uint16_t> syncIntervals{500, 1500, 5000};
+	const std::vector<uint16_t> updateIntervals{100, 250, 1000};
+	const std::vector<uint16_t> forwardIntervals{5, 50};
+
+	protocolSimulator::simulationParameters parameters;
+
+	report << "Simulated sweep (" << inTopology.numberOfServers() << " servers, "
+		<< parameters.m_clientsPerServer << " clients each, "
+		<< parameters.m_messagesPerSecond << " messages and "
+		<< parameters.m_reconnectsPerSecond << " moves per second for "
+		<< parameters.m_simulatedSeconds << " s, "
+		<< parameters.m_lossPercent << "% lost, "
+		<< parameters.m_minimumDelayMilliseconds << "-"
+		<< parameters.m_maximumDelayMilliseconds << " ms delay, "
+		<< parameters.m_reorderPercent << "% up to "
+		<< parameters.m_reorderDelayMilliseconds << " ms later)" << std::endl;
+
+	bool passed = true;
+
+	for(const uint16_t& syncInterval : syncIntervals)
+	{
+		for(const uint16_t& updateInterval : updateIntervals)
+		{
+			for(const uint16_t& forwardInterval : forwardIntervals)
+			{
+				parameters.m_syncIntervalMilliseconds = syncInterval;
+				parameters.m_updateIntervalMilliseconds = updateInterval;
+				parameters.m_forwardIntervalMilliseconds = forwardInterval;
+
+				const benchmarkClock::time_point start = benchmarkClock::now();
+
+				protocolSimulator simulator(
+					inTopology,
+					parameters);
+
+				simulator.run();
+
+				report << "  " << simulator.resultsAsString() << std::endl
+					<< "    " << simulator.viewEventCount() << " events in "
+					<< std::fixed << std::setprecision(0) << elapsedMilliseconds(start)
+					<< " ms" << std::endl;
+
+				passed = checkInvariant(
+					simulator.converged(),
+					"a move or message never converged in the simulation",
+					report) && passed;
+			}
+		}
+	}
+
+	// lists long enough to be synced in parts, and as summaries
+	protocolSimulator::simulationParameters membershipParameters;
+
+	membershipParameters.m_clientsPerServer = simulatedMembershipClients;
+	membershipParameters.m_simulatedSeconds = simulatedMembershipSeconds;
+
+	report << "Simulated membership (" << simulatedMembershipClients << " clients on each server for "
+		<< simulatedMembershipSeconds << " s)" << std::endl;
+
+	for(const uint16_t& filterBits : {static_cast<uint16_t>(0), constants::membershipFilterBits})
+	{
+		membershipParameters.m_membershipFilterBits = filterBits;
+
+		protocolSimulator simulator(
+			inTopology,
+			membershipParameters);
+
+		simulator.run();
+
+		report << "  " << (filterBits == 0 ? std::string("full lists") : std::to_string(filterBits) + " bit filters")
+			<< ": " << simulator.resultsAsString() << std::endl;
+
+		passed = checkInvariant(
+			simulator.converged(),
+			"a move or message never converged in the simulation",
+			report) && passed;
+	}
+
+	return passed;
+};
+
+//---------------------------------------------------------- membershipSummaries
+// Implementation notes:
+//  The bytes are counted after the last server knows every client, so
+//  they are the steady state syncs rather than the joins. Summed over
+//  every server, each list crosses every link once per sync interval.
+//  The last server is then restarted, which it only recovers from by
+//  syncs since no client joins or leaves.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::membershipSummaries(
+	const serverTopology& inTopology,
+	const uint32_t& inClientCount,
+	std::ostream& report)
+{
+	const std::vector<uint16_t> filterBitsByMode{0, constants::membershipFilterBits};
+
+	bool passed = true;
+
+	for(const uint16_t& filterBits : filterBitsByMode)
+	{
+		serverTopology topology(inTopology);
+
+		topology.setMembershipFilterBits(
+			filterBits);
+
+		clusterHarness cluster(topology);
+		cluster.start();
+
+		const int16_t originIndex = 0;
+		const int16_t observerIndex = cluster.viewTopology().highestServerIndex();
+
+		report << "Membership sync ("
+			<< (filterBits == 0 ? std::string("full lists") : std::to_string(filterBits) + " bit filters")
+			<< ", " << inClientCount << " clients on "
+			<< cluster.viewTopology().viewServerName(originIndex) << ")" << std::endl;
+
+		std::vector<boost::shared_ptr<scriptedClient>> clients;
+
+		for(uint32_t i = 0; i < inClientCount; i++)
+		{
+			clients.push_back(boost::make_shared<scriptedClient>(
+				"member" + std::to_string(i),
+				cluster.viewTopology(),
+				originIndex,
+				cluster.ioService()));
+		}
+
+		if(!connectInBatches(cluster, originIndex, clients)
+			|| !waitUntilKnown(cluster, observerIndex, clients.back()->viewUsername(), originIndex))
+		{
+			report << "  clients never all known" << std::endl;
+			passed = false;
+			cluster.stop();
+			continue;
+		}
+
+		uint64_t bytesBefore = 0;
+
+		for(int16_t serverIndex = 0;
+			serverIndex < cluster.viewTopology().numberOfServers();
+			serverIndex++)
+		{
+			bytesBefore += cluster.serverAt(serverIndex).syncPayloadBytesSent();
+		}
+
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			membershipSyncIntervals * constants::syncIntervalMilliseconds));
+
+		uint64_t bytesAfter = 0;
+
+		for(int16_t serverIndex = 0;
+			serverIndex < cluster.viewTopology().numberOfServers();
+			serverIndex++)
+		{
+			bytesAfter += cluster.serverAt(serverIndex).syncPayloadBytesSent();
+		}
+
+		uint32_t known = 0;
+
+		for(const boost::shared_ptr<scriptedClient>& client : clients)
+		{
+			if(cluster.serverAt(observerIndex).serverIndexOfClient(
+				client->viewUsername()) == originIndex)
+			{
+				known++;
+			}
+		}
+
+		report << "  " << (bytesAfter - bytesBefore) / membershipSyncIntervals
+			<< " sync payload bytes per interval, "
+			<< cluster.viewTopology().viewServerName(observerIndex) << " knows "
+			<< known << "/" << inClientCount << " clients" << std::endl;
+
+		passed = checkInvariant(
+			known == inClientCount,
+			"clients were forgotten between syncs",
+			report) && passed;
+
+		cluster.killServer(
+			observerIndex);
+
+		cluster.restartServer(
+			observerIndex);
+
+		const benchmarkClock::time_point restart = benchmarkClock::now();
+
+		known = 0;
+
+		while(known < inClientCount
+			&& elapsedMilliseconds(restart) < convergenceTimeoutMilliseconds)
+		{
+			known = 0;
+
+			for(const boost::shared_ptr<scriptedClient>& client : clients)
+			{
+				if(cluster.serverAt(observerIndex).serverIndexOfClient(
+					client->viewUsername()) == originIndex)
+				{
+					known++;
+				}
+			}
+
+			boost::this_thread::sleep(
+				boost::posix_time::millisec(
+				sessionPollIntervalMilliseconds));
+		}
+
+		report << std::fixed << std::setprecision(1)
+			<< "  " << cluster.viewTopology().viewServerName(observerIndex) << " restarted, knows "
+			<< known << "/" << inClientCount << " clients again after "
+			<< elapsedMilliseconds(restart) << " ms" << std::endl;
+
+		passed = checkInvariant(
+			known == inClientCount,
+			"the restarted server did not relearn every client within "
+				+ std::to_string(convergenceTimeoutMilliseconds) + " ms",
+			report) && passed;
+
+		std::istringstream syncMetrics(
+			cluster.serverAt(observerIndex).metricsAsString("sync."));
+
+		for(std::string line; std::getline(syncMetrics, line); )
+		{
+			report << "  " << cluster.viewTopology().viewServerName(observerIndex)
+				<< " " << line << std::endl;
+		}
+
+		cluster.stop();
+	}
+
+	return passed;
+};
+
+//---------------------------------------------------------------- deliveryOrder
+// Implementation notes:
+//  The sender sends 10 and 12 to the receiver directly and 11 to everyone
+//  in between, so 12 follows 10 and 11 follows nothing. The messages are
+//  fed straight into a delivery buffer in each order, no cluster is run.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::deliveryOrder(
+	std::ostream& report)
+{
+	const uint16_t holdMilliseconds = 500;
+
+	std::vector<dataMessage> sent;
+
+	sent.push_back(dataMessage(
+		10, constants::mt_CLIENT_SEND, "sender", "receiver", "direct 10"));
+	sent.push_back(dataMessage(
+		11, constants::mt_CLIENT_SEND, "sender", constants::broadcastIdentifier(), "broadcast 11"));
+	sent.push_back(dataMessage(
+		12, constants::mt_CLIENT_SEND, "sender", "receiver", "direct 12"));
+
+	sent[2].setPreviousSequenceNumber(
+		10);
+
+	// the order each case receives them in, 0 being lost, and the order
+	// they must be shown in
+	const std::vector<std::vector<int64_t>> arrivals{
+		{10, 11, 12},
+		{11, 12, 10},
+		{12, 11, 10},
+		{11, 12, 0}};
+
+	const std::vector<std::vector<int64_t>> expected{
+		{10, 11, 12},
+		{11, 10, 12},
+		{11, 10, 12},
+		{11, 12}};
+
+	report << "Delivery order (direct 10 and 12, broadcast 11 from one sender)" << std::endl;
+
+	bool passed = true;
+
+	for(size_t i = 0; i < arrivals.size(); i++)
+	{
+		deliveryBuffer buffer(
+			holdMilliseconds);
+
+		const deliveryBuffer::deliveryClock::time_point now =
+			deliveryBuffer::deliveryClock::now();
+
+		std::vector<int64_t> shown;
+
+		for(const int64_t& sequenceNumber : arrivals[i])
+		{
+			if(sequenceNumber == 0)
+			{
+				continue;
+			}
+
+			for(const dataMessage& message : buffer.receive(sent[sequenceNumber - 10], now))
+			{
+				shown.push_back(message.viewSequenceNumber());
+			}
+		}
+
+		for(const dataMessage& message :
+			buffer.takeExpired(now + boost::chrono::milliseconds(holdMilliseconds)))
+		{
+			shown.push_back(message.viewSequenceNumber());
+		}
+
+		report << "  received";
+
+		for(const int64_t& sequenceNumber : arrivals[i])
+		{
+			report << " " << (sequenceNumber == 0 ? std::string("lost") : std::to_string(sequenceNumber));
+		}
+
+		report << ", shown";
+
+		for(const int64_t& sequenceNumber : shown)
+		{
+			report << " " << sequenceNumber;
+		}
+
+		report << (shown == expected[i] ? ", ok" : ", out of order") << std::endl;
+
+		passed = passed && shown == expected[i];
+	}
+
+	// a message from further back than the window, held up by a failover,
+	// is still shown
+	deliveryBuffer buffer(
+		holdMilliseconds);
+
+	const deliveryBuffer::deliveryClock::time_point now =
+		deliveryBuffer::deliveryClock::now();
+
+	const int64_t laterSequenceNumber = 10 + constants::deliveredWindowSize;
+
+	buffer.receive(
+		dataMessage(laterSequenceNumber, constants::mt_CLIENT_SEND, "sender", "receiver", "later"),
+		now);
+
+	const size_t shownOld = buffer.receive(sent[0], now).size();
+
+	report << "  received " << laterSequenceNumber << " 10, shown 10 "
+		<< (shownOld == 1 ? "too old" : "never") << std::endl;
+
+	passed = checkInvariant(
+		shownOld == 1,
+		"a message older than the delivered window was dropped",
+		report) && passed;
+
+	return passed;
+};
+
+//--------------------------------------------------------------- sessionLookups
+// Implementation notes:
+//  A fresh cluster for each way of sending, so the server's counters only
+//  hold that way's gets. The lookups are also timed on their own, with the
+//  containers the server kept its clients in before they were keyed by
+//  session, since the difference is lost in the time a get takes.
+//------------------------------------------------------------------------------
+bool clusterBenchmarks::sessionLookups(
+	const serverTopology& inTopology,
+	const uint32_t& inClientCount,
+	const uint32_t& inGetsPerClient,
+	std::ostream& report)
+{
+	const int16_t originIndex = 0;
+
+	report << "Session lookups (" << inClientCount << " clients on "
+		<< inTopology.viewServerName(originIndex) << ", " << inGetsPerClient
+		<< " gets each)" << std::endl;
+
+	const std::vector<bool> sendsSession{false, true};
+
+	for(const bool& sendSession : sendsSession)
+	{
+		clusterHarness cluster(inTopology);
+		cluster.start();
+
+		std::vector<boost::shared_ptr<scriptedClient>> clients;
+
+		for(uint32_t i = 0; i < inClientCount; i++)
+		{
+			clients.push_back(boost::make_shared<scriptedClient>(
+				"lookup" + std::to_string(i),
+				cluster.viewTopology(),
+				originIndex,
+				cluster.ioService()));
+		}
+
+		if(!connectInBatches(cluster, originIndex, clients))
+		{
+			report << "  clients never all connected" << std::endl;
+			cluster.stop();
+			return false;
+		}
+
+		// the session replies may still be on their way
+		const benchmarkClock::time_point connected = benchmarkClock::now();
+		size_t withSession = 0;
+
+		while(withSession < clients.size()
+			&& elapsedMilliseconds(connected) < convergenceTimeoutMilliseconds)
+		{
+			pollInterval();
+
+			withSession = 0;
+
+			for(const boost::shared_ptr<scriptedClient>& client : clients)
+			{
+				client->receiveMessages();
+
+				if(!client->viewSessionIdentifier().empty())
+				{
+					withSession++;
+				}
+			}
+		}
+
+		if(withSession < clients.size())
+		{
+			report << "  clients never all got a session" << std::endl;
+			cluster.stop();
+			return false;
+		}
+
+		const dataMessage getMessage(
+			1,
+			constants::mt_CLIENT_GET,
+			sendSession
+				? clients.back()->viewSessionIdentifier()
+				: clients.back()->viewUsername(),
+			cluster.viewTopology().viewServerName(originIndex),
+			"blank");
+
+		if(!sendSession)
+		{
+			for(const boost::shared_ptr<scriptedClient>& client : clients)
+			{
+				client->forgetSession();
+			}
+		}
+
+		const benchmarkClock::time_point start = benchmarkClock::now();
+
+		for(uint32_t round = 0; round < inGetsPerClient; round++)
+		{
+			// a batch at a time, so the server's socket does not overflow
+			for(uint32_t i = 0; i < inClientCount; i++)
+			{
+				clients[i]->requestMessages();
+
+				if((i + 1) % connectBatchSize == 0)
+				{
+					pollInterval();
+				}
+			}
+
+			for(const boost::shared_ptr<scriptedClient>& client : clients)
+			{
+				client->receiveMessages();
+			}
+		}
+
+		const double sendMilliseconds = elapsedMilliseconds(start);
+
+		// let the server catch up before reading its counters
+		boost::this_thread::sleep(
+			boost::posix_time::millisec(
+			sessionPollIntervalMilliseconds));
+
+		report << std::fixed << std::setprecision(1)
+			<< "  by " << (sendSession ? "session " : "username")
+			<< ": get datagram " << getMessage.asCharVector().size()
+			<< " bytes, gets sent in " << sendMilliseconds << " ms" << std::endl;
+
+		std::istringstream metrics(
+			cluster.serverAt(originIndex).metricsAsString("received.client_get")
+			+ cluster.serverAt(originIndex).metricsAsString("latency.handling_us"));
+
+		for(std::string line; std::getline(metrics, line); )
+		{
+			report << "    " << line << std::endl;
+		}
+
+		cluster.stop();
+	}
+
+	// a get looked its client up twice, to refresh it and to find its
+	// messages, and a session first had to be turned into the username
+	std::unordered_map<uint32_t, std::string> usernamesBySession;
+	std::map<std::string, remoteConnection> clientsByUsername;
+	std::unordered_map<uint32_t, remoteConnection> clientsBySession;
+
+	for(uint32_t i = 0; i < inClientCount; i++)
+	{
+		const uint32_t session = i + 1;
+		const remoteConnection connection(
+			"lookup" + std::to_string(i),
+			boost::asio::ip::udp::endpoint(),
+			session);
+
+		usernamesBySession.insert(std::make_pair(
+			session,
+			connection.viewIdentifier()));
+
+		clientsByUsername.insert(std::make_pair(
+			connection.viewIdentifier(),
+			connection));
+
+		clientsBySession.insert(std::make_pair(
+			session,
+			connection));
+	}
+
+	const uint32_t lookupRounds = 1000;
+	uint64_t usernameSum = 0;
+	uint64_t sessionSum = 0;
+
+	const benchmarkClock::time_point usernameStart = benchmarkClock::now();
+
+	for(uint32_t round = 0; round < lookupRounds; round++)
+	{
+		for(uint32_t session = 1; session <= inClientCount; session++)
+		{
+			const std::string username(
+				usernamesBySession.find(session)->second);
+
+			usernameSum += clientsByUsername.find(username)->second.viewSessionIdentifier();
+			usernameSum += clientsByUsername.find(username)->second.viewSessionIdentifier();
+		}
+	}
+
+	const double usernameMilliseconds = elapsedMilliseconds(usernameStart);
+
+	const benchmarkClock::time_point sessionStart = benchmarkClock::now();
+
+	for(uint32_t round = 0; round < lookupRounds; round++)
+	{
+		for(uint32_t session = 1; session <= inClientCount; session++)
+		{
+			sessionSum += clientsBySession.find(session)->second.viewSessionIdentifier();
+			sessionSum += clientsBySession.find(session)->second.viewSessionIdentifier();
+		}
+	}
+
+	const double sessionMilliseconds = elapsedMilliseconds(sessionStart);
+
+	const double lookups = static_cast<double>(lookupRounds) * inClientCount;
+
+	report << std::fixed << std::setprecision(1)
+		<< "  client lookups per get: by username " << usernameMilliseconds * 1e6 / lookups
+		<< " ns, by session " << sessionMilliseconds * 1e6 / lookups << " ns"
+		<< (usernameSum == sessionSum ? "" : ", found different clients") << std::endl;
+
+	return usernameSum == sessionSum;
+};
\ No newline at end of file
@@ -0,0 +1,327 @@
+#pragma once
+
+// STL
+#include <ostream>
+#include <string>
+#include <cstdint>
+
+// Project
+#include "../Common/serverTopology.h"
+
+namespace clusterBenchmarks
+{
+	//---------------------------------------------------------- syncConvergence
+	// Brief Description
+	//  Connects a client to the first server and reports how long it takes
+	//  until every other server knows which server that client is on, then
+	//  disconnects it and reports how long until every server forgets it.
+	//  Returns false if a server does not converge within the timeout.
+	//
+	// Method:    syncConvergence
+	// FullName:  clusterBenchmarks::syncConvergence
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool syncConvergence(
+		const serverTopology& inTopology,
+		std::ostream& report);
+
+	//------------------------------------------------------------- relayLatency
+	// Brief Description
+	//  Sends messages one at a time from a client on the first server to a
+	//  client on each other server, and reports the delivery latency, the
+	//  number of relay hops the messages took and the latency per hop for
+	//  each destination. Returns false if any message is lost.
+	//
+	// Method:    relayLatency
+	// FullName:  clusterBenchmarks::relayLatency
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMessagesPerDestination
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool relayLatency(
+		const serverTopology& inTopology,
+		const uint32_t& inMessagesPerDestination,
+		std::ostream& report);
+
+	//------------------------------------------------------- deliveryThroughput
+	// Brief Description
+	//  Sends a burst of messages from a client on the first server to a
+	//  client on the last server, and reports how many arrived and how fast.
+	//  Returns false unless each arrived once, in the order it was sent.
+	//
+	// Method:    deliveryThroughput
+	// FullName:  clusterBenchmarks::deliveryThroughput
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMessageCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool deliveryThroughput(
+		const serverTopology& inTopology,
+		const uint32_t& inMessageCount,
+		std::ostream& report);
+
+	//----------------------------------------------------------------- failover
+	// Brief Description
+	//  Kills the middle server, reports how long its neighbours take to
+	//  detect it, whether a message from the first to the last server gets
+	//  through or is held meanwhile, then restarts it and reports how long
+	//  until it is detected again and the message is delivered. Returns
+	//  false if either change goes unseen or the message is never
+	//  delivered.
+	//
+	// Method:    failover
+	// FullName:  clusterBenchmarks::failover
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool failover(
+		const serverTopology& inTopology,
+		std::ostream& report);
+
+	//------------------------------------------------------------------- fanOut
+	// Brief Description
+	//  Connects many clients to the last server and broadcasts to them from
+	//  a client on the first server. Reports how fast the broadcasts reach
+	//  every client, and how many relays they took between servers.
+	//  Returns false unless every client got every broadcast.
+	//
+	// Method:    fanOut
+	// FullName:  clusterBenchmarks::fanOut
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inRecipientCount
+	// Parameter: const uint32_t& inBroadcastCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool fanOut(
+		const serverTopology& inTopology,
+		const uint32_t& inRecipientCount,
+		const uint32_t& inBroadcastCount,
+		std::ostream& report);
+
+	//------------------------------------------------------------ channelFanOut
+	// Brief Description
+	//  Connects many clients to the last server, joins them to a channel and
+	//  reports how long the first server takes to learn of the subscription.
+	//  Then publishes to the channel from a client on the first server, one
+	//  message at a time, and reports how fast each one reaches the first
+	//  and the last member, and whether clients on the same server that did
+	//  not join received anything. Returns false unless every member got
+	//  every message and no other client got any.
+	//
+	// Method:    channelFanOut
+	// FullName:  clusterBenchmarks::channelFanOut
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMemberCount
+	// Parameter: const uint32_t& inNonMemberCount
+	// Parameter: const uint32_t& inMessageCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool channelFanOut(
+		const serverTopology& inTopology,
+		const uint32_t& inMemberCount,
+		const uint32_t& inNonMemberCount,
+		const uint32_t& inMessageCount,
+		std::ostream& report);
+
+	//------------------------------------------------------------ sessionExpiry
+	// Brief Description
+	//  Connects clients to the first server with a short session timeout.
+	//  Half of them keep getting messages and the other half go silent.
+	//  Reports how long after connecting the silent ones are evicted and
+	//  forgotten by the last server, and checks that none of the active
+	//  ones are. Returns false if a silent client outlives the test or an
+	//  active one is evicted.
+	//
+	// Method:    sessionExpiry
+	// FullName:  clusterBenchmarks::sessionExpiry
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inClientCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool sessionExpiry(
+		const serverTopology& inTopology,
+		const uint32_t& inClientCount,
+		std::ostream& report);
+
+	//------------------------------------------------------------ backlogBounds
+	// Brief Description
+	//  Floods messages with a short time to live to a client that does not
+	//  exist and to one on the last server that never gets its messages.
+	//  Reports the peak backlog, how long it takes to drain after the last
+	//  send, and the messages dropped for each reason. Returns false if the
+	//  backlog never drains.
+	//
+	// Method:    backlogBounds
+	// FullName:  clusterBenchmarks::backlogBounds
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMessageCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool backlogBounds(
+		const serverTopology& inTopology,
+		const uint32_t& inMessageCount,
+		std::ostream& report);
+
+	//------------------------------------------------------------ spoolRecovery
+	// Brief Description
+	//  Fills the last server's backlog with messages for clients that do
+	//  not get them, first in memory only and then spooled, and reports
+	//  both times. The last server is then restarted. Reports how long the
+	//  restart takes, how many messages it recovered and delivered, and
+	//  the spool counters once they were ACKed. Returns false unless every
+	//  message was recovered and delivered.
+	//
+	// Method:    spoolRecovery
+	// FullName:  clusterBenchmarks::spoolRecovery
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inSinkCount
+	// Parameter: const uint32_t& inMessagesPerSink
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool spoolRecovery(
+		const serverTopology& inTopology,
+		const uint32_t& inSinkCount,
+		const uint32_t& inMessagesPerSink,
+		std::ostream& report);
+
+	//----------------------------------------------------------- messageTracing
+	// Brief Description
+	//  Sends messages from a client on the first server to one on the last
+	//  with every message traced, then reports the time each message
+	//  spends in each step of its path from the traces the servers wrote.
+	//  Returns false unless every message was delivered and traced.
+	//
+	// Method:    messageTracing
+	// FullName:  clusterBenchmarks::messageTracing
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMessageCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool messageTracing(
+		const serverTopology& inTopology,
+		const uint32_t& inMessageCount,
+		std::ostream& report);
+
+	//--------------------------------------------------------- captureAndReplay
+	// Brief Description
+	//  Sends messages from a client on the first server to one on the last
+	//  while the last server records the datagrams it receives, then
+	//  replays the capture into a fresh cluster at the speed it was taken
+	//  and as fast as possible, and reports both. Returns false unless
+	//  every message was delivered and every replay handled.
+	//
+	// Method:    captureAndReplay
+	// FullName:  clusterBenchmarks::captureAndReplay
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inMessageCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool captureAndReplay(
+		const serverTopology& inTopology,
+		const uint32_t& inMessageCount,
+		std::ostream& report);
+
+	//----------------------------------------------------------- simulatedSweep
+	// Brief Description
+	//  Simulates ten minutes of the topology's servers with clients sending
+	//  and moving between servers, over a network that loses, delays and
+	//  reorders datagrams, for combinations of the sync, forward and update
+	//  intervals. Reports for each how long moves take to be known
+	//  everywhere, the delivery latency and the datagrams sent. Returns
+	//  false if a move or message does not converge in any combination.
+	//
+	// Method:    simulatedSweep
+	// FullName:  clusterBenchmarks::simulatedSweep
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool simulatedSweep(
+		const serverTopology& inTopology,
+		std::ostream& report);
+
+	//------------------------------------------------------ membershipSummaries
+	// Brief Description
+	//  Connects clients to the first server, once with client lists synced
+	//  in full and once as Bloom filters. Reports the bytes of sync payload
+	//  the servers send per sync interval once the lists have converged, and
+	//  how many of the clients the last server knows, then restarts it.
+	//  Returns false unless it knows all of them, before and after.
+	//
+	// Method:    membershipSummaries
+	// FullName:  clusterBenchmarks::membershipSummaries
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inClientCount
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool membershipSummaries(
+		const serverTopology& inTopology,
+		const uint32_t& inClientCount,
+		std::ostream& report);
+
+	//------------------------------------------------------------ deliveryOrder
+	// Brief Description
+	//  Feeds a client's delivery buffer a sender's direct and broadcast
+	//  messages in different orders, one of them lost, and checks that each
+	//  direct message is shown after the one before it. Returns false if
+	//  any order is wrong.
+	//
+	// Method:    deliveryOrder
+	// FullName:  clusterBenchmarks::deliveryOrder
+	// Access:    public
+	// Returns:   bool
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool deliveryOrder(
+		std::ostream& report);
+
+	//----------------------------------------------------------- sessionLookups
+	// Brief Description
+	//  Connects clients to the first server and has them get their messages
+	//  by username, as clients that missed their session do, and then by
+	//  session. Reports the size of a get, the gets the server handled and
+	//  its handling latency, and the time a get spends looking its client up
+	//  by username and by session. Returns false if the two lookups find
+	//  different clients.
+	//
+	// Method:    sessionLookups
+	// FullName:  clusterBenchmarks::sessionLookups
+	// Access:    public
+	// Returns:   bool
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const uint32_t& inClientCount
+	// Parameter: const uint32_t& inGetsPerClient
+	// Parameter: std::ostream& report
+	//--------------------------------------------------------------------------
+	bool sessionLookups(
+		const serverTopology& inTopology,
+		const uint32_t& inClientCount,
+		const uint32_t& inGetsPerClient,
+		std::ostream& report);
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+// STL
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Project
+#include "clusterHarness.h"
+
+namespace
+{
+	//--------------------------------------------------------- impairmentScript
+	// Implementation notes:
+	//  Shared by every cluster, benchmarks run one cluster at a time
+	//--------------------------------------------------------------------------
+	std::vector<impairmentProxy::scriptStep>& impairmentScript()
+	{
+		static std::vector<impairmentProxy::scriptStep> script;
+
+		return script;
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Binding every listening port happens here, so a port that is already
+//  in use is reported before any server thread starts. In an impaired
+//  cluster, the proxy gives each server a topology of its own and the
+//  clients the last one.
+//------------------------------------------------------------------------------
+clusterHarness::clusterHarness(
+	const serverTopology& inTopology) :
+	m_topology(inTopology),
+	m_running(false),
+	m_serverTopologies(inTopology.numberOfServers(), inTopology)
+{
+	if(!impairmentScript().empty())
+	{
+		this->m_proxy.reset(
+			new impairmentProxy(impairmentScript()));
+
+		this->m_serverTopologies =
+			this->m_proxy->interpose(inTopology);
+
+		this->m_topology = this->m_serverTopologies.back();
+
+		this->m_serverTopologies.pop_back();
+	}
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
+	{
+		this->m_servers.push_back(new server(
+			this->m_serverTopologies[serverIndex],
+			serverIndex,
+			this->m_ioService));
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  Delete the servers once their threads are done with them
+//------------------------------------------------------------------------------
+clusterHarness::~clusterHarness()
+{
+	this->stop();
+
+	for(server* currentServer : this->m_servers)
+	{
+		delete currentServer;
+	}
+};
+
+//------------------------------------------------------------------------ start
+// Implementation notes:
+//  server::run() blocks until the server is stopped, hence one thread each
+//------------------------------------------------------------------------------
+void clusterHarness::start()
+{
+	if(this->m_running)
+	{
+		return;
+	}
+
+	if(this->m_proxy)
+	{
+		this->m_proxy->start();
+	}
+
+	for(server* currentServer : this->m_servers)
+	{
+		this->m_serverThreads.push_back(new boost::thread(
+			boost::bind(&server::run, currentServer)));
+	}
+
+	this->m_running = true;
+};
+
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  Stop all servers first so they wind down in parallel, then join. Servers
+//  that were killed have no thread left.
+//------------------------------------------------------------------------------
+void clusterHarness::stop()
+{
+	if(!this->m_running)
+	{
+		return;
+	}
+
+	for(server* currentServer : this->m_servers)
+	{
+		if(currentServer != nullptr)
+		{
+			currentServer->stop();
+		}
+	}
+
+	for(boost::thread* serverThread : this->m_serverThreads)
+	{
+		if(serverThread != nullptr)
+		{
+			serverThread->join();
+			delete serverThread;
+		}
+	}
+
+	this->m_serverThreads.clear();
+
+	if(this->m_proxy)
+	{
+		this->m_proxy->stop();
+	}
+
+	this->m_running = false;
+};
+
+//------------------------------------------------------------------- killServer
+// Implementation notes:
+//  Deleting the server closes its socket, so the port can be bound again
+//------------------------------------------------------------------------------
+void clusterHarness::killServer(
+	const int16_t& inServerIndex)
+{
+	this->m_servers[inServerIndex]->stop();
+
+	this->m_serverThreads[inServerIndex]->join();
+
+	delete this->m_serverThreads[inServerIndex];
+	this->m_serverThreads[inServerIndex] = nullptr;
+
+	delete this->m_servers[inServerIndex];
+	this->m_servers[inServerIndex] = nullptr;
+};
+
+//---------------------------------------------------------------- restartServer
+// Implementation notes:
+//  The new server starts with no clients and no knowledge of the others
+//------------------------------------------------------------------------------
+void clusterHarness::restartServer(
+	const int16_t& inServerIndex)
+{
+	this->m_servers[inServerIndex] = new server(
+		this->m_serverTopologies[inServerIndex],
+		inServerIndex,
+		this->m_ioService);
+
+	this->m_serverThreads[inServerIndex] = new boost::thread(
+		boost::bind(&server::run, this->m_servers[inServerIndex]));
+};
+
+//--------------------------------------------------------------------- serverAt
+// Implementation notes:
+//  Returns the server at the index
+//------------------------------------------------------------------------------
+server& clusterHarness::serverAt(
+	const int16_t& inServerIndex)
+{
+	return *this->m_servers[inServerIndex];
+};
+
+//----------------------------------------------------------------- viewTopology
+// Implementation notes:
+//  Returns a const reference to the topology
+//------------------------------------------------------------------------------
+const serverTopology& clusterHarness::viewTopology() const
+{
+	return this->m_topology;
+};
+
+//-------------------------------------------------------------------- viewProxy
+// Implementation notes:
+//  Returns a pointer to the proxy, if there is one
+//------------------------------------------------------------------------------
+const impairmentProxy* clusterHarness::viewProxy() const
+{
+	return this->m_proxy.get();
+};
+
+//-------------------------------------------------------------------- ioService
+// Implementation notes:
+//  Returns a reference to the io service
+//------------------------------------------------------------------------------
+boost::asio::io_service& clusterHarness::ioService()
+{
+	return this->m_ioService;
+};
+
+//------------------------------------------------------------- loopbackTopology
+// Implementation notes:
+//  The kernel picks each port; the probe sockets are kept open until every
+//  port is chosen so that no port is handed out twice.
+//------------------------------------------------------------------------------
+serverTopology clusterHarness::loopbackTopology(
+	const int16_t& inNumberOfServers)
+{
+	const serverTopology defaultTopology;
+
+	boost::asio::io_service ioService;
+	std::vector<boost::shared_ptr<boost::asio::ip::udp::socket>> probeSockets;
+
+	std::vector<std::string> serverNames;
+	std::vector<boost::asio::ip::udp::endpoint> serverEndpoints;
+
+	for(int16_t serverIndex = 0;
+		serverIndex < inNumberOfServers;
+		serverIndex++)
+	{
+		// keep the familiar names where there are enough of them
+		serverNames.push_back(
+			defaultTopology.serverIndexIsValid(serverIndex)
+			? defaultTopology.viewServerName(serverIndex)
+			: "Server" + std::to_string(serverIndex));
+
+		probeSockets.push_back(
+			boost::make_shared<boost::asio::ip::udp::socket>(
+				ioService,
+				boost::asio::ip::udp::endpoint(
+					boost::asio::ip::address_v4::loopback(), 0)));
+
+		serverEndpoints.push_back(
+			probeSockets.back()->local_endpoint());
+	}
+
+	return serverTopology(
+		serverNames,
+		serverEndpoints);
+};
+
+//----------------------------------------------------------- impairEveryCluster
+// Implementation notes:
+//  Clusters that already exist keep what they were created with
+//------------------------------------------------------------------------------
+void clusterHarness::impairEveryCluster(
+	const std::vector<impairmentProxy::scriptStep>& inScript)
+{
+	impairmentScript() = inScript;
+};
\ No newline at end of file
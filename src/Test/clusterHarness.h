@@ -0,0 +1,187 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "impairmentProxy.h"
+#include "../Server/server.h"
+#include "../Common/serverTopology.h"
+
+class clusterHarness
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the cluster harness. Every server of the topology
+	//  is created in this process, so all of its addresses should be local.
+	//  If every cluster is impaired, an impairment proxy is put between the
+	//  servers and in front of each of them.
+	//
+	// Method:    clusterHarness
+	// FullName:  clusterHarness::clusterHarness
+	// Access:    public
+	// Returns:
+	// Parameter: const serverTopology& inTopology
+	//--------------------------------------------------------------------------
+	clusterHarness(
+		const serverTopology& inTopology);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Stops the cluster if it is still running and deletes the servers.
+	//
+	// Method:    ~clusterHarness
+	// FullName:  clusterHarness::~clusterHarness
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~clusterHarness();
+
+	//-------------------------------------------------------------------- start
+	// Brief Description
+	//  Runs every server on its own thread.
+	//
+	// Method:    start
+	// FullName:  clusterHarness::start
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void start();
+
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Stops every server and waits for their threads to finish.
+	//
+	// Method:    stop
+	// FullName:  clusterHarness::stop
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stop();
+
+	//--------------------------------------------------------------- killServer
+	// Brief Description
+	//  Stops one server of a running cluster and releases its port, as if
+	//  the process had died. The other servers are not told.
+	//
+	// Method:    killServer
+	// FullName:  clusterHarness::killServer
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	void killServer(
+		const int16_t& inServerIndex);
+
+	//------------------------------------------------------------ restartServer
+	// Brief Description
+	//  Starts a fresh server in place of one that was killed.
+	//
+	// Method:    restartServer
+	// FullName:  clusterHarness::restartServer
+	// Access:    public
+	// Returns:   void
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	void restartServer(
+		const int16_t& inServerIndex);
+
+	//----------------------------------------------------------------- serverAt
+	// Brief Description
+	//  Returns the server with the given index.
+	//
+	// Method:    serverAt
+	// FullName:  clusterHarness::serverAt
+	// Access:    public
+	// Returns:   server&
+	// Parameter: const int16_t& inServerIndex
+	//--------------------------------------------------------------------------
+	server& serverAt(
+		const int16_t& inServerIndex);
+
+	//------------------------------------------------------------- viewTopology
+	// Brief Description
+	//  Returns the topology of this cluster, which scripted clients use to
+	//  find their server. In an impaired cluster the servers are at the
+	//  proxy's fronts.
+	//
+	// Method:    viewTopology
+	// FullName:  clusterHarness::viewTopology
+	// Access:    public
+	// Returns:   const serverTopology&
+	//--------------------------------------------------------------------------
+	const serverTopology& viewTopology() const;
+
+	//---------------------------------------------------------------- viewProxy
+	// Brief Description
+	//  Returns the impairment proxy of the cluster, or nullptr if it is not
+	//  impaired.
+	//
+	// Method:    viewProxy
+	// FullName:  clusterHarness::viewProxy
+	// Access:    public
+	// Returns:   const impairmentProxy*
+	//--------------------------------------------------------------------------
+	const impairmentProxy* viewProxy() const;
+
+	//---------------------------------------------------------------- ioService
+	// Brief Description
+	//  Returns the io service shared by the servers, for scripted clients.
+	//
+	// Method:    ioService
+	// FullName:  clusterHarness::ioService
+	// Access:    public
+	// Returns:   boost::asio::io_service&
+	//--------------------------------------------------------------------------
+	boost::asio::io_service& ioService();
+
+	//--------------------------------------------------------- loopbackTopology
+	// Brief Description
+	//  Creates a topology of inNumberOfServers servers on 127.0.0.1, each on
+	//  an ephemeral port that was free when this was called.
+	//
+	// Method:    loopbackTopology
+	// FullName:  clusterHarness::loopbackTopology
+	// Access:    public static
+	// Returns:   serverTopology
+	// Parameter: const int16_t& inNumberOfServers
+	//--------------------------------------------------------------------------
+	static serverTopology loopbackTopology(
+		const int16_t& inNumberOfServers);
+
+	//------------------------------------------------------- impairEveryCluster
+	// Brief Description
+	//  Makes every cluster created from now on impaired by the script. An
+	//  empty script stops impairing them.
+	//
+	// Method:    impairEveryCluster
+	// FullName:  clusterHarness::impairEveryCluster
+	// Access:    public static
+	// Returns:   void
+	// Parameter: const std::vector<impairmentProxy::scriptStep>& inScript
+	//--------------------------------------------------------------------------
+	static void impairEveryCluster(
+		const std::vector<impairmentProxy::scriptStep>& inScript);
+
+private:
+	// Member Variables
+	boost::asio::io_service m_ioService;
+	std::vector<boost::thread*> m_serverThreads;
+	std::vector<server*> m_servers;
+	serverTopology m_topology;
+	bool m_running;
+
+	// each server's own topology, which differs from the clients' when the
+	// cluster is impaired
+	std::vector<serverTopology> m_serverTopologies;
+	boost::scoped_ptr<impairmentProxy> m_proxy;
+};
\ No newline at end of file
@@ -0,0 +1,561 @@
+// STL
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+// Project
+#include "impairmentProxy.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ proxySocket
+// Implementation notes:
+//  What arrives on a socket is sent on from its out socket to its
+//  destination. A front has neither, it sends from the socket it keeps for
+//  each sender to its destination, the server it is in front of.
+//------------------------------------------------------------------------------
+class impairmentProxy::proxySocket
+{
+public:
+	proxySocket(
+		boost::asio::io_service& inIoService,
+		const uint16_t& inPort) :
+		m_socket(
+			inIoService,
+			boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), inPort)),
+		m_isFront(false),
+		m_outSocket(nullptr)
+	{
+	};
+
+	boost::asio::ip::udp::socket m_socket;
+	boost::asio::ip::udp::endpoint m_sender;
+
+	bool m_isFront;
+	proxySocket* m_outSocket;
+	boost::asio::ip::udp::endpoint m_destination;
+	std::map<boost::asio::ip::udp::endpoint, proxySocket*> m_socketBySender;
+};
+
+namespace
+{
+	//--------------------------------------------------------- loopbackEndpoint
+	// Implementation notes:
+	//  Where a socket bound to every address is reached from this computer
+	//--------------------------------------------------------------------------
+	boost::asio::ip::udp::endpoint loopbackEndpoint(
+		const boost::asio::ip::udp::socket& inSocket)
+	{
+		return boost::asio::ip::udp::endpoint(
+			boost::asio::ip::address_v4::loopback(),
+			inSocket.local_endpoint().port());
+	};
+}
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The metrics are looked up once, forwarding only updates them
+//------------------------------------------------------------------------------
+impairmentProxy::impairmentProxy(
+	const std::vector<scriptStep>& inScript,
+	const uint32_t& inSeed) :
+	m_script(inScript),
+	m_random(inSeed),
+	m_buffer(constants::receiveBufferLength),
+	m_received(m_metrics.addCounter("proxy.received")),
+	m_lost(m_metrics.addCounter("proxy.lost")),
+	m_duplicated(m_metrics.addCounter("proxy.duplicated")),
+	m_reordered(m_metrics.addCounter("proxy.reordered")),
+	m_forwarded(m_metrics.addCounter("proxy.forwarded")),
+	m_bytesForwarded(m_metrics.addCounter("proxy.bytes_forwarded")),
+	m_addedDelay(m_metrics.addHistogram("proxy.added_delay_us"))
+{
+	if(this->m_script.empty())
+	{
+		throw std::runtime_error("An impairment script needs at least one step");
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The thread must be gone before the sockets its handlers use
+//------------------------------------------------------------------------------
+impairmentProxy::~impairmentProxy()
+{
+	this->stop();
+};
+
+//--------------------------------------------------------------------- addFront
+// Implementation notes:
+//  The sockets for its senders are bound as they first send
+//------------------------------------------------------------------------------
+boost::asio::ip::udp::endpoint impairmentProxy::addFront(
+	const uint16_t& inListeningPort,
+	const boost::asio::ip::udp::endpoint& inTarget)
+{
+	proxySocket* front = this->bindSocket(
+		inListeningPort);
+
+	front->m_isFront = true;
+	front->m_destination = inTarget;
+
+	return loopbackEndpoint(front->m_socket);
+};
+
+//---------------------------------------------------------------------- addLink
+// Implementation notes:
+//  The second sees what the first sends come from the socket the second
+//  sends to, and the other way around
+//------------------------------------------------------------------------------
+std::pair<boost::asio::ip::udp::endpoint, boost::asio::ip::udp::endpoint> impairmentProxy::addLink(
+	const boost::asio::ip::udp::endpoint& inFirst,
+	const boost::asio::ip::udp::endpoint& inSecond)
+{
+	proxySocket* towardsSecond = this->bindSocket(0);
+	proxySocket* towardsFirst = this->bindSocket(0);
+
+	towardsSecond->m_outSocket = towardsFirst;
+	towardsSecond->m_destination = inSecond;
+
+	towardsFirst->m_outSocket = towardsSecond;
+	towardsFirst->m_destination = inFirst;
+
+	return std::make_pair(
+		loopbackEndpoint(towardsSecond->m_socket),
+		loopbackEndpoint(towardsFirst->m_socket));
+};
+
+//-------------------------------------------------------------------- interpose
+// Implementation notes:
+//  Every pair is linked whatever the routing mode, so routes that change
+//  when a server goes down are impaired too
+//------------------------------------------------------------------------------
+std::vector<serverTopology> impairmentProxy::interpose(
+	const serverTopology& inTopology)
+{
+	const int16_t numberOfServers = inTopology.numberOfServers();
+
+	std::vector<serverTopology> outTopologies(
+		numberOfServers + 1,
+		inTopology);
+
+	for(int16_t serverIndex = 0; serverIndex < numberOfServers; serverIndex++)
+	{
+		outTopologies[numberOfServers].setServerEndpoint(
+			serverIndex,
+			this->addFront(0, inTopology.viewServerEndpoint(serverIndex)));
+
+		for(int16_t otherIndex = serverIndex + 1; otherIndex < numberOfServers; otherIndex++)
+		{
+			const std::pair<boost::asio::ip::udp::endpoint, boost::asio::ip::udp::endpoint> link =
+				this->addLink(
+					inTopology.viewServerEndpoint(serverIndex),
+					inTopology.viewServerEndpoint(otherIndex));
+
+			outTopologies[serverIndex].setServerEndpoint(
+				otherIndex,
+				link.first);
+
+			outTopologies[otherIndex].setServerEndpoint(
+				serverIndex,
+				link.second);
+		}
+	}
+
+	return outTopologies;
+};
+
+//------------------------------------------------------------------------ start
+// Implementation notes:
+//  The work keeps the io service running while nothing is pending
+//------------------------------------------------------------------------------
+void impairmentProxy::start()
+{
+	if(this->m_thread)
+	{
+		return;
+	}
+
+	this->m_ioService.reset();
+
+	this->m_startTime = boost::chrono::steady_clock::now();
+
+	for(const boost::shared_ptr<proxySocket>& currentSocket : this->m_sockets)
+	{
+		this->receiveNext(
+			currentSocket.get());
+	}
+
+	this->m_work.reset(
+		new boost::asio::io_service::work(this->m_ioService));
+
+	this->m_thread.reset(
+		new boost::thread(boost::bind(&impairmentProxy::forwardLoop, this)));
+};
+
+//------------------------------------------------------------------------- stop
+// Implementation notes:
+//  Stopping the io service abandons the pending receives and timers
+//------------------------------------------------------------------------------
+void impairmentProxy::stop()
+{
+	if(!this->m_thread)
+	{
+		return;
+	}
+
+	this->m_work.reset();
+
+	this->m_ioService.stop();
+
+	this->m_thread->join();
+	this->m_thread.reset();
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  The counters are updated without a lock, see metricsRegistry
+//------------------------------------------------------------------------------
+std::string impairmentProxy::asString() const
+{
+	return this->m_metrics.asString();
+};
+
+//------------------------------------------------------------------ parseScript
+// Implementation notes:
+//  A script that starts after 0 starts unimpaired
+//------------------------------------------------------------------------------
+std::vector<impairmentProxy::scriptStep> impairmentProxy::parseScript(
+	const std::string& inScript)
+{
+	std::vector<scriptStep> outScript;
+
+	impairmentProfile profile;
+
+	std::string scriptWithoutComments("");
+
+	{
+		std::stringstream lines(inScript);
+		std::string line("");
+
+		while(std::getline(lines, line))
+		{
+			scriptWithoutComments += line.substr(0, line.find('#')) + ";";
+		}
+	}
+
+	std::stringstream steps(scriptWithoutComments);
+	std::string step("");
+
+	while(std::getline(steps, step, ';'))
+	{
+		if(step.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::stringstream fields(step);
+
+		double atSeconds = 0.0;
+
+		if(!(fields >> atSeconds) || atSeconds < 0.0)
+		{
+			throw std::runtime_error("Invalid impairment step '" + step + "'");
+		}
+
+		const uint32_t atMilliseconds = static_cast<uint32_t>(atSeconds * 1000.0);
+
+		if(!outScript.empty() && atMilliseconds <= outScript.back().m_atMilliseconds)
+		{
+			throw std::runtime_error("Impairment step '" + step + "' is not after the one before");
+		}
+
+		std::string setting("");
+
+		while(fields >> setting)
+		{
+			bool valid = false;
+
+			if(setting == "loss")
+			{
+				valid = static_cast<bool>(fields >> profile.m_lossPercent);
+			}
+			else if(setting == "delay")
+			{
+				valid = static_cast<bool>(fields >> profile.m_delayMilliseconds);
+			}
+			else if(setting == "jitter")
+			{
+				valid = static_cast<bool>(fields >> profile.m_jitterMilliseconds);
+			}
+			else if(setting == "duplicate")
+			{
+				valid = static_cast<bool>(fields >> profile.m_duplicatePercent);
+			}
+			else if(setting == "reorder")
+			{
+				valid = static_cast<bool>(fields >> profile.m_reorderPercent >> profile.m_reorderMilliseconds);
+			}
+
+			if(!valid)
+			{
+				throw std::runtime_error("Invalid impairment step '" + step + "'");
+			}
+		}
+
+		if(outScript.empty() && atMilliseconds > 0)
+		{
+			outScript.push_back(scriptStep(
+				0,
+				impairmentProfile()));
+		}
+
+		outScript.push_back(scriptStep(
+			atMilliseconds,
+			profile));
+	}
+
+	return outScript;
+};
+
+//------------------------------------------------------------------ forwardLoop
+// Implementation notes:
+//  Every handler runs on this thread, so they share the generator and the
+//  sockets without a lock
+//------------------------------------------------------------------------------
+void impairmentProxy::forwardLoop()
+{
+	this->m_ioService.run();
+};
+
+//------------------------------------------------------------------ receiveNext
+// Implementation notes:
+//  One wait is pending per socket at a time. The datagram is only read
+//  once it is there, into the shared buffer, so a front with thousands of
+//  senders does not hold a buffer per sender.
+//------------------------------------------------------------------------------
+void impairmentProxy::receiveNext(
+	proxySocket* inSocket)
+{
+	inSocket->m_socket.async_wait(
+		boost::asio::ip::udp::socket::wait_read,
+		boost::bind(
+			&impairmentProxy::handleReceive,
+			this,
+			inSocket,
+			boost::asio::placeholders::error));
+};
+
+//---------------------------------------------------------------- handleReceive
+// Implementation notes:
+//  Errors such as a refused send to a server that is down are reported on
+//  the next receive, the socket keeps receiving after them. A duplicate
+//  draws its own delay, so it may arrive before the original.
+//------------------------------------------------------------------------------
+void impairmentProxy::handleReceive(
+	proxySocket* inSocket,
+	const boost::system::error_code& inError)
+{
+	if(inError == boost::asio::error::operation_aborted)
+	{
+		return;
+	}
+
+	boost::system::error_code error(inError);
+
+	size_t length = 0;
+
+	if(!error)
+	{
+		length = inSocket->m_socket.receive_from(
+			boost::asio::buffer(this->m_buffer),
+			inSocket->m_sender,
+			0,
+			error);
+	}
+
+	if(error && error != boost::asio::error::message_size)
+	{
+		this->receiveNext(
+			inSocket);
+
+		return;
+	}
+
+	this->m_received.add();
+
+	proxySocket* outSocket = inSocket->m_outSocket;
+	boost::asio::ip::udp::endpoint destination = inSocket->m_destination;
+
+	if(inSocket->m_isFront)
+	{
+		proxySocket*& senderSocket = inSocket->m_socketBySender[inSocket->m_sender];
+
+		if(senderSocket == nullptr)
+		{
+			senderSocket = this->bindSocket(0);
+
+			senderSocket->m_outSocket = inSocket;
+			senderSocket->m_destination = inSocket->m_sender;
+
+			this->receiveNext(
+				senderSocket);
+		}
+
+		outSocket = senderSocket;
+	}
+
+	const payloadPointer payload(boost::make_shared<std::vector<char>>(
+		this->m_buffer.begin(),
+		this->m_buffer.begin() + length));
+
+	const impairmentProfile& profile = this->currentProfile();
+
+	std::uniform_real_distribution<double> percent(0.0, 100.0);
+
+	if(percent(this->m_random) < profile.m_lossPercent)
+	{
+		this->m_lost.add();
+	}
+	else
+	{
+		uint16_t copies = 1;
+
+		if(percent(this->m_random) < profile.m_duplicatePercent)
+		{
+			this->m_duplicated.add();
+			copies++;
+		}
+
+		for(uint16_t copy = 0; copy < copies; copy++)
+		{
+			std::uniform_int_distribution<int64_t> jitter(
+				-static_cast<int64_t>(profile.m_jitterMilliseconds) * 1000,
+				static_cast<int64_t>(profile.m_jitterMilliseconds) * 1000);
+
+			int64_t delayMicroseconds = std::max<int64_t>(
+				0,
+				static_cast<int64_t>(profile.m_delayMilliseconds) * 1000 + jitter(this->m_random));
+
+			if(percent(this->m_random) < profile.m_reorderPercent)
+			{
+				this->m_reordered.add();
+
+				delayMicroseconds += static_cast<int64_t>(profile.m_reorderMilliseconds) * 1000;
+			}
+
+			this->m_addedDelay.record(
+				static_cast<uint64_t>(delayMicroseconds));
+
+			if(delayMicroseconds == 0)
+			{
+				this->forward(
+					outSocket,
+					payload,
+					destination);
+
+				continue;
+			}
+
+			boost::shared_ptr<boost::asio::deadline_timer> timer(
+				new boost::asio::deadline_timer(
+					this->m_ioService,
+					boost::posix_time::microseconds(delayMicroseconds)));
+
+			timer->async_wait(boost::bind(
+				&impairmentProxy::handleDelay,
+				this,
+				timer,
+				outSocket,
+				payload,
+				destination,
+				boost::asio::placeholders::error));
+		}
+	}
+
+	this->receiveNext(
+		inSocket);
+};
+
+//---------------------------------------------------------------------- forward
+// Implementation notes:
+//  A datagram that cannot be sent is lost, as it would be on the network
+//------------------------------------------------------------------------------
+void impairmentProxy::forward(
+	proxySocket* inSocket,
+	const payloadPointer& inPayload,
+	const boost::asio::ip::udp::endpoint& inDestination)
+{
+	boost::system::error_code error;
+
+	inSocket->m_socket.send_to(
+		boost::asio::buffer(*inPayload),
+		inDestination, 0, error);
+
+	if(!error)
+	{
+		this->m_forwarded.add();
+		this->m_bytesForwarded.add(inPayload->size());
+	}
+};
+
+//------------------------------------------------------------------ handleDelay
+// Implementation notes:
+//  The timer is kept alive by the handler until it fires
+//------------------------------------------------------------------------------
+void impairmentProxy::handleDelay(
+	// only bound so the shared_ptr keeps the timer alive until this runs
+	const boost::shared_ptr<boost::asio::deadline_timer>&,
+	proxySocket* inSocket,
+	const payloadPointer& inPayload,
+	const boost::asio::ip::udp::endpoint& inDestination,
+	const boost::system::error_code& inError)
+{
+	if(inError)
+	{
+		return;
+	}
+
+	this->forward(
+		inSocket,
+		inPayload,
+		inDestination);
+};
+
+//--------------------------------------------------------------- currentProfile
+// Implementation notes:
+//  The last step that has started, scripts are short
+//------------------------------------------------------------------------------
+const impairmentProxy::impairmentProfile& impairmentProxy::currentProfile() const
+{
+	const uint64_t elapsedMilliseconds =
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::steady_clock::now() - this->m_startTime).count();
+
+	size_t stepIndex = 0;
+
+	while(stepIndex + 1 < this->m_script.size()
+		&& this->m_script[stepIndex + 1].m_atMilliseconds <= elapsedMilliseconds)
+	{
+		stepIndex++;
+	}
+
+	return this->m_script[stepIndex].m_profile;
+};
+
+//------------------------------------------------------------------- bindSocket
+// Implementation notes:
+//  Bound to every address, so clients on other computers can use a front
+//------------------------------------------------------------------------------
+impairmentProxy::proxySocket* impairmentProxy::bindSocket(
+	const uint16_t& inPort)
+{
+	this->m_sockets.push_back(boost::make_shared<proxySocket>(
+		this->m_ioService,
+		inPort));
+
+	return this->m_sockets.back().get();
+};
\ No newline at end of file
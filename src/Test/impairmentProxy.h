@@ -0,0 +1,267 @@
+#pragma once
+
+// STL
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/chrono.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// Project
+#include "../Common/metricsRegistry.h"
+#include "../Common/serverTopology.h"
+
+// Forwards UDP datagrams between clients and servers, and between servers,
+// losing, delaying, duplicating and reordering them as a script says.
+//
+// In front of a server, the proxy listens on a port of its own and
+// forwards what it receives to the server from one socket per sender, so
+// the server's replies can be returned to the right sender.
+//
+// Between two servers, a server identifies the server a relay came from by
+// the address it came from, so each pair of servers gets a pair of
+// sockets. Each server is told the other is at one of them, and what
+// arrives on one is sent on from the other.
+class impairmentProxy
+{
+public:
+
+	class impairmentProfile
+	{
+	public:
+		impairmentProfile() :
+			m_lossPercent(0.0),
+			m_delayMilliseconds(0),
+			m_jitterMilliseconds(0),
+			m_duplicatePercent(0.0),
+			m_reorderPercent(0.0),
+			m_reorderMilliseconds(0)
+		{
+		};
+
+		// each datagram is lost, or delayed by the delay plus or minus up
+		// to the jitter. A duplicate is delayed on its own, and a datagram
+		// that is reordered is held back for longer.
+		double m_lossPercent;
+		uint32_t m_delayMilliseconds;
+		uint32_t m_jitterMilliseconds;
+		double m_duplicatePercent;
+		double m_reorderPercent;
+		uint32_t m_reorderMilliseconds;
+	};
+
+	class scriptStep
+	{
+	public:
+		scriptStep(
+			const uint32_t& inAtMilliseconds,
+			const impairmentProfile& inProfile) :
+			m_atMilliseconds(inAtMilliseconds),
+			m_profile(inProfile)
+		{
+		};
+
+		// since the proxy started
+		uint32_t m_atMilliseconds;
+		impairmentProfile m_profile;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a proxy that follows the script, which must have at
+	//  least one step. Nothing is bound until sockets are added.
+	//
+	// Method:    impairmentProxy
+	// FullName:  impairmentProxy::impairmentProxy
+	// Access:    public
+	// Returns:
+	// Parameter: const std::vector<scriptStep>& inScript
+	// Parameter: const uint32_t& inSeed
+	//--------------------------------------------------------------------------
+	impairmentProxy(
+		const std::vector<scriptStep>& inScript,
+		const uint32_t& inSeed = 1);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Destructor, stops the proxy if it is running.
+	//
+	// Method:    ~impairmentProxy
+	// FullName:  impairmentProxy::~impairmentProxy
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~impairmentProxy();
+
+	//----------------------------------------------------------------- addFront
+	// Brief Description
+	//  Listens on the port, or one the system picks for 0, and forwards what
+	//  arrives to the target. Returns the endpoint to send to instead of the
+	//  target.
+	//
+	// Method:    addFront
+	// FullName:  impairmentProxy::addFront
+	// Access:    public
+	// Returns:   boost::asio::ip::udp::endpoint
+	// Parameter: const uint16_t& inListeningPort
+	// Parameter: const boost::asio::ip::udp::endpoint& inTarget
+	//--------------------------------------------------------------------------
+	boost::asio::ip::udp::endpoint addFront(
+		const uint16_t& inListeningPort,
+		const boost::asio::ip::udp::endpoint& inTarget);
+
+	//------------------------------------------------------------------ addLink
+	// Brief Description
+	//  Binds a pair of sockets between the two endpoints. Returns the
+	//  endpoint the first should send to instead of the second, then the
+	//  one the second should send to instead of the first.
+	//
+	// Method:    addLink
+	// FullName:  impairmentProxy::addLink
+	// Access:    public
+	// Returns:   std::pair<boost::asio::ip::udp::endpoint, boost::asio::ip::udp::endpoint>
+	// Parameter: const boost::asio::ip::udp::endpoint& inFirst
+	// Parameter: const boost::asio::ip::udp::endpoint& inSecond
+	//--------------------------------------------------------------------------
+	std::pair<boost::asio::ip::udp::endpoint, boost::asio::ip::udp::endpoint> addLink(
+		const boost::asio::ip::udp::endpoint& inFirst,
+		const boost::asio::ip::udp::endpoint& inSecond);
+
+	//---------------------------------------------------------------- interpose
+	// Brief Description
+	//  Adds a front for every server of the topology and a link between
+	//  every pair of them, and returns the topology each server should be
+	//  given: its own endpoint, and the links for the others. The topology
+	//  for clients, with the fronts, is the one at the number of servers.
+	//
+	// Method:    interpose
+	// FullName:  impairmentProxy::interpose
+	// Access:    public
+	// Returns:   std::vector<serverTopology>
+	// Parameter: const serverTopology& inTopology
+	//--------------------------------------------------------------------------
+	std::vector<serverTopology> interpose(
+		const serverTopology& inTopology);
+
+	//-------------------------------------------------------------------- start
+	// Brief Description
+	//  Starts forwarding on a thread of its own. The script starts now.
+	//
+	// Method:    start
+	// FullName:  impairmentProxy::start
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void start();
+
+	//--------------------------------------------------------------------- stop
+	// Brief Description
+	//  Stops forwarding. Datagrams still being delayed are dropped.
+	//
+	// Method:    stop
+	// FullName:  impairmentProxy::stop
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void stop();
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns what the proxy did so far: the datagrams received, lost,
+	//  duplicated, reordered and forwarded, the bytes forwarded and the
+	//  delays added, one metric per line.
+	//
+	// Method:    asString
+	// FullName:  impairmentProxy::asString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asString() const;
+
+	//-------------------------------------------------------------- parseScript
+	// Brief Description
+	//  Reads a script, one step per line or separated by ';'. A step is the
+	//  second it starts at, then any of
+	//
+	//    loss <percent>
+	//    delay <ms>
+	//    jitter <ms>
+	//    duplicate <percent>
+	//    reorder <percent> <ms>
+	//
+	//  Settings a step leaves out keep their value from the step before.
+	//  '#' starts a comment. Throws a std::runtime_error naming the
+	//  offending step if the script is invalid.
+	//
+	// Method:    parseScript
+	// FullName:  impairmentProxy::parseScript
+	// Access:    public
+	// Returns:   std::vector<impairmentProxy::scriptStep>
+	// Parameter: const std::string& inScript
+	//--------------------------------------------------------------------------
+	static std::vector<scriptStep> parseScript(
+		const std::string& inScript);
+
+private:
+
+	class proxySocket;
+
+	typedef boost::shared_ptr<std::vector<char>> payloadPointer;
+
+	void forwardLoop();
+
+	void receiveNext(
+		proxySocket* inSocket);
+
+	void handleReceive(
+		proxySocket* inSocket,
+		const boost::system::error_code& inError);
+
+	void forward(
+		proxySocket* inSocket,
+		const payloadPointer& inPayload,
+		const boost::asio::ip::udp::endpoint& inDestination);
+
+	void handleDelay(
+		const boost::shared_ptr<boost::asio::deadline_timer>& inTimer,
+		proxySocket* inSocket,
+		const payloadPointer& inPayload,
+		const boost::asio::ip::udp::endpoint& inDestination,
+		const boost::system::error_code& inError);
+
+	const impairmentProfile& currentProfile() const;
+
+	proxySocket* bindSocket(
+		const uint16_t& inPort);
+
+	// Member Variables
+	boost::asio::io_service m_ioService;
+	// new senders to a front get sockets while forwarding
+	std::vector<boost::shared_ptr<proxySocket>> m_sockets;
+	std::vector<scriptStep> m_script;
+	std::mt19937 m_random;
+	boost::chrono::steady_clock::time_point m_startTime;
+	boost::scoped_ptr<boost::asio::io_service::work> m_work;
+	boost::scoped_ptr<boost::thread> m_thread;
+
+	// every handler runs on the forwarding thread, so one buffer as large
+	// as a datagram can be serves every socket
+	std::vector<char> m_buffer;
+
+	metricsRegistry m_metrics;
+	metricsRegistry::counter& m_received;
+	metricsRegistry::counter& m_lost;
+	metricsRegistry::counter& m_duplicated;
+	metricsRegistry::counter& m_reordered;
+	metricsRegistry::counter& m_forwarded;
+	metricsRegistry::counter& m_bytesForwarded;
+	metricsRegistry::latencyHistogram& m_addedDelay;
+};
\ No newline at end of file
@@ -0,0 +1,1885 @@
+// STL
+#include <algorithm>
+#include <list>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Project
+#include "protocolSimulator.h"
+#include "../Common/dataMessage.h"
+#include "../Common/encodedMessage.h"
+#include "../Common/metricsRegistry.h"
+#include "../Server/bloomFilter.h"
+#include "../Server/reliableLink.h"
+#include "../Server/routingTable.h"
+
+namespace
+{
+	typedef boost::shared_ptr<const std::set<uint32_t>> clientList;
+
+	enum DatagramType
+	{
+		dt_SYNC,
+		dt_SUMMARY,
+		dt_LIST_REQUEST,
+		dt_UPDATE,
+		dt_CLIENT_SEND,
+		dt_SERVER_ACK,
+		dt_CLIENT_GET,
+		dt_DELIVERY,
+		dt_CLIENT_ACK,
+		dt_RELAY,
+		dt_RELAY_ACK
+	};
+
+	enum EventType
+	{
+		et_DATAGRAM,
+		et_SYNC,
+		et_FORWARD,
+		et_POLL,
+		et_RETRANSMIT,
+		et_SEND,
+		et_RECONNECT
+	};
+
+	const int64_t microsecondsPerMillisecond = 1000;
+
+	//---------------------------------------------------------- timeOfLinkClock
+	// Implementation notes:
+	//  The reliable links take steady clock times, virtual times are passed
+	//  to them as that long after the clock's epoch
+	//--------------------------------------------------------------------------
+	reliableLink::linkClock::time_point timeOfLinkClock(
+		const int64_t& inMicroseconds)
+	{
+		return reliableLink::linkClock::time_point(
+			boost::chrono::microseconds(inMicroseconds));
+	};
+
+	//------------------------------------------------------------- nameOfClient
+	// Implementation notes:
+	//  Clients are named by their index, so relays can carry them
+	//--------------------------------------------------------------------------
+	std::string nameOfClient(
+		const uint32_t& inClientIndex)
+	{
+		return "c" + std::to_string(inClientIndex);
+	};
+
+	//------------------------------------------------------------- listLength
+	// Implementation notes:
+	//  The bytes the names of the list take in a sync, each with its
+	//  delimiter
+	//--------------------------------------------------------------------------
+	size_t listLength(
+		const std::set<uint32_t>& inList)
+	{
+		size_t outLength = 0;
+
+		for(const uint32_t& clientIndex : inList)
+		{
+			outLength += nameOfClient(clientIndex).size() + 1;
+		}
+
+		return outLength;
+	};
+}
+
+
+//-------------------------------------------------------------- simulationState
+// Implementation notes:
+//  Everything of a run. Events at the same time are processed in the order
+//  they were scheduled, which with the seeded generator makes runs
+//  repeatable.
+//------------------------------------------------------------------------------
+class protocolSimulator::simulationState
+{
+public:
+
+	// what is sent, only the fields of its type are used
+	class simulatedDatagram
+	{
+	public:
+		simulatedDatagram(
+			const DatagramType& inType) :
+			m_type(inType),
+			m_fromServer(-1),
+			m_origin(-1),
+			m_version(0),
+			m_part(0),
+			m_partCount(1),
+			m_count(0),
+			m_joined(false),
+			m_client(0),
+			m_sequenceNumber(0),
+			m_messageIdentifier(0),
+			m_destination(0)
+		{
+		};
+
+		DatagramType m_type;
+
+		// -1 if a client sent it
+		int16_t m_fromServer;
+
+		// syncs, summaries, list requests and updates. A sync carries the
+		// names of its part of the list, a summary the filter and the
+		// number of names it was built from.
+		int16_t m_origin;
+		int64_t m_version;
+		clientList m_list;
+		uint16_t m_part;
+		uint16_t m_partCount;
+		uint32_t m_count;
+		boost::shared_ptr<const bloomFilter> m_filter;
+		bool m_joined;
+
+		// the client sending, or the subject of an update
+		uint32_t m_client;
+		int64_t m_sequenceNumber;
+		uint64_t m_messageIdentifier;
+		uint32_t m_destination;
+
+		// relays and their ACKs are real messages
+		std::vector<char> m_encodedRelay;
+		boost::shared_ptr<const dataMessage> m_acknowledgement;
+	};
+
+	typedef boost::shared_ptr<const simulatedDatagram> datagramPointer;
+
+	class simulatedEvent
+	{
+	public:
+		simulatedEvent(
+			const int64_t& inMicroseconds,
+			const uint64_t& inOrder,
+			const EventType& inType,
+			const uint32_t& inTarget,
+			const bool& inTargetIsClient,
+			const int64_t& inValue,
+			const datagramPointer& inDatagram) :
+			m_microseconds(inMicroseconds),
+			m_order(inOrder),
+			m_type(inType),
+			m_target(inTarget),
+			m_targetIsClient(inTargetIsClient),
+			m_value(inValue),
+			m_datagram(inDatagram)
+		{
+		};
+
+		// the queue takes the greatest first, so the earliest is greatest
+		bool operator<(
+			const simulatedEvent& inOther) const
+		{
+			if(this->m_microseconds != inOther.m_microseconds)
+			{
+				return this->m_microseconds > inOther.m_microseconds;
+			}
+
+			return this->m_order > inOther.m_order;
+		};
+
+		int64_t m_microseconds;
+		uint64_t m_order;
+		EventType m_type;
+		uint32_t m_target;
+		bool m_targetIsClient;
+		int64_t m_value;
+		datagramPointer m_datagram;
+	};
+
+	class heldMessage
+	{
+	public:
+		heldMessage(
+			const uint64_t& inMessageIdentifier,
+			const uint32_t& inDestination,
+			const uint16_t& inHopCount,
+			const uint16_t& inAttempts) :
+			m_messageIdentifier(inMessageIdentifier),
+			m_destination(inDestination),
+			m_hopCount(inHopCount),
+			m_attempts(inAttempts)
+		{
+		};
+
+		uint64_t m_messageIdentifier;
+		uint32_t m_destination;
+		uint16_t m_hopCount;
+		uint16_t m_attempts;
+	};
+
+	// the parts of a list received so far, as server::listAssembly
+	class listAssembly
+	{
+	public:
+		listAssembly() :
+			m_version(0),
+			m_partsReceived(0)
+		{
+		};
+
+		int64_t m_version;
+		std::vector<clientList> m_parts;
+		uint16_t m_partsReceived;
+	};
+
+	class simulatedServer
+	{
+	public:
+		simulatedServer(
+			const serverTopology& inTopology,
+			const int16_t& inServerIndex) :
+			m_routingTable(inTopology, inServerIndex),
+			m_versions(inTopology.numberOfServers(), 1),
+			m_lists(inTopology.numberOfServers()),
+			m_assemblies(inTopology.numberOfServers()),
+			m_filters(inTopology.numberOfServers()),
+			m_listRequestTimes(inTopology.numberOfServers(), -1),
+			m_retryHeldMessagesNow(false)
+		{
+			for(int16_t serverIndex = 0;
+				serverIndex < inTopology.numberOfServers();
+				serverIndex++)
+			{
+				this->m_links.push_back(reliableLink(
+					inTopology.viewServerName(inServerIndex),
+					inTopology.viewServerName(serverIndex),
+					1));
+			}
+		};
+
+		routingTable m_routingTable;
+		std::vector<reliableLink> m_links;
+
+		// every server's clients as this server knows them, its own included
+		std::vector<int64_t> m_versions;
+		std::vector<clientList> m_lists;
+		std::vector<listAssembly> m_assemblies;
+
+		// the last summary of each list, and when it was last asked for
+		std::vector<bloomFilter> m_filters;
+		std::vector<int64_t> m_listRequestTimes;
+
+		std::map<uint32_t, std::list<uint64_t>> m_messagesByClient;
+		std::multimap<int64_t, heldMessage> m_heldMessages;
+		std::set<std::pair<uint32_t, int64_t>> m_sendsReceived;
+		bool m_retryHeldMessagesNow;
+	};
+
+	class simulatedClient
+	{
+	public:
+		simulatedClient(
+			const int16_t& inServerIndex) :
+			m_serverIndex(inServerIndex),
+			m_nextSequenceNumber(1)
+		{
+		};
+
+		int16_t m_serverIndex;
+		int64_t m_nextSequenceNumber;
+
+		// message identifier and retransmit timer by sequence number
+		std::map<int64_t, std::pair<uint64_t, int64_t>> m_unacknowledged;
+		std::set<uint64_t> m_received;
+	};
+
+	class sentMessage
+	{
+	public:
+		sentMessage(
+			const uint32_t& inDestination,
+			const int64_t& inSentMicroseconds) :
+			m_destination(inDestination),
+			m_sentMicroseconds(inSentMicroseconds)
+		{
+		};
+
+		uint32_t m_destination;
+		int64_t m_sentMicroseconds;
+	};
+
+	class pendingMove
+	{
+	public:
+		pendingMove(
+			const int64_t& inStartMicroseconds,
+			const int16_t& inServerIndex) :
+			m_startMicroseconds(inStartMicroseconds),
+			m_serverIndex(inServerIndex)
+		{
+		};
+
+		int64_t m_startMicroseconds;
+		int16_t m_serverIndex;
+	};
+
+	simulationState(
+		const serverTopology& inTopology,
+		const simulationParameters& inParameters) :
+		m_topology(inTopology),
+		m_parameters(inParameters),
+		m_random(inParameters.m_seed),
+		m_now(0),
+		m_eventOrder(0),
+		m_eventCount(0),
+		m_datagramsSent(0),
+		m_datagramsLost(0),
+		m_syncPayloadBytes(0),
+		m_listRequests(0),
+		m_messagesDelivered(0),
+		m_movesStarted(0),
+		m_convergence(m_results.addHistogram("convergence")),
+		m_delivery(m_results.addHistogram("delivery"))
+	{
+	};
+
+	void schedule(
+		const int64_t& inDelayMicroseconds,
+		const EventType& inType,
+		const uint32_t& inTarget,
+		const bool& inTargetIsClient,
+		const int64_t& inValue = 0,
+		const datagramPointer& inDatagram = datagramPointer());
+
+	void sendDatagram(
+		const boost::shared_ptr<simulatedDatagram>& inDatagram,
+		const uint32_t& inTarget,
+		const bool& inTargetIsClient);
+
+	void processEvent(
+		const simulatedEvent& inEvent);
+
+	void serverReceive(
+		const int16_t& inServerIndex,
+		const simulatedDatagram& inDatagram);
+
+	void clientReceive(
+		const uint32_t& inClientIndex,
+		const simulatedDatagram& inDatagram);
+
+	int16_t lookupServerIndexOfClient(
+		const int16_t& inServerIndex,
+		const uint32_t& inClientIndex) const;
+
+	void routeMessage(
+		const int16_t& inServerIndex,
+		const uint64_t& inMessageIdentifier,
+		const uint32_t& inDestination,
+		const uint16_t& inHopCount,
+		const bool& inEnforceHopLimit);
+
+	void relayToServer(
+		const int16_t& inServerIndex,
+		const int16_t& inNextHop,
+		const uint64_t& inMessageIdentifier,
+		const uint32_t& inDestination,
+		const uint16_t& inHopCount);
+
+	void flushServerLink(
+		const int16_t& inServerIndex,
+		const int16_t& inPeerIndex);
+
+	void attemptForward(
+		const int16_t& inServerIndex);
+
+	void sendSyncPayloads(
+		const int16_t& inServerIndex);
+
+	void sendClientList(
+		const int16_t& inServerIndex,
+		const int16_t& inOriginIndex,
+		const int16_t& inNeighbourIndex);
+
+	bool assembleClientList(
+		listAssembly& inAssembly,
+		const simulatedDatagram& inSync,
+		clientList& outList);
+
+	void requestClientList(
+		const int16_t& inServerIndex,
+		const int16_t& inOriginIndex);
+
+	void publishMembershipChange(
+		const int16_t& inServerIndex,
+		const uint32_t& inClientIndex,
+		const bool& inJoined);
+
+	void forwardMembershipUpdate(
+		const int16_t& inServerIndex,
+		const simulatedDatagram& inUpdate);
+
+	void sendFromClient(
+		const uint32_t& inClientIndex,
+		const int64_t& inSequenceNumber);
+
+	void reconnectClient(
+		const uint32_t& inClientIndex,
+		const int16_t& inServerIndex);
+
+	void checkConvergence();
+
+	int64_t exponentialDelay(
+		const double& inPerSecond);
+
+	// the topology is kept here, the routing tables refer to it
+	const serverTopology m_topology;
+	const simulationParameters m_parameters;
+	std::mt19937 m_random;
+
+	int64_t m_now;
+	uint64_t m_eventOrder;
+	uint64_t m_eventCount;
+	std::priority_queue<simulatedEvent> m_events;
+
+	std::vector<boost::shared_ptr<simulatedServer>> m_servers;
+	std::vector<simulatedClient> m_clients;
+	std::vector<sentMessage> m_messages;
+
+	uint64_t m_datagramsSent;
+	uint64_t m_datagramsLost;
+	uint64_t m_syncPayloadBytes;
+	uint64_t m_listRequests;
+	uint64_t m_messagesDelivered;
+	uint64_t m_movesStarted;
+
+	// clients that moved, until every server knows where to
+	std::map<uint32_t, pendingMove> m_pendingMoves;
+
+	// both in microseconds
+	metricsRegistry m_results;
+	metricsRegistry::latencyHistogram& m_convergence;
+	metricsRegistry::latencyHistogram& m_delivery;
+};
+
+//--------------------------------------------------------------------- schedule
+// Implementation notes:
+//  The order breaks ties between events at the same time
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::schedule(
+	const int64_t& inDelayMicroseconds,
+	const EventType& inType,
+	const uint32_t& inTarget,
+	const bool& inTargetIsClient,
+	const int64_t& inValue,
+	const datagramPointer& inDatagram)
+{
+	this->m_events.push(simulatedEvent(
+		this->m_now + inDelayMicroseconds,
+		this->m_eventOrder++,
+		inType,
+		inTarget,
+		inTargetIsClient,
+		inValue,
+		inDatagram));
+};
+
+//----------------------------------------------------------------- sendDatagram
+// Implementation notes:
+//  Each datagram draws its own delay, so two sent together can arrive in
+//  either order even without the extra reordering delay
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::sendDatagram(
+	const boost::shared_ptr<simulatedDatagram>& inDatagram,
+	const uint32_t& inTarget,
+	const bool& inTargetIsClient)
+{
+	this->m_datagramsSent++;
+
+	std::uniform_real_distribution<double> percent(0.0, 100.0);
+
+	if(percent(this->m_random) < this->m_parameters.m_lossPercent)
+	{
+		this->m_datagramsLost++;
+
+		return;
+	}
+
+	std::uniform_int_distribution<int64_t> delay(
+		this->m_parameters.m_minimumDelayMilliseconds * microsecondsPerMillisecond,
+		std::max(
+			this->m_parameters.m_minimumDelayMilliseconds,
+			this->m_parameters.m_maximumDelayMilliseconds) * microsecondsPerMillisecond);
+
+	int64_t delayMicroseconds = delay(this->m_random);
+
+	if(percent(this->m_random) < this->m_parameters.m_reorderPercent)
+	{
+		std::uniform_int_distribution<int64_t> reorderDelay(
+			0,
+			this->m_parameters.m_reorderDelayMilliseconds * microsecondsPerMillisecond);
+
+		delayMicroseconds += reorderDelay(this->m_random);
+	}
+
+	this->schedule(
+		delayMicroseconds,
+		et_DATAGRAM,
+		inTarget,
+		inTargetIsClient,
+		0,
+		inDatagram);
+};
+
+//----------------------------------------------------------------- processEvent
+// Implementation notes:
+//  Periodic events schedule their next occurrence, the workload events are
+//  Poisson processes and stop at the end of the simulated duration
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::processEvent(
+	const simulatedEvent& inEvent)
+{
+	const int64_t workloadEnd =
+		static_cast<int64_t>(this->m_parameters.m_simulatedSeconds) * 1000 * microsecondsPerMillisecond;
+
+	switch(inEvent.m_type)
+	{
+		case et_DATAGRAM:
+		{
+			if(inEvent.m_targetIsClient)
+			{
+				this->clientReceive(
+					inEvent.m_target,
+					*inEvent.m_datagram);
+			}
+			else
+			{
+				this->serverReceive(
+					static_cast<int16_t>(inEvent.m_target),
+					*inEvent.m_datagram);
+			}
+
+			break;
+		}
+		case et_SYNC:
+		{
+			this->sendSyncPayloads(
+				static_cast<int16_t>(inEvent.m_target));
+
+			this->schedule(
+				this->m_parameters.m_syncIntervalMilliseconds * microsecondsPerMillisecond,
+				et_SYNC,
+				inEvent.m_target,
+				false);
+
+			break;
+		}
+		case et_FORWARD:
+		{
+			this->attemptForward(
+				static_cast<int16_t>(inEvent.m_target));
+
+			this->schedule(
+				this->m_parameters.m_forwardIntervalMilliseconds * microsecondsPerMillisecond,
+				et_FORWARD,
+				inEvent.m_target,
+				false);
+
+			break;
+		}
+		case et_POLL:
+		{
+			boost::shared_ptr<simulatedDatagram> get(
+				new simulatedDatagram(dt_CLIENT_GET));
+
+			get->m_client = inEvent.m_target;
+
+			this->sendDatagram(
+				get,
+				this->m_clients[inEvent.m_target].m_serverIndex,
+				false);
+
+			this->schedule(
+				this->m_parameters.m_updateIntervalMilliseconds * microsecondsPerMillisecond,
+				et_POLL,
+				inEvent.m_target,
+				true);
+
+			break;
+		}
+		case et_RETRANSMIT:
+		{
+			simulatedClient& client = this->m_clients[inEvent.m_target];
+
+			std::map<int64_t, std::pair<uint64_t, int64_t>>::iterator unacknowledged =
+				client.m_unacknowledged.find(inEvent.m_value);
+
+			if(unacknowledged == client.m_unacknowledged.end())
+			{
+				break;
+			}
+
+			this->sendFromClient(
+				inEvent.m_target,
+				inEvent.m_value);
+
+			unacknowledged->second.second = std::min<int64_t>(
+				unacknowledged->second.second * 2,
+				constants::clientMaximumRetransmitMilliseconds);
+
+			this->schedule(
+				unacknowledged->second.second * microsecondsPerMillisecond,
+				et_RETRANSMIT,
+				inEvent.m_target,
+				true,
+				inEvent.m_value);
+
+			break;
+		}
+		case et_SEND:
+		{
+			if(this->m_now >= workloadEnd || this->m_clients.size() < 2)
+			{
+				break;
+			}
+
+			std::uniform_int_distribution<uint32_t> anyClient(
+				0,
+				static_cast<uint32_t>(this->m_clients.size() - 1));
+
+			const uint32_t sender = anyClient(this->m_random);
+
+			uint32_t destination = sender;
+
+			while(destination == sender)
+			{
+				destination = anyClient(this->m_random);
+			}
+
+			simulatedClient& client = this->m_clients[sender];
+
+			const int64_t sequenceNumber = client.m_nextSequenceNumber++;
+
+			client.m_unacknowledged.insert(std::make_pair(
+				sequenceNumber,
+				std::make_pair(
+					static_cast<uint64_t>(this->m_messages.size()),
+					static_cast<int64_t>(constants::clientInitialRetransmitMilliseconds))));
+
+			this->m_messages.push_back(sentMessage(
+				destination,
+				this->m_now));
+
+			this->sendFromClient(
+				sender,
+				sequenceNumber);
+
+			this->schedule(
+				constants::clientInitialRetransmitMilliseconds * microsecondsPerMillisecond,
+				et_RETRANSMIT,
+				sender,
+				true,
+				sequenceNumber);
+
+			this->schedule(
+				this->exponentialDelay(this->m_parameters.m_messagesPerSecond),
+				et_SEND,
+				0,
+				false);
+
+			break;
+		}
+		case et_RECONNECT:
+		{
+			if(this->m_now >= workloadEnd || this->m_servers.size() < 2)
+			{
+				break;
+			}
+
+			std::uniform_int_distribution<uint32_t> anyClient(
+				0,
+				static_cast<uint32_t>(this->m_clients.size() - 1));
+
+			std::uniform_int_distribution<int16_t> anyOtherServer(
+				1,
+				static_cast<int16_t>(this->m_servers.size() - 1));
+
+			const uint32_t clientIndex = anyClient(this->m_random);
+
+			this->reconnectClient(
+				clientIndex,
+				static_cast<int16_t>(
+					(this->m_clients[clientIndex].m_serverIndex + anyOtherServer(this->m_random))
+					% this->m_servers.size()));
+
+			this->schedule(
+				this->exponentialDelay(this->m_parameters.m_reconnectsPerSecond),
+				et_RECONNECT,
+				0,
+				false);
+
+			break;
+		}
+	}
+};
+
+//---------------------------------------------------------------- serverReceive
+// Implementation notes:
+//  Follows the cases of server::listenLoopUDP for the messages modelled
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::serverReceive(
+	const int16_t& inServerIndex,
+	const simulatedDatagram& inDatagram)
+{
+	simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	switch(inDatagram.m_type)
+	{
+		case dt_SYNC:
+		{
+			// a newer version may have arrived as an update already
+			if(inDatagram.m_origin == inServerIndex
+				|| inDatagram.m_version < thisServer.m_versions[inDatagram.m_origin])
+			{
+				break;
+			}
+
+			clientList list;
+
+			if(!this->assembleClientList(
+				thisServer.m_assemblies[inDatagram.m_origin],
+				inDatagram,
+				list))
+			{
+				break;
+			}
+
+			if(*list != *thisServer.m_lists[inDatagram.m_origin])
+			{
+				thisServer.m_retryHeldMessagesNow = true;
+
+				thisServer.m_lists[inDatagram.m_origin] = list;
+
+				this->checkConvergence();
+			}
+
+			thisServer.m_filters[inDatagram.m_origin] = bloomFilter();
+			thisServer.m_versions[inDatagram.m_origin] = inDatagram.m_version;
+
+			break;
+		}
+		case dt_SUMMARY:
+		{
+			if(inDatagram.m_origin == inServerIndex
+				|| inDatagram.m_version < thisServer.m_versions[inDatagram.m_origin])
+			{
+				break;
+			}
+
+			// names the filter rules out are removed, a different count
+			// asks for the list
+			std::set<uint32_t> list;
+
+			for(const uint32_t& clientIndex : *thisServer.m_lists[inDatagram.m_origin])
+			{
+				if(inDatagram.m_filter->mayContain(nameOfClient(clientIndex)))
+				{
+					list.insert(clientIndex);
+				}
+			}
+
+			if(list.size() != thisServer.m_lists[inDatagram.m_origin]->size())
+			{
+				thisServer.m_lists[inDatagram.m_origin] =
+					boost::make_shared<const std::set<uint32_t>>(list);
+
+				this->checkConvergence();
+			}
+
+			thisServer.m_filters[inDatagram.m_origin] = *inDatagram.m_filter;
+			thisServer.m_versions[inDatagram.m_origin] = inDatagram.m_version;
+
+			if(list.size() != inDatagram.m_count)
+			{
+				this->requestClientList(
+					inServerIndex,
+					inDatagram.m_origin);
+			}
+
+			break;
+		}
+		case dt_LIST_REQUEST:
+		{
+			this->sendClientList(
+				inServerIndex,
+				inDatagram.m_origin,
+				inDatagram.m_fromServer);
+
+			break;
+		}
+		case dt_UPDATE:
+		{
+			if(inDatagram.m_origin == inServerIndex
+				|| inDatagram.m_version <= thisServer.m_versions[inDatagram.m_origin])
+			{
+				break;
+			}
+
+			// after a lost update the list is wrong until the next sync
+			std::set<uint32_t> list(*thisServer.m_lists[inDatagram.m_origin]);
+
+			if(inDatagram.m_joined)
+			{
+				list.insert(inDatagram.m_client);
+
+				thisServer.m_retryHeldMessagesNow = true;
+			}
+			else
+			{
+				list.erase(inDatagram.m_client);
+			}
+
+			thisServer.m_lists[inDatagram.m_origin] =
+				boost::make_shared<const std::set<uint32_t>>(list);
+
+			thisServer.m_versions[inDatagram.m_origin] = inDatagram.m_version;
+
+			this->forwardMembershipUpdate(
+				inServerIndex,
+				inDatagram);
+
+			this->checkConvergence();
+
+			break;
+		}
+		case dt_CLIENT_SEND:
+		{
+			boost::shared_ptr<simulatedDatagram> acknowledgement(
+				new simulatedDatagram(dt_SERVER_ACK));
+
+			acknowledgement->m_fromServer = inServerIndex;
+			acknowledgement->m_sequenceNumber = inDatagram.m_sequenceNumber;
+
+			this->sendDatagram(
+				acknowledgement,
+				inDatagram.m_client,
+				true);
+
+			// a retransmission whose ACK was lost is not routed again
+			if(thisServer.m_sendsReceived.insert(std::make_pair(
+				inDatagram.m_client,
+				inDatagram.m_sequenceNumber)).second)
+			{
+				this->routeMessage(
+					inServerIndex,
+					inDatagram.m_messageIdentifier,
+					inDatagram.m_destination,
+					0,
+					true);
+			}
+
+			break;
+		}
+		case dt_CLIENT_GET:
+		{
+			for(const uint64_t& messageIdentifier : thisServer.m_messagesByClient[inDatagram.m_client])
+			{
+				boost::shared_ptr<simulatedDatagram> delivery(
+					new simulatedDatagram(dt_DELIVERY));
+
+				delivery->m_fromServer = inServerIndex;
+				delivery->m_messageIdentifier = messageIdentifier;
+
+				this->sendDatagram(
+					delivery,
+					inDatagram.m_client,
+					true);
+			}
+
+			break;
+		}
+		case dt_CLIENT_ACK:
+		{
+			std::map<uint32_t, std::list<uint64_t>>::iterator messageList =
+				thisServer.m_messagesByClient.find(inDatagram.m_client);
+
+			if(messageList != thisServer.m_messagesByClient.end())
+			{
+				messageList->second.remove(
+					inDatagram.m_messageIdentifier);
+			}
+
+			break;
+		}
+		case dt_RELAY:
+		{
+			const dataMessage relayMessage(inDatagram.m_encodedRelay);
+
+			const bool firstReceipt =
+				thisServer.m_links[inDatagram.m_fromServer].receive(
+					relayMessage);
+
+			// duplicates are ACKed too, the previous ACK may have been lost
+			boost::shared_ptr<simulatedDatagram> acknowledgement(
+				new simulatedDatagram(dt_RELAY_ACK));
+
+			acknowledgement->m_fromServer = inServerIndex;
+			acknowledgement->m_acknowledgement = boost::make_shared<const dataMessage>(
+				thisServer.m_links[inDatagram.m_fromServer].createAcknowledgement());
+
+			this->sendDatagram(
+				acknowledgement,
+				inDatagram.m_fromServer,
+				false);
+
+			if(firstReceipt)
+			{
+				this->routeMessage(
+					inServerIndex,
+					static_cast<uint64_t>(relayMessage.viewSequenceNumber()),
+					static_cast<uint32_t>(std::stoul(relayMessage.viewDestinationIdentifier().substr(1))),
+					relayMessage.viewHopCount(),
+					true);
+			}
+
+			break;
+		}
+		case dt_RELAY_ACK:
+		{
+			thisServer.m_links[inDatagram.m_fromServer].receiveAcknowledgement(
+				*inDatagram.m_acknowledgement,
+				timeOfLinkClock(this->m_now));
+
+			this->flushServerLink(
+				inServerIndex,
+				inDatagram.m_fromServer);
+
+			break;
+		}
+		case dt_SERVER_ACK:
+		case dt_DELIVERY:
+		{
+			// only clients are sent these
+			break;
+		}
+	}
+};
+
+//---------------------------------------------------------------- clientReceive
+// Implementation notes:
+//  Every delivery is ACKed to the server that sent it, the first one of a
+//  message is when it was delivered
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::clientReceive(
+	const uint32_t& inClientIndex,
+	const simulatedDatagram& inDatagram)
+{
+	simulatedClient& client = this->m_clients[inClientIndex];
+
+	if(inDatagram.m_type == dt_SERVER_ACK)
+	{
+		client.m_unacknowledged.erase(
+			inDatagram.m_sequenceNumber);
+
+		return;
+	}
+
+	if(inDatagram.m_type != dt_DELIVERY)
+	{
+		return;
+	}
+
+	boost::shared_ptr<simulatedDatagram> acknowledgement(
+		new simulatedDatagram(dt_CLIENT_ACK));
+
+	acknowledgement->m_client = inClientIndex;
+	acknowledgement->m_messageIdentifier = inDatagram.m_messageIdentifier;
+
+	this->sendDatagram(
+		acknowledgement,
+		inDatagram.m_fromServer,
+		false);
+
+	if(client.m_received.insert(inDatagram.m_messageIdentifier).second)
+	{
+		this->m_messagesDelivered++;
+
+		this->m_delivery.record(static_cast<uint64_t>(
+			this->m_now - this->m_messages[inDatagram.m_messageIdentifier].m_sentMicroseconds));
+	}
+};
+
+//---------------------------------------------------- lookupServerIndexOfClient
+// Implementation notes:
+//  As server::lookupServerIndexOfClient, this server's own clients first
+//------------------------------------------------------------------------------
+int16_t protocolSimulator::simulationState::lookupServerIndexOfClient(
+	const int16_t& inServerIndex,
+	const uint32_t& inClientIndex) const
+{
+	const simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	if(thisServer.m_lists[inServerIndex]->count(inClientIndex) > 0)
+	{
+		return inServerIndex;
+	}
+
+	for(int16_t serverIndex = 0;
+		serverIndex < this->m_topology.numberOfServers();
+		serverIndex++)
+	{
+		if(serverIndex != inServerIndex
+			&& thisServer.m_lists[serverIndex]->count(inClientIndex) > 0)
+		{
+			return serverIndex;
+		}
+	}
+
+	return -1;
+};
+
+//----------------------------------------------------------------- routeMessage
+// Implementation notes:
+//  As server::routeMessage for a message to one client. A queued message
+//  is sent to the client straight away and again on each get until it is
+//  ACKed.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::routeMessage(
+	const int16_t& inServerIndex,
+	const uint64_t& inMessageIdentifier,
+	const uint32_t& inDestination,
+	const uint16_t& inHopCount,
+	const bool& inEnforceHopLimit)
+{
+	simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	const int16_t destinationServerIndex =
+		this->lookupServerIndexOfClient(
+			inServerIndex,
+			inDestination);
+
+	if(destinationServerIndex == inServerIndex)
+	{
+		thisServer.m_messagesByClient[inDestination].push_back(
+			inMessageIdentifier);
+
+		boost::shared_ptr<simulatedDatagram> delivery(
+			new simulatedDatagram(dt_DELIVERY));
+
+		delivery->m_fromServer = inServerIndex;
+		delivery->m_messageIdentifier = inMessageIdentifier;
+
+		this->sendDatagram(
+			delivery,
+			inDestination,
+			true);
+
+		return;
+	}
+
+	if(destinationServerIndex != -1
+		&& (!inEnforceHopLimit
+			|| inHopCount < this->m_topology.numberOfServers()))
+	{
+		const int16_t nextHop =
+			thisServer.m_routingTable.viewNextHop(destinationServerIndex);
+
+		if(nextHop != -1)
+		{
+			this->relayToServer(
+				inServerIndex,
+				nextHop,
+				inMessageIdentifier,
+				inDestination,
+				inHopCount);
+
+			return;
+		}
+	}
+
+	// as server::confirmClientLocation, the servers whose filter may have
+	// the client are asked for their list
+	if(destinationServerIndex == -1
+		&& this->m_parameters.m_membershipFilterBits != 0)
+	{
+		for(int16_t serverIndex = 0;
+			serverIndex < this->m_topology.numberOfServers();
+			serverIndex++)
+		{
+			if(serverIndex != inServerIndex
+				&& thisServer.m_filters[serverIndex].mayContain(nameOfClient(inDestination)))
+			{
+				this->requestClientList(
+					inServerIndex,
+					serverIndex);
+			}
+		}
+	}
+
+	thisServer.m_heldMessages.insert(std::make_pair(
+		this->m_now + constants::heldRetryMinimumMilliseconds * microsecondsPerMillisecond,
+		heldMessage(inMessageIdentifier, inDestination, inHopCount, 0)));
+};
+
+//---------------------------------------------------------------- relayToServer
+// Implementation notes:
+//  The relay is a real message, numbered and windowed by the real link.
+//  Its sequence number is the message identifier.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::relayToServer(
+	const int16_t& inServerIndex,
+	const int16_t& inNextHop,
+	const uint64_t& inMessageIdentifier,
+	const uint32_t& inDestination,
+	const uint16_t& inHopCount)
+{
+	dataMessage relayMessage(
+		static_cast<int64_t>(inMessageIdentifier),
+		constants::MessageType::mt_SERVER_SEND,
+		this->m_topology.viewServerName(inServerIndex),
+		nameOfClient(inDestination),
+		"");
+
+	for(uint16_t hop = 0; hop <= inHopCount; hop++)
+	{
+		relayMessage.incrementHopCount();
+	}
+
+	this->m_servers[inServerIndex]->m_links[inNextHop].enqueue(
+		boost::make_shared<const encodedMessage>(relayMessage));
+
+	this->flushServerLink(
+		inServerIndex,
+		inNextHop);
+};
+
+//-------------------------------------------------------------- flushServerLink
+// Implementation notes:
+//  The datagram carries the bytes the server would put on the wire
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::flushServerLink(
+	const int16_t& inServerIndex,
+	const int16_t& inPeerIndex)
+{
+	for(const reliableLink::relayTransmission& transmission :
+		this->m_servers[inServerIndex]->m_links[inPeerIndex].takeSendable(timeOfLinkClock(this->m_now)))
+	{
+		boost::shared_ptr<simulatedDatagram> relay(
+			new simulatedDatagram(dt_RELAY));
+
+		relay->m_fromServer = inServerIndex;
+
+		for(const boost::asio::const_buffer& buffer :
+			transmission.m_relay->viewBuffersForRelay(transmission.m_linkSequenceNumbers))
+		{
+			const char* bytes = boost::asio::buffer_cast<const char*>(buffer);
+
+			relay->m_encodedRelay.insert(
+				relay->m_encodedRelay.end(),
+				bytes,
+				bytes + boost::asio::buffer_size(buffer));
+		}
+
+		this->sendDatagram(
+			relay,
+			inPeerIndex,
+			false);
+	}
+};
+
+//--------------------------------------------------------------- attemptForward
+// Implementation notes:
+//  As one pass of server::attemptForward: held messages that are due, or
+//  all of them after a list changed, are retried, then relays whose timers
+//  expired are retransmitted
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::attemptForward(
+	const int16_t& inServerIndex)
+{
+	simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	std::multimap<int64_t, heldMessage>::iterator lastDue =
+		thisServer.m_retryHeldMessagesNow
+			? thisServer.m_heldMessages.end()
+			: thisServer.m_heldMessages.upper_bound(this->m_now);
+
+	std::vector<heldMessage> messagesToCheck;
+
+	for(std::multimap<int64_t, heldMessage>::iterator it = thisServer.m_heldMessages.begin();
+		it != lastDue;
+		it++)
+	{
+		messagesToCheck.push_back(
+			it->second);
+	}
+
+	thisServer.m_heldMessages.erase(
+		thisServer.m_heldMessages.begin(),
+		lastDue);
+
+	thisServer.m_retryHeldMessagesNow = false;
+
+	for(const heldMessage& messageToCheck : messagesToCheck)
+	{
+		const int16_t destinationServerIndex =
+			this->lookupServerIndexOfClient(
+				inServerIndex,
+				messageToCheck.m_destination);
+
+		if(destinationServerIndex == -1
+			|| (destinationServerIndex != inServerIndex
+				&& thisServer.m_routingTable.viewNextHop(destinationServerIndex) == -1))
+		{
+			const uint16_t attempts = messageToCheck.m_attempts + 1;
+
+			int64_t backoff = constants::heldRetryMaximumMilliseconds;
+
+			if(attempts < 16)
+			{
+				backoff = std::min<int64_t>(
+					backoff,
+					static_cast<int64_t>(constants::heldRetryMinimumMilliseconds) << attempts);
+			}
+
+			thisServer.m_heldMessages.insert(std::make_pair(
+				this->m_now + backoff * microsecondsPerMillisecond,
+				heldMessage(messageToCheck.m_messageIdentifier, messageToCheck.m_destination, messageToCheck.m_hopCount, attempts)));
+
+			continue;
+		}
+
+		this->routeMessage(
+			inServerIndex,
+			messageToCheck.m_messageIdentifier,
+			messageToCheck.m_destination,
+			messageToCheck.m_hopCount,
+			false);
+	}
+
+	for(const int16_t& neighbour : thisServer.m_routingTable.viewNeighbours())
+	{
+		this->flushServerLink(
+			inServerIndex,
+			neighbour);
+	}
+};
+
+//------------------------------------------------------------- sendSyncPayloads
+// Implementation notes:
+//  As server::sendSyncPayloadsToServer for every neighbour. With filters,
+//  a list longer than its encoded filter is sent as a summary, which is
+//  built once and shared by the neighbours.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::sendSyncPayloads(
+	const int16_t& inServerIndex)
+{
+	const simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	const uint16_t filterBits =
+		this->m_parameters.m_membershipFilterBits;
+
+	for(int16_t originIndex = 0;
+		originIndex < this->m_topology.numberOfServers();
+		originIndex++)
+	{
+		if(thisServer.m_versions[originIndex] == 0)
+		{
+			continue;
+		}
+
+		const std::set<uint32_t>& list = *thisServer.m_lists[originIndex];
+
+		boost::shared_ptr<bloomFilter> summary;
+
+		// a filter is written six bits to a character
+		if(filterBits != 0
+			&& listLength(list) > static_cast<size_t>(filterBits + 5) / 6)
+		{
+			summary.reset(
+				new bloomFilter(filterBits, list.size()));
+
+			for(const uint32_t& clientIndex : list)
+			{
+				summary->add(
+					nameOfClient(clientIndex));
+			}
+		}
+
+		for(const int16_t& neighbour : thisServer.m_routingTable.viewNeighbours())
+		{
+			if(!thisServer.m_routingTable.shouldAdvertise(originIndex, neighbour))
+			{
+				continue;
+			}
+
+			if(!summary)
+			{
+				this->sendClientList(
+					inServerIndex,
+					originIndex,
+					neighbour);
+
+				continue;
+			}
+
+			boost::shared_ptr<simulatedDatagram> summaryDatagram(
+				new simulatedDatagram(dt_SUMMARY));
+
+			summaryDatagram->m_fromServer = inServerIndex;
+			summaryDatagram->m_origin = originIndex;
+			summaryDatagram->m_version = thisServer.m_versions[originIndex];
+			summaryDatagram->m_count = static_cast<uint32_t>(list.size());
+			summaryDatagram->m_filter = summary;
+
+			this->m_syncPayloadBytes +=
+				std::to_string(list.size()).size() + 1 + (filterBits + 5) / 6;
+
+			this->sendDatagram(
+				summaryDatagram,
+				neighbour,
+				false);
+		}
+	}
+};
+
+//--------------------------------------------------------------- sendClientList
+// Implementation notes:
+//  As server::sendNameList, the list is split into parts of at most the
+//  part length in names, each its own datagram that can be lost on its
+//  own. A part has at least one name, an empty list is one empty part.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::sendClientList(
+	const int16_t& inServerIndex,
+	const int16_t& inOriginIndex,
+	const int16_t& inNeighbourIndex)
+{
+	const simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	const clientList& list = thisServer.m_lists[inOriginIndex];
+
+	std::vector<std::set<uint32_t>> parts(1);
+	std::vector<size_t> partLengths(1, 0);
+
+	for(const uint32_t& clientIndex : *list)
+	{
+		const size_t nameLength = nameOfClient(clientIndex).size() + 1;
+
+		if(!parts.back().empty()
+			&& partLengths.back() + nameLength > constants::syncListPartLength)
+		{
+			parts.push_back(std::set<uint32_t>());
+			partLengths.push_back(0);
+		}
+
+		parts.back().insert(clientIndex);
+		partLengths.back() += nameLength;
+	}
+
+	for(size_t part = 0; part < parts.size(); part++)
+	{
+		boost::shared_ptr<simulatedDatagram> sync(
+			new simulatedDatagram(dt_SYNC));
+
+		sync->m_fromServer = inServerIndex;
+		sync->m_origin = inOriginIndex;
+		sync->m_version = thisServer.m_versions[inOriginIndex];
+		sync->m_part = static_cast<uint16_t>(part);
+		sync->m_partCount = static_cast<uint16_t>(parts.size());
+
+		// a list of one part is shared with the datagram, not copied
+		sync->m_list = parts.size() == 1
+			? list
+			: boost::make_shared<const std::set<uint32_t>>(parts[part]);
+
+		this->m_syncPayloadBytes += partLengths[part]
+			+ std::to_string(part).size() + std::to_string(parts.size()).size() + 2;
+
+		this->sendDatagram(
+			sync,
+			inNeighbourIndex,
+			false);
+	}
+};
+
+//----------------------------------------------------------- assembleClientList
+// Implementation notes:
+//  As server::assembleNameList, a list is only returned once every part of
+//  one version has arrived, from any neighbour
+//------------------------------------------------------------------------------
+bool protocolSimulator::simulationState::assembleClientList(
+	listAssembly& inAssembly,
+	const simulatedDatagram& inSync,
+	clientList& outList)
+{
+	if(inSync.m_partCount == 1)
+	{
+		outList = inSync.m_list;
+
+		return true;
+	}
+
+	if(inSync.m_version < inAssembly.m_version)
+	{
+		return false;
+	}
+
+	if(inSync.m_version != inAssembly.m_version
+		|| inAssembly.m_parts.size() != inSync.m_partCount)
+	{
+		inAssembly.m_version = inSync.m_version;
+		inAssembly.m_parts.assign(inSync.m_partCount, clientList());
+		inAssembly.m_partsReceived = 0;
+	}
+
+	if(inAssembly.m_parts[inSync.m_part])
+	{
+		return false;
+	}
+
+	inAssembly.m_parts[inSync.m_part] = inSync.m_list;
+	inAssembly.m_partsReceived++;
+
+	if(inAssembly.m_partsReceived < inSync.m_partCount)
+	{
+		return false;
+	}
+
+	std::set<uint32_t> list;
+
+	for(const clientList& part : inAssembly.m_parts)
+	{
+		list.insert(
+			part->begin(),
+			part->end());
+	}
+
+	outList = boost::make_shared<const std::set<uint32_t>>(list);
+
+	inAssembly.m_parts.clear();
+	inAssembly.m_partsReceived = 0;
+
+	return true;
+};
+
+//------------------------------------------------------------ requestClientList
+// Implementation notes:
+//  As server::requestClientList, at most once per sync interval for each
+//  list, from the next hop towards the origin
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::requestClientList(
+	const int16_t& inServerIndex,
+	const int16_t& inOriginIndex)
+{
+	simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	if(thisServer.m_listRequestTimes[inOriginIndex] >= 0
+		&& this->m_now - thisServer.m_listRequestTimes[inOriginIndex]
+			< this->m_parameters.m_syncIntervalMilliseconds * microsecondsPerMillisecond)
+	{
+		return;
+	}
+
+	const int16_t nextHop =
+		thisServer.m_routingTable.viewNextHop(inOriginIndex);
+
+	if(nextHop == -1)
+	{
+		return;
+	}
+
+	boost::shared_ptr<simulatedDatagram> request(
+		new simulatedDatagram(dt_LIST_REQUEST));
+
+	request->m_fromServer = inServerIndex;
+	request->m_origin = inOriginIndex;
+
+	this->sendDatagram(
+		request,
+		nextHop,
+		false);
+
+	thisServer.m_listRequestTimes[inOriginIndex] = this->m_now;
+
+	this->m_listRequests++;
+};
+
+//------------------------------------------------------ publishMembershipChange
+// Implementation notes:
+//  Rebuilds this server's own list under a new version and announces the
+//  change to the neighbours
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::publishMembershipChange(
+	const int16_t& inServerIndex,
+	const uint32_t& inClientIndex,
+	const bool& inJoined)
+{
+	simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	std::set<uint32_t> list(*thisServer.m_lists[inServerIndex]);
+
+	if(inJoined)
+	{
+		list.insert(inClientIndex);
+	}
+	else
+	{
+		list.erase(inClientIndex);
+	}
+
+	thisServer.m_lists[inServerIndex] =
+		boost::make_shared<const std::set<uint32_t>>(list);
+
+	simulatedDatagram update(dt_UPDATE);
+
+	update.m_origin = inServerIndex;
+	update.m_version = ++thisServer.m_versions[inServerIndex];
+	update.m_joined = inJoined;
+	update.m_client = inClientIndex;
+
+	this->forwardMembershipUpdate(
+		inServerIndex,
+		update);
+};
+
+//------------------------------------------------------ forwardMembershipUpdate
+// Implementation notes:
+//  The same rule as the periodic sync
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::forwardMembershipUpdate(
+	const int16_t& inServerIndex,
+	const simulatedDatagram& inUpdate)
+{
+	const simulatedServer& thisServer = *this->m_servers[inServerIndex];
+
+	for(const int16_t& neighbour : thisServer.m_routingTable.viewNeighbours())
+	{
+		if(!thisServer.m_routingTable.shouldAdvertise(inUpdate.m_origin, neighbour))
+		{
+			continue;
+		}
+
+		boost::shared_ptr<simulatedDatagram> update(
+			new simulatedDatagram(inUpdate));
+
+		update->m_fromServer = inServerIndex;
+
+		this->sendDatagram(
+			update,
+			neighbour,
+			false);
+	}
+};
+
+//--------------------------------------------------------------- sendFromClient
+// Implementation notes:
+//  Sent to the server the client is on now, which after a move is not the
+//  one it first sent the message to
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::sendFromClient(
+	const uint32_t& inClientIndex,
+	const int64_t& inSequenceNumber)
+{
+	const simulatedClient& client = this->m_clients[inClientIndex];
+
+	const uint64_t messageIdentifier =
+		client.m_unacknowledged.at(inSequenceNumber).first;
+
+	boost::shared_ptr<simulatedDatagram> send(
+		new simulatedDatagram(dt_CLIENT_SEND));
+
+	send->m_client = inClientIndex;
+	send->m_sequenceNumber = inSequenceNumber;
+	send->m_messageIdentifier = messageIdentifier;
+	send->m_destination = this->m_messages[messageIdentifier].m_destination;
+
+	this->sendDatagram(
+		send,
+		client.m_serverIndex,
+		false);
+};
+
+//-------------------------------------------------------------- reconnectClient
+// Implementation notes:
+//  The client leaves one server and connects to the other at once. The
+//  messages queued for it on the old server are held there and routed to
+//  it again once the old server learns where it went.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::reconnectClient(
+	const uint32_t& inClientIndex,
+	const int16_t& inServerIndex)
+{
+	const int16_t previousServerIndex =
+		this->m_clients[inClientIndex].m_serverIndex;
+
+	simulatedServer& previousServer = *this->m_servers[previousServerIndex];
+
+	this->publishMembershipChange(
+		previousServerIndex,
+		inClientIndex,
+		false);
+
+	for(const uint64_t& messageIdentifier : previousServer.m_messagesByClient[inClientIndex])
+	{
+		previousServer.m_heldMessages.insert(std::make_pair(
+			this->m_now + constants::heldRetryMinimumMilliseconds * microsecondsPerMillisecond,
+			heldMessage(messageIdentifier, inClientIndex, 0, 0)));
+	}
+
+	previousServer.m_messagesByClient.erase(
+		inClientIndex);
+
+	this->m_clients[inClientIndex].m_serverIndex = inServerIndex;
+
+	this->publishMembershipChange(
+		inServerIndex,
+		inClientIndex,
+		true);
+
+	this->m_servers[inServerIndex]->m_retryHeldMessagesNow = true;
+
+	// a client that moves again before the last move converged counts once
+	this->m_movesStarted++;
+
+	if(this->m_pendingMoves.erase(inClientIndex) > 0)
+	{
+		this->m_movesStarted--;
+	}
+
+	this->m_pendingMoves.insert(std::make_pair(
+		inClientIndex,
+		pendingMove(this->m_now, inServerIndex)));
+
+	this->checkConvergence();
+};
+
+//------------------------------------------------------------- checkConvergence
+// Implementation notes:
+//  A move has converged once every server looks the client up on the
+//  server it moved to. Only a few moves are pending at any time.
+//------------------------------------------------------------------------------
+void protocolSimulator::simulationState::checkConvergence()
+{
+	std::map<uint32_t, pendingMove>::iterator move = this->m_pendingMoves.begin();
+
+	while(move != this->m_pendingMoves.end())
+	{
+		bool converged = true;
+
+		for(int16_t serverIndex = 0;
+			converged && serverIndex < this->m_topology.numberOfServers();
+			serverIndex++)
+		{
+			converged = this->lookupServerIndexOfClient(serverIndex, move->first)
+				== move->second.m_serverIndex;
+		}
+
+		if(!converged)
+		{
+			move++;
+			continue;
+		}
+
+		this->m_convergence.record(static_cast<uint64_t>(
+			this->m_now - move->second.m_startMicroseconds));
+
+		move = this->m_pendingMoves.erase(move);
+	}
+};
+
+//------------------------------------------------------------- exponentialDelay
+// Implementation notes:
+//  The time to the next event of a Poisson process
+//------------------------------------------------------------------------------
+int64_t protocolSimulator::simulationState::exponentialDelay(
+	const double& inPerSecond)
+{
+	std::exponential_distribution<double> seconds(inPerSecond);
+
+	return static_cast<int64_t>(seconds(this->m_random) * 1000 * microsecondsPerMillisecond) + 1;
+};
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  Clients are spread over the servers in turn, every server starts with
+//  every list at version 1
+//------------------------------------------------------------------------------
+protocolSimulator::protocolSimulator(
+	const serverTopology& inTopology,
+	const simulationParameters& inParameters) :
+	m_state(new simulationState(inTopology, inParameters))
+{
+	simulationState& state = *this->m_state;
+
+	const int16_t numberOfServers = state.m_topology.numberOfServers();
+
+	std::vector<std::set<uint32_t>> clientsByServer(numberOfServers);
+
+	for(uint32_t clientIndex = 0;
+		clientIndex < inParameters.m_clientsPerServer * numberOfServers;
+		clientIndex++)
+	{
+		const int16_t serverIndex = static_cast<int16_t>(clientIndex % numberOfServers);
+
+		state.m_clients.push_back(simulationState::simulatedClient(
+			serverIndex));
+
+		clientsByServer[serverIndex].insert(clientIndex);
+	}
+
+	for(int16_t serverIndex = 0; serverIndex < numberOfServers; serverIndex++)
+	{
+		state.m_servers.push_back(boost::make_shared<simulationState::simulatedServer>(
+			state.m_topology,
+			serverIndex));
+	}
+
+	for(const boost::shared_ptr<simulationState::simulatedServer>& currentServer : state.m_servers)
+	{
+		for(int16_t serverIndex = 0; serverIndex < numberOfServers; serverIndex++)
+		{
+			currentServer->m_lists[serverIndex] =
+				boost::make_shared<const std::set<uint32_t>>(clientsByServer[serverIndex]);
+		}
+	}
+};
+
+//------------------------------------------------------------------- destructor
+// Implementation notes:
+//  The state is deleted by its scoped pointer
+//------------------------------------------------------------------------------
+protocolSimulator::~protocolSimulator()
+{
+};
+
+//-------------------------------------------------------------------------- run
+// Implementation notes:
+//  The periodic events start at random offsets within their intervals, as
+//  separate processes would. Messages sent near the end are given the
+//  drain time to be delivered.
+//------------------------------------------------------------------------------
+void protocolSimulator::run()
+{
+	simulationState& state = *this->m_state;
+
+	const int64_t endMicroseconds =
+		(static_cast<int64_t>(state.m_parameters.m_simulatedSeconds) * 1000
+			+ constants::simulationDrainMilliseconds) * microsecondsPerMillisecond;
+
+	for(int16_t serverIndex = 0;
+		serverIndex < state.m_topology.numberOfServers();
+		serverIndex++)
+	{
+		std::uniform_int_distribution<int64_t> syncOffset(
+			0,
+			state.m_parameters.m_syncIntervalMilliseconds * microsecondsPerMillisecond);
+
+		std::uniform_int_distribution<int64_t> forwardOffset(
+			0,
+			state.m_parameters.m_forwardIntervalMilliseconds * microsecondsPerMillisecond);
+
+		state.schedule(syncOffset(state.m_random), et_SYNC, serverIndex, false);
+		state.schedule(forwardOffset(state.m_random), et_FORWARD, serverIndex, false);
+	}
+
+	for(uint32_t clientIndex = 0; clientIndex < state.m_clients.size(); clientIndex++)
+	{
+		std::uniform_int_distribution<int64_t> pollOffset(
+			0,
+			state.m_parameters.m_updateIntervalMilliseconds * microsecondsPerMillisecond);
+
+		state.schedule(pollOffset(state.m_random), et_POLL, clientIndex, true);
+	}
+
+	if(state.m_parameters.m_messagesPerSecond > 0.0)
+	{
+		state.schedule(
+			state.exponentialDelay(state.m_parameters.m_messagesPerSecond),
+			et_SEND,
+			0,
+			false);
+	}
+
+	if(state.m_parameters.m_reconnectsPerSecond > 0.0)
+	{
+		state.schedule(
+			state.exponentialDelay(state.m_parameters.m_reconnectsPerSecond),
+			et_RECONNECT,
+			0,
+			false);
+	}
+
+	while(!state.m_events.empty()
+		&& state.m_events.top().m_microseconds <= endMicroseconds)
+	{
+		const simulationState::simulatedEvent nextEvent(state.m_events.top());
+
+		state.m_events.pop();
+
+		state.m_now = nextEvent.m_microseconds;
+		state.m_eventCount++;
+
+		state.processEvent(
+			nextEvent);
+	}
+};
+
+//-------------------------------------------------------------- resultsAsString
+// Implementation notes:
+//  Times are recorded in microseconds and printed in milliseconds
+//------------------------------------------------------------------------------
+std::string protocolSimulator::resultsAsString() const
+{
+	const simulationState& state = *this->m_state;
+
+	const double simulatedSeconds =
+		state.m_parameters.m_simulatedSeconds
+		+ constants::simulationDrainMilliseconds / 1000.0;
+
+	std::stringstream ss;
+
+	ss.setf(std::ios::fixed);
+	ss.precision(1);
+
+	ss << "sync " << state.m_parameters.m_syncIntervalMilliseconds
+		<< " ms, forward " << state.m_parameters.m_forwardIntervalMilliseconds
+		<< " ms, update " << state.m_parameters.m_updateIntervalMilliseconds
+		<< " ms: moves known everywhere p50 " << state.m_convergence.viewPercentile(50.0) / 1000.0
+		<< " p99 " << state.m_convergence.viewPercentile(99.0) / 1000.0
+		<< " max " << state.m_convergence.viewMaximum() / 1000.0
+		<< " ms (" << state.m_convergence.viewCount() << "/" << state.m_movesStarted
+		<< "), delivered p50 " << state.m_delivery.viewPercentile(50.0) / 1000.0
+		<< " p99 " << state.m_delivery.viewPercentile(99.0) / 1000.0
+		<< " max " << state.m_delivery.viewMaximum() / 1000.0
+		<< " ms (" << state.m_messagesDelivered << "/" << state.m_messages.size()
+		<< "), " << state.m_datagramsSent / simulatedSeconds << " datagrams/s, "
+		<< state.m_datagramsLost << " lost, "
+		<< state.m_syncPayloadBytes / simulatedSeconds << " sync bytes/s, "
+		<< state.m_listRequests << " list requests";
+
+	return ss.str();
+};
+
+//-------------------------------------------------------------------- converged
+// Implementation notes:
+//  A move is only recorded once every server knows of it, and a message
+//  once it is delivered, so both counts fall short of a run that did not
+//  converge
+//------------------------------------------------------------------------------
+bool protocolSimulator::converged() const
+{
+	const simulationState& state = *this->m_state;
+
+	return state.m_convergence.viewCount() == state.m_movesStarted
+		&& state.m_messagesDelivered == state.m_messages.size();
+};
+
+//--------------------------------------------------------------- viewEventCount
+// Implementation notes:
+//  Returns the number of events processed
+//------------------------------------------------------------------------------
+uint64_t protocolSimulator::viewEventCount() const
+{
+	return this->m_state->m_eventCount;
+};
\ No newline at end of file
@@ -0,0 +1,171 @@
+#pragma once
+
+// STL
+#include <string>
+#include <cstdint>
+
+// Boost
+#include <boost/scoped_ptr.hpp>
+
+// Project
+#include "../Common/constants.h"
+#include "../Common/serverTopology.h"
+
+// Runs the sync, forwarding and delivery protocol of a cluster of servers
+// and their clients as discrete events on a virtual clock, over an
+// in-memory network that loses, delays and reorders datagrams. Nothing
+// sleeps, so simulated hours take seconds, and a run is the same every
+// time for the same parameters and seed.
+//
+// The servers use the real routing table, reliable links and Bloom
+// filters. The rest of the server is modelled after server.cpp: membership
+// lists with versions, updates passed on as they happen and lists synced
+// periodically in parts that fit a datagram, or as filter summaries with
+// lists asked for when they disagree, messages held until their recipient
+// is known and retried with a backoff, and messages queued for a client
+// until it polls and ACKs them.
+//
+// It does not model sessions, clients are known by name only; heartbeats,
+// servers going down and restarting; channels and broadcasts; message
+// expiry, backlog quotas and the spool; the client's delivery buffer and
+// send window; the server batching membership updates each forwarding
+// tick and sending them over its reliable links, here each change is one
+// datagram that is not retransmitted; or sockets dropping datagrams when
+// their buffer is full.
+// Every datagram it sends fits the receive buffer, the sync lists being
+// split as the server splits them, so truncation is not modelled either.
+class protocolSimulator
+{
+public:
+
+	class simulationParameters
+	{
+	public:
+		simulationParameters() :
+			m_clientsPerServer(10),
+			m_messagesPerSecond(20.0),
+			m_reconnectsPerSecond(1.0),
+			m_simulatedSeconds(600),
+			m_syncIntervalMilliseconds(constants::syncIntervalMilliseconds),
+			m_forwardIntervalMilliseconds(constants::forwardIntervalMilliseconds),
+			m_updateIntervalMilliseconds(constants::updateIntervalMilliseconds),
+			m_lossPercent(1.0),
+			m_minimumDelayMilliseconds(1),
+			m_maximumDelayMilliseconds(5),
+			m_reorderPercent(5.0),
+			m_reorderDelayMilliseconds(20),
+			m_membershipFilterBits(0),
+			m_seed(1)
+		{
+		};
+
+		// clients send to random clients, and move to random servers
+		uint32_t m_clientsPerServer;
+		double m_messagesPerSecond;
+		double m_reconnectsPerSecond;
+		uint32_t m_simulatedSeconds;
+
+		// the intervals being tuned
+		uint16_t m_syncIntervalMilliseconds;
+		uint16_t m_forwardIntervalMilliseconds;
+		uint16_t m_updateIntervalMilliseconds;
+
+		// the network: each datagram is lost, or delayed uniformly between
+		// the minimum and maximum, and some are held back further, which
+		// reorders them
+		double m_lossPercent;
+		uint16_t m_minimumDelayMilliseconds;
+		uint16_t m_maximumDelayMilliseconds;
+		double m_reorderPercent;
+		uint16_t m_reorderDelayMilliseconds;
+
+		// 0 syncs full lists, otherwise lists longer than a filter of this
+		// many bits are synced as summaries
+		uint16_t m_membershipFilterBits;
+
+		uint32_t m_seed;
+	};
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for a simulation of the servers of the topology, with
+	//  its routing mode, each starting with its clients connected and known
+	//  to every other server.
+	//
+	// Method:    protocolSimulator
+	// FullName:  protocolSimulator::protocolSimulator
+	// Access:    public
+	// Returns:
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const simulationParameters& inParameters
+	//--------------------------------------------------------------------------
+	protocolSimulator(
+		const serverTopology& inTopology,
+		const simulationParameters& inParameters);
+
+	//--------------------------------------------------------------- destructor
+	// Brief Description
+	//  Destructor, defined where the simulation state is complete.
+	//
+	// Method:    ~protocolSimulator
+	// FullName:  protocolSimulator::~protocolSimulator
+	// Access:    public
+	// Returns:
+	//--------------------------------------------------------------------------
+	~protocolSimulator();
+
+	//---------------------------------------------------------------------- run
+	// Brief Description
+	//  Runs the simulation for the simulated duration of the parameters.
+	//
+	// Method:    run
+	// FullName:  protocolSimulator::run
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void run();
+
+	//---------------------------------------------------------- resultsAsString
+	// Brief Description
+	//  Returns the outcome of the run on one line: how long clients that
+	//  moved took to be known by every server, how long messages took to
+	//  be delivered, both in milliseconds, the datagrams and sync payload
+	//  bytes sent per simulated second, and the lists asked for.
+	//
+	// Method:    resultsAsString
+	// FullName:  protocolSimulator::resultsAsString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string resultsAsString() const;
+
+	//---------------------------------------------------------------- converged
+	// Brief Description
+	//  Returns whether, by the end of the run, every client that moved was
+	//  known by every server and every message was delivered.
+	//
+	// Method:    converged
+	// FullName:  protocolSimulator::converged
+	// Access:    public
+	// Returns:   bool
+	//--------------------------------------------------------------------------
+	bool converged() const;
+
+	//----------------------------------------------------------- viewEventCount
+	// Brief Description
+	//  Returns the number of events the run processed.
+	//
+	// Method:    viewEventCount
+	// FullName:  protocolSimulator::viewEventCount
+	// Access:    public
+	// Returns:   uint64_t
+	//--------------------------------------------------------------------------
+	uint64_t viewEventCount() const;
+
+private:
+
+	class simulationState;
+
+	// Member Variables
+	boost::scoped_ptr<simulationState> m_state;
+};
\ No newline at end of file
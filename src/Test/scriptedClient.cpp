@@ -0,0 +1,402 @@
+// STL
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+
+// Project
+#include "scriptedClient.h"
+#include "../Common/constants.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The socket is non-blocking so receiveMessages() can drain it and return.
+//  Sequence numbers start from the time, as the interactive client's do.
+//------------------------------------------------------------------------------
+scriptedClient::scriptedClient(
+	const std::string& inUsername,
+	const serverTopology& inTopology,
+	const int16_t& inServerIndex,
+	boost::asio::io_service& ioService) :
+	m_UDPsocket(ioService),
+	m_serverEndPoint(inTopology.viewServerEndpoint(inServerIndex)),
+	m_username(inUsername),
+	m_serverName(inTopology.viewServerName(inServerIndex)),
+	m_sequenceNumber(
+		boost::chrono::duration_cast<boost::chrono::milliseconds>(
+			boost::chrono::system_clock::now().time_since_epoch()).count() * 1000),
+	m_deliveryBuffer(inTopology.viewReorderHoldMilliseconds()),
+	m_acknowledgementFramesSent(0)
+{
+	this->m_UDPsocket.open(
+		boost::asio::ip::udp::v4());
+
+	this->m_UDPsocket.non_blocking(true);
+};
+
+//---------------------------------------------------------------------- connect
+// Implementation notes:
+//  Same connection message as the interactive client
+//------------------------------------------------------------------------------
+void scriptedClient::connect()
+{
+	const dataMessage connectionMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_CONNECT,
+		this->m_username,
+		this->m_serverName,
+		this->m_username + " has connected.");
+
+	this->sendToServer(
+		connectionMessage);
+};
+
+//------------------------------------------------------------------- disconnect
+// Implementation notes:
+//  Same disconnection message as the interactive client
+//------------------------------------------------------------------------------
+void scriptedClient::disconnect()
+{
+	const dataMessage disconnectionMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_DISCONNECT,
+		this->m_username,
+		this->m_serverName,
+		this->m_username + " has disconnected.");
+
+	this->sendToServer(
+		disconnectionMessage);
+};
+
+//------------------------------------------------------------------------- join
+// Implementation notes:
+//  Same join message as the interactive client's /join command
+//------------------------------------------------------------------------------
+void scriptedClient::join(
+	const std::string& inChannel)
+{
+	this->m_outbox.enqueue(dataMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_JOIN,
+		this->m_username,
+		this->m_serverName,
+		inChannel));
+
+	this->flushOutbox();
+};
+
+//------------------------------------------------------------------------ leave
+// Implementation notes:
+//  Same leave message as the interactive client's /leave command
+//------------------------------------------------------------------------------
+void scriptedClient::leave(
+	const std::string& inChannel)
+{
+	this->m_outbox.enqueue(dataMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_LEAVE,
+		this->m_username,
+		this->m_serverName,
+		inChannel));
+
+	this->flushOutbox();
+};
+
+//------------------------------------------------------------------------- send
+// Implementation notes:
+//  Same chat message as the interactive client's /m command, sent reliably
+//------------------------------------------------------------------------------
+void scriptedClient::send(
+	const std::string& inDestination,
+	const std::string& inPayload)
+{
+	dataMessage chatMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_SEND,
+		this->m_username,
+		inDestination,
+		inPayload);
+
+	chatMessage.setPreviousSequenceNumber(
+		this->m_lastSequenceNumberByDestination[inDestination]);
+
+	this->m_lastSequenceNumberByDestination[inDestination] =
+		chatMessage.viewSequenceNumber();
+
+	this->m_outbox.enqueue(
+		chatMessage);
+
+	this->flushOutbox();
+};
+
+//-------------------------------------------------------------- requestMessages
+// Implementation notes:
+//  Same get message as the interactive client's get loop, pending ACKs go
+//  first so the server does not send those messages again
+//------------------------------------------------------------------------------
+void scriptedClient::requestMessages()
+{
+	this->sendAcknowledgements(
+		true);
+
+	const dataMessage getMessage(
+		this->sequenceNumber(),
+		constants::mt_CLIENT_GET,
+		this->m_username,
+		this->m_serverName,
+		"blank");
+
+	this->sendToServer(
+		getMessage);
+};
+
+//-------------------------------------------------------------- receiveMessages
+// Implementation notes:
+//  Reads until the socket would block. Anything that fails to parse is
+//  dropped, the same way the server drops it. Flushing the outbox here is
+//  what drives its retransmissions.
+//------------------------------------------------------------------------------
+std::vector<dataMessage> scriptedClient::receiveMessages()
+{
+	std::vector<dataMessage> outMessages;
+
+	// thousands of clients poll from a few threads, which share a buffer
+	// as large as a datagram can be rather than each allocating one
+	thread_local std::vector<char> receiveBuffer(constants::receiveBufferLength);
+
+	while(true)
+	{
+		boost::asio::ip::udp::endpoint senderEndPoint;
+
+		boost::system::error_code error;
+
+		const size_t receivedLength =
+			this->m_UDPsocket.receive_from(
+				boost::asio::buffer(receiveBuffer),
+				senderEndPoint, 0, error);
+
+		if(error == boost::asio::error::would_block)
+		{
+			break;
+		}
+		else if(error && error != boost::asio::error::message_size)
+		{
+			continue;
+		}
+
+		const std::vector<char> receivedPayload(
+			receiveBuffer.begin(),
+			receiveBuffer.begin() + receivedLength);
+
+		try
+		{
+			const dataMessage message(
+				receivedPayload);
+
+			if(message.viewMessageType() == constants::MessageType::mt_SERVER_ACK)
+			{
+				this->m_outbox.receiveAcknowledgement(
+					message.viewSequenceNumber(),
+					clientOutbox::outboxClock::now());
+				continue;
+			}
+
+			if(message.viewMessageType() == constants::MessageType::mt_SERVER_SESSION)
+			{
+				this->m_sessionIdentifier = message.viewPayload() == "0"
+					? ""
+					: constants::sessionPrefix() + message.viewPayload();
+
+				if(this->m_sessionIdentifier.empty())
+				{
+					this->connect();
+				}
+				continue;
+			}
+
+			if(message.viewMessageType() != constants::MessageType::mt_SERVER_SEND)
+			{
+				continue;
+			}
+
+			const deliveryBuffer::deliveryClock::time_point now =
+				deliveryBuffer::deliveryClock::now();
+
+			if(this->m_pendingAcknowledgements.isEmpty())
+			{
+				this->m_timeOfOldestPendingAcknowledgement = now;
+			}
+
+			this->m_pendingAcknowledgements.add(
+				message.viewSourceIdentifier(),
+				message.viewSequenceNumber());
+
+			const std::vector<dataMessage> deliverable =
+				this->m_deliveryBuffer.receive(
+					message,
+					now);
+
+			outMessages.insert(
+				outMessages.end(),
+				deliverable.begin(),
+				deliverable.end());
+		}
+		catch(std::exception& exception)
+		{
+			// Malformed message, drop it
+		}
+	}
+
+	const std::vector<dataMessage> expired =
+		this->m_deliveryBuffer.takeExpired(
+			deliveryBuffer::deliveryClock::now());
+
+	outMessages.insert(
+		outMessages.end(),
+		expired.begin(),
+		expired.end());
+
+	this->sendAcknowledgements(
+		false);
+
+	this->flushOutbox();
+
+	return outMessages;
+};
+
+//---------------------------------------------------------------- forgetSession
+// Implementation notes:
+//  The server keeps the session until the client times out or connects again
+//------------------------------------------------------------------------------
+void scriptedClient::forgetSession()
+{
+	this->m_sessionIdentifier.clear();
+};
+
+//-------------------------------------------------------- viewSessionIdentifier
+// Implementation notes:
+//  Returns a const reference to the session, with its prefix
+//------------------------------------------------------------------------------
+const std::string& scriptedClient::viewSessionIdentifier() const
+{
+	return this->m_sessionIdentifier;
+};
+
+//----------------------------------------------------------------- viewUsername
+// Implementation notes:
+//  Returns a const reference to the username
+//------------------------------------------------------------------------------
+const std::string& scriptedClient::viewUsername() const
+{
+	return this->m_username;
+};
+
+//------------------------------------------------------------------- viewOutbox
+// Implementation notes:
+//  Returns a const reference to the outbox
+//------------------------------------------------------------------------------
+const clientOutbox& scriptedClient::viewOutbox() const
+{
+	return this->m_outbox;
+};
+
+//----------------------------------------------------------- viewDeliveryBuffer
+// Implementation notes:
+//  Returns a const reference to the delivery buffer
+//------------------------------------------------------------------------------
+const deliveryBuffer& scriptedClient::viewDeliveryBuffer() const
+{
+	return this->m_deliveryBuffer;
+};
+
+//------------------------------------------------ viewAcknowledgementFramesSent
+// Implementation notes:
+//  Returns a const reference to the number of ACK frames sent
+//------------------------------------------------------------------------------
+const uint64_t& scriptedClient::viewAcknowledgementFramesSent() const
+{
+	return this->m_acknowledgementFramesSent;
+};
+
+//----------------------------------------------------------------- sendToServer
+// Implementation notes:
+//  Errors are ignored, a lost datagram shows up in the measurements. The
+//  session is put in as the interactive client does.
+//------------------------------------------------------------------------------
+void scriptedClient::sendToServer(
+	const dataMessage& inMessage)
+{
+	boost::system::error_code ignoredError;
+
+	dataMessage messageToSend(inMessage);
+
+	if(inMessage.viewMessageType() != constants::MessageType::mt_CLIENT_CONNECT
+		&& !this->m_sessionIdentifier.empty())
+	{
+		messageToSend.setSourceIdentifier(
+			this->m_sessionIdentifier);
+	}
+
+	this->m_UDPsocket.send_to(
+		boost::asio::buffer(messageToSend.asCharVector()),
+		this->m_serverEndPoint, 0, ignoredError);
+};
+
+//------------------------------------------------------------------ flushOutbox
+// Implementation notes:
+//  Same as the interactive client, without the lock. Failed messages are
+//  only counted, the benchmarks see them as undelivered.
+//------------------------------------------------------------------------------
+void scriptedClient::flushOutbox()
+{
+	for(const dataMessage& message :
+		this->m_outbox.takeSendable(clientOutbox::outboxClock::now()))
+	{
+		this->sendToServer(
+			message);
+	}
+
+	this->m_outbox.takeFailed();
+};
+
+//--------------------------------------------------------- sendAcknowledgements
+// Implementation notes:
+//  Same delay as the interactive client, checked on every receive
+//------------------------------------------------------------------------------
+void scriptedClient::sendAcknowledgements(
+	const bool& inForce)
+{
+	if(this->m_pendingAcknowledgements.isEmpty())
+	{
+		return;
+	}
+
+	if(!inForce
+		&& deliveryBuffer::deliveryClock::now() - this->m_timeOfOldestPendingAcknowledgement
+			< boost::chrono::milliseconds(constants::acknowledgementDelayMilliseconds))
+	{
+		return;
+	}
+
+	for(const dataMessage& frame :
+		this->m_pendingAcknowledgements.asMessages(this->m_username, this->m_serverName))
+	{
+		this->sendToServer(
+			frame);
+
+		this->m_acknowledgementFramesSent++;
+	}
+
+	this->m_pendingAcknowledgements.clear();
+};
+
+//--------------------------------------------------------------- sequenceNumber
+// Implementation notes:
+//  Increments the sequence number every time it is used, self explanatory.
+//------------------------------------------------------------------------------
+const int64_t& scriptedClient::sequenceNumber()
+{
+	return ++this->m_sequenceNumber;
+};
\ No newline at end of file
@@ -0,0 +1,272 @@
+#pragma once
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Boost
+#include <boost/asio.hpp>
+
+// Project
+#include "../Common/acknowledgementFrame.h"
+#include "../Common/dataMessage.h"
+#include "../Common/serverTopology.h"
+#include "../Client/clientOutbox.h"
+#include "../Client/deliveryBuffer.h"
+
+class scriptedClient
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for the scripted client. Unlike the interactive client,
+	//  it has no threads and no command line; the harness drives it by
+	//  calling its methods directly.
+	//
+	// Method:    scriptedClient
+	// FullName:  scriptedClient::scriptedClient
+	// Access:    public
+	// Returns:
+	// Parameter: const std::string& inUsername
+	// Parameter: const serverTopology& inTopology
+	// Parameter: const int16_t& inServerIndex
+	// Parameter: boost::asio::io_service& ioService
+	//--------------------------------------------------------------------------
+	scriptedClient(
+		const std::string& inUsername,
+		const serverTopology& inTopology,
+		const int16_t& inServerIndex,
+		boost::asio::io_service& ioService);
+
+	//------------------------------------------------------------------ connect
+	// Brief Description
+	//  Sends the connection message to the server.
+	//
+	// Method:    connect
+	// FullName:  scriptedClient::connect
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void connect();
+
+	//--------------------------------------------------------------- disconnect
+	// Brief Description
+	//  Sends the disconnection message to the server.
+	//
+	// Method:    disconnect
+	// FullName:  scriptedClient::disconnect
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void disconnect();
+
+	//--------------------------------------------------------------------- join
+	// Brief Description
+	//  Subscribes to a channel, sent reliably like a chat message.
+	//
+	// Method:    join
+	// FullName:  scriptedClient::join
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inChannel
+	//--------------------------------------------------------------------------
+	void join(
+		const std::string& inChannel);
+
+	//-------------------------------------------------------------------- leave
+	// Brief Description
+	//  Unsubscribes from a channel, sent reliably like a chat message.
+	//
+	// Method:    leave
+	// FullName:  scriptedClient::leave
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inChannel
+	//--------------------------------------------------------------------------
+	void leave(
+		const std::string& inChannel);
+
+	//--------------------------------------------------------------------- send
+	// Brief Description
+	//  Sends a chat message destined for another client. The message goes
+	//  through the outbox, as the interactive client's do, so it is only
+	//  retransmitted while receiveMessages() is being called.
+	//
+	// Method:    send
+	// FullName:  scriptedClient::send
+	// Access:    public
+	// Returns:   void
+	// Parameter: const std::string& inDestination
+	// Parameter: const std::string& inPayload
+	//--------------------------------------------------------------------------
+	void send(
+		const std::string& inDestination,
+		const std::string& inPayload);
+
+	//---------------------------------------------------------- requestMessages
+	// Brief Description
+	//  Sends a get to the server, which makes it send back every message
+	//  it holds for this client.
+	//
+	// Method:    requestMessages
+	// FullName:  scriptedClient::requestMessages
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void requestMessages();
+
+	//---------------------------------------------------------- receiveMessages
+	// Brief Description
+	//  Returns every message that has already arrived from the server without
+	//  blocking. Each message is ACKed, as the interactive client does, in
+	//  frames sent once the oldest ACK has waited the coalescing delay. Each
+	//  message goes through the delivery buffer, so duplicates are left out and
+	//  messages are returned in the order they were sent. ACKs from the
+	//  server are applied to the outbox, which is then flushed.
+	//
+	// Method:    receiveMessages
+	// FullName:  scriptedClient::receiveMessages
+	// Access:    public
+	// Returns:   std::vector<dataMessage>
+	//--------------------------------------------------------------------------
+	std::vector<dataMessage> receiveMessages();
+
+	//------------------------------------------------------------ forgetSession
+	// Brief Description
+	//  Drops the session, so the client goes on sending its username like
+	//  one that missed the server's session reply.
+	//
+	// Method:    forgetSession
+	// FullName:  scriptedClient::forgetSession
+	// Access:    public
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void forgetSession();
+
+	//---------------------------------------------------- viewSessionIdentifier
+	// Brief Description
+	//  Returns a const reference to the session sent in place of the
+	//  username, empty until the server gives one.
+	//
+	// Method:    viewSessionIdentifier
+	// FullName:  scriptedClient::viewSessionIdentifier
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewSessionIdentifier() const;
+
+	//------------------------------------------------------------- viewUsername
+	// Brief Description
+	//  Returns a const reference to the username of this client.
+	//
+	// Method:    viewUsername
+	// FullName:  scriptedClient::viewUsername
+	// Access:    public
+	// Returns:   const std::string&
+	//--------------------------------------------------------------------------
+	const std::string& viewUsername() const;
+
+	//--------------------------------------------------------------- viewOutbox
+	// Brief Description
+	//  Returns a const reference to the outbox, for its statistics.
+	//
+	// Method:    viewOutbox
+	// FullName:  scriptedClient::viewOutbox
+	// Access:    public
+	// Returns:   const clientOutbox&
+	//--------------------------------------------------------------------------
+	const clientOutbox& viewOutbox() const;
+
+	//------------------------------------------------------- viewDeliveryBuffer
+	// Brief Description
+	//  Returns a const reference to the delivery buffer, for its statistics.
+	//
+	// Method:    viewDeliveryBuffer
+	// FullName:  scriptedClient::viewDeliveryBuffer
+	// Access:    public
+	// Returns:   const deliveryBuffer&
+	//--------------------------------------------------------------------------
+	const deliveryBuffer& viewDeliveryBuffer() const;
+
+	//-------------------------------------------- viewAcknowledgementFramesSent
+	// Brief Description
+	//  Returns the number of ACK frames sent to the server.
+	//
+	// Method:    viewAcknowledgementFramesSent
+	// FullName:  scriptedClient::viewAcknowledgementFramesSent
+	// Access:    public
+	// Returns:   const uint64_t&
+	//--------------------------------------------------------------------------
+	const uint64_t& viewAcknowledgementFramesSent() const;
+
+private:
+
+	//------------------------------------------------------------- sendToServer
+	// Brief Description
+	//  Sends a message to the server over UDP, from the client's session if
+	//  the server gave it one.
+	//
+	// Method:    sendToServer
+	// FullName:  scriptedClient::sendToServer
+	// Access:    private
+	// Returns:   void
+	// Parameter: const dataMessage& inMessage
+	//--------------------------------------------------------------------------
+	void sendToServer(
+		const dataMessage& inMessage);
+
+	//-------------------------------------------------------------- flushOutbox
+	// Brief Description
+	//  Sends whatever the outbox has ready to send.
+	//
+	// Method:    flushOutbox
+	// FullName:  scriptedClient::flushOutbox
+	// Access:    private
+	// Returns:   void
+	//--------------------------------------------------------------------------
+	void flushOutbox();
+
+	//----------------------------------------------------- sendAcknowledgements
+	// Brief Description
+	//  Sends the pending ACKs as frames once the oldest has waited the
+	//  coalescing delay, or straight away if forced.
+	//
+	// Method:    sendAcknowledgements
+	// FullName:  scriptedClient::sendAcknowledgements
+	// Access:    private
+	// Returns:   void
+	// Parameter: const bool& inForce
+	//--------------------------------------------------------------------------
+	void sendAcknowledgements(
+		const bool& inForce);
+
+	//----------------------------------------------------------- sequenceNumber
+	// Brief Description
+	//  Increments and returns the sequence number of this client.
+	//
+	// Method:    sequenceNumber
+	// FullName:  scriptedClient::sequenceNumber
+	// Access:    private
+	// Returns:   const int64_t&
+	//--------------------------------------------------------------------------
+	const int64_t& sequenceNumber();
+
+	// Member Variables
+	boost::asio::ip::udp::socket m_UDPsocket;
+	boost::asio::ip::udp::endpoint m_serverEndPoint;
+	std::string m_username;
+	std::string m_serverName;
+	int64_t m_sequenceNumber;
+	clientOutbox m_outbox;
+	deliveryBuffer m_deliveryBuffer;
+	std::map<std::string, int64_t> m_lastSequenceNumberByDestination;
+	acknowledgementFrame m_pendingAcknowledgements;
+	deliveryBuffer::deliveryClock::time_point m_timeOfOldestPendingAcknowledgement;
+	uint64_t m_acknowledgementFramesSent;
+
+	// empty until the server gives the client a session
+	std::string m_sessionIdentifier;
+};
\ No newline at end of file
@@ -1,22 +1,402 @@
-#include <boost/lambda/lambda.hpp>
+// STL
+#include <fstream>
 #include <iostream>
-#include <iterator>
-#include <algorithm>
+#include <sstream>
 #include <string>
 #include <vector>
 
-int main()
+// Project
+#include "clusterBenchmarks.h"
+#include "captureReplay.h"
+#include "clusterHarness.h"
+#include "impairmentProxy.h"
+#include "traceReport.h"
+#include "../Common/asyncLog.h"
+#include "../Common/serverTopology.h"
+#include "../Common/stageProfiler.h"
+
+int main(int argc, char* argv[])
 {
-	std::string a = "a";
-	std::string b = "b";
-	std::string c = "c";
+	std::string benchmark("all");
+	std::string configurationFilePath("");
+	std::string routingMode("");
+	std::string traceDirectory("");
+	std::string capturePath("");
+	double replaySpeed = 1.0;
+	std::string impairment("");
+	uint16_t frontPort = 0;
+	std::string frontServer("");
+	int16_t numberOfServers = 5;
+	bool verbose = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const std::string argument(argv[i]);
+
+		if(argument == "-v")
+		{
+			verbose = true;
+		}
+		else if(argument == "-c" && i + 1 < argc)
+		{
+			configurationFilePath = argv[++i];
+		}
+		else if(argument == "-r" && i + 1 < argc)
+		{
+			routingMode = argv[++i];
+		}
+		else if(argument == "-t" && i + 1 < argc)
+		{
+			traceDirectory = argv[++i];
+		}
+		else if(argument == "-p" && i + 1 < argc)
+		{
+			capturePath = argv[++i];
+		}
+		else if(argument == "-x" && i + 1 < argc)
+		{
+			replaySpeed = std::stod(argv[++i]);
+		}
+		else if(argument == "-i" && i + 1 < argc)
+		{
+			impairment = argv[++i];
+		}
+		else if(argument == "-f" && i + 2 < argc)
+		{
+			frontPort = static_cast<uint16_t>(std::stoi(argv[++i]));
+			frontServer = argv[++i];
+		}
+		else if(argument == "-n" && i + 1 < argc)
+		{
+			numberOfServers = static_cast<int16_t>(std::stoi(argv[++i]));
+		}
+		else
+		{
+			benchmark = argument;
+		}
+	}
+
+	// The servers log every datagram to std::cout, keep the report readable
+	// and do not spend the benchmarks formatting lines nobody reads
+	std::ostream report(std::cout.rdbuf());
+
+	if(!verbose)
+	{
+		std::cout.rdbuf(nullptr);
+	}
+
+	std::vector<std::string> failed;
+
+	try
+	{
+		// by default the cluster runs on ephemeral loopback ports, a
+		// configuration file can be given to use fixed ports instead
+		serverTopology topology(
+			configurationFilePath.empty()
+			? clusterHarness::loopbackTopology(numberOfServers)
+			: serverTopology(configurationFilePath));
+
+		// the routing mode of the configuration file can be overridden
+		if(routingMode == "chain")
+		{
+			topology.setRoutingMode(serverTopology::rm_CHAIN);
+		}
+		else if(routingMode == "mesh")
+		{
+			topology.setRoutingMode(serverTopology::rm_MESH);
+		}
+		else if(!routingMode.empty())
+		{
+			report << "Unknown routing mode: " << routingMode << std::endl;
+			return 1;
+		}
+
+		// the traces of a cluster that ran elsewhere are only reported on
+		if(!traceDirectory.empty())
+		{
+			traceReport traces(topology);
+
+			report << traces.addDirectory(traceDirectory)
+				<< " traces, step times in microseconds" << std::endl
+				<< traces.asString();
+
+			asyncLog::flush();
+			std::cout.rdbuf(report.rdbuf());
+
+			return 0;
+		}
+
+		if(!verbose)
+		{
+			topology.setLogLevel(
+				asyncLog::ll_WARNING,
+				1);
+		}
+
+		// the impairment script is read from a file, or given inline
+		std::vector<impairmentProxy::scriptStep> script(
+			1,
+			impairmentProxy::scriptStep(0, impairmentProxy::impairmentProfile()));
+
+		if(!impairment.empty())
+		{
+			std::ifstream scriptFile(impairment.c_str());
+			std::stringstream scriptText;
+
+			if(scriptFile)
+			{
+				scriptText << scriptFile.rdbuf();
+			}
+			else
+			{
+				scriptText << impairment;
+			}
+
+			script = impairmentProxy::parseScript(
+				scriptText.str());
+
+			clusterHarness::impairEveryCluster(
+				script);
+		}
+
+		// a proxy on its own, in front of a server that runs elsewhere
+		if(frontPort != 0)
+		{
+			const int16_t serverIndex =
+				topology.serverIndexFromIdentifier(frontServer);
+
+			if(serverIndex == -1)
+			{
+				report << "Unknown server: " << frontServer << std::endl;
+				return 1;
+			}
+
+			impairmentProxy proxy(
+				script);
+
+			proxy.addFront(
+				frontPort,
+				topology.viewServerEndpoint(serverIndex));
+
+			proxy.start();
+
+			report << "Forwarding port " << frontPort << " to "
+				<< topology.viewServerName(serverIndex)
+				<< ", press Enter to stop" << std::endl;
+
+			std::cin.get();
+
+			proxy.stop();
+
+			report << proxy.asString();
+
+			asyncLog::flush();
+			std::cout.rdbuf(report.rdbuf());
+
+			return 0;
+		}
+
+		// a capture is replayed into a cluster of the topology on its own
+		if(!capturePath.empty())
+		{
+			const captureReplay replay(
+				capturePath);
+
+			clusterHarness cluster(topology);
+			cluster.start();
+
+			const bool replayed = replay.replay(
+				cluster,
+				replaySpeed,
+				report);
+
+			cluster.stop();
+
+			asyncLog::flush();
+			std::cout.rdbuf(report.rdbuf());
+
+			return replayed ? 0 : 1;
+		}
+
+		if(benchmark == "all" || benchmark == "convergence")
+		{
+			if(!clusterBenchmarks::syncConvergence(
+				topology, report))
+			{
+				failed.push_back("convergence");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "latency")
+		{
+			if(!clusterBenchmarks::relayLatency(
+				topology, 20, report))
+			{
+				failed.push_back("latency");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "throughput")
+		{
+			if(!clusterBenchmarks::deliveryThroughput(
+				topology, 1000, report))
+			{
+				failed.push_back("throughput");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "failover")
+		{
+			if(!clusterBenchmarks::failover(
+				topology, report))
+			{
+				failed.push_back("failover");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "fanout")
+		{
+			if(!clusterBenchmarks::fanOut(
+				topology, 10000, 10, report))
+			{
+				failed.push_back("fanout");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "channel")
+		{
+			if(!clusterBenchmarks::channelFanOut(
+				topology, 10000, 100, 20, report))
+			{
+				failed.push_back("channel");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "session")
+		{
+			if(!clusterBenchmarks::sessionExpiry(
+				topology, 1000, report))
+			{
+				failed.push_back("session");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "backlog")
+		{
+			if(!clusterBenchmarks::backlogBounds(
+				topology, 10000, report))
+			{
+				failed.push_back("backlog");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "spool")
+		{
+			if(!clusterBenchmarks::spoolRecovery(
+				topology, 20, 1000, report))
+			{
+				failed.push_back("spool");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "trace")
+		{
+			if(!clusterBenchmarks::messageTracing(
+				topology, 200, report))
+			{
+				failed.push_back("trace");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "replay")
+		{
+			if(!clusterBenchmarks::captureAndReplay(
+				topology, 1000, report))
+			{
+				failed.push_back("replay");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "simulate")
+		{
+			if(!clusterBenchmarks::simulatedSweep(
+				topology, report))
+			{
+				failed.push_back("simulate");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "membership")
+		{
+			if(!clusterBenchmarks::membershipSummaries(
+				topology, 100, report))
+			{
+				failed.push_back("membership");
+			}
+
+			if(!clusterBenchmarks::membershipSummaries(
+				topology, 300, report))
+			{
+				failed.push_back("membership");
+			}
+
+			if(!clusterBenchmarks::membershipSummaries(
+				topology, 1000, report))
+			{
+				failed.push_back("membership");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "order")
+		{
+			if(!clusterBenchmarks::deliveryOrder(
+				report))
+			{
+				failed.push_back("order");
+			}
+		}
+
+		if(benchmark == "all" || benchmark == "lookup")
+		{
+			if(!clusterBenchmarks::sessionLookups(
+				topology, 1000, 20, report))
+			{
+				failed.push_back("lookup");
+			}
+		}
+	}
+	catch(std::exception& exception)
+	{
+		report << exception.what() << std::endl;
+		failed.push_back(exception.what());
+	}
+
+	// a benchmark fails when its own invariants do not hold, the exit code
+	// is for scripts running the harness
+	if(!failed.empty())
+	{
+		report << "Failed:";
+
+		for(const std::string& name : failed)
+		{
+			report << " " << name;
+		}
+
+		report << std::endl;
+	}
+
+	// profiling builds report where the servers spent their time
+	if(stageProfiler::isEnabled())
+	{
+		report << "Stage profile (written to profile.folded and profile.json)" << std::endl
+			<< stageProfiler::asString();
 
-	std::vector<std::string> test({
-		a,
-		b,
-		c});
+		stageProfiler::writeFiles(
+			"profile");
+	}
 
-	std::cout << test[0] << " " << test[1] << " " << test[2] << std::endl;
+	asyncLog::flush();
+	std::cout.rdbuf(report.rdbuf());
 
-	std::cin >> a;
+	return failed.empty() ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+// STL
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// Project
+#include "traceReport.h"
+
+//------------------------------------------------------------------ constructor
+// Implementation notes:
+//  The topology is copied, reports outlive the clusters they are about
+//------------------------------------------------------------------------------
+traceReport::traceReport(
+	const serverTopology& inTopology) :
+	m_topology(inTopology)
+{
+};
+
+//----------------------------------------------------------------- addDirectory
+// Implementation notes:
+//  Stamps are on the wall clock of the server that made them, a step
+//  between servers whose clocks disagree can come out negative. Those are
+//  counted as 0 rather than wrapping around.
+//------------------------------------------------------------------------------
+uint32_t traceReport::addDirectory(
+	const std::string& inDirectory)
+{
+	uint32_t tracesRead = 0;
+
+	boost::system::error_code error;
+
+	for(boost::filesystem::directory_iterator it(inDirectory, error);
+		!error && it != boost::filesystem::directory_iterator();
+		it.increment(error))
+	{
+		if(it->path().extension() != ".traces")
+		{
+			continue;
+		}
+
+		std::ifstream file(
+			it->path().string().c_str());
+
+		for(std::string line; std::getline(file, line); )
+		{
+			std::vector<messageTrace::traceStamp> stamps;
+
+			try
+			{
+				stamps = messageTrace(line).viewStamps();
+			}
+			catch(std::exception&)
+			{
+				continue;
+			}
+
+			if(stamps.size() < 2)
+			{
+				continue;
+			}
+
+			tracesRead++;
+
+			for(size_t step = 1; step < stamps.size(); step++)
+			{
+				std::stringstream name;
+
+				name << std::setw(2) << std::setfill('0') << step << " "
+					<< this->stampAsString(stamps[step - 1]) << " -> "
+					<< this->stampAsString(stamps[step]);
+
+				this->m_steps.addHistogram(name.str()).record(static_cast<uint64_t>(
+					std::max<int64_t>(stamps[step].m_microseconds - stamps[step - 1].m_microseconds, 0)));
+			}
+
+			this->m_steps.addHistogram("total").record(static_cast<uint64_t>(
+				std::max<int64_t>(stamps.back().m_microseconds - stamps.front().m_microseconds, 0)));
+		}
+	}
+
+	return tracesRead;
+};
+
+//--------------------------------------------------------------------- asString
+// Implementation notes:
+//  The step numbers sort the steps in the order they happen
+//------------------------------------------------------------------------------
+std::string traceReport::asString() const
+{
+	return this->m_steps.asString();
+};
+
+//---------------------------------------------------------------- stampAsString
+// Implementation notes:
+//  Servers that are not in the topology are shown by their index
+//------------------------------------------------------------------------------
+std::string traceReport::stampAsString(
+	const messageTrace::traceStamp& inStamp) const
+{
+	std::string serverName("#" + std::to_string(inStamp.m_serverIndex));
+
+	if(inStamp.m_serverIndex >= 0
+		&& inStamp.m_serverIndex <= this->m_topology.highestServerIndex())
+	{
+		serverName = this->m_topology.viewServerName(inStamp.m_serverIndex);
+	}
+
+	return serverName + " " + messageTrace::stageAsString(inStamp.m_stage);
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+// STL
+#include <string>
+#include <cstdint>
+
+// Project
+#include "../Common/messageTrace.h"
+#include "../Common/metricsRegistry.h"
+#include "../Common/serverTopology.h"
+
+class traceReport
+{
+public:
+
+	//-------------------------------------------------------------- constructor
+	// Brief Description
+	//  Constructor for an empty report. The topology names the servers of
+	//  the stamps.
+	//
+	// Method:    traceReport
+	// FullName:  traceReport::traceReport
+	// Access:    public
+	// Returns:
+	// Parameter: const serverTopology& inTopology
+	//--------------------------------------------------------------------------
+	traceReport(
+		const serverTopology& inTopology);
+
+	//------------------------------------------------------------- addDirectory
+	// Brief Description
+	//  Reads every .traces file the servers wrote to the directory. Each
+	//  line is the path of one message, from the server its sender was on
+	//  to its recipient's ACK. Malformed lines are skipped. Returns the
+	//  number of traces read.
+	//
+	// Method:    addDirectory
+	// FullName:  traceReport::addDirectory
+	// Access:    public
+	// Returns:   uint32_t
+	// Parameter: const std::string& inDirectory
+	//--------------------------------------------------------------------------
+	uint32_t addDirectory(
+		const std::string& inDirectory);
+
+	//----------------------------------------------------------------- asString
+	// Brief Description
+	//  Returns one line per step between two consecutive stamps, numbered
+	//  in the order they happen, then one for the whole path. Each gives
+	//  the count and percentiles of its time in microseconds.
+	//
+	// Method:    asString
+	// FullName:  traceReport::asString
+	// Access:    public
+	// Returns:   std::string
+	//--------------------------------------------------------------------------
+	std::string asString() const;
+
+private:
+
+	//------------------------------------------------------------ stampAsString
+	// Brief Description
+	//  Returns the name of the stamp's server and its stage.
+	//
+	// Method:    stampAsString
+	// FullName:  traceReport::stampAsString
+	// Access:    private
+	// Returns:   std::string
+	// Parameter: const messageTrace::traceStamp& inStamp
+	//--------------------------------------------------------------------------
+	std::string stampAsString(
+		const messageTrace::traceStamp& inStamp) const;
+
+	// Member Variables
+	serverTopology m_topology;
+	metricsRegistry m_steps;
+};
\ No newline at end of file